@@ -68,9 +68,16 @@ namespace Falcor
         }
     }
 
-    CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const ReadTextureTask::SharedPtr& pRecycle)
     {
-        return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex);
+        return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex, pRecycle);
+    }
+
+    std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
+    {
+        std::vector<uint8_t> result(getDataSize());
+        getData(result.data());
+        return result;
     }
 
     std::vector<uint8_t> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
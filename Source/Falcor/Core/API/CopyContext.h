@@ -43,11 +43,36 @@ namespace Falcor
         {
         public:
             using SharedPtr = std::shared_ptr<ReadTextureTask>;
-            static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+            /** Record a copy of a texture subresource into a readback buffer and submit it.
+                \param[in] pCtx The copy context to record into. The context is flushed without waiting.
+                \param[in] pTexture The texture to read.
+                \param[in] subresourceIndex The subresource to read.
+                \param[in] pRecycle Optional retired task whose readback buffer and fence are reused. The task must no longer be in use by the caller.
+            */
+            static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, const SharedPtr& pRecycle = nullptr);
+
+            /** Wait for the copy to finish and return the tightly packed texel data.
+            */
             std::vector<uint8_t> getData();
+
+            /** Wait for the copy to finish and write the tightly packed texel data to a caller provided buffer.
+                This does not allocate and may be called from a thread other than the one that created the task.
+                \param[in] pDst Destination buffer of at least getDataSize() bytes.
+            */
+            void getData(void* pDst);
+
+            /** Get the size in bytes of the tightly packed texel data.
+            */
+            size_t getDataSize() const;
+
+            /** Check if the GPU finished the copy, i.e., if getData() will return without blocking.
+            */
+            bool isReady() const { return mpFence->getGpuValue() >= mFenceValue; }
+
         private:
             ReadTextureTask() = default;
             GpuFence::SharedPtr mpFence;
+            uint64_t mFenceValue = 0;
             Buffer::SharedPtr mpBuffer;
             CopyContext* mpContext;
             uint32_t mRowCount;
@@ -129,8 +154,11 @@ namespace Falcor
         std::vector<uint8_t> readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
 
         /** Read texture data Asynchronously
+            \param[in] pTexture The texture to read.
+            \param[in] subresourceIndex The subresource to read.
+            \param[in] pRecycle Optional retired task whose readback buffer and fence are reused instead of allocating new ones.
         */
-        ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
+        ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const ReadTextureTask::SharedPtr& pRecycle = nullptr);
 
         /** Get the low-level context data
         */
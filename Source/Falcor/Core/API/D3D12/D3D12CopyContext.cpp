@@ -142,7 +142,7 @@ namespace Falcor
         pBuffer->unmap();
     }
 
-    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex)
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, const SharedPtr& pRecycle)
     {
         SharedPtr pThis = SharedPtr(new ReadTextureTask);
         pThis->mpContext = pCtx;
@@ -154,8 +154,15 @@ namespace Falcor
         ID3D12Device* pDevice = gpDevice->getApiHandle();
         pDevice->GetCopyableFootprints(&texDesc, subresourceIndex, 1, 0, &footprint, &pThis->mRowCount, &rowSize, &size);
 
-        //Create buffer
-        pThis->mpBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        // Reuse the readback buffer and fence of a retired task if possible, otherwise create new ones
+        if (pRecycle)
+        {
+            pRecycle->mpFence->syncCpu(pRecycle->mFenceValue);
+            if (pRecycle->mpBuffer->getSize() >= size) pThis->mpBuffer = pRecycle->mpBuffer;
+            pThis->mpFence = pRecycle->mpFence;
+        }
+        if (!pThis->mpBuffer) pThis->mpBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        if (!pThis->mpFence) pThis->mpFence = GpuFence::create();
 
         //Copy from texture to buffer
         D3D12_TEXTURE_COPY_LOCATION srcLoc = { pTexture->getApiHandle(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, subresourceIndex };
@@ -164,43 +171,44 @@ namespace Falcor
         pCtx->getLowLevelData()->getCommandList()->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
         pCtx->setPendingCommands(true);
 
-        // Create a fence and signal
-        pThis->mpFence = GpuFence::create();
+        // Signal the fence
         pCtx->flush(false);
-        pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
+        pThis->mFenceValue = pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
         pThis->mTextureFormat = pTexture->getFormat();
 
         return pThis;
     }
 
-    std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
+    size_t CopyContext::ReadTextureTask::getDataSize() const
     {
-        mpFence->syncCpu();
-        D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = mFootprint;
-
         // Calculate row size. GPU pitch can be different because it is aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
-        FALCOR_ASSERT(footprint.Footprint.Width % getFormatWidthCompressionRatio(mTextureFormat) == 0); // Should divide evenly
-        uint32_t actualRowSize = (footprint.Footprint.Width / getFormatWidthCompressionRatio(mTextureFormat)) * getFormatBytesPerBlock(mTextureFormat);
+        FALCOR_ASSERT(mFootprint.Footprint.Width % getFormatWidthCompressionRatio(mTextureFormat) == 0); // Should divide evenly
+        size_t actualRowSize = (mFootprint.Footprint.Width / getFormatWidthCompressionRatio(mTextureFormat)) * getFormatBytesPerBlock(mTextureFormat);
+        return actualRowSize * mRowCount * mFootprint.Footprint.Depth;
+    }
+
+    void CopyContext::ReadTextureTask::getData(void* pDst)
+    {
+        mpFence->syncCpu(mFenceValue);
+        const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = mFootprint;
+        size_t actualRowSize = getDataSize() / ((size_t)mRowCount * footprint.Footprint.Depth);
 
         // Get buffer data
-        std::vector<uint8_t> result;
-        result.resize(mRowCount * actualRowSize * footprint.Footprint.Depth);
-        uint8_t* pData = reinterpret_cast<uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
 
         for (uint32_t z = 0; z < footprint.Footprint.Depth; z++)
         {
-            const uint8_t* pSrcZ = pData + z * footprint.Footprint.RowPitch * mRowCount;
-            uint8_t* pDstZ = result.data() + z * actualRowSize * mRowCount;
+            const uint8_t* pSrcZ = pData + z * (size_t)footprint.Footprint.RowPitch * mRowCount;
+            uint8_t* pDstZ = reinterpret_cast<uint8_t*>(pDst) + z * actualRowSize * mRowCount;
             for (uint32_t y = 0; y < mRowCount; y++)
             {
-                const uint8_t* pSrc = pSrcZ + y * footprint.Footprint.RowPitch;
-                uint8_t* pDst = pDstZ + y * actualRowSize;
-                memcpy(pDst, pSrc, actualRowSize);
+                const uint8_t* pSrc = pSrcZ + y * (size_t)footprint.Footprint.RowPitch;
+                uint8_t* pDstRow = pDstZ + y * actualRowSize;
+                memcpy(pDstRow, pSrc, actualRowSize);
             }
         }
 
         mpBuffer->unmap();
-        return result;
     }
 
     static void d3d12ResourceBarrier(const Resource* pResource, Resource::State newState, Resource::State oldState, uint32_t subresourceIndex, ID3D12GraphicsCommandList* pCmdList)
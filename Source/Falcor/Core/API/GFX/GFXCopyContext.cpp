@@ -71,7 +71,7 @@ namespace Falcor
         }
     }
 
-    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex)
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, const SharedPtr& pRecycle)
     {
         SharedPtr pThis = SharedPtr(new ReadTextureTask);
         pThis->mpContext = pCtx;
@@ -88,8 +88,15 @@ namespace Falcor
         uint64_t rowCount =  (pTexture->getHeight(mipLevel) + formatInfo.blockHeight - 1) / formatInfo.blockHeight;
         uint64_t size = pTexture->getDepth(mipLevel) * rowCount * pThis->mRowSize;
 
-        //Create buffer
-        pThis->mpBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        // Reuse the readback buffer and fence of a retired task if possible, otherwise create new ones
+        if (pRecycle)
+        {
+            pRecycle->mpFence->syncCpu(pRecycle->mFenceValue);
+            if (pRecycle->mpBuffer->getSize() >= size) pThis->mpBuffer = pRecycle->mpBuffer;
+            pThis->mpFence = pRecycle->mpFence;
+        }
+        if (!pThis->mpBuffer) pThis->mpBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        if (!pThis->mpFence) pThis->mpFence = GpuFence::create();
 
         //Copy from texture to buffer
         pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
@@ -111,37 +118,38 @@ namespace Falcor
             gfx::ITextureResource::Size{ (int)pTexture->getWidth(mipLevel), (int)pTexture->getHeight(mipLevel), (int)pTexture->getDepth(mipLevel) });
         pCtx->setPendingCommands(true);
 
-        // Create a fence and signal
-        pThis->mpFence = GpuFence::create();
+        // Signal the fence
         pCtx->flush(false);
-        pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
+        pThis->mFenceValue = pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
         pThis->mRowCount = (uint32_t)rowCount;
         pThis->mDepth = pTexture->getDepth(mipLevel);
         return pThis;
     }
 
-    std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
+    size_t CopyContext::ReadTextureTask::getDataSize() const
+    {
+        return (size_t)mDepth * mRowCount * mActualRowSize;
+    }
+
+    void CopyContext::ReadTextureTask::getData(void* pDst)
     {
-        mpFence->syncCpu();
+        mpFence->syncCpu(mFenceValue);
         // Get buffer data
-        std::vector<uint8_t> result;
-        result.resize((size_t)mRowCount * mActualRowSize);
-        uint8_t* pData = reinterpret_cast<uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
 
         for (uint32_t z = 0; z < mDepth; z++)
         {
             const uint8_t* pSrcZ = pData + z * (size_t)mRowSize * mRowCount;
-            uint8_t* pDstZ = result.data() + z * (size_t)mActualRowSize * mRowCount;
+            uint8_t* pDstZ = reinterpret_cast<uint8_t*>(pDst) + z * (size_t)mActualRowSize * mRowCount;
             for (uint32_t y = 0; y < mRowCount; y++)
             {
                 const uint8_t* pSrc = pSrcZ + y * (size_t)mRowSize;
-                uint8_t* pDst = pDstZ + y * (size_t)mActualRowSize;
-                memcpy(pDst, pSrc, mActualRowSize);
+                uint8_t* pDstRow = pDstZ + y * (size_t)mActualRowSize;
+                memcpy(pDstRow, pSrc, mActualRowSize);
             }
         }
 
         mpBuffer->unmap();
-        return result;
     }
 
     bool CopyContext::textureBarrier(const Texture* pTexture, Resource::State newState)
@@ -72,6 +72,7 @@ namespace Falcor
         for (auto& it : mNodeData)
         {
             it.second.pPass->setScene(gpDevice->getRenderContext(), pScene);
+            mDirtyPasses.insert(it.second.pPass.get());
         }
         mRecompile = true;
     }
@@ -91,7 +92,7 @@ namespace Falcor
             mNameToIndex[passName] = passIndex;
         }
 
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, pRawPass = pPass.get()]() { mRecompile = true; mDirtyPasses.insert(pRawPass); };
         pPass->mName = passName;
 
         if (mpScene) pPass->setScene(gpDevice->getRenderContext(), mpScene);
@@ -143,7 +144,7 @@ namespace Falcor
         std::string passTypeName = pOldPass->getType();
         auto pPass = RenderPassLibrary::instance().createPass(pRenderContext, passTypeName.c_str(), dict);
         pPassIt->second.pPass = pPass;
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, pRawPass = pPass.get()]() { mRecompile = true; mDirtyPasses.insert(pRawPass); };
         pPass->mName = pOldPass->getName();
 
         if (mpScene) pPass->setScene(gpDevice->getRenderContext(), mpScene);
@@ -384,12 +385,15 @@ namespace Falcor
     bool RenderGraph::compile(RenderContext* pRenderContext, std::string& log)
     {
         if (!mRecompile) return true;
-        mpExe = nullptr;
+
+        // The previous executable is handed to the compiler so that unchanged passes and resources can be reused
+        auto pPrevExe = std::move(mpExe);
 
         try
         {
-            mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps);
+            mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps, pPrevExe);
             mRecompile = false;
+            mDirtyPasses.clear();
             return true;
         }
         catch (const std::exception& e)
@@ -480,6 +484,13 @@ namespace Falcor
         }
     }
 
+    void RenderGraph::setResourcePool(const ResourcePool::SharedPtr& pPool)
+    {
+        if (mCompilerDeps.pResourcePool == pPool) return;
+        mCompilerDeps.pResourcePool = pPool;
+        mRecompile = true;
+    }
+
     void RenderGraph::setInput(const std::string& name, const Resource::SharedPtr& pResource)
     {
         str_pair strPair;
@@ -675,6 +686,12 @@ namespace Falcor
         renderGraph.def("getOutput", pybind11::overload_cast<const std::string&>(&RenderGraph::getOutput), "name"_a);
         auto printGraph = [](RenderGraph::SharedPtr pGraph) { pybind11::print(RenderGraphExporter::getIR(pGraph)); };
         renderGraph.def("print", printGraph);
+        auto printSchedule = [](RenderGraph::SharedPtr pGraph)
+        {
+            const auto pSchedule = pGraph->getSchedule();
+            pybind11::print(pSchedule ? pSchedule->toString() : "The graph has not been compiled.");
+        };
+        renderGraph.def("printSchedule", printSchedule);
 
         // RenderPass
         pybind11::class_<RenderPass, RenderPass::SharedPtr> renderPass(m, "RenderPass");
@@ -218,6 +218,21 @@ namespace Falcor
         */
         void setName(const std::string& name) { mName = name; }
 
+        /** Set a pool to share transient resources with other graphs that use the same pool.
+            The graphs must be executed one after another. Graph outputs and resources that keep their content between executions are not shared.
+            \param[in] pPool The resource pool, or nullptr to not share resources.
+        */
+        void setResourcePool(const ResourcePool::SharedPtr& pPool);
+
+        /** Get the resource pool shared with other graphs. This may be nullptr.
+        */
+        const ResourcePool::SharedPtr& getResourcePool() const { return mCompilerDeps.pResourcePool; }
+
+        /** Get the dependency-level schedule of the compiled graph.
+            \return The schedule, or nullptr if the graph has not been compiled successfully.
+        */
+        const RenderGraphSchedule* getSchedule() const { return mpExe ? &mpExe->getSchedule() : nullptr; }
+
         /** Compile the graph.
         */
         bool compile(RenderContext* pRenderContext, std::string& log);
@@ -274,6 +289,7 @@ namespace Falcor
         RenderGraphExe::SharedPtr mpExe;                            ///< Helper for allocating resources and executing the graph.
         RenderGraphCompiler::Dependencies mCompilerDeps;            ///< Data needed by the graph compiler.
         bool mRecompile = false;                                    ///< Set to true to trigger a recompilation after any graph changes (topology/scene/size/passes/etc.)
+        std::unordered_set<const RenderPass*> mDirtyPasses;         ///< Passes that requested a recompile since the last compilation. Their previous compilation state is not reused.
 
         friend class RenderGraphUI;
         friend class RenderGraphExporter;
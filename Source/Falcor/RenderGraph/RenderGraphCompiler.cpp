@@ -38,13 +38,22 @@ namespace Falcor
         {
             return src.getSampleCount() > 1 && dst.getSampleCount() == 1;
         }
+
+        bool isSameCompileData(const RenderPass::CompileData& a, const RenderPass::CompileData& b)
+        {
+            return a.defaultTexDims == b.defaultTexDims && a.defaultTexFormat == b.defaultTexFormat && a.connectedResources == b.connectedResources;
+        }
     }
 
-    RenderGraphCompiler::RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies) : mGraph(graph), mDependencies(dependencies) {}
+    RenderGraphCompiler::RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies, const RenderGraphExe::SharedPtr& pPrevExe)
+        : mGraph(graph)
+        , mDependencies(dependencies)
+        , mpPrevExe(pPrevExe)
+    {}
 
-    RenderGraphExe::SharedPtr RenderGraphCompiler::compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies)
+    RenderGraphExe::SharedPtr RenderGraphCompiler::compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies, const RenderGraphExe::SharedPtr& pPrevExe)
     {
-        RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies);
+        RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies, pPrevExe);
 
         // Register the external resources
         auto pResourcesCache = ResourceCache::create();
@@ -58,6 +67,7 @@ namespace Falcor
 
         auto pExe = RenderGraphExe::create();
         pExe->mExecutionList.reserve(c.mExecutionList.size());
+        pExe->mSchedule = c.buildSchedule();
 
         for (auto e : c.mExecutionList)
         {
@@ -65,6 +75,7 @@ namespace Falcor
         }
         c.restoreCompilationChanges();
         pExe->mpResourceCache = pResourcesCache;
+        pExe->mPassCompileStates = std::move(c.mPassCompileStates);
         return pExe;
     }
 
@@ -147,11 +158,42 @@ namespace Falcor
             if (participatingPasses.find(node) != participatingPasses.end())
             {
                 const auto pData = mGraph.mNodeData[node];
-                mExecutionList.push_back({ node, pData.pPass, pData.name, pData.pPass->reflect(compileData) });
+                mExecutionList.push_back({ node, pData.pPass, pData.name, reflectPass(pData.name, pData.pPass, compileData) });
             }
         }
     }
 
+    const RenderGraphExe::PassCompileState* RenderGraphCompiler::findPrevCompileState(const std::string& name, const RenderPass::SharedPtr& pPass) const
+    {
+        // Passes that requested a recompile since the previous compilation have no valid state
+        if (!mpPrevExe || mGraph.mDirtyPasses.count(pPass.get())) return nullptr;
+
+        auto it = mpPrevExe->mPassCompileStates.find(name);
+        if (it == mpPrevExe->mPassCompileStates.end() || it->second.pPass != pPass) return nullptr;
+        return &it->second;
+    }
+
+    RenderPassReflection RenderGraphCompiler::reflectPass(const std::string& name, const RenderPass::SharedPtr& pPass, const RenderPass::CompileData& compileData)
+    {
+        auto& state = mPassCompileStates[name];
+        if (state.pPass == pPass && isSameCompileData(state.reflectData, compileData)) return state.reflector;
+
+        // Reuse the reflection (and compilation state) of the previous compilation if the pass didn't change
+        const auto pPrevState = findPrevCompileState(name, pPass);
+        if (pPrevState && isSameCompileData(pPrevState->reflectData, compileData))
+        {
+            state = *pPrevState;
+        }
+        else
+        {
+            state = {};
+            state.pPass = pPass;
+            state.reflectData = compileData;
+            state.reflector = pPass->reflect(compileData);
+        }
+        return state.reflector;
+    }
+
     bool RenderGraphCompiler::insertAutoPasses()
     {
         bool addedPasses = false;
@@ -313,10 +355,37 @@ namespace Falcor
             }
         }
 
-        pResourceCache->allocateResources(mDependencies.defaultResourceProps);
+        pResourceCache->allocateResources(mDependencies.defaultResourceProps, mpPrevExe ? mpPrevExe->mpResourceCache.get() : nullptr, mDependencies.pResourcePool.get());
     }
 
 
+    RenderGraphSchedule RenderGraphCompiler::buildSchedule() const
+    {
+        // Passes are identified by their index in the execution list
+        std::vector<std::string> passNames;
+        std::unordered_map<uint32_t, uint32_t> nodeToPass;
+        for (const auto& p : mExecutionList)
+        {
+            nodeToPass[p.index] = (uint32_t)passNames.size();
+            passNames.push_back(p.name);
+        }
+
+        // Every edge between executed passes is a dependency. Data-dependency edges also need a barrier on the source resource.
+        std::vector<RenderGraphSchedule::Dependency> dependencies;
+        for (const auto& [edgeId, edgeData] : mGraph.mEdgeData)
+        {
+            const auto& pEdge = mGraph.mpGraph->getEdge(edgeId);
+            auto srcIt = nodeToPass.find(pEdge->getSourceNode());
+            auto dstIt = nodeToPass.find(pEdge->getDestNode());
+            if (srcIt == nodeToPass.end() || dstIt == nodeToPass.end()) continue;
+
+            std::string resource = edgeData.srcField.empty() ? "" : passNames[srcIt->second] + '.' + edgeData.srcField;
+            dependencies.push_back({ srcIt->second, dstIt->second, resource });
+        }
+
+        return RenderGraphSchedule::build(passNames, dependencies);
+    }
+
     void RenderGraphCompiler::restoreCompilationChanges()
     {
         for (const auto& name : mCompilationChanges.generatedPasses) mGraph.removePass(name);
@@ -402,15 +471,37 @@ namespace Falcor
 
     void RenderGraphCompiler::compilePasses(RenderContext* pRenderContext)
     {
+        // Reflections that were updated on a retry depend on the connected resources of the pass.
+        // If those changed, reflect the pass again without them, so the pass is compiled and retried with the new connections.
+        for (auto& p : mExecutionList)
+        {
+            auto& state = mPassCompileStates.at(p.name);
+            if (!state.reflectedOnRetry) continue;
+            if (state.compiled && isSameCompileData(state.compileData, prepPassCompilationData(p))) continue;
+
+            state.reflector = p.pPass->reflect(state.reflectData);
+            state.reflectedOnRetry = false;
+            state.compiled = false;
+            p.reflector = state.reflector;
+        }
+
         while(1)
         {
             std::string log;
             bool success = true;
             for (auto& p : mExecutionList)
             {
+                // Skip passes that were already compiled with identical data
+                auto compileData = prepPassCompilationData(p);
+                auto& state = mPassCompileStates.at(p.name);
+                if (state.compiled && isSameCompileData(state.compileData, compileData)) continue;
+
                 try
                 {
-                    p.pPass->compile(pRenderContext, prepPassCompilationData(p));
+                    state.compiled = false;
+                    p.pPass->compile(pRenderContext, compileData);
+                    state.compileData = std::move(compileData);
+                    state.compiled = true;
                 }
                 catch (const std::exception& e)
                 {
@@ -428,7 +519,11 @@ namespace Falcor
                 auto newR = p.pPass->reflect(prepPassCompilationData(p));
                 if (newR != p.reflector)
                 {
-                    p.reflector = newR;
+                    // Keep the compilation state in sync, so the next compilation reuses the updated reflection and not the one without connections
+                    auto& state = mPassCompileStates.at(p.name);
+                    state.reflector = newR;
+                    state.reflectedOnRetry = true;
+                    p.reflector = std::move(newR);
                     changed = true;
                 }
             }
@@ -40,13 +40,25 @@ namespace Falcor
         {
             ResourceCache::DefaultProperties defaultResourceProps;
             ResourceCache::ResourcesMap externalResources;
+            ResourcePool::SharedPtr pResourcePool;
         };
-        static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
+
+        /** Compile a render graph.
+            \param[in] graph The graph to compile.
+            \param[in] pRenderContext The render context.
+            \param[in] dependencies Data needed by the compiler.
+            \param[in] pPrevExe Optional. The result of the previous compilation of the graph. Passes that did not request a recompile and whose compile data is unchanged
+                are not reflected and compiled again, and resources with unchanged properties are reused. The previous executable must not be used after this call.
+            \return The compiled graph.
+        */
+        static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies, const RenderGraphExe::SharedPtr& pPrevExe = nullptr);
 
     private:
-        RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies);
+        RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies, const RenderGraphExe::SharedPtr& pPrevExe);
         RenderGraph& mGraph;
         const Dependencies& mDependencies;
+        RenderGraphExe::SharedPtr mpPrevExe;
+        std::unordered_map<std::string, RenderGraphExe::PassCompileState> mPassCompileStates;
 
         struct PassData
         {
@@ -70,6 +82,9 @@ namespace Falcor
         void allocateResources(ResourceCache* pResourceCache);
         void validateGraph() const;
         void restoreCompilationChanges();
+        RenderGraphSchedule buildSchedule() const;
         RenderPass::CompileData prepPassCompilationData(const PassData& passData);
+        RenderPassReflection reflectPass(const std::string& name, const RenderPass::SharedPtr& pPass, const RenderPass::CompileData& compileData);
+        const RenderGraphExe::PassCompileState* findPrevCompileState(const std::string& name, const RenderPass::SharedPtr& pPass) const;
     };
 }
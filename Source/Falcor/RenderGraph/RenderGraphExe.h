@@ -29,6 +29,7 @@
 #include "ResourceCache.h"
 #include "Utils/InternalDictionary.h"
 #include "RenderPass.h"
+#include "RenderGraphSchedule.h"
 
 namespace Falcor
 {
@@ -80,6 +81,10 @@ namespace Falcor
         */
         void setInput(const std::string& name, const Resource::SharedPtr& pResource);
 
+        /** Get the dependency-level schedule of the passes. Pass indices refer to the execution order.
+        */
+        const RenderGraphSchedule& getSchedule() const { return mSchedule; }
+
     private:
         friend class RenderGraphCompiler;
         static SharedPtr create() { return SharedPtr(new RenderGraphExe); }
@@ -96,7 +101,21 @@ namespace Falcor
             Pass(const std::string& name_, const RenderPass::SharedPtr& pPass_) : name(name_), pPass(pPass_) {}
         };
 
+        /** Reflection and compilation state of a pass. Used to skip passes that did not change when the graph is recompiled.
+        */
+        struct PassCompileState
+        {
+            RenderPass::SharedPtr pPass;            ///< The pass the state belongs to.
+            RenderPass::CompileData reflectData;    ///< Data the pass was reflected with.
+            RenderPassReflection reflector;         ///< Reflection returned by the pass for reflectData.
+            RenderPass::CompileData compileData;    ///< Data the pass was last successfully compiled with.
+            bool compiled = false;                  ///< True if the pass was successfully compiled with compileData.
+            bool reflectedOnRetry = false;          ///< True if reflector was updated with the connected resources after a failed compilation. It is only valid as long as compileData doesn't change.
+        };
+
         std::vector<Pass> mExecutionList;
         ResourceCache::SharedPtr mpResourceCache;
+        RenderGraphSchedule mSchedule;
+        std::unordered_map<std::string, PassCompileState> mPassCompileStates;   ///< Map from pass name to its compilation state.
     };
 }
@@ -0,0 +1,152 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "RenderGraphSchedule.h"
+#include <map>
+
+namespace Falcor
+{
+    RenderGraphSchedule RenderGraphSchedule::build(const std::vector<std::string>& passNames, const std::vector<Dependency>& dependencies, const std::vector<double>& passCosts)
+    {
+        const uint32_t passCount = (uint32_t)passNames.size();
+        checkArgument(passCosts.empty() || passCosts.size() == passCount, "'passCosts' has {} entries but there are {} passes.", passCosts.size(), passCount);
+
+        std::vector<std::vector<uint32_t>> successors(passCount);
+        std::vector<std::vector<uint32_t>> predecessors(passCount);
+        for (const auto& d : dependencies)
+        {
+            checkArgument(d.srcPass < passCount && d.dstPass < passCount, "Dependency {} -> {} references a pass out of range.", d.srcPass, d.dstPass);
+            checkArgument(d.srcPass != d.dstPass, "Pass '{}' depends on itself.", passNames[d.srcPass]);
+            successors[d.srcPass].push_back(d.dstPass);
+            predecessors[d.dstPass].push_back(d.srcPass);
+        }
+
+        RenderGraphSchedule schedule;
+        schedule.mPassNames = passNames;
+        schedule.mPassLevels.assign(passCount, 0);
+
+        // Assign levels in topological order (Kahn's algorithm). A pass is scheduled one level after its latest dependency.
+        // Accumulate the cost of the most expensive chain ending at each pass at the same time.
+        std::vector<uint32_t> inDegree(passCount);
+        std::vector<uint32_t> queue;
+        queue.reserve(passCount);
+        for (uint32_t i = 0; i < passCount; i++)
+        {
+            inDegree[i] = (uint32_t)predecessors[i].size();
+            if (inDegree[i] == 0) queue.push_back(i);
+        }
+
+        std::vector<double> pathCost(passCount, 0.0);
+        std::vector<uint32_t> pathPrev(passCount, uint32_t(-1));
+        for (size_t q = 0; q < queue.size(); q++)
+        {
+            uint32_t pass = queue[q];
+            pathCost[pass] += passCosts.empty() ? 1.0 : passCosts[pass];
+            for (uint32_t succ : successors[pass])
+            {
+                schedule.mPassLevels[succ] = std::max(schedule.mPassLevels[succ], schedule.mPassLevels[pass] + 1);
+                if (pathPrev[succ] == uint32_t(-1) || pathCost[pass] > pathCost[succ])
+                {
+                    pathCost[succ] = pathCost[pass];
+                    pathPrev[succ] = pass;
+                }
+                if (--inDegree[succ] == 0) queue.push_back(succ);
+            }
+        }
+        checkArgument(queue.size() == passCount, "The pass dependencies contain a cycle.");
+
+        // Group the passes into levels
+        uint32_t levelCount = passCount > 0 ? *std::max_element(schedule.mPassLevels.begin(), schedule.mPassLevels.end()) + 1 : 0;
+        schedule.mLevels.resize(levelCount);
+        for (uint32_t i = 0; i < passCount; i++) schedule.mLevels[schedule.mPassLevels[i]].passes.push_back(i);
+
+        // Collect the barriers of each level. Resources read by multiple passes of a level need a single barrier.
+        std::vector<std::map<std::pair<uint32_t, std::string>, std::vector<uint32_t>>> barriers(levelCount);
+        for (const auto& d : dependencies)
+        {
+            if (d.resource.empty()) continue;
+            auto& dstPasses = barriers[schedule.mPassLevels[d.dstPass]][{ d.srcPass, d.resource }];
+            if (std::find(dstPasses.begin(), dstPasses.end(), d.dstPass) == dstPasses.end()) dstPasses.push_back(d.dstPass);
+        }
+        for (uint32_t l = 0; l < levelCount; l++)
+        {
+            for (auto& [key, dstPasses] : barriers[l])
+            {
+                std::sort(dstPasses.begin(), dstPasses.end());
+                schedule.mLevels[l].barriers.push_back({ key.second, key.first, std::move(dstPasses) });
+            }
+        }
+
+        // Trace the critical path back from the pass with the highest accumulated cost
+        if (passCount > 0)
+        {
+            uint32_t pass = uint32_t(std::max_element(pathCost.begin(), pathCost.end()) - pathCost.begin());
+            schedule.mCriticalPathCost = pathCost[pass];
+            for (; pass != uint32_t(-1); pass = pathPrev[pass]) schedule.mCriticalPath.push_back(pass);
+            std::reverse(schedule.mCriticalPath.begin(), schedule.mCriticalPath.end());
+        }
+
+        return schedule;
+    }
+
+    uint32_t RenderGraphSchedule::getMaxLevelSize() const
+    {
+        size_t maxSize = 0;
+        for (const auto& level : mLevels) maxSize = std::max(maxSize, level.passes.size());
+        return (uint32_t)maxSize;
+    }
+
+    std::vector<uint32_t> RenderGraphSchedule::getExecutionOrder() const
+    {
+        std::vector<uint32_t> order;
+        order.reserve(mPassNames.size());
+        for (const auto& level : mLevels) order.insert(order.end(), level.passes.begin(), level.passes.end());
+        return order;
+    }
+
+    std::string RenderGraphSchedule::toString() const
+    {
+        std::string s;
+        for (size_t l = 0; l < mLevels.size(); l++)
+        {
+            s += fmt::format("Level {}:\n", l);
+            for (const auto& barrier : mLevels[l].barriers)
+            {
+                std::string readers;
+                for (uint32_t pass : barrier.dstPasses) readers += (readers.empty() ? "" : ", ") + mPassNames[pass];
+                s += fmt::format("    barrier '{}' -> {}\n", barrier.resource, readers);
+            }
+            for (uint32_t pass : mLevels[l].passes) s += fmt::format("    pass '{}'\n", mPassNames[pass]);
+        }
+
+        std::string path;
+        for (uint32_t pass : mCriticalPath) path += (path.empty() ? "" : " -> ") + mPassNames[pass];
+        s += fmt::format("Critical path (cost {}): {}\n", mCriticalPathCost, path);
+        return s;
+    }
+}
@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Dependency-level schedule of a compiled render graph.
+        Passes are grouped into levels. Passes within a level don't depend on each other and all dependencies of a pass are in earlier levels,
+        so the passes of a level may be recorded independently once the previous levels have been recorded.
+        The schedule is a pure CPU data structure built from pass names and dependencies only.
+        The graph is still executed serially in execution-list order. Recording the passes of a level in parallel is blocked on
+        the API layer, whose descriptor pools, upload heaps and resource state tracking are not thread safe.
+    */
+    class FALCOR_API RenderGraphSchedule
+    {
+    public:
+        /** Dependency between two passes.
+        */
+        struct Dependency
+        {
+            uint32_t srcPass;                   ///< Index of the pass that has to execute first.
+            uint32_t dstPass;                   ///< Index of the dependent pass.
+            std::string resource;               ///< Full name of the resource written by srcPass and read by dstPass (`passName.fieldName`), or empty for execution dependencies.
+        };
+
+        /** Barrier that is needed before the passes of a level execute.
+            Makes a resource written by a pass in an earlier level visible to the passes of the level that read it.
+        */
+        struct Barrier
+        {
+            std::string resource;               ///< Full name of the resource.
+            uint32_t srcPass;                   ///< Index of the pass writing the resource.
+            std::vector<uint32_t> dstPasses;    ///< Indices of the passes of the level reading the resource, in ascending order.
+        };
+
+        struct Level
+        {
+            std::vector<uint32_t> passes;       ///< Indices of the passes in the level, in ascending order.
+            std::vector<Barrier> barriers;      ///< Barriers to execute before the passes of the level.
+        };
+
+        RenderGraphSchedule() = default;
+
+        /** Build a schedule. Throws an ArgumentError if the arguments are invalid or the dependencies contain a cycle.
+            \param[in] passNames Names of the passes. Passes are identified by their index in this list.
+            \param[in] dependencies Dependencies between the passes. Multiple dependencies between the same passes are allowed.
+            \param[in] passCosts Optional. Cost of each pass, used to find the critical path. If empty, each pass has a cost of 1.
+            \return The schedule.
+        */
+        static RenderGraphSchedule build(const std::vector<std::string>& passNames, const std::vector<Dependency>& dependencies, const std::vector<double>& passCosts = {});
+
+        /** Get the number of passes.
+        */
+        uint32_t getPassCount() const { return (uint32_t)mPassNames.size(); }
+
+        /** Get the name of a pass.
+        */
+        const std::string& getPassName(uint32_t passIndex) const { return mPassNames.at(passIndex); }
+
+        /** Get the level a pass is scheduled in.
+        */
+        uint32_t getPassLevel(uint32_t passIndex) const { return mPassLevels.at(passIndex); }
+
+        /** Get the levels, in execution order.
+        */
+        const std::vector<Level>& getLevels() const { return mLevels; }
+
+        /** Get the maximum number of passes in a level.
+        */
+        uint32_t getMaxLevelSize() const;
+
+        /** Get the passes in execution order, i.e., level by level.
+        */
+        std::vector<uint32_t> getExecutionOrder() const;
+
+        /** Get the critical path, the chain of dependent passes with the highest total cost.
+            \return Indices of the passes on the critical path, in execution order.
+        */
+        const std::vector<uint32_t>& getCriticalPath() const { return mCriticalPath; }
+
+        /** Get the total cost of the passes on the critical path.
+        */
+        double getCriticalPathCost() const { return mCriticalPathCost; }
+
+        /** Get a human readable description of the schedule.
+        */
+        std::string toString() const;
+
+    private:
+        std::vector<std::string> mPassNames;
+        std::vector<uint32_t> mPassLevels;
+        std::vector<Level> mLevels;
+        std::vector<uint32_t> mCriticalPath;
+        double mCriticalPathCost = 0.0;
+    };
+}
@@ -31,6 +31,117 @@
 
 namespace Falcor
 {
+    namespace
+    {
+        bool isPoolable(const RenderPassReflection::Field& field, uint32_t timePoint)
+        {
+            // Graph outputs are read after the graph executed, persistent and internal resources keep their content between executions
+            if (timePoint == uint32_t(-1)) return false;
+            if (is_set(field.getFlags(), RenderPassReflection::Field::Flags::Persistent)) return false;
+            return !is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+        }
+
+        ResourcePool::Desc getResourceDesc(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags)
+        {
+            ResourcePool::Desc desc;
+            desc.type = field.getType();
+            desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+            desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+            desc.depth = field.getDepth() ? field.getDepth() : 1;
+            desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+            desc.bindFlags = field.getBindFlags();
+            desc.arraySize = field.getArraySize();
+            desc.mipLevels = field.getMipCount();
+            desc.format = ResourceFormat::Unknown;
+
+            if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
+            {
+                desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+                if (resolveBindFlags)
+                {
+                    ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+                    bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
+                    bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+                    if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
+                    auto supported = getFormatBindFlags(desc.format);
+                    mask &= supported;
+                    desc.bindFlags |= mask;
+                }
+            }
+            else // RawBuffer
+            {
+                if (resolveBindFlags) desc.bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            }
+            return desc;
+        }
+
+        Resource::SharedPtr createResource(const ResourcePool::Desc& desc, const std::string& resourceName)
+        {
+            Resource::SharedPtr pResource;
+
+            switch (desc.type)
+            {
+            case RenderPassReflection::Field::Type::RawBuffer:
+                pResource = Buffer::create(desc.width, desc.bindFlags, Buffer::CpuAccess::None);
+                break;
+            case RenderPassReflection::Field::Type::Texture1D:
+                pResource = Texture::create1D(desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::Texture2D:
+                if (desc.sampleCount > 1)
+                {
+                    pResource = Texture::create2DMS(desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
+                }
+                else
+                {
+                    pResource = Texture::create2D(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                }
+                break;
+            case RenderPassReflection::Field::Type::Texture3D:
+                pResource = Texture::create3D(desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::TextureCube:
+                pResource = Texture::createCube(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
+            }
+            pResource->setName(resourceName);
+            return pResource;
+        }
+    }
+
+    bool ResourcePool::Desc::operator==(const Desc& other) const
+    {
+        return type == other.type && width == other.width && height == other.height && depth == other.depth && sampleCount == other.sampleCount
+            && arraySize == other.arraySize && mipLevels == other.mipLevels && format == other.format && bindFlags == other.bindFlags;
+    }
+
+    ResourcePool::SharedPtr ResourcePool::create()
+    {
+        return SharedPtr(new ResourcePool());
+    }
+
+    Resource::SharedPtr ResourcePool::acquire(const Desc& desc, const std::unordered_set<const Resource*>& usedResources, const std::string& name)
+    {
+        for (const auto& [resourceDesc, pResource] : mResources)
+        {
+            if (resourceDesc == desc && usedResources.count(pResource.get()) == 0) return pResource;
+        }
+
+        auto pResource = createResource(desc, name);
+        mResources.emplace_back(desc, pResource);
+        return pResource;
+    }
+
+    void ResourcePool::releaseUnused()
+    {
+        // Resources only referenced by the pool are not used by any cache
+        auto isUnused = [](const auto& entry) { return entry.second.use_count() == 1; };
+        mResources.erase(std::remove_if(mResources.begin(), mResources.end(), isUnused), mResources.end());
+    }
+
     ResourceCache::SharedPtr ResourceCache::create()
     {
         return SharedPtr(new ResourceCache());
@@ -102,7 +213,7 @@ namespace Falcor
             FALCOR_ASSERT(mNameToIndex.count(name) == 0);
             mNameToIndex[name] = (uint32_t)mResourceData.size();
             bool resolveBindFlags = (field.getBindFlags() == ResourceBindFlags::None);
-            mResourceData.push_back({ field, {timePoint, timePoint}, nullptr, resolveBindFlags, name });
+            mResourceData.push_back({ field, {timePoint, timePoint}, nullptr, resolveBindFlags, name, isPoolable(field, timePoint) });
         }
         else // Add alias
         {
@@ -112,81 +223,67 @@ namespace Falcor
             mergeTimePoint(mResourceData[index].lifetime, timePoint);
             mResourceData[index].pResource = nullptr;
             mResourceData[index].resolveBindFlags = mResourceData[index].resolveBindFlags || (field.getBindFlags() == ResourceBindFlags::None);
+            mResourceData[index].poolable = mResourceData[index].poolable && isPoolable(field, timePoint);
         }
     }
 
-    Resource::SharedPtr createResourceForPass(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags, const std::string& resourceName)
+    Resource::SharedPtr ResourceCache::findReusableResource(const ResourceData& data, const DefaultProperties& params) const
     {
-        uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-        uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-        uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-        uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-        auto bindFlags = field.getBindFlags();
-        auto arraySize = field.getArraySize();
-        auto mipLevels = field.getMipCount();
+        auto it = mNameToIndex.find(data.name);
+        if (it == mNameToIndex.end()) return nullptr;
+
+        const auto& prevData = mResourceData[it->second];
+        if (prevData.pResource == nullptr || prevData.name != data.name) return nullptr;
+        if (prevData.field != data.field || prevData.resolveBindFlags != data.resolveBindFlags || prevData.poolable != data.poolable) return nullptr;
 
-        ResourceFormat format = ResourceFormat::Unknown;
+        // Properties not specified by the field are taken from the default properties, which must match as well
+        const auto& field = data.field;
+        if ((field.getWidth() == 0 || field.getHeight() == 0) && params.dims != mDefaultProperties.dims) return nullptr;
+        if (field.getType() != RenderPassReflection::Field::Type::RawBuffer && field.getFormat() == ResourceFormat::Unknown && params.format != mDefaultProperties.format) return nullptr;
 
-        if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
+        return prevData.pResource;
+    }
+
+    void ResourceCache::allocateResources(const DefaultProperties& params, ResourceCache* pPrevCache, ResourcePool* pPool)
+    {
+        if (pPrevCache)
         {
-            format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
-            if (resolveBindFlags)
+            // Reuse resources of the previous compilation. Their content is kept, which is fine since newly created resources have undefined content anyway.
+            // Pooled resources may be in use by other caches, so nothing is reused if the pool changed.
+            if (pPrevCache->mpResourcePool == pPool)
             {
-                ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-                bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
-                bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
-                if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
-                auto supported = getFormatBindFlags(format);
-                mask &= supported;
-                bindFlags |= mask;
+                for (auto& data : mResourceData)
+                {
+                    if ((data.pResource == nullptr) && (data.field.isValid())) data.pResource = pPrevCache->findReusableResource(data, params);
+                }
             }
+            pPrevCache->reset();
         }
-        else // RawBuffer
-        {
-            if (resolveBindFlags) bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-        }
-        Resource::SharedPtr pResource;
 
-        switch (field.getType())
+        // A pooled resource must only be used once by this cache
+        std::unordered_set<const Resource*> usedResources;
+        if (pPool)
         {
-        case RenderPassReflection::Field::Type::RawBuffer:
-            pResource = Buffer::create(width, bindFlags, Buffer::CpuAccess::None);
-            break;
-        case RenderPassReflection::Field::Type::Texture1D:
-            pResource = Texture::create1D(width, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::Texture2D:
-            if (sampleCount > 1)
-            {
-                pResource = Texture::create2DMS(width, height, format, sampleCount, arraySize, bindFlags);
-            }
-            else
-            {
-                pResource = Texture::create2D(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
-            }
-            break;
-        case RenderPassReflection::Field::Type::Texture3D:
-            pResource = Texture::create3D(width, height, depth, format, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::TextureCube:
-            pResource = Texture::createCube(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
+            for (const auto& data : mResourceData) if (data.pResource) usedResources.insert(data.pResource.get());
         }
-        pResource->setName(resourceName);
-        return pResource;
-    }
 
-    void ResourceCache::allocateResources(const DefaultProperties& params)
-    {
         for (auto& data : mResourceData)
         {
             if ((data.pResource == nullptr) && (data.field.isValid()))
             {
-                data.pResource = createResourceForPass(params, data.field, data.resolveBindFlags, data.name);
+                auto desc = getResourceDesc(params, data.field, data.resolveBindFlags);
+                if (pPool && data.poolable)
+                {
+                    data.pResource = pPool->acquire(desc, usedResources, data.name);
+                    usedResources.insert(data.pResource.get());
+                }
+                else
+                {
+                    data.pResource = createResource(desc, data.name);
+                }
             }
         }
+        mDefaultProperties = params;
+        mpResourcePool = pPool;
     }
 }
@@ -31,6 +31,57 @@
 
 namespace Falcor
 {
+    /** Pool of resources shared by the resource caches of render graphs that are executed one after another, e.g., when rendering several graphs per frame.
+        A cache uses each pooled resource at most once. Graph outputs and resources that have to keep their content between executions are never pooled.
+    */
+    class FALCOR_API ResourcePool
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ResourcePool>;
+
+        /** Creation parameters of a resource.
+        */
+        struct Desc
+        {
+            RenderPassReflection::Field::Type type = RenderPassReflection::Field::Type::Texture2D;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t depth = 0;
+            uint32_t sampleCount = 0;
+            uint32_t arraySize = 0;
+            uint32_t mipLevels = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+            ResourceBindFlags bindFlags = ResourceBindFlags::None;
+
+            bool operator==(const Desc& other) const;
+        };
+
+        /** Create a new object
+        */
+        static SharedPtr create();
+
+        /** Get a pooled resource created with the given description that is not used by the caller yet. A new resource is created and added to the pool if there is none.
+            \param[in] desc Resource description.
+            \param[in] usedResources Resources the caller already uses.
+            \param[in] name Name of the resource if a new one is created.
+            \return The resource.
+        */
+        Resource::SharedPtr acquire(const Desc& desc, const std::unordered_set<const Resource*>& usedResources, const std::string& name);
+
+        /** Release the pooled resources that are not used by any cache.
+        */
+        void releaseUnused();
+
+        /** Get the number of pooled resources.
+        */
+        size_t getResourceCount() const { return mResources.size(); }
+
+    private:
+        ResourcePool() = default;
+
+        std::vector<std::pair<Desc, Resource::SharedPtr>> mResources;
+    };
+
     class FALCOR_API ResourceCache
     {
     public:
@@ -74,8 +125,12 @@ namespace Falcor
 
         /** Allocate all resources that need to be created/updated.
             This includes new resources, resources whose properties have been updated since last allocation call.
+            \param[in] params Default properties for resource properties not specified by the fields.
+            \param[in] pPrevCache Optional. Cache of a previous compilation of the graph. Resources in it that have the same name and identical properties are reused instead of being recreated.
+                The previous cache is reset after the reusable resources have been found, to release the remaining resources before new ones are allocated.
+            \param[in] pPool Optional. Pool to take transient resources from, to share them with the caches of other render graphs.
         */
-        void allocateResources(const DefaultProperties& params);
+        void allocateResources(const DefaultProperties& params, ResourceCache* pPrevCache = nullptr, ResourcePool* pPool = nullptr);
 
         /** Clears all registered field/resource properties and allocated resources.
         */
@@ -91,11 +146,16 @@ namespace Falcor
             Resource::SharedPtr pResource;          // The resource
             bool resolveBindFlags;                  // Whether or not we should resolve the field's bind-flags before creating the resource
             std::string name;                       // Full name of the resource, including the pass name
+            bool poolable;                          // Whether or not the resource may be shared with other caches through a resource pool
         };
 
+        Resource::SharedPtr findReusableResource(const ResourceData& data, const DefaultProperties& params) const;
+
         // Resources and properties for fields within (and therefore owned by) a render graph
         std::unordered_map<std::string, uint32_t> mNameToIndex;
         std::vector<ResourceData> mResourceData;
+        DefaultProperties mDefaultProperties;   // Default properties used by the last allocation
+        const ResourcePool* mpResourcePool = nullptr;   // Resource pool used by the last allocation. Only used for comparison.
 
         // References to output resources not to be allocated by the render graph
         ResourcesMap mExternalResources;
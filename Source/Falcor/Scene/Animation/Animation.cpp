@@ -28,8 +28,10 @@
 #include "stdafx.h"
 #include "Animation.h"
 #include "AnimationController.h"
+#include "Utils/NumericRange.h"
 #include "glm/gtc/quaternion.hpp"
 #include "glm/gtx/transform.hpp"
+#include <execution>
 
 namespace Falcor
 {
@@ -109,6 +111,24 @@ namespace Falcor
         return SharedPtr(new Animation(name, nodeID, duration));
     }
 
+    Animation::SharedPtr Animation::createInstanced(const std::string& name, uint32_t nodeID, uint32_t nodeCount, double duration, std::vector<Keyframe> keyframes)
+    {
+        checkArgument(nodeCount > 0, "'nodeCount' must be non-zero");
+        checkArgument(!keyframes.empty() && keyframes.size() % nodeCount == 0, "'keyframes' size ({}) is not a non-zero multiple of 'nodeCount' ({})", keyframes.size(), nodeCount);
+
+        // Validate that all tracks share the keyframe times of the first track.
+        const size_t trackSize = keyframes.size() / nodeCount;
+        for (size_t i = trackSize; i < keyframes.size(); i++)
+        {
+            checkArgument(keyframes[i].time == keyframes[i % trackSize].time, "'keyframes' of node {} do not match the keyframe times of the first node", i / trackSize);
+        }
+
+        auto pAnimation = SharedPtr(new Animation(name, nodeID, duration));
+        pAnimation->mNodeCount = nodeCount;
+        pAnimation->mKeyframes = std::move(keyframes);
+        return pAnimation;
+    }
+
     Animation::Animation(const std::string& name, uint32_t nodeID, double duration)
         : mName(name)
         , mNodeID(nodeID)
@@ -117,58 +137,91 @@ namespace Falcor
 
     glm::mat4 Animation::animate(double currentTime)
     {
+        FALCOR_ASSERT(mNodeCount == 1);
+        glm::mat4 transform;
+        animate(currentTime, &transform);
+        return transform;
+    }
+
+    void Animation::animate(double currentTime, glm::mat4* pTransforms)
+    {
+        FALCOR_ASSERT(!mKeyframes.empty());
+        const size_t trackSize = getTrackSize();
+        const double firstKeyframeTime = mKeyframes.front().time;
+        const double lastKeyframeTime = mKeyframes[trackSize - 1].time;
+
         // Calculate the sample time.
         double time = currentTime;
-        if (time < mKeyframes.front().time || time > mKeyframes.back().time)
+        if (time < firstKeyframeTime || time > lastKeyframeTime)
         {
             time = calcSampleTime(currentTime);
         }
 
         // Determine if the animation behaves linearly outside of defined keyframes.
-        bool isLinearPostInfinity = time > mKeyframes.back().time && this->getPostInfinityBehavior() == Behavior::Linear;
-        bool isLinearPreInfinity = time < mKeyframes.front().time && this->getPreInfinityBehavior() == Behavior::Linear;
+        bool isLinearPostInfinity = time > lastKeyframeTime && this->getPostInfinityBehavior() == Behavior::Linear && trackSize > 1;
+        bool isLinearPreInfinity = time < firstKeyframeTime && this->getPreInfinityBehavior() == Behavior::Linear && trackSize > 1;
 
-        Keyframe interpolated;
+        // All tracks share the same keyframe times, so the frame index is only searched for once.
+        double sampleTime = time;
+        if (isLinearPreInfinity) sampleTime = firstKeyframeTime + kEpsilonTime;
+        else if (isLinearPostInfinity) sampleTime = lastKeyframeTime - kEpsilonTime;
+        const size_t frameIndex = findFrameIndex(sampleTime);
 
-        if (isLinearPreInfinity && mKeyframes.size() > 1)
+        auto animateTrack = [&](const Keyframe* pTrack)
         {
-            const auto& k0 = mKeyframes.front();
-            auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
-            double segmentDuration = k1.time - k0.time;
-            float t = (float)((time - k0.time) / segmentDuration);
-            interpolated = interpolateLinear(k0, k1, t);
-        }
-        else if (isLinearPostInfinity && mKeyframes.size() > 1)
+            Keyframe interpolated;
+
+            if (isLinearPreInfinity)
+            {
+                const auto& k0 = pTrack[0];
+                auto k1 = interpolate(mInterpolationMode, sampleTime, frameIndex, pTrack);
+                double segmentDuration = k1.time - k0.time;
+                float t = (float)((time - k0.time) / segmentDuration);
+                interpolated = interpolateLinear(k0, k1, t);
+            }
+            else if (isLinearPostInfinity)
+            {
+                const auto& k1 = pTrack[trackSize - 1];
+                auto k0 = interpolate(mInterpolationMode, sampleTime, frameIndex, pTrack);
+                double segmentDuration = k1.time - k0.time;
+                float t = (float)((time - k0.time) / segmentDuration);
+                interpolated = interpolateLinear(k0, k1, t);
+            }
+            else
+            {
+                interpolated = interpolate(mInterpolationMode, time, frameIndex, pTrack);
+            }
+
+            glm::mat4 T = translate(interpolated.translation);
+            glm::mat4 R = mat4_cast(interpolated.rotation);
+            glm::mat4 S = scale(interpolated.scaling);
+            return T * R * S;
+        };
+
+        if (mNodeCount == 1)
         {
-            const auto& k1 = mKeyframes.back();
-            auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
-            double segmentDuration = k1.time - k0.time;
-            float t = (float)((time - k0.time) / segmentDuration);
-            interpolated = interpolateLinear(k0, k1, t);
+            pTransforms[0] = animateTrack(mKeyframes.data());
         }
         else
         {
-            interpolated = interpolate(mInterpolationMode, time);
+            NumericRange<uint32_t> range(0, mNodeCount);
+            std::for_each(std::execution::par, range.begin(), range.end(),
+                [&](uint32_t i) { pTransforms[i] = animateTrack(&mKeyframes[i * trackSize]); }
+            );
         }
-
-        glm::mat4 T = translate(interpolated.translation);
-        glm::mat4 R = mat4_cast(interpolated.rotation);
-        glm::mat4 S = scale(interpolated.scaling);
-        glm::mat4 transform = T * R * S;
-
-        return transform;
     }
 
-    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    size_t Animation::findFrameIndex(double time) const
     {
         FALCOR_ASSERT(!mKeyframes.empty());
+        const size_t trackSize = getTrackSize();
 
         // Validate cached frame index.
-        size_t frameIndex = clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
+        size_t frameIndex = clamp(mCachedFrameIndex, (size_t)0, trackSize - 1);
         if (time < mKeyframes[frameIndex].time) frameIndex = 0;
 
         // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
+        while (frameIndex < trackSize - 1)
         {
             if (mKeyframes[frameIndex + 1].time > time) break;
             frameIndex++;
@@ -176,21 +229,28 @@ namespace Falcor
 
         // Cache frame index;
         mCachedFrameIndex = frameIndex;
+        return frameIndex;
+    }
+
+    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time, size_t frameIndex, const Keyframe* pTrack) const
+    {
+        const size_t trackSize = getTrackSize();
+        FALCOR_ASSERT(frameIndex < trackSize);
 
         // Compute index of adjacent frame including optional warping.
-        auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
+        auto adjacentFrame = [this, trackSize] (size_t frame, int32_t offset = 1)
         {
-            size_t count = mKeyframes.size();
+            size_t count = trackSize;
             return mEnableWarping ? (frame + count + offset) % count : clamp(frame + offset, (size_t)0, count - 1);
         };
 
-        if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
+        if (mode == InterpolationMode::Linear || trackSize < 4)
         {
             size_t i0 = frameIndex;
             size_t i1 = adjacentFrame(i0);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
+            const Keyframe& k0 = pTrack[i0];
+            const Keyframe& k1 = pTrack[i1];
 
             double segmentDuration = k1.time - k0.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -205,10 +265,10 @@ namespace Falcor
             size_t i2 = adjacentFrame(i1, 1);
             size_t i3 = adjacentFrame(i1, 2);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-            const Keyframe& k2 = mKeyframes[i2];
-            const Keyframe& k3 = mKeyframes[i3];
+            const Keyframe& k0 = pTrack[i0];
+            const Keyframe& k1 = pTrack[i1];
+            const Keyframe& k2 = pTrack[i2];
+            const Keyframe& k3 = pTrack[i3];
 
             double segmentDuration = k2.time - k1.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -260,6 +320,7 @@ namespace Falcor
     void Animation::addKeyframe(const Keyframe& keyframe)
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
+        if (mNodeCount != 1) throw RuntimeError("Cannot add keyframes to animation '{}' driving {} nodes", mName, mNodeCount);
 
         if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
         {
@@ -329,6 +390,7 @@ namespace Falcor
         pybind11::class_<Animation, Animation::SharedPtr> animation(m, "Animation");
         animation.def_property_readonly("name", &Animation::getName);
         animation.def_property_readonly("nodeID", &Animation::getNodeID);
+        animation.def_property_readonly("nodeCount", &Animation::getNodeCount);
         animation.def_property_readonly("duration", &Animation::getDuration);
         animation.def_property("preInfinityBehavior", &Animation::getPreInfinityBehavior, &Animation::setPreInfinityBehavior);
         animation.def_property("postInfinityBehavior", &Animation::getPostInfinityBehavior, &Animation::setPostInfinityBehavior);
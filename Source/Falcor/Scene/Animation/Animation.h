@@ -67,14 +67,30 @@ namespace Falcor
         */
         static SharedPtr create(const std::string& name, uint32_t nodeID, double duration);
 
+        /** Create a new animation driving a range of consecutive nodes.
+            This avoids creating one animation per node for large sets of animated instances.
+            All nodes share the same keyframe times.
+            \param[in] name Animation name.
+            \param[in] nodeID ID of the first animated node.
+            \param[in] nodeCount Number of animated nodes.
+            \param[in] duration Animation duration in seconds.
+            \param[in] keyframes Keyframes of all nodes, stored as one track of keyframes per node. All tracks have the same length and keyframe times.
+            \return Returns a new animation.
+        */
+        static SharedPtr createInstanced(const std::string& name, uint32_t nodeID, uint32_t nodeCount, double duration, std::vector<Keyframe> keyframes);
+
         /** Get the animation name.
         */
         const std::string& getName() const { return mName; }
 
-        /** Get the animated node.
+        /** Get the animated node. For animations driving multiple nodes, this is the first node.
         */
         uint32_t getNodeID() const { return mNodeID; }
 
+        /** Get the number of animated nodes.
+        */
+        uint32_t getNodeCount() const { return mNodeCount; }
+
         /** Set the animated node.
         */
         void setNodeID(uint32_t id) { mNodeID = id; }
@@ -117,6 +133,7 @@ namespace Falcor
 
         /** Add a keyframe.
             If there's already a keyframe at the requested time, this call will override the existing frame.
+            Keyframes can only be added to animations driving a single node.
             \param[in] keyframe Keyframe.
         */
         void addKeyframe(const Keyframe& keyframe);
@@ -140,6 +157,12 @@ namespace Falcor
         */
         glm::mat4 animate(double currentTime);
 
+        /** Compute the animation for all animated nodes.
+            \param[in] currentTime The current time in seconds. This can be larger then the animation time, in which case the animation will loop.
+            \param[out] pTransforms Array of getNodeCount() transform matrices, receiving the transforms of the animated nodes.
+        */
+        void animate(double currentTime, glm::mat4* pTransforms);
+
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -147,11 +170,14 @@ namespace Falcor
     private:
         Animation(const std::string& name, uint32_t nodeID, double duration);
 
-        Keyframe interpolate(InterpolationMode mode, double time) const;
+        size_t getTrackSize() const { return mKeyframes.size() / mNodeCount; }
+        size_t findFrameIndex(double time) const;
+        Keyframe interpolate(InterpolationMode mode, double time, size_t frameIndex, const Keyframe* pTrack) const;
         double calcSampleTime(double currentTime);
 
         std::string mName;
         uint32_t mNodeID;
+        uint32_t mNodeCount = 1;
         double mDuration; // Includes any time before the first keyframe. May be Assimp or FBX specific.
 
         Behavior mPreInfinityBehavior = Behavior::Constant; // How the animation behaves before the first keyframe
@@ -160,7 +186,7 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
+        std::vector<Keyframe> mKeyframes; // One track of keyframes per animated node.
         mutable size_t mCachedFrameIndex = 0;
 
         friend class SceneCache;
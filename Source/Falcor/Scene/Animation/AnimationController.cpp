@@ -198,6 +198,7 @@ namespace Falcor
         FALCOR_PROFILE("animate");
 
         std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        mChangedMatrixIDs.clear();
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
@@ -294,9 +295,10 @@ namespace Falcor
         for (auto& pAnimation : mAnimations)
         {
             uint32_t nodeID = pAnimation->getNodeID();
-            FALCOR_ASSERT(nodeID < mLocalMatrices.size());
-            mLocalMatrices[nodeID] = pAnimation->animate(time);
-            mMatricesChanged[nodeID] = true;
+            uint32_t nodeCount = pAnimation->getNodeCount();
+            FALCOR_ASSERT(nodeID + nodeCount <= mLocalMatrices.size());
+            pAnimation->animate(time, &mLocalMatrices[nodeID]);
+            std::fill_n(mMatricesChanged.begin() + nodeID, nodeCount, true);
         }
     }
 
@@ -304,16 +306,25 @@ namespace Falcor
     {
         const auto& sceneGraph = mpScene->mSceneGraph;
 
+        // The change flags accumulate over the frame, so the list of changed matrices is rebuilt from them.
+        mChangedMatrixIDs.clear();
+
         for (size_t i = 0; i < mGlobalMatrices.size(); i++)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != SceneBuilder::kInvalidNode)
+            // Propagate matrix change flag to children. When updating all matrices, all are flagged as changed
+            // so that the scene picks up the new transforms when the controller is enabled/disabled.
+            if (updateAll)
+            {
+                mMatricesChanged[i] = true;
+            }
+            else if (sceneGraph[i].parent != SceneBuilder::kInvalidNode)
             {
                 mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent];
             }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
+            if (!mMatricesChanged[i]) continue;
 
+            mChangedMatrixIDs.push_back((uint32_t)i);
             mGlobalMatrices[i] = mLocalMatrices[i];
 
             if (mpScene->mSceneGraph[i].parent != SceneBuilder::kInvalidNode)
@@ -396,11 +407,9 @@ namespace Falcor
     {
         if (staticVertexData.empty()) return;
 
-        // We always copy the static data, to initialize the non-skinned vertices.
+        // The static data, which initializes the non-skinned vertices, is uploaded to the vertex buffer by the scene.
         FALCOR_ASSERT(mpScene->getMeshVao());
-        const Buffer::SharedPtr& pVB = mpScene->getMeshVao()->getVertexBuffer(Scene::kStaticDataBufferIndex);
-        FALCOR_ASSERT(pVB->getSize() == staticVertexData.size() * sizeof(staticVertexData[0]));
-        pVB->setBlob(staticVertexData.data(), 0, pVB->getSize());
+        FALCOR_ASSERT(mpScene->getMeshVao()->getVertexBuffer(Scene::kStaticDataBufferIndex)->getSize() == staticVertexData.size() * sizeof(staticVertexData[0]));
 
         if (!skinningVertexData.empty())
         {
@@ -111,6 +111,10 @@ namespace Falcor
         */
         bool isMatrixChanged(size_t matrixID) const { return mMatricesChanged[matrixID]; }
 
+        /** Get the IDs of all matrices that changed since last frame, in ascending order.
+        */
+        const std::vector<uint32_t>& getChangedMatrixIDs() const { return mChangedMatrixIDs; }
+
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
         */
@@ -164,6 +168,7 @@ namespace Falcor
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
         std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint32_t> mChangedMatrixIDs;    ///< IDs of the matrices that changed since last frame.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = false;           ///< True if animations are enabled.
@@ -28,8 +28,10 @@
 #include "stdafx.h"
 #include "CurveTessellation.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/NumericRange.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <execution>
 
 namespace Falcor
 {
@@ -39,6 +41,15 @@ namespace Falcor
         // This scaling factor is trying to bring their width on average back to curveWidth.
         const float kMeshCompensationScale = 1.207f;
 
+        // Number of strands tessellated by each parallel task. The per-task scratch memory is reused for all of its strands.
+        const uint32_t kStrandsPerTask = 64;
+
+        // Number of bisection steps used to find the grid cell size for strand clustering.
+        const uint32_t kClusterBisectionSteps = 24;
+
+        // Grid cells are addressed by 21 bits per axis so that a cell fits in a 64-bit key.
+        const uint32_t kClusterCellBits = 21;
+
         float4 transformSphere(const glm::mat4& xform, const float4& sphere)
         {
             // Spheres are represented as (center.x, center.y, center.z, radius).
@@ -49,228 +60,265 @@ namespace Falcor
             float xr = glm::length(xq.xyz - xp.xyz);
             return float4(xp.xyz, xr);
         }
-    }
-
-    CurveTessellation::SweptSphereResult CurveTessellation::convertToLinearSweptSphere(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const glm::mat4& xform)
-    {
-        SweptSphereResult result;
-
-        // Only support linear tube segments now.
-        // TODO: Add quadratic or cubic tube segments if necessary.
-        FALCOR_ASSERT(degree == 1);
-        result.degree = degree;
 
-        uint32_t pointCounts = 0;
-        uint32_t segCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        uint32_t getTessellatedPointCount(uint32_t controlPointCount, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand)
         {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            pointCounts += tmpPointCount;
-            segCounts += tmpPointCount - 1;
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, static_cast<uint32_t>(vertexCountsPerStrand[i]));
+            // Every Xth sub-segment start is kept, the last vertex is always kept.
+            return div_round_up(subdivPerSegment * (controlPointCount - 1), keepOneEveryXVerticesPerStrand) + 1;
         }
-        result.indices.reserve(segCounts);
-        result.points.reserve(pointCounts);
-        result.radius.reserve(pointCounts);
-        result.texCrds.reserve(pointCounts);
 
-        uint32_t pointOffset = 0;
+        /** Per-task scratch memory for tessellating strands.
+        */
+        struct StrandScratch
+        {
+            std::vector<float3> controlPoints;
+            std::vector<float> widths;
+            std::vector<float2> UVs;
+            CubicSpline<float3> splinePoints;
+            CubicSpline<float> splineWidths;
+            CubicSpline<float2> splineUVs;
 
-        std::vector<float3> strandControlPoints;
-        std::vector<float> strandWidths;
-        std::vector<float2> strandUVs;
+            std::vector<float3> curvePoints;
+            std::vector<float> curveWidths;
+            std::vector<float2> curveUVs;
+        };
 
-        strandControlPoints.reserve(maxVertexCountsPerStrand);
-        strandWidths.reserve(maxVertexCountsPerStrand);
-        strandUVs.reserve(maxVertexCountsPerStrand);
+        /** Run a function on all strands of a layout in parallel. The function is called as func(strandIndex, scratch).
+        */
+        template<typename F>
+        void forEachStrand(const CurveTessellation::StrandLayout& layout, F func)
+        {
+            const uint32_t strandCount = layout.getStrandCount();
+            auto range = NumericRange<uint32_t>(0, div_round_up(strandCount, kStrandsPerTask));
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t taskIndex)
+            {
+                StrandScratch scratch;
+                const uint32_t strandEnd = std::min(strandCount, (taskIndex + 1) * kStrandsPerTask);
+                for (uint32_t i = taskIndex * kStrandsPerTask; i < strandEnd; i++) func(i, scratch);
+            });
+        }
 
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        /** Removes duplicated control points of a strand and builds its splines.
+        */
+        void loadStrand(const CurveTessellation::StrandLayout& layout, uint32_t strandIndex, const float3* controlPoints, const float* widths, const float2* UVs, StrandScratch& scratch)
         {
-            strandControlPoints.clear();
-            strandWidths.clear();
-            strandUVs.clear();
+            const uint32_t offset = layout.controlPointOffsets[strandIndex];
+            const uint32_t count = layout.controlPointCounts[strandIndex];
+
+            scratch.controlPoints.clear();
+            scratch.widths.clear();
+            scratch.UVs.clear();
 
             // Optimize geometry by removing duplicates.
-            for (uint32_t j = 0; j < (uint32_t)vertexCountsPerStrand[i] - 1; j++)
+            for (uint32_t j = offset; j < offset + count - 1; j++)
             {
-                if (controlPoints[pointOffset + j] != controlPoints[pointOffset + j + 1])
+                if (controlPoints[j] != controlPoints[j + 1])
                 {
-                    strandControlPoints.push_back(controlPoints[pointOffset + j]);
-                    strandWidths.push_back(widths[pointOffset + j]);
-                    if (UVs) strandUVs.push_back(UVs[pointOffset + j]);
+                    scratch.controlPoints.push_back(controlPoints[j]);
+                    scratch.widths.push_back(widths[j]);
+                    if (UVs) scratch.UVs.push_back(UVs[j]);
                 }
             }
 
             // Add the last control point.
-            strandControlPoints.push_back(controlPoints[pointOffset + vertexCountsPerStrand[i] - 1]);
-            strandWidths.push_back(widths[pointOffset + vertexCountsPerStrand[i] - 1]);
-            if (UVs) strandUVs.push_back(UVs[pointOffset + vertexCountsPerStrand[i] - 1]);
+            scratch.controlPoints.push_back(controlPoints[offset + count - 1]);
+            scratch.widths.push_back(widths[offset + count - 1]);
+            if (UVs) scratch.UVs.push_back(UVs[offset + count - 1]);
 
-            uint32_t optimizedVertexCount = static_cast<uint32_t>(strandControlPoints.size());
+            const uint32_t optimizedVertexCount = (uint32_t)scratch.controlPoints.size();
+            FALCOR_ASSERT(getTessellatedPointCount(optimizedVertexCount, layout.subdivPerSegment, layout.keepOneEveryXVerticesPerStrand) == layout.pointOffsets[strandIndex + 1] - layout.pointOffsets[strandIndex]);
 
-            CubicSpline splinePoints(strandControlPoints.data(), optimizedVertexCount);
-            CubicSpline splineWidths(strandWidths.data(), optimizedVertexCount);
+            scratch.splinePoints.build(scratch.controlPoints.data(), optimizedVertexCount);
+            scratch.splineWidths.build(scratch.widths.data(), optimizedVertexCount);
+            if (UVs) scratch.splineUVs.build(scratch.UVs.data(), optimizedVertexCount);
+        }
+
+        /** Samples the splines of a loaded strand. The function is called as func(pointIndex, position, width, uv) for every tessellated point of the strand.
+        */
+        template<typename F>
+        void sampleStrand(const CurveTessellation::StrandLayout& layout, const StrandScratch& scratch, bool hasUVs, F func)
+        {
+            const uint32_t optimizedVertexCount = (uint32_t)scratch.controlPoints.size();
+            auto sample = [&](uint32_t pointIndex, uint32_t section, float t)
+            {
+                float2 uv = hasUVs ? scratch.splineUVs.interpolate(section, t) : float2(0.f);
+                func(pointIndex, scratch.splinePoints.interpolate(section, t), scratch.splineWidths.interpolate(section, t), uv);
+            };
 
             uint32_t tmpCount = 0;
+            uint32_t pointIndex = 0;
             for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
             {
-                for (uint32_t k = 0; k < subdivPerSegment; k++)
+                for (uint32_t k = 0; k < layout.subdivPerSegment; k++)
                 {
-                    if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
+                    if (tmpCount % layout.keepOneEveryXVerticesPerStrand == 0)
                     {
-                        float t = (float)k / (float)subdivPerSegment;
-                        result.indices.push_back((uint32_t)result.points.size());
-
-                        // Pre-transform curve points.
-                        float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
-
-                        result.points.push_back(sph.xyz);
-                        result.radius.push_back(sph.w);
+                        sample(pointIndex++, j, (float)k / (float)layout.subdivPerSegment);
                     }
                     tmpCount++;
                 }
             }
 
             // Always keep the last vertex.
-            float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedVertexCount - 2, 1.f), splineWidths.interpolate(optimizedVertexCount - 2, 1.f) * 0.5f * widthScale));
-            result.points.push_back(sph.xyz);
-            result.radius.push_back(sph.w);
+            sample(pointIndex, optimizedVertexCount - 2, 1.f);
+        }
 
-            // Texture coordinates.
-            if (UVs)
+        /** Tessellates all strands to linear swept spheres. The writer is called as write(pointIndex, sphere, uv) for every output point.
+        */
+        template<typename W>
+        void tessellateSweptSpheres(const CurveTessellation::StrandLayout& layout, const float3* controlPoints, const float* widths, const float2* UVs, float widthScale, const glm::mat4& xform, uint32_t* pIndices, W write)
+        {
+            forEachStrand(layout, [&](uint32_t strandIndex, StrandScratch& scratch)
             {
-                CubicSpline splineUVs(strandUVs.data(), optimizedVertexCount);
-                tmpCount = 0;
-                for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
-                {
-                    for (uint32_t k = 0; k < subdivPerSegment; k++)
-                    {
-                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                        {
-                            float t = (float)k / (float)subdivPerSegment;
-                            result.texCrds.push_back(splineUVs.interpolate(j, t));
-                        }
-                        tmpCount++;
-                    }
-                }
+                loadStrand(layout, strandIndex, controlPoints, widths, UVs, scratch);
 
-                // Always keep the last vertex.
-                result.texCrds.push_back(splineUVs.interpolate(optimizedVertexCount - 2, 1.f));
-            }
+                // Each strand has one segment less than points, so the segments of strand i start at pointOffsets[i] - i.
+                const uint32_t pointOffset = layout.pointOffsets[strandIndex];
+                const uint32_t pointCount = layout.pointOffsets[strandIndex + 1] - pointOffset;
+                uint32_t* pStrandIndices = pIndices + (pointOffset - strandIndex);
 
-            for (uint32_t j = i; j < std::min((uint32_t)strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+                sampleStrand(layout, scratch, UVs != nullptr, [&](uint32_t j, const float3& position, float width, const float2& uv)
+                {
+                    // Pre-transform curve points.
+                    float4 sph = transformSphere(xform, float4(position, width * 0.5f * widthScale));
+                    write(pointOffset + j, sph, uv);
+                    if (j + 1 < pointCount) pStrandIndices[j] = pointOffset + j;
+                });
+            });
         }
-
-        return result;
     }
 
-    CurveTessellation::MeshResult CurveTessellation::convertToMesh(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
+    CurveTessellation::StrandLayout CurveTessellation::computeStrandLayout(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand)
     {
-        MeshResult result;
-        uint32_t vertexCounts = 0;
-        uint32_t faceCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        FALCOR_ASSERT(subdivPerSegment > 0 && keepOneEveryXStrands > 0 && keepOneEveryXVerticesPerStrand > 0);
+
+        StrandLayout layout;
+        layout.subdivPerSegment = subdivPerSegment;
+        layout.keepOneEveryXVerticesPerStrand = keepOneEveryXVerticesPerStrand;
+
+        // Find the input ranges of the kept strands.
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> counts;
+        offsets.reserve(div_round_up(strandCount, (size_t)keepOneEveryXStrands));
+        counts.reserve(offsets.capacity());
+
+        uint32_t controlPointOffset = 0;
+        for (size_t i = 0; i < strandCount; i++)
         {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            vertexCounts += pointCountPerCrossSection * tmpPointCount;
-            faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, static_cast<uint32_t>(vertexCountsPerStrand[i]));
+            if (i % keepOneEveryXStrands == 0 && vertexCountsPerStrand[i] >= 2)
+            {
+                offsets.push_back(controlPointOffset);
+                counts.push_back((uint32_t)vertexCountsPerStrand[i]);
+            }
+            controlPointOffset += (uint32_t)vertexCountsPerStrand[i];
         }
-        result.vertices.reserve(vertexCounts);
-        result.normals.reserve(vertexCounts);
-        result.tangents.reserve(vertexCounts);
-        result.texCrds.reserve(vertexCounts);
-        result.radii.reserve(vertexCounts);
-        result.faceVertexCounts.reserve(faceCounts);
-        result.faceVertexIndices.reserve(faceCounts * 3);
+
+        // Count the tessellated points of each strand after removing duplicated control points.
+        std::vector<uint32_t> pointCounts(offsets.size());
+        auto range = NumericRange<size_t>(0, offsets.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            uint32_t optimizedVertexCount = 1;
+            for (uint32_t j = offsets[i]; j < offsets[i] + counts[i] - 1; j++)
+            {
+                if (controlPoints[j] != controlPoints[j + 1]) optimizedVertexCount++;
+            }
+            pointCounts[i] = optimizedVertexCount >= 2 ? getTessellatedPointCount(optimizedVertexCount, subdivPerSegment, keepOneEveryXVerticesPerStrand) : 0;
+        });
+
+        // Compute the output offsets, skipping degenerate strands.
+        layout.controlPointOffsets.reserve(offsets.size());
+        layout.controlPointCounts.reserve(offsets.size());
+        layout.pointOffsets.reserve(offsets.size() + 1);
 
         uint32_t pointOffset = 0;
-        uint32_t meshVertexOffset = 0;
+        for (size_t i = 0; i < offsets.size(); i++)
+        {
+            if (pointCounts[i] == 0) continue;
+            layout.controlPointOffsets.push_back(offsets[i]);
+            layout.controlPointCounts.push_back(counts[i]);
+            layout.pointOffsets.push_back(pointOffset);
+            pointOffset += pointCounts[i];
+        }
+        layout.pointOffsets.push_back(pointOffset);
 
-        std::vector<float3> strandControlPoints;
-        std::vector<float> strandWidths;
-        std::vector<float2> strandUVs;
+        return layout;
+    }
 
-        strandControlPoints.reserve(maxVertexCountsPerStrand);
-        strandWidths.reserve(maxVertexCountsPerStrand);
-        strandUVs.reserve(maxVertexCountsPerStrand);
+    CurveTessellation::SweptSphereResult CurveTessellation::convertToLinearSweptSphere(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const glm::mat4& xform)
+    {
+        SweptSphereResult result;
+
+        // Only support linear tube segments now.
+        // TODO: Add quadratic or cubic tube segments if necessary.
+        FALCOR_ASSERT(degree == 1);
+        result.degree = degree;
+
+        StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+
+        result.indices.resize(layout.getSegmentCount());
+        result.points.resize(layout.getPointCount());
+        result.radius.resize(layout.getPointCount());
+        if (UVs) result.texCrds.resize(layout.getPointCount());
 
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        tessellateSweptSpheres(layout, controlPoints, widths, UVs, widthScale, xform, result.indices.data(), [&](uint32_t i, const float4& sph, const float2& uv)
         {
-            strandControlPoints.clear();
-            strandWidths.clear();
-            strandUVs.clear();
+            result.points[i] = sph.xyz;
+            result.radius[i] = sph.w;
+            if (UVs) result.texCrds[i] = uv;
+        });
 
-            // Optimize geometry by removing duplicates.
-            for (uint32_t j = 0; j < (uint32_t)vertexCountsPerStrand[i] - 1; j++)
-            {
-                if (controlPoints[pointOffset + j] != controlPoints[pointOffset + j + 1])
-                {
-                    strandControlPoints.push_back(controlPoints[pointOffset + j]);
-                    strandWidths.push_back(widths[pointOffset + j]);
-                    if (UVs) strandUVs.push_back(UVs[pointOffset + j]);
-                }
-            }
+        return result;
+    }
 
-            // Add the last control point.
-            strandControlPoints.push_back(controlPoints[pointOffset + vertexCountsPerStrand[i] - 1]);
-            strandWidths.push_back(widths[pointOffset + vertexCountsPerStrand[i] - 1]);
-            if (UVs) strandUVs.push_back(UVs[pointOffset + vertexCountsPerStrand[i] - 1]);
+    void CurveTessellation::convertToLinearSweptSphere(const StrandLayout& layout, const float3* controlPoints, const float* widths, const float2* UVs, float widthScale, const glm::mat4& xform, uint32_t* pIndices, StaticCurveVertexData* pVertices)
+    {
+        tessellateSweptSpheres(layout, controlPoints, widths, UVs, widthScale, xform, pIndices, [&](uint32_t i, const float4& sph, const float2& uv)
+        {
+            pVertices[i].position = sph.xyz;
+            pVertices[i].radius = sph.w;
+            pVertices[i].texCrd = uv;
+        });
+    }
 
-            uint32_t optimizedVertexCount = static_cast<uint32_t>(strandControlPoints.size());
+    CurveTessellation::MeshResult CurveTessellation::convertToMesh(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
+    {
+        MeshResult result;
 
-            CubicSpline splinePoints(strandControlPoints.data(), optimizedVertexCount);
-            CubicSpline splineWidths(strandWidths.data(), optimizedVertexCount);
+        StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
 
-            std::vector<float3> curvePoints;
-            std::vector<float> curveWidths;
+        const uint32_t vertexCount = pointCountPerCrossSection * layout.getPointCount();
+        const uint32_t faceCount = 2 * pointCountPerCrossSection * layout.getSegmentCount();
 
-            uint32_t tmpCount = 0;
-            for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
-            {
-                for (uint32_t k = 0; k < subdivPerSegment; k++)
-                {
-                    if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                    {
-                        float t = (float)k / (float)subdivPerSegment;
-                        curvePoints.push_back(splinePoints.interpolate(j, t));
-                        curveWidths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(j, t));
-                    }
-                    tmpCount++;
-                }
-            }
+        result.vertices.resize(vertexCount);
+        result.normals.resize(vertexCount);
+        result.tangents.resize(vertexCount);
+        result.radii.resize(vertexCount);
+        if (UVs) result.texCrds.resize(vertexCount);
+        result.faceVertexCounts.assign(faceCount, 3);
+        result.faceVertexIndices.resize(faceCount * 3);
 
-            // Always keep the last vertex.
-            curvePoints.push_back(splinePoints.interpolate(optimizedVertexCount - 2, 1.f));
-            curveWidths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(optimizedVertexCount - 2, 1.f));
+        forEachStrand(layout, [&](uint32_t strandIndex, StrandScratch& scratch)
+        {
+            loadStrand(layout, strandIndex, controlPoints, widths, UVs, scratch);
 
-            std::vector<float2> curveUVs;
+            auto& curvePoints = scratch.curvePoints;
+            auto& curveWidths = scratch.curveWidths;
+            auto& curveUVs = scratch.curveUVs;
+            curvePoints.clear();
+            curveWidths.clear();
+            curveUVs.clear();
 
-            // Texture coordinates.
-            if (UVs)
+            sampleStrand(layout, scratch, UVs != nullptr, [&](uint32_t j, const float3& position, float width, const float2& uv)
             {
-                CubicSpline splineUVs(strandUVs.data(), optimizedVertexCount);
-                tmpCount = 0;
-                for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
-                {
-                    for (uint32_t k = 0; k < subdivPerSegment; k++)
-                    {
-                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                        {
-                            float t = (float)k / (float)subdivPerSegment;
-                            curveUVs.push_back(splineUVs.interpolate(j, t));
-                        }
-                        tmpCount++;
-                    }
-                }
-
-                // Always keep the last vertex.
-                curveUVs.push_back(splineUVs.interpolate(optimizedVertexCount - 2, 1.f));
-            }
+                curvePoints.push_back(position);
+                curveWidths.push_back(kMeshCompensationScale * widthScale * width);
+                curveUVs.push_back(uv);
+            });
 
-            for (uint32_t j = i; j < std::min((uint32_t)strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+            const uint32_t meshVertexOffset = pointCountPerCrossSection * layout.pointOffsets[strandIndex];
+            uint32_t vertexIndex = meshVertexOffset;
+            uint32_t* pFaceVertexIndices = result.faceVertexIndices.data() + 6 * pointCountPerCrossSection * (layout.pointOffsets[strandIndex] - strandIndex);
 
             // Build the initial frame.
             float3 prevFwd, s, t;
@@ -307,15 +355,16 @@ namespace Falcor
                     float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
 
                     float curveRadius = 0.5f * curveWidths[j];
-                    result.vertices.push_back(curvePoints[j] + curveRadius * vNormal);
-                    result.normals.push_back(vNormal);
-                    result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
-                    result.radii.push_back(curveRadius);
+                    result.vertices[vertexIndex] = curvePoints[j] + curveRadius * vNormal;
+                    result.normals[vertexIndex] = vNormal;
+                    result.tangents[vertexIndex] = float4(fwd.x, fwd.y, fwd.z, 1);
+                    result.radii[vertexIndex] = curveRadius;
 
                     if (UVs)
                     {
-                        result.texCrds.push_back(curveUVs[j]);
+                        result.texCrds[vertexIndex] = curveUVs[j];
                     }
+                    vertexIndex++;
                 }
 
                 // Mesh faces.
@@ -323,23 +372,174 @@ namespace Falcor
                 {
                     for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
                     {
-                        result.faceVertexCounts.push_back(3);
-                        result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + k);
-                        result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
-                        result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
-
-                        result.faceVertexCounts.push_back(3);
-                        result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + k);
-                        result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
-                        result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + k);
+                        *pFaceVertexIndices++ = meshVertexOffset + j * pointCountPerCrossSection + k;
+                        *pFaceVertexIndices++ = meshVertexOffset + j * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection;
+                        *pFaceVertexIndices++ = meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection;
+
+                        *pFaceVertexIndices++ = meshVertexOffset + j * pointCountPerCrossSection + k;
+                        *pFaceVertexIndices++ = meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection;
+                        *pFaceVertexIndices++ = meshVertexOffset + (j + 1) * pointCountPerCrossSection + k;
                     }
                 }
 
                 prevFwd = fwd;
             }
+        });
 
-            meshVertexOffset += pointCountPerCrossSection * (uint32_t)curvePoints.size();
+        return result;
+    }
+
+    CurveTessellation::StrandClusterResult CurveTessellation::clusterStrands(const uint32_t* indices, uint32_t indexCount, const StaticCurveVertexData* vertices, uint32_t targetStrandCount)
+    {
+        checkArgument(targetStrandCount > 0, "'targetStrandCount' must be positive.");
+
+        // Find the strands as runs of segments with consecutive vertices.
+        // The segments of strand s are [strandSegments[s], strandSegments[s + 1]).
+        std::vector<uint32_t> strandSegments;
+        for (uint32_t i = 0; i < indexCount; i++)
+        {
+            if (i == 0 || indices[i] != indices[i - 1] + 1) strandSegments.push_back(i);
         }
+        const uint32_t strandCount = (uint32_t)strandSegments.size();
+        strandSegments.push_back(indexCount);
+
+        auto getRoot = [&](uint32_t s) { return vertices[indices[strandSegments[s]]].position; };
+        auto getTip = [&](uint32_t s) { return vertices[indices[strandSegments[s + 1] - 1] + 1].position; };
+
+        float3 minRoot = float3(std::numeric_limits<float>::max());
+        float3 maxRoot = float3(-std::numeric_limits<float>::max());
+        for (uint32_t s = 0; s < strandCount; s++)
+        {
+            minRoot = glm::min(minRoot, getRoot(s));
+            maxRoot = glm::max(maxRoot, getRoot(s));
+        }
+        const float3 extent = maxRoot - minRoot;
+        const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+
+        // Assign strands to grid cells of the given size and return the number of occupied cells.
+        auto range = NumericRange<uint32_t>(0, strandCount);
+        std::vector<uint64_t> cellKeys(strandCount);
+        std::vector<uint64_t> sortedKeys;
+        auto assignCells = [&](float cellSize)
+        {
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t s)
+            {
+                const uint32_t maxCell = (1u << kClusterCellBits) - 1;
+                uint3 cell = glm::min(uint3((getRoot(s) - minRoot) / cellSize), uint3(maxCell));
+                cellKeys[s] = uint64_t(cell.x) | (uint64_t(cell.y) << kClusterCellBits) | (uint64_t(cell.z) << (2 * kClusterCellBits));
+            });
+            sortedKeys = cellKeys;
+            std::sort(std::execution::par, sortedKeys.begin(), sortedKeys.end());
+            return (uint32_t)(std::unique(sortedKeys.begin(), sortedKeys.end()) - sortedKeys.begin());
+        };
+
+        if (strandCount <= targetStrandCount)
+        {
+            // Nothing to reduce, every strand forms its own cluster.
+            std::iota(cellKeys.begin(), cellKeys.end(), 0);
+        }
+        else if (maxExtent == 0.f)
+        {
+            // All roots coincide, the strands form a single cluster.
+            std::fill(cellKeys.begin(), cellKeys.end(), 0);
+        }
+        else
+        {
+            // Bisect the cell size. The upper bound puts all strands in a single cell.
+            float lo = maxExtent / (float)(1u << kClusterCellBits);
+            float hi = 2.f * maxExtent;
+            for (uint32_t i = 0; i < kClusterBisectionSteps; i++)
+            {
+                float mid = 0.5f * (lo + hi);
+                if (assignCells(mid) <= targetStrandCount) hi = mid;
+                else lo = mid;
+            }
+            assignCells(hi);
+        }
+
+        // Sort strands by cell. Each run of strands in the same cell forms a cluster.
+        std::vector<uint32_t> sortedStrands(strandCount);
+        std::iota(sortedStrands.begin(), sortedStrands.end(), 0);
+        std::sort(std::execution::par, sortedStrands.begin(), sortedStrands.end(), [&](uint32_t a, uint32_t b)
+        {
+            return cellKeys[a] != cellKeys[b] ? cellKeys[a] < cellKeys[b] : a < b;
+        });
+        std::vector<uint32_t> clusterOffsets;
+        for (uint32_t i = 0; i < strandCount; i++)
+        {
+            if (i == 0 || cellKeys[sortedStrands[i]] != cellKeys[sortedStrands[i - 1]]) clusterOffsets.push_back(i);
+        }
+        const uint32_t clusterCount = (uint32_t)clusterOffsets.size();
+        clusterOffsets.push_back(strandCount);
+
+        // Pick the representative strand of each cluster.
+        std::vector<uint32_t> representatives(clusterCount);
+        std::vector<float> clusterErrors(clusterCount);
+        auto clusterRange = NumericRange<uint32_t>(0, clusterCount);
+        std::for_each(std::execution::par, clusterRange.begin(), clusterRange.end(), [&](uint32_t c)
+        {
+            const uint32_t begin = clusterOffsets[c];
+            const uint32_t end = clusterOffsets[c + 1];
+
+            float3 meanRoot = float3(0.f);
+            for (uint32_t i = begin; i < end; i++) meanRoot += getRoot(sortedStrands[i]);
+            meanRoot /= (float)(end - begin);
+
+            uint32_t representative = sortedStrands[begin];
+            float minDistance = std::numeric_limits<float>::max();
+            for (uint32_t i = begin; i < end; i++)
+            {
+                float distance = glm::length(getRoot(sortedStrands[i]) - meanRoot);
+                if (distance < minDistance)
+                {
+                    minDistance = distance;
+                    representative = sortedStrands[i];
+                }
+            }
+
+            float error = 0.f;
+            for (uint32_t i = begin; i < end; i++)
+            {
+                error = std::max(error, glm::length(getRoot(sortedStrands[i]) - getRoot(representative)));
+                error = std::max(error, glm::length(getTip(sortedStrands[i]) - getTip(representative)));
+            }
+
+            representatives[c] = representative;
+            clusterErrors[c] = error;
+        });
+
+        // Compute the output offsets and copy the representative strands.
+        StrandClusterResult result;
+        result.strandCount = clusterCount;
+
+        std::vector<uint32_t> segmentOffsets(clusterCount + 1, 0);
+        for (uint32_t c = 0; c < clusterCount; c++)
+        {
+            uint32_t s = representatives[c];
+            segmentOffsets[c + 1] = segmentOffsets[c] + strandSegments[s + 1] - strandSegments[s];
+            result.error = std::max(result.error, clusterErrors[c]);
+        }
+        result.indices.resize(segmentOffsets.back());
+        result.vertices.resize(segmentOffsets.back() + clusterCount);
+
+        std::for_each(std::execution::par, clusterRange.begin(), clusterRange.end(), [&](uint32_t c)
+        {
+            const uint32_t s = representatives[c];
+            const uint32_t segmentCount = strandSegments[s + 1] - strandSegments[s];
+            const float radiusScale = std::sqrt((float)(clusterOffsets[c + 1] - clusterOffsets[c]));
+
+            // Each strand has one more vertex than segments, so the vertices of cluster c start at segmentOffsets[c] + c.
+            const uint32_t vertexOffset = segmentOffsets[c] + c;
+            const uint32_t firstVertex = indices[strandSegments[s]];
+            for (uint32_t j = 0; j <= segmentCount; j++)
+            {
+                StaticCurveVertexData v = vertices[firstVertex + j];
+                v.radius *= radiusScale;
+                result.vertices[vertexOffset + j] = v;
+                if (j < segmentCount) result.indices[segmentOffsets[c] + j] = vertexOffset + j;
+            }
+        });
+
         return result;
     }
 }
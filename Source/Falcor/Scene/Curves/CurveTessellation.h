@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "Scene/SceneTypes.slang"
 #include "Utils/Math/CubicSpline.h"
 
 namespace Falcor
@@ -33,6 +34,34 @@ namespace Falcor
     class FALCOR_API CurveTessellation
     {
     public:
+        /** Output layout of a tessellation, computed by a counting pass over the input strands.
+            The layout tells where each strand is written, so strands can be tessellated in parallel into preallocated output arrays.
+            Strands with fewer than two distinct control points are not tessellated.
+        */
+        struct StrandLayout
+        {
+            uint32_t subdivPerSegment = 1;                  ///< Number of sub-segments within each cubic bspline segment.
+            uint32_t keepOneEveryXVerticesPerStrand = 1;    ///< Keep one of every X vertices in each curve strand.
+            std::vector<uint32_t> controlPointOffsets;      ///< Offset of the first control point of each tessellated strand in the input arrays.
+            std::vector<uint32_t> controlPointCounts;       ///< Number of input control points of each tessellated strand.
+            std::vector<uint32_t> pointOffsets;             ///< Offset of the first tessellated point of each strand. Holds one extra element with the total point count.
+
+            uint32_t getStrandCount() const { return (uint32_t)controlPointOffsets.size(); }
+            uint32_t getPointCount() const { return pointOffsets.empty() ? 0 : pointOffsets.back(); }
+            uint32_t getSegmentCount() const { return getPointCount() - getStrandCount(); }
+        };
+
+        /** Compute the output layout of tessellating cubic B-splines.
+            \param[in] strandCount Number of curve strands.
+            \param[in] vertexCountsPerStrand Number of control points per strand.
+            \param[in] controlPoints Array of control points.
+            \param[in] subdivPerSegment Number of sub-segments within each cubic bspline segment (defined by 4 control points).
+            \param[in] keepOneEveryXStrands Keep one of every X curve strands.
+            \param[in] keepOneEveryXVerticesPerStrand Keep one of every X vertices in each curve strand.
+            \return Output layout.
+        */
+        static StrandLayout computeStrandLayout(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand);
+
         // Swept spheres
 
         struct SweptSphereResult
@@ -60,6 +89,19 @@ namespace Falcor
         */
         static SweptSphereResult convertToLinearSweptSphere(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const glm::mat4& xform);
 
+        /** Convert cubic B-splines to linear swept sphere segments, writing directly into preallocated arrays.
+            This is used to fill the curve buffers of SceneBuilder::ProcessedCurve without intermediate copies.
+            \param[in] layout Output layout from computeStrandLayout().
+            \param[in] controlPoints Array of control points.
+            \param[in] widths Array of curve widths, i.e., diameters of swept spheres.
+            \param[in] UVs Array of texture coordinates. If nullptr, texture coordinates are set to zero.
+            \param[in] widthScale Global scaling factor for curve width (normally set to 1.0).
+            \param[in] xform Row-major 4x4 transformation matrix. We apply pre-transformation to curve geometry.
+            \param[out] pIndices Array of layout.getSegmentCount() segment indices.
+            \param[out] pVertices Array of layout.getPointCount() vertices.
+        */
+        static void convertToLinearSweptSphere(const StrandLayout& layout, const float3* controlPoints, const float* widths, const float2* UVs, float widthScale, const glm::mat4& xform, uint32_t* pIndices, StaticCurveVertexData* pVertices);
+
         // Tessellated mesh
 
         struct MeshResult
@@ -88,6 +130,28 @@ namespace Falcor
         */
         static MeshResult convertToMesh(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection);
 
+        // Level of detail
+
+        struct StrandClusterResult
+        {
+            std::vector<uint32_t> indices;                  ///< Segment indices of the representative strands.
+            std::vector<StaticCurveVertexData> vertices;    ///< Vertices of the representative strands with widened radii.
+            uint32_t strandCount = 0;                       ///< Number of strands, one per cluster.
+            float error = 0.f;                              ///< Largest distance between the end points of a strand and those of its representative.
+        };
+
+        /** Reduce the number of linear swept sphere strands by clustering strands with nearby roots.
+            The roots are clustered on a uniform grid whose cell size is found by bisection to give at most the target number of clusters.
+            Each cluster is represented by the strand with the root closest to the cluster mean. Its radius is scaled by the square root
+            of the cluster size to approximately preserve the coverage of the removed strands.
+            \param[in] indices Segment indices, each referencing the first of the two vertices of a segment. Strands are runs of segments with consecutive vertices.
+            \param[in] indexCount Number of segments.
+            \param[in] vertices Curve vertices.
+            \param[in] targetStrandCount Maximum number of strands to keep.
+            \return Representative strands.
+        */
+        static StrandClusterResult clusterStrands(const uint32_t* indices, uint32_t indexCount, const StaticCurveVertexData* vertices, uint32_t targetStrandCount);
+
     private:
         CurveTessellation() = default;
         CurveTessellation(const CurveTessellation&) = delete;
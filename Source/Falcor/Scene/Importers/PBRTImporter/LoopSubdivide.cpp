@@ -33,369 +33,440 @@
 
 #include "stdafx.h"
 #include "LoopSubdivide.h"
+#include "Utils/NumericRange.h"
 
 #include <algorithm>
-#include <map>
-#include <set>
-#include <memory_resource>
+#include <execution>
+#include <unordered_map>
 
 namespace Falcor
 {
     namespace pbrt
     {
-        struct SDFace;
-        struct SDVertex;
-
-        #define NEXT(i) (((i) + 1) % 3)
-        #define PREV(i) (((i) + 2) % 3)
-
-        struct SDVertex
+        namespace
         {
-            SDVertex(const float3& p = float3(0.f)) : p(p) {}
+            const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+            const uint32_t kInlineRingSize = 16;
 
-            int valence();
-            void oneRing(float3 *p);
+            const uint8_t kVertexBoundary = 0x1;
+            const uint8_t kVertexRegular = 0x2;
 
-            float3 p;
-            SDFace* startFace = nullptr;
-            SDVertex* child = nullptr;
-            bool regular = false;
-            bool boundary = false;
-        };
+            inline uint32_t next(uint32_t i) { return (i + 1) % 3; }
+            inline uint32_t prev(uint32_t i) { return (i + 2) % 3; }
 
-        struct SDFace
-        {
-            SDFace()
+            inline float beta(uint32_t valence)
             {
-                for (uint32_t i = 0; i < 3; ++i)
-                {
-                    v[i] = nullptr;
-                    f[i] = nullptr;
-                }
-                for (uint32_t i = 0; i < 4; ++i)
-                {
-                    children[i] = nullptr;
-                }
+                if (valence == 3)
+                    return 3.f / 16.f;
+                else
+                    return 3.f / (8.f * valence);
             }
 
-            uint32_t vnum(SDVertex* vert) const
+            inline float loopGamma(uint32_t valence)
             {
-                for (int i = 0; i < 3; ++i)
-                {
-                    if (v[i] == vert) return i;
-                }
-                throw RuntimeError("Basic logic error in SDFace::vnum().");
+                return 1.f / (valence + 3.f / (8.f * beta(valence)));
             }
 
-            SDFace* nextFace(SDVertex* vert) const { return f[vnum(vert)]; }
-            SDFace* prevFace(SDVertex* vert) const { return f[PREV(vnum(vert))]; }
-            SDVertex* nextVert(SDVertex* vert) const { return v[NEXT(vnum(vert))]; }
-            SDVertex* prevVert(SDVertex* vert) const { return v[PREV(vnum(vert))]; }
-            SDVertex* otherVert(SDVertex* v0, SDVertex* v1)
+            /** Storage for the one-ring of a vertex. Avoids heap allocations for common valences.
+            */
+            class RingBuffer
             {
-                for (uint32_t i = 0; i < 3; ++i)
+            public:
+                float3* get(uint32_t valence)
                 {
-                    if (v[i] != v0 && v[i] != v1) return v[i];
+                    if (valence <= kInlineRingSize) return mInline;
+                    mHeap.resize(valence);
+                    return mHeap.data();
                 }
-                throw RuntimeError("Basic logic error in SDFace::otherVert()");
-            }
 
-            SDVertex* v[3];
-            SDFace* f[3];
-            SDFace* children[4];
-        };
+            private:
+                float3 mInline[kInlineRingSize];
+                std::vector<float3> mHeap;
+            };
 
-        struct SDEdge
-        {
-            SDEdge(SDVertex* v0 = nullptr, SDVertex* v1 = nullptr)
+            /** Triangle mesh with adjacency stored in flat arrays.
+                Half-edges are addressed implicitly as 3 * face + k, where half-edge k runs from vertex k to vertex next(k) of the face.
+                This replaces pbrt's pointer based SDVertex/SDFace structures, the traversal logic is kept identical.
+            */
+            struct SubdivisionMesh
             {
-                v[0] = std::min(v0, v1);
-                v[1] = std::max(v0, v1);
-                f[0] = f[1] = nullptr;
-                f0edgeNum = -1;
-            }
+                std::vector<float3> positions;
+                std::vector<uint32_t> vertexStartFace;  ///< A face adjacent to each vertex.
+                std::vector<uint8_t> vertexFlags;       ///< Combination of kVertexBoundary and kVertexRegular.
+                std::vector<uint32_t> faceVertices;     ///< Three vertex indices per face.
+                std::vector<uint32_t> faceNeighbors;    ///< Face across each half-edge or kInvalidIndex on boundaries.
 
-            bool operator<(const SDEdge &e2) const
-            {
-                if (v[0] == e2.v[0]) return v[1] < e2.v[1];
-                return v[0] < e2.v[0];
-            }
+                uint32_t getVertexCount() const { return (uint32_t)positions.size(); }
+                uint32_t getFaceCount() const { return (uint32_t)(faceVertices.size() / 3); }
 
-            SDVertex* v[2];
-            SDFace* f[2];
-            int f0edgeNum;
-        };
+                bool isBoundary(uint32_t vertex) const { return (vertexFlags[vertex] & kVertexBoundary) != 0; }
+                bool isRegular(uint32_t vertex) const { return (vertexFlags[vertex] & kVertexRegular) != 0; }
 
-        static float3 weightOneRing(SDVertex* vert, float beta);
-        static float3 weightBoundary(SDVertex* vert, float beta);
-
-        inline int SDVertex::valence()
-        {
-            SDFace* f = startFace;
-            if (!boundary)
-            {
-                // Compute valence of interior vertex.
-                int nf = 1;
-                while ((f = f->nextFace(this)) != startFace) ++nf;
-                return nf;
-            }
-            else
-            {
-                // Compute valence of boundary vertex
-                int nf = 1;
-                while ((f = f->nextFace(this)) != nullptr) ++nf;
-                f = startFace;
-                while ((f = f->prevFace(this)) != nullptr) ++nf;
-                return nf + 1;
-            }
-        }
+                uint32_t vnum(uint32_t face, uint32_t vertex) const
+                {
+                    const uint32_t* v = &faceVertices[3 * face];
+                    if (v[0] == vertex) return 0;
+                    if (v[1] == vertex) return 1;
+                    FALCOR_ASSERT(v[2] == vertex);
+                    return 2;
+                }
 
-        inline float beta(uint32_t valence)
-        {
-            if (valence == 3)
-                return 3.f / 16.f;
-            else
-                return 3.f / (8.f * valence);
-        }
+                uint32_t nextFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[3 * face + vnum(face, vertex)]; }
+                uint32_t prevFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[3 * face + prev(vnum(face, vertex))]; }
+                uint32_t nextVert(uint32_t face, uint32_t vertex) const { return faceVertices[3 * face + next(vnum(face, vertex))]; }
+                uint32_t prevVert(uint32_t face, uint32_t vertex) const { return faceVertices[3 * face + prev(vnum(face, vertex))]; }
 
-        inline float loopGamma(uint32_t valence)
-        {
-            return 1.f / (valence + 3.f / (8.f * beta(valence)));
-        }
+                uint32_t otherVert(uint32_t face, uint32_t v0, uint32_t v1) const
+                {
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        uint32_t v = faceVertices[3 * face + i];
+                        if (v != v0 && v != v1) return v;
+                    }
+                    FALCOR_UNREACHABLE();
+                    return kInvalidIndex;
+                }
 
-        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
-        {
-            std::vector<SDVertex*> vertices;
-            std::vector<SDFace*> faces;
+                /** Returns the half-edge of the neighboring face that shares the given half-edge, or kInvalidIndex on boundaries.
+                */
+                uint32_t twin(uint32_t halfEdge) const
+                {
+                    uint32_t face = faceNeighbors[halfEdge];
+                    if (face == kInvalidIndex) return kInvalidIndex;
 
-            // Allocate vertices and faces.
-            std::unique_ptr<SDVertex[]> verts = std::make_unique<SDVertex[]>(positions.size());
-            for (size_t i = 0; i < positions.size(); ++i)
-            {
-                verts[i] = SDVertex(positions[i]);
-                vertices.push_back(&verts[i]);
-            }
-            size_t faceCount = indices.size() / 3;
-            std::unique_ptr<SDFace[]> fs = std::make_unique<SDFace[]>(faceCount);
-            for (size_t i = 0; i < faceCount; ++i)
-            {
-                faces.push_back(&fs[i]);
-            }
+                    uint32_t v0 = faceVertices[halfEdge];
+                    uint32_t v1 = faceVertices[3 * (halfEdge / 3) + next(halfEdge % 3)];
+                    for (uint32_t k = 0; k < 3; ++k)
+                    {
+                        uint32_t w0 = faceVertices[3 * face + k];
+                        uint32_t w1 = faceVertices[3 * face + next(k)];
+                        if ((w0 == v0 && w1 == v1) || (w0 == v1 && w1 == v0)) return 3 * face + k;
+                    }
+                    return kInvalidIndex;
+                }
 
-            // Set face to vertex pointers.
-            const uint32_t* vp = indices.data();
-            for (size_t i = 0; i < faceCount; ++i, vp += 3)
-            {
-                SDFace* f = faces[i];
-                for (uint32_t j = 0; j < 3; ++j)
+                uint32_t valence(uint32_t vertex) const
                 {
-                    SDVertex* v = vertices[vp[j]];
-                    f->v[j] = v;
-                    v->startFace = f;
+                    uint32_t startFace = vertexStartFace[vertex];
+                    uint32_t f = startFace;
+                    if (!isBoundary(vertex))
+                    {
+                        // Compute valence of interior vertex.
+                        uint32_t nf = 1;
+                        while ((f = nextFace(f, vertex)) != startFace) ++nf;
+                        return nf;
+                    }
+                    else
+                    {
+                        // Compute valence of boundary vertex.
+                        uint32_t nf = 1;
+                        while ((f = nextFace(f, vertex)) != kInvalidIndex) ++nf;
+                        f = startFace;
+                        while ((f = prevFace(f, vertex)) != kInvalidIndex) ++nf;
+                        return nf + 1;
+                    }
                 }
-            }
 
-            // Set neighbor pointers in faces.
-            std::set<SDEdge> edges;
-            for (size_t i = 0; i < faceCount; ++i)
-            {
-                SDFace* f = faces[i];
-                for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
+                void oneRing(uint32_t vertex, float3* p) const
                 {
-                    // Update neighbor pointer for edgeNum.
-                    int v0 = edgeNum, v1 = NEXT(edgeNum);
-                    SDEdge e(f->v[v0], f->v[v1]);
-                    if (edges.find(e) == edges.end())
+                    uint32_t startFace = vertexStartFace[vertex];
+                    if (!isBoundary(vertex))
                     {
-                        // Handle new edge.
-                        e.f[0] = f;
-                        e.f0edgeNum = edgeNum;
-                        edges.insert(e);
+                        // Get one-ring vertices for interior vertex.
+                        uint32_t face = startFace;
+                        do
+                        {
+                            *p++ = positions[nextVert(face, vertex)];
+                            face = nextFace(face, vertex);
+                        } while (face != startFace);
                     }
                     else
                     {
-                        // Handle previously seen edge.
-                        e =* edges.find(e);
-                        e.f[0]->f[e.f0edgeNum] = f;
-                        f->f[edgeNum] = e.f[0];
-                        edges.erase(e);
+                        // Get one-ring vertices for boundary vertex.
+                        uint32_t face = startFace;
+                        uint32_t f2;
+                        while ((f2 = nextFace(face, vertex)) != kInvalidIndex)
+                        {
+                            face = f2;
+                        }
+                        *p++ = positions[nextVert(face, vertex)];
+                        do
+                        {
+                            *p++ = positions[prevVert(face, vertex)];
+                            face = prevFace(face, vertex);
+                        } while (face != kInvalidIndex);
                     }
                 }
-            }
 
-            // Finish vertex initialization.
-            for (size_t i = 0; i < positions.size(); ++i)
-            {
-                SDVertex* v = vertices[i];
-                SDFace* f = v->startFace;
-                do
+                float3 weightOneRing(uint32_t vertex, uint32_t valence, float beta, RingBuffer& ring) const
                 {
-                    f = f->nextFace(v);
-                } while ((f != nullptr) && f != v->startFace);
-                v->boundary = (f == nullptr);
-                if (!v->boundary && v->valence() == 6) v->regular = true;
-                else if (v->boundary && v->valence() == 4) v->regular = true;
-                else v->regular = false;
-            }
-
-            // Refine LoopSubdiv into triangles.
-            std::vector<SDFace*> f = faces;
-            std::vector<SDVertex*> v = vertices;
+                    float3* pRing = ring.get(valence);
+                    oneRing(vertex, pRing);
+                    float3 p = (1 - valence * beta) * positions[vertex];
+                    for (uint32_t i = 0; i < valence; ++i)
+                    {
+                        p += beta * pRing[i];
+                    }
+                    return p;
+                }
 
-            std::pmr::monotonic_buffer_resource buffer;
-            std::pmr::polymorphic_allocator<SDVertex> vertexAllocator(&buffer);
-            std::pmr::polymorphic_allocator<SDFace> faceAllocator(&buffer);
+                float3 weightBoundary(uint32_t vertex, float beta, RingBuffer& ring) const
+                {
+                    uint32_t valence = this->valence(vertex);
+                    float3* pRing = ring.get(valence);
+                    oneRing(vertex, pRing);
+                    float3 p = (1 - 2 * beta) * positions[vertex];
+                    p += beta * pRing[0];
+                    p += beta * pRing[valence - 1];
+                    return p;
+                }
+            };
 
-            for (size_t i = 0; i < levels; ++i)
+            SubdivisionMesh createBaseMesh(fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
             {
-                // Update f and v for next level of subdivision.
-                std::vector<SDFace*> newFaces;
-                std::vector<SDVertex*> newVertices;
+                SubdivisionMesh mesh;
+                const uint32_t vertexCount = (uint32_t)positions.size();
+                const uint32_t faceCount = (uint32_t)(indices.size() / 3);
+
+                mesh.positions.assign(positions.begin(), positions.end());
+                mesh.faceVertices.assign(indices.begin(), indices.begin() + 3 * faceCount);
 
-                // Allocate next level of children in mesh tree.
-                for (SDVertex* vertex : v)
+                // Set vertex to face indices, the last face referencing a vertex is used as in pbrt.
+                mesh.vertexStartFace.assign(vertexCount, kInvalidIndex);
+                for (uint32_t i = 0; i < 3 * faceCount; ++i)
                 {
-                    vertex->child = vertexAllocator.allocate(1);
-                    vertex->child->regular = vertex->regular;
-                    vertex->child->boundary = vertex->boundary;
-                    newVertices.push_back(vertex->child);
+                    uint32_t vertex = mesh.faceVertices[i];
+                    if (vertex >= vertexCount) throw RuntimeError("Loop subdivision vertex index {} is out of range.", vertex);
+                    mesh.vertexStartFace[vertex] = i / 3;
+                }
+                for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+                {
+                    if (mesh.vertexStartFace[vertex] == kInvalidIndex) throw RuntimeError("Loop subdivision vertex {} is not referenced by any face.", vertex);
+                }
+
+                // Set neighbor indices in faces by pairing half-edges with matching vertices.
+                mesh.faceNeighbors.assign(3 * faceCount, kInvalidIndex);
+                std::unordered_map<uint64_t, uint32_t> openEdges;
+                openEdges.reserve(3 * faceCount / 2);
+                for (uint32_t halfEdge = 0; halfEdge < 3 * faceCount; ++halfEdge)
+                {
+                    uint32_t v0 = mesh.faceVertices[halfEdge];
+                    uint32_t v1 = mesh.faceVertices[3 * (halfEdge / 3) + next(halfEdge % 3)];
+                    uint64_t key = (uint64_t(std::min(v0, v1)) << 32) | std::max(v0, v1);
+
+                    auto [it, inserted] = openEdges.try_emplace(key, halfEdge);
+                    if (!inserted)
+                    {
+                        // Handle previously seen edge.
+                        uint32_t other = it->second;
+                        mesh.faceNeighbors[other] = halfEdge / 3;
+                        mesh.faceNeighbors[halfEdge] = other / 3;
+                        openEdges.erase(it);
+                    }
                 }
-                for (SDFace* face : f)
+
+                // Finish vertex initialization.
+                mesh.vertexFlags.resize(vertexCount);
+                auto range = NumericRange<uint32_t>(0, vertexCount);
+                std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t vertex)
+                {
+                    uint32_t startFace = mesh.vertexStartFace[vertex];
+                    uint32_t f = startFace;
+                    do
+                    {
+                        f = mesh.nextFace(f, vertex);
+                    } while (f != kInvalidIndex && f != startFace);
+
+                    bool boundary = f == kInvalidIndex;
+                    mesh.vertexFlags[vertex] = boundary ? kVertexBoundary : 0;
+                    uint32_t valence = mesh.valence(vertex);
+                    if ((!boundary && valence == 6) || (boundary && valence == 4)) mesh.vertexFlags[vertex] |= kVertexRegular;
+                });
+
+                return mesh;
+            }
+
+            /** Performs one level of Loop subdivision.
+                Even vertices keep their index, odd vertices follow in the order their edges are first visited by face, and each face is split into four children.
+            */
+            SubdivisionMesh subdivide(const SubdivisionMesh& mesh)
+            {
+                const uint32_t vertexCount = mesh.getVertexCount();
+                const uint32_t faceCount = mesh.getFaceCount();
+                const uint32_t halfEdgeCount = 3 * faceCount;
+
+                // Find twin half-edges in parallel. Each edge is owned by its first half-edge, which creates the odd vertex.
+                std::vector<uint32_t> edgeVertices(halfEdgeCount);
+                auto halfEdgeRange = NumericRange<uint32_t>(0, halfEdgeCount);
+                std::for_each(std::execution::par, halfEdgeRange.begin(), halfEdgeRange.end(), [&](uint32_t halfEdge)
+                {
+                    edgeVertices[halfEdge] = mesh.twin(halfEdge);
+                });
+
+                // Assign odd vertex indices in half-edge order. Twins of owned half-edges always come later and copy the index.
+                std::vector<uint32_t> oddHalfEdges;
+                oddHalfEdges.reserve(halfEdgeCount / 2 + 1);
+                for (uint32_t halfEdge = 0; halfEdge < halfEdgeCount; ++halfEdge)
                 {
-                    for (uint32_t k = 0; k < 4; ++k)
+                    uint32_t twin = edgeVertices[halfEdge];
+                    if (twin == kInvalidIndex || halfEdge < twin)
                     {
-                        face->children[k] = faceAllocator.allocate(1);
-                        newFaces.push_back(face->children[k]);
+                        edgeVertices[halfEdge] = vertexCount + (uint32_t)oddHalfEdges.size();
+                        oddHalfEdges.push_back(halfEdge);
+                    }
+                    else
+                    {
+                        edgeVertices[halfEdge] = edgeVertices[twin];
                     }
                 }
 
-                // Update vertex positions and create new edge vertices.
+                const uint32_t oddVertexCount = (uint32_t)oddHalfEdges.size();
+                SubdivisionMesh result;
+                result.positions.resize(vertexCount + oddVertexCount);
+                result.vertexStartFace.resize(vertexCount + oddVertexCount);
+                result.vertexFlags.resize(vertexCount + oddVertexCount);
+                result.faceVertices.resize(4 * halfEdgeCount);
+                result.faceNeighbors.resize(4 * halfEdgeCount);
 
                 // Update vertex positions for even vertices.
-                for (SDVertex* vertex : v)
+                auto vertexRange = NumericRange<uint32_t>(0, vertexCount);
+                std::for_each(std::execution::par, vertexRange.begin(), vertexRange.end(), [&](uint32_t vertex)
                 {
-                    if (!vertex->boundary)
+                    RingBuffer ring;
+                    if (!mesh.isBoundary(vertex))
                     {
                         // Apply one-ring rule for even vertex.
-                        if (vertex->regular) vertex->child->p = weightOneRing(vertex, 1.f / 16.f);
-                        else vertex->child->p = weightOneRing(vertex, beta(vertex->valence()));
+                        uint32_t valence = mesh.valence(vertex);
+                        float b = mesh.isRegular(vertex) ? 1.f / 16.f : beta(valence);
+                        result.positions[vertex] = mesh.weightOneRing(vertex, valence, b, ring);
                     }
                     else
                     {
                         // Apply boundary rule for even vertex.
-                        vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
+                        result.positions[vertex] = mesh.weightBoundary(vertex, 1.f / 8.f, ring);
                     }
-                }
+
+                    uint32_t startFace = mesh.vertexStartFace[vertex];
+                    result.vertexStartFace[vertex] = 4 * startFace + mesh.vnum(startFace, vertex);
+                    result.vertexFlags[vertex] = mesh.vertexFlags[vertex];
+                });
 
                 // Compute new odd edge vertices.
-                std::map<SDEdge, SDVertex*> edgeVerts;
-                for (SDFace* face : f)
+                auto oddRange = NumericRange<uint32_t>(0, oddVertexCount);
+                std::for_each(std::execution::par, oddRange.begin(), oddRange.end(), [&](uint32_t i)
                 {
-                    for (uint32_t k = 0; k < 3; ++k)
+                    uint32_t halfEdge = oddHalfEdges[i];
+                    uint32_t face = halfEdge / 3;
+                    uint32_t v0 = mesh.faceVertices[halfEdge];
+                    uint32_t v1 = mesh.faceVertices[3 * face + next(halfEdge % 3)];
+                    uint32_t neighbor = mesh.faceNeighbors[halfEdge];
+                    bool boundary = neighbor == kInvalidIndex;
+
+                    uint32_t vertex = vertexCount + i;
+                    result.vertexFlags[vertex] = kVertexRegular | (boundary ? kVertexBoundary : 0);
+                    result.vertexStartFace[vertex] = 4 * face + 3;
+
+                    // Apply edge rules to compute new vertex position.
+                    float3 p;
+                    if (boundary)
                     {
-                        // Compute odd vertex on kth edge.
-                        SDEdge edge(face->v[k], face->v[NEXT(k)]);
-                        SDVertex* vert = edgeVerts[edge];
-                        if (vert == nullptr)
-                        {
-                            // Create and initialize new odd vertex
-                            vert = vertexAllocator.allocate(1);
-                            newVertices.push_back(vert);
-                            vert->regular = true;
-                            vert->boundary = (face->f[k] == nullptr);
-                            vert->startFace = face->children[3];
-
-                            // Apply edge rules to compute new vertex position
-                            if (vert->boundary)
-                            {
-                                vert->p = 0.5f * edge.v[0]->p;
-                                vert->p += 0.5f * edge.v[1]->p;
-                            }
-                            else
-                            {
-                                vert->p = 3.f / 8.f * edge.v[0]->p;
-                                vert->p += 3.f / 8.f * edge.v[1]->p;
-                                vert->p += 1.f / 8.f * face->otherVert(edge.v[0], edge.v[1])->p;
-                                vert->p += 1.f / 8.f * face->f[k]->otherVert(edge.v[0], edge.v[1])->p;
-                            }
-                            edgeVerts[edge] = vert;
-                        }
+                        p = 0.5f * mesh.positions[v0];
+                        p += 0.5f * mesh.positions[v1];
                     }
-                }
+                    else
+                    {
+                        p = 3.f / 8.f * mesh.positions[v0];
+                        p += 3.f / 8.f * mesh.positions[v1];
+                        p += 1.f / 8.f * mesh.positions[mesh.otherVert(face, v0, v1)];
+                        p += 1.f / 8.f * mesh.positions[mesh.otherVert(neighbor, v0, v1)];
+                    }
+                    result.positions[vertex] = p;
+                });
 
                 // Update new mesh topology.
-
-                // Update even vertex face pointers.
-                for (SDVertex* vertex : v)
+                auto faceRange = NumericRange<uint32_t>(0, faceCount);
+                std::for_each(std::execution::par, faceRange.begin(), faceRange.end(), [&](uint32_t face)
                 {
-                    int vertNum = vertex->startFace->vnum(vertex);
-                    vertex->child->startFace = vertex->startFace->children[vertNum];
-                }
+                    const uint32_t* v = &mesh.faceVertices[3 * face];
+                    const uint32_t* neighbors = &mesh.faceNeighbors[3 * face];
+                    uint32_t* childVertices = &result.faceVertices[12 * face];
+                    uint32_t* childNeighbors = &result.faceNeighbors[12 * face];
+                    const uint32_t firstChild = 4 * face;
 
-                // Update face neighbor pointers.
-                for (SDFace* face : f)
-                {
                     for (uint32_t j = 0; j < 3; ++j)
                     {
-                        // Update children f pointers for siblings.
-                        face->children[3]->f[j] = face->children[NEXT(j)];
-                        face->children[j]->f[NEXT(j)] = face->children[3];
-
-                        // Update children f pointers for neighbor children.
-                        SDFace* f2 = face->f[j];
-                        face->children[j]->f[j] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                        f2 = face->f[PREV(j)];
-                        face->children[j]->f[PREV(j)] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
+                        // Update children neighbors for siblings.
+                        childNeighbors[3 * 3 + j] = firstChild + next(j);
+                        childNeighbors[3 * j + next(j)] = firstChild + 3;
+
+                        // Update children neighbors for neighbor children.
+                        uint32_t f2 = neighbors[j];
+                        childNeighbors[3 * j + j] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, v[j]) : kInvalidIndex;
+                        f2 = neighbors[prev(j)];
+                        childNeighbors[3 * j + prev(j)] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, v[j]) : kInvalidIndex;
                     }
-                }
 
-                // Update face vertex pointers.
-                for (SDFace* face : f)
-                {
                     for (uint32_t j = 0; j < 3; ++j)
                     {
-                        // Update child vertex pointer to new even vertex
-                        face->children[j]->v[j] = face->v[j]->child;
-
-                        // Update child vertex pointer to new odd vertex
-                        SDVertex *vert = edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
-                        face->children[j]->v[NEXT(j)] = vert;
-                        face->children[NEXT(j)]->v[j] = vert;
-                        face->children[3]->v[j] = vert;
+                        // Update child vertex to new even vertex, which keeps the index of its parent.
+                        childVertices[3 * j + j] = v[j];
+
+                        // Update child vertex to new odd vertex.
+                        uint32_t oddVertex = edgeVertices[3 * face + j];
+                        childVertices[3 * j + next(j)] = oddVertex;
+                        childVertices[3 * next(j) + j] = oddVertex;
+                        childVertices[3 * 3 + j] = oddVertex;
                     }
-                }
+                });
 
-                // Prepare for next level of subdivision
-                f = newFaces;
-                v = newVertices;
+                return result;
             }
+        }
 
-            // Push vertices to limit surface.
-            std::vector<float3> pLimit(v.size());
-            for (size_t i = 0; i < v.size(); ++i)
+        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
+        {
+            SubdivisionMesh mesh = createBaseMesh(positions, indices);
+
+            // Refine LoopSubdiv into triangles.
+            for (uint32_t i = 0; i < levels; ++i)
             {
-                if (v[i]->boundary) pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
-                else pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
+                mesh = subdivide(mesh);
             }
-            for (size_t i = 0; i < v.size(); ++i)
+
+            const uint32_t vertexCount = mesh.getVertexCount();
+            auto vertexRange = NumericRange<uint32_t>(0, vertexCount);
+
+            // Push vertices to limit surface.
+            std::vector<float3> pLimit(vertexCount);
+            std::for_each(std::execution::par, vertexRange.begin(), vertexRange.end(), [&](uint32_t vertex)
             {
-                v[i]->p = pLimit[i];
-            }
+                RingBuffer ring;
+                if (mesh.isBoundary(vertex))
+                {
+                    pLimit[vertex] = mesh.weightBoundary(vertex, 1.f / 5.f, ring);
+                }
+                else
+                {
+                    uint32_t valence = mesh.valence(vertex);
+                    pLimit[vertex] = mesh.weightOneRing(vertex, valence, loopGamma(valence), ring);
+                }
+            });
+            mesh.positions = std::move(pLimit);
 
             // Compute vertex tangents on limit surface.
-            std::vector<float3> Ns;
-            Ns.reserve(v.size());
-            std::vector<float3> pRing(16, float3());
-            for (SDVertex* vertex : v)
+            std::vector<float3> Ns(vertexCount);
+            std::for_each(std::execution::par, vertexRange.begin(), vertexRange.end(), [&](uint32_t vertex)
             {
+                RingBuffer ring;
                 float3 S(0.f);
                 float3 T(0.f);
-                uint32_t valence = vertex->valence();
-                if (valence > pRing.size()) pRing.resize(valence);
-                vertex->oneRing(&pRing[0]);
-                if (!vertex->boundary)
+                const float3& p = mesh.positions[vertex];
+                uint32_t valence = mesh.valence(vertex);
+                float3* pRing = ring.get(valence);
+                mesh.oneRing(vertex, pRing);
+                if (!mesh.isBoundary(vertex))
                 {
-                    // Compute tangents of interior face
+                    // Compute tangents of interior face.
                     for (uint32_t j = 0; j < valence; ++j)
                     {
                         S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
@@ -404,19 +475,19 @@ namespace Falcor
                 }
                 else
                 {
-                    // Compute tangents of boundary face
+                    // Compute tangents of boundary face.
                     S = pRing[valence - 1] - pRing[0];
                     if (valence == 2)
                     {
-                        T = float3(pRing[0] + pRing[1] - 2.f * vertex->p);
+                        T = float3(pRing[0] + pRing[1] - 2.f * p);
                     }
                     else if (valence == 3)
                     {
-                        T = pRing[1] - vertex->p;
+                        T = pRing[1] - p;
                     }
                     else if (valence == 4) // regular
                     {
-                        T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex->p);
+                        T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * p);
                     }
                     else
                     {
@@ -430,95 +501,15 @@ namespace Falcor
                         T = -T;
                     }
                 }
-                Ns.push_back(cross(S, T));
-            }
-
-            // Create triangle mesh from subdivision mesh
-            {
-                size_t ntris = f.size();
-                std::vector<uint32_t> verts(3 * ntris);
-                uint32_t *vp = verts.data();
-                uint32_t totVerts = (uint32_t)v.size();
-                std::map<SDVertex*, uint32_t> usedVerts;
-                for (uint32_t i = 0; i < totVerts; ++i)
-                {
-                    usedVerts[v[i]] = i;
-                }
-                for (size_t i = 0; i < ntris; ++i)
-                {
-                    for (uint32_t j = 0; j < 3; ++j)
-                    {
-                        *vp = usedVerts[f[i]->v[j]];
-                        ++vp;
-                    }
-                }
-
-                LoopSubdivideResult result;
-                result.positions = std::move(pLimit);
-                result.normals = std::move(Ns);
-                result.indices = std::move(verts);
-                return result;
-            }
-        }
-
-        static float3 weightOneRing(SDVertex* vert, float beta)
-        {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - valence * beta) * vert->p;
-            for (uint32_t i = 0; i < valence; ++i)
-            {
-                p += beta * pRing[i];
-            }
-            return p;
-        }
-
-        void SDVertex::oneRing(float3* p)
-        {
-            if (!boundary)
-            {
-                // Get one-ring vertices for interior vertex.
-                SDFace* face = startFace;
-                do
-                {
-                    *p++ = face->nextVert(this)->p;
-                    face = face->nextFace(this);
-                } while (face != startFace);
-            }
-            else
-            {
-                // Get one-ring vertices for boundary vertex.
-                SDFace* face = startFace;
-                SDFace* f2;
-                while ((f2 = face->nextFace(this)) != nullptr)
-                {
-                    face = f2;
-                }
-                *p++ = face->nextVert(this)->p;
-                do
-                {
-                    *p++ = face->prevVert(this)->p;
-                    face = face->prevFace(this);
-                } while (face != nullptr);
-            }
-        }
-
-        static float3 weightBoundary(SDVertex* vert, float beta)
-        {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - 2 * beta) * vert->p;
-            p += beta * pRing[0];
-            p += beta * pRing[valence - 1];
-            return p;
+                Ns[vertex] = cross(S, T);
+            });
+
+            // Create triangle mesh from subdivision mesh. Vertices are already stored in output order.
+            LoopSubdivideResult result;
+            result.positions = std::move(mesh.positions);
+            result.normals = std::move(Ns);
+            result.indices = std::move(mesh.faceVertices);
+            return result;
         }
     }
 }
@@ -44,6 +44,13 @@ namespace Falcor
             std::vector<uint32_t> indices;
         };
 
-        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> vertices);
+        /** Subdivides a triangle mesh using Loop subdivision and pushes the vertices to the limit surface.
+            Each level is computed in parallel on flat index arrays.
+            \param[in] levels Number of subdivision levels.
+            \param[in] positions Vertex positions.
+            \param[in] vertices Vertex indices, three per triangle. Every vertex must be referenced by a triangle.
+            \return The subdivided mesh with limit surface positions and normals.
+        */
+        FALCOR_API LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> vertices);
     }
 }
@@ -112,19 +112,6 @@ namespace Falcor
             size_t numReferencedPoints = 0;                         // Number of elements of points that are referenced by the point indices.
         };
 
-        // CurveGeomData represents curve data using a single array for each of points, radius, tangents, normals and optionally texture coordinates.
-        // All are indexed per vertex.
-        struct CurveGeomData
-        {
-            uint32_t degree;                                        // Polynomial degree of curve; linear (1) by default
-            std::vector<uint32_t> indices;                          // First point indices of curve segments
-            std::vector<float3> points;                             // Vertex positions
-            std::vector<float> radius;                              // Radius of spheres at curve ends
-            std::vector<float2> texCrds;                            // Texture coordinates
-            std::string id;                                         // Name; equal to name of UsdGeomBasisCurves
-            UsdShadeMaterial material;                              // Bound material
-        };
-
         // Shuffle triangle data into GeomSubset order.
         // N specifies the number of data values per face; 1 corresponds to uniform, 3 corresponds to faceVarying
         template <size_t N, class T>
@@ -551,7 +538,7 @@ namespace Falcor
             return true;
         }
 
-        // Convert a UsdGeomBasisCurves into a CurveGeomData (curve primitive) or a MeshGeomData (mesh)
+        // Convert a UsdGeomBasisCurves into a SceneBuilder::ProcessedCurve (curve primitive) or a MeshGeomData (mesh)
         template <class T>
         bool convertCurveGeomData(const UsdGeomBasisCurves& usdCurve, const UsdTimeCode& timeCode, ImporterContext& ctx, T& geomOut)
         {
@@ -632,28 +619,39 @@ namespace Falcor
             // Perceptually, it is a good practice to increase width of hair strands if we render less of them than anticipated.
             float widthScale = std::sqrt((float)keepOneEveryXStrands);
 
-            if constexpr (std::is_same<T, CurveGeomData>::value)
+            if constexpr (std::is_same<T, SceneBuilder::ProcessedCurve>::value)
             {
-                // Convert to linear swept sphere segments.
-                CurveTessellation::SweptSphereResult result = CurveTessellation::convertToLinearSweptSphere(strandCount, usdCurveVertexCounts.data(), (float3*)usdPoints.data(), usdCurveWidths.data(), pUsdUVs, 1, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, glm::identity<glm::float4x4>());
+                // Convert to linear swept sphere segments, written directly into the buffers of the processed curve.
+                CurveTessellation::StrandLayout layout = CurveTessellation::computeStrandLayout(strandCount, usdCurveVertexCounts.data(), (float3*)usdPoints.data(), subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+                if (layout.getSegmentCount() == 0)
+                {
+                    // Leave the output empty. The caller skips keyframes without segments.
+                    logWarning("Curve '{}' has no segments. Ignoring.", curveName);
+                    return true;
+                }
 
-                // Copy data
-                geomOut.id = curveName;
-                geomOut.degree = result.degree;
-                geomOut.indices = std::move(result.indices);
-                geomOut.points = std::move(result.points);
-                geomOut.radius = std::move(result.radius);
-                geomOut.material = ctx.getBoundMaterial(usdCurve);
+                geomOut.name = curveName;
+                geomOut.topology = Vao::Topology::LineStrip;
+                geomOut.indexData.resize(layout.getSegmentCount());
+                geomOut.staticData.resize(layout.getPointCount());
+                CurveTessellation::convertToLinearSweptSphere(layout, (float3*)usdPoints.data(), usdCurveWidths.data(), pUsdUVs, widthScale, glm::identity<glm::float4x4>(), geomOut.indexData.data(), geomOut.staticData.data());
 
-                // Copy texture coordinates
-                if (result.texCrds.size() > 0)
+                if (!pUsdUVs)
                 {
-                    geomOut.texCrds = std::move(result.texCrds);
+                    logWarning("Curve '{}' has no texture coordinates.", curveName);
                 }
-                else
+
+                Material::SharedPtr pMaterial = ctx.resolveMaterial(usdCurve.GetPrim(), ctx.getBoundMaterial(usdCurve), curveName);
+
+                // It is possible the material was found in the scene and is assigned to other non-curve geometry.
+                // We'll issue a warning if there is a material type mismatch.
+                FALCOR_ASSERT(pMaterial);
+                if (pMaterial->getType() != MaterialType::Hair)
                 {
-                    logWarning("Curve '{}' has no texture coordinates.", curveName);
+                    logWarning("Material '{}' assigned to curve '{}' is of non-hair type.", pMaterial->getName(), curveName);
                 }
+
+                geomOut.pMaterial = pMaterial;
             }
             else if constexpr (std::is_same<T, MeshGeomData>::value)
             {
@@ -745,41 +743,6 @@ namespace Falcor
             return true;
         }
 
-        bool createSceneBuilderCurve(const UsdPrim& curvePrim, const CurveGeomData& curveData, ImporterContext& ctx, SceneBuilder::Curve& sbCurve)
-        {
-            sbCurve.name = curveData.id;
-            sbCurve.indexCount = (uint32_t)curveData.indices.size();
-            sbCurve.vertexCount = (uint32_t)curveData.points.size();
-            sbCurve.pIndices = curveData.indices.data();
-            sbCurve.positions.pData = curveData.points.data();
-            sbCurve.radius.pData = curveData.radius.data();
-            sbCurve.texCrds.pData = (curveData.texCrds.size() > 0 ? curveData.texCrds.data() : nullptr);
-
-            Material::SharedPtr pMaterial = ctx.resolveMaterial(curvePrim, curveData.material, sbCurve.name);
-
-            // It is possible the material was found in the scene and is assigned to other non-curve geometry.
-            // We'll issue a warning if there is a material type mismatch.
-            FALCOR_ASSERT(pMaterial);
-            if (pMaterial->getType() != MaterialType::Hair)
-            {
-                logWarning("Material '{}' assigned to curve '{}' is of non-hair type.", pMaterial->getName(), sbCurve.name);
-            }
-
-            sbCurve.pMaterial = pMaterial;
-
-            if (sbCurve.pIndices == nullptr || sbCurve.indexCount == 0)
-            {
-                logWarning("Gprim '{}' has no indices. Ignoring.", curvePrim.GetPath().GetString());
-                return false;
-            }
-            if (sbCurve.positions.pData == nullptr)
-            {
-                logWarning("Gprim '{}' has no position data. Ignoring.", curvePrim.GetPath().GetString());
-                return false;
-            }
-            return true;
-        }
-
         void verifyMeshGeomData(const MeshGeomData& geomData, const std::filesystem::path& path, const std::string& primName)
         {
             // Basic sanity checks
@@ -966,23 +929,27 @@ namespace Falcor
                 for (uint32_t i = 0; i < timeSampleCount; i++) timeCodes.push_back(UsdTimeCode(curve.timeSamples[i]));
             }
 
+            std::vector<double> timeSamples;
             for (size_t i = 0; i < timeCodes.size(); i++)
             {
-                CurveGeomData curveData;
-                if (!convertCurveGeomData(geomCurve, timeCodes[i], ctx, curveData))
+                SceneBuilder::ProcessedCurve processedCurve;
+                if (!convertCurveGeomData(geomCurve, timeCodes[i], ctx, processedCurve))
                 {
+                    curve.processedCurves.clear();
                     return false;
                 }
 
-                SceneBuilder::Curve sbCurve;
-                if (createSceneBuilderCurve(curve.curvePrim, curveData, ctx, sbCurve))
-                {
-                    curve.processedCurves.push_back(ctx.builder.processCurve(sbCurve));
-                }
+                // Skip keyframes without segments.
+                if (processedCurve.indexData.empty()) continue;
+
+                curve.processedCurves.push_back(std::move(processedCurve));
 
                 // Compute keyframe time in seconds.
-                curve.timeSamples[i] /= ctx.timeCodesPerSecond;
+                timeSamples.push_back(curve.timeSamples[i] / ctx.timeCodesPerSecond);
             }
+            curve.timeSamples = std::move(timeSamples);
+
+            if (curve.processedCurves.empty()) return false;
 
             // Process a mesh of the first keyframe.
             if (curve.tessellationMode == CurveTessellationMode::PolyTube)
@@ -1009,6 +976,38 @@ namespace Falcor
             return true;
         }
 
+        SceneBuilder::Instancer::Prototype flattenPrototype(ImporterContext& ctx, const PrototypeGeom& protoGeom)
+        {
+            FALCOR_ASSERT(protoGeom.animations.empty() && protoGeom.prototypeInstances.empty());
+
+            // Compute the transforms of the prototype nodes relative to the prototype root.
+            // Nodes are added during traversal, so parents precede their children.
+            std::vector<float4x4> nodeXforms(protoGeom.nodes.size());
+            for (size_t i = 0; i < protoGeom.nodes.size(); i++)
+            {
+                const auto& node = protoGeom.nodes[i];
+                nodeXforms[i] = (node.parent == SceneBuilder::kInvalidNode) ? node.transform : nodeXforms[node.parent] * node.transform;
+            }
+
+            // Group the meshes by transform.
+            SceneBuilder::Instancer::Prototype prototype;
+            for (const auto& meshInstance : protoGeom.geomInstances)
+            {
+                float4x4 xform = nodeXforms[meshInstance.parentID] * meshInstance.xform;
+                auto it = std::find_if(prototype.begin(), prototype.end(), [&](const auto& part) { return part.transform == xform; });
+                if (it == prototype.end())
+                {
+                    prototype.emplace_back().transform = xform;
+                    it = std::prev(prototype.end());
+                }
+
+                const auto& mesh = ctx.getMesh(meshInstance.prim);
+                it->meshIDs.insert(it->meshIDs.end(), mesh.meshIDs.begin(), mesh.meshIDs.end());
+            }
+
+            return prototype;
+        }
+
         void addSkeletonsToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             for (auto& skel : ctx.skeletons)
@@ -1215,6 +1214,23 @@ namespace Falcor
                 }
             }
 
+            // Add packed point instancers to scene builder. Their prototypes are static and contain no nested instances,
+            // so each prototype is flattened into parts holding the prototype meshes and their transforms relative to the instance.
+            for (auto& pointInstancer : ctx.pointInstancers)
+            {
+                SceneBuilder::Instancer instancer;
+                instancer.name = pointInstancer.name;
+                instancer.parent = pointInstancer.parentID;
+                for (const auto& protoPrim : pointInstancer.protoPrims)
+                {
+                    instancer.prototypes.push_back(flattenPrototype(ctx, ctx.getPrototypeGeom(protoPrim)));
+                }
+                instancer.prototypeIndices = std::move(pointInstancer.protoIndices);
+                instancer.transforms = std::move(pointInstancer.xforms);
+                instancer.keyframes = std::move(pointInstancer.keyframes);
+                ctx.builder.addInstancer(instancer);
+            }
+
             timeReport.measure("Create instances");
         }
 
@@ -1229,21 +1245,24 @@ namespace Falcor
 
             // Add processed curves or meshes (of the first keyframe) to scene builder.
             // This is done sequentially after being processed in parallel to ensure a deterministic ordering.
+            // Curves that could not be processed were reported with a warning and are skipped.
             for (auto& curve : ctx.curves)
             {
+                if (curve.processedCurves.empty()) continue;
+
+                // Add the curve vertex cache (only has positions) first, as it copies the keyframe data that is moved to the scene builder below.
+                ctx.addCachedCurve(curve);
+
                 if (curve.tessellationMode == CurveTessellationMode::LinearSweptSphere)
                 {
-                    FALCOR_ASSERT(!curve.processedCurves.empty());
-                    curve.geometryID = ctx.builder.addProcessedCurve(curve.processedCurves[0]);
+                    curve.geometryID = ctx.builder.addProcessedCurve(std::move(curve.processedCurves[0]));
                 }
                 else
                 {
                     curve.geometryID = ctx.builder.addProcessedMesh(curve.processedMesh);
                 }
+                ctx.cachedCurves.back().geometryID = curve.geometryID;
             }
-
-            // Add curve vertex cache (only has positions) to scene builder.
-            for (auto& curve : ctx.curves) ctx.addCachedCurve(curve);
             ctx.builder.setCachedCurves(std::move(ctx.cachedCurves));
 
             timeReport.measure("Process curves");
@@ -1251,8 +1270,10 @@ namespace Falcor
             // Add instances to scene builder.
             for (const auto& instance : ctx.curveInstances)
             {
-                auto nodeId = ctx.builder.addNode(makeNode(instance.name, instance.xform, float4x4(1.f), instance.parentID));
                 const auto& curve = ctx.getCurve(instance.prim);
+                if (curve.geometryID == Curve::kInvalidID) continue;
+
+                auto nodeId = ctx.builder.addNode(makeNode(instance.name, instance.xform, float4x4(1.f), instance.parentID));
 
                 if (curve.tessellationMode == CurveTessellationMode::LinearSweptSphere)
                 {
@@ -1566,7 +1587,7 @@ namespace Falcor
         return true;
     }
 
-    bool ImporterContext::createPointInstanceKeyframes(const UsdGeomPointInstancer& instancer, std::vector<std::vector<Animation::Keyframe>>& keyframes)
+    bool ImporterContext::createPointInstanceKeyframes(const UsdGeomPointInstancer& instancer, std::vector<Animation::Keyframe>& keyframes, size_t& keyframeCount)
     {
         logDebug("Creating PointInstancer keyframes for '{}'.", instancer.GetPath().GetString());
 
@@ -1595,9 +1616,10 @@ namespace Falcor
 
         // instXforms is a vector of length equal to the number of time codes.
         // Each element of the vector holds an array of size equal to the number of instances.
-        // We need to, in effect, transpose this layout when constructing the vector of Animations.
-        keyframes.resize(instXforms[0].size());
+        // We need to, in effect, transpose this layout to store one track of keyframes per instance.
         FALCOR_ASSERT(instXforms.size() == times.size());
+        keyframeCount = times.size();
+        keyframes.resize(instXforms[0].size() * keyframeCount);
 
         // For each time sample
         for (uint32_t i = 0; i < instXforms.size(); ++i)
@@ -1605,17 +1627,23 @@ namespace Falcor
             const auto& matrices = instXforms[i];
             double time = times[i];
 
+            if (matrices.size() * keyframeCount != keyframes.size())
+            {
+                logError("Point instancer '{}' has varying instance counts over time. Ignoring animation.", instancer.GetPath().GetString());
+                keyframes.clear();
+                return false;
+            }
+
             // For each instance
             for (uint32_t j = 0; j < matrices.size(); ++j)
             {
                 const auto& matrix = matrices[j];
                 float4x4 glmMat = toGlm(matrix);
-                Animation::Keyframe keyframe;
+                Animation::Keyframe& keyframe = keyframes[j * keyframeCount + i];
                 float3 skew;
                 float4 persp;
                 glm::decompose(glmMat, keyframe.scaling, keyframe.rotation, keyframe.translation, skew, persp);
                 keyframe.time = time / timeCodesPerSecond;
-                keyframes[j].push_back(keyframe);
             }
         }
 
@@ -2040,14 +2068,24 @@ namespace Falcor
         VtIntArray protoIndices;
         protoIndicesAttr.Get(&protoIndices, UsdTimeCode::EarliestTime());
 
-        std::vector<std::vector<Animation::Keyframe>> keyframes;
+        for (int protoIndex : protoIndices)
+        {
+            if (protoIndex < 0 || (size_t)protoIndex >= protoPrims.size())
+            {
+                logError("Point instancer '{}' references prototype index {} which is out of range. Ignoring prim.", primName, protoIndex);
+                return;
+            }
+        }
+
+        std::vector<Animation::Keyframe> keyframes;
+        size_t keyframeCount = 0;
         VtMatrix4dArray instXforms;
 
-        if (createPointInstanceKeyframes(instancer, keyframes))
+        if (createPointInstanceKeyframes(instancer, keyframes, keyframeCount))
         {
-            if (protoIndices.size() != keyframes.size())
+            if (protoIndices.size() * keyframeCount != keyframes.size())
             {
-                logError("Point instancer '{}' has {} prototype indices but {} sampled transforms.", primName, protoIndices.size(), keyframes.size());
+                logError("Point instancer '{}' has {} prototype indices but {} sampled transforms.", primName, protoIndices.size(), keyframes.size() / keyframeCount);
                 return;
             }
         }
@@ -2067,7 +2105,35 @@ namespace Falcor
             }
         }
 
-        // Create instances from the prototypes.
+        // Top-level instancers of static prototypes without nested instances are kept in packed form.
+        // Their prototypes are flattened when the instances are added to the scene builder.
+        auto isFlatPrototype = [this](const UsdPrim& protoPrim)
+        {
+            const PrototypeGeom& protoGeom = getPrototypeGeom(protoPrim);
+            return protoGeom.animations.empty() && protoGeom.prototypeInstances.empty();
+        };
+
+        if (!proto && std::all_of(protoPrims.begin(), protoPrims.end(), isFlatPrototype))
+        {
+            PointInstancer pointInstancer;
+            pointInstancer.name = primName;
+            pointInstancer.parentID = nodeStack.back();
+            pointInstancer.protoPrims = std::move(protoPrims);
+            pointInstancer.protoIndices.assign(protoIndices.begin(), protoIndices.end());
+            if (keyframes.size() > 0)
+            {
+                pointInstancer.keyframes = std::move(keyframes);
+            }
+            else
+            {
+                pointInstancer.xforms.resize(instXforms.size());
+                for (size_t i = 0; i < instXforms.size(); ++i) pointInstancer.xforms[i] = toGlm(instXforms[i]);
+            }
+            pointInstancers.push_back(std::move(pointInstancer));
+            return;
+        }
+
+        // Otherwise create individual instances from the prototypes.
         for (size_t i = 0; i < protoIndices.size(); ++i)
         {
             UsdPrim& protoPrim(protoPrims[protoIndices[i]]);
@@ -2075,7 +2141,8 @@ namespace Falcor
             PrototypeInstance protoInst = {instanceName, protoPrim};
             if (keyframes.size() > 0)
             {
-                protoInst.keyframes = std::move(keyframes[i]);
+                auto track = keyframes.begin() + i * keyframeCount;
+                protoInst.keyframes.assign(track, track + keyframeCount);
             }
             else
             {
@@ -71,6 +71,20 @@ namespace Falcor
         std::vector<Animation::Keyframe> keyframes;     ///< Keyframes for animated instance transformation, if any.
     };
 
+    /** Represents a point instancer in the scene whose instances are kept in packed form during import.
+        It is added to the scene builder as a single SceneBuilder::Instancer, without creating per-instance prototype instances.
+        The scene builder still creates a node and mesh instances per instance (see SceneBuilder::addInstancer()).
+    */
+    struct PointInstancer
+    {
+        std::string name;                                   ///< Instancer name.
+        uint32_t parentID = SceneBuilder::kInvalidNode;     ///< SceneBuilder parent node id.
+        std::vector<UsdPrim> protoPrims;                    ///< Prototype prims.
+        std::vector<uint32_t> protoIndices;                 ///< Prototype index per instance.
+        std::vector<float4x4> xforms;                       ///< Instance transforms, if not animated.
+        std::vector<Animation::Keyframe> keyframes;         ///< Keyframes of animated instance transforms, if any. Stored as one track per instance.
+    };
+
     /** Mesh processing task parameters
     */
     struct MeshProcessingTask
@@ -269,10 +283,10 @@ namespace Falcor
         // Create animation from time-sampled transforms on a prim, such as for rigid body animations.
         uint32_t createAnimation(const UsdGeomXformable& xformable);
 
-        // Initialize a vector of keyframes, one for each instance in a point instancer.
+        // Initialize the keyframes of all instances in a point instancer, stored as one track of keyframeCount keyframes per instance.
         // Returns false, and does not initialize keyframes, if the instance transforms are not animated.
         // Returns true otherwise.
-        bool createPointInstanceKeyframes(const UsdGeomPointInstancer& instancer, std::vector<std::vector<Animation::Keyframe>>& keyframes);
+        bool createPointInstanceKeyframes(const UsdGeomPointInstancer& instancer, std::vector<Animation::Keyframe>& keyframes, size_t& keyframeCount);
 
         // Transforms
 
@@ -335,6 +349,7 @@ namespace Falcor
         std::vector<MeshProcessingTask> meshTasks;                                                   ///< List of mesh processing tasks (non time-sampled, and first time-samples)
         std::vector<MeshProcessingTask> meshKeyframeTasks;                                           ///< List of processing tasks for time-sampled mesh vertex data
         std::vector<PrototypeInstance> prototypeInstances;                                           ///< List of prototype instances.
+        std::vector<PointInstancer> pointInstancers;                                                 ///< List of packed point instancers.
         std::unordered_map<UsdObject, size_t, UsdObjHash> geomMap;                                   ///< Map from prim to mesh.
         std::unordered_map<UsdObject, size_t, UsdObjHash> prototypeGeomMap;                          ///< Map from prim to prototype mesh.
         std::vector<Skeleton> skeletons;                                                             ///< List of skeletons. One per SkelRoot prim.
@@ -41,6 +41,8 @@
 #pragma warning(pop)
 
 #include "Utils.h"
+#include "PreviewSurfaceTexels.h"
+#include "Utils/CryptoUtils.h"
 
 using namespace pxr;
 
@@ -48,14 +50,65 @@ namespace Falcor
 {
     namespace
     {
-        const char kSpecTransShaderFile[]("Scene/Importers/USDImporter/CreateSpecularTransmissionTexture.cs.slang");
-        const char kSpecTransShaderEntry[]("createSpecularTransmissionTexture");
+        template<typename T>
+        void hashValue(SHA1& sha1, const T& value)
+        {
+            sha1.update(&value, sizeof(T));
+        }
+
+        void hashString(SHA1& sha1, const std::string& str)
+        {
+            sha1.update(str.data(), str.size());
+        }
+
+        /** Hash a conversion input. For textured inputs, the identity of the source image (path, size and modification time)
+            is hashed instead of its content, so that cached conversions can be found without loading the image.
+        */
+        void hashInput(SHA1& sha1, const std::filesystem::path& path, bool srgb, TextureChannelFlags channels, const float4& uniformValue)
+        {
+            if (path.empty())
+            {
+                hashValue(sha1, uniformValue);
+                return;
+            }
+
+            std::error_code ec;
+            std::string pathString = std::filesystem::absolute(path, ec).string();
+            uint64_t fileSize = std::filesystem::file_size(path, ec);
+            int64_t writeTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+
+            hashString(sha1, pathString);
+            hashValue(sha1, fileSize);
+            hashValue(sha1, writeTime);
+            hashValue(sha1, srgb);
+            hashValue(sha1, channels);
+        }
+
+        /** Load an image for conversion on the CPU.
+            \return The image, or nullptr if it could not be loaded or has a format that is not supported by BitmapReader.
+        */
+        Bitmap::UniqueConstPtr loadImage(const std::filesystem::path& path)
+        {
+            if (path.empty()) return nullptr;
 
-        const char kPackAlphaShaderFile[]("Scene/Importers/USDImporter/PackBaseColorAlpha.cs.slang");
-        const char kPackAlphaShaderEntry[]("packBaseColorAlpha");
+            Bitmap::UniqueConstPtr pBitmap(Bitmap::createFromFile(path, false));
+            if (pBitmap && !BitmapReader::isSupportedFormat(pBitmap->getFormat()))
+            {
+                logWarning("Image '{}' has format '{}', which is not supported for texture conversion.", path, to_string(pBitmap->getFormat()));
+                return nullptr;
+            }
+            return pBitmap;
+        }
+
+        bool readCachedTexels(const SHA1::MD& key, uint2& resolution, std::vector<uint8_t>& data)
+        {
+            return PreviewSurfaceTexelCache::isEnabled() && PreviewSurfaceTexelCache::read(key, resolution, data);
+        }
 
-        const char kSpecularShaderFile[]("Scene/Importers/USDImporter/CreateSpecularTexture.cs.slang");
-        const char kSpecularShaderEntry[]("createSpecularTexture");
+        void writeCachedTexels(const SHA1::MD& key, uint2 resolution, const std::vector<uint8_t>& data)
+        {
+            if (PreviewSurfaceTexelCache::isEnabled()) PreviewSurfaceTexelCache::write(key, resolution, data);
+        }
 
         inline int32_t getChannelIndex(TextureChannelFlags flags)
         {
@@ -323,18 +376,19 @@ namespace Falcor
                 }
             }
 
-            // Create the texture by first reading the image (which is relatively slow) outside of the mutex,
-            // and then creating the texture itself inside it.
-            Bitmap::UniqueConstPtr pBitmap(Bitmap::createFromFile(filename, false));
-            if (pBitmap)
+            // Only record the image here. It is loaded on demand, as images that are only used as input to a
+            // cached conversion never need to be loaded at all.
+            std::filesystem::path fullPath;
+            if (findFileInDataDirectories(filename, fullPath))
             {
-                ResourceFormat format = loadSRGB ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
-                {
-                    std::scoped_lock lock(mMutex);
-                    ret.pTexture = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), format, 1, Texture::kMaxPossible, pBitmap->getData());
-                }
+                ret.path = fullPath;
+                ret.srgb = loadSRGB;
+            }
+            else
+            {
+                // The fallback value will be used.
+                logWarning("Can't find image file '{}' referenced by UsdUVTexture '{}'.", filename, prim.GetName().GetString());
             }
-            // Else, a warning will have been emitted by Bitmap::createFromFile(), and the fallback value will be used.
         }
         else
         {
@@ -385,130 +439,142 @@ namespace Falcor
         return ret;
     }
 
-    PreviewSurfaceConverter::PreviewSurfaceConverter()
+    Texture::SharedPtr PreviewSurfaceConverter::createTexture(const ConvertedInput& input)
     {
-        mpSpecTransPass = ComputePass::create(kSpecTransShaderFile, kSpecTransShaderEntry);
+        // Create the texture by first reading the image (which is relatively slow) outside of the mutex,
+        // and then creating the texture itself inside it.
+        Bitmap::UniqueConstPtr pBitmap(Bitmap::createFromFile(input.path, false));
+        if (!pBitmap) return nullptr;
 
-        mpPackAlphaPass = ComputePass::create(kPackAlphaShaderFile, kPackAlphaShaderEntry);
-
-        mpSpecularPass = ComputePass::create(kSpecularShaderFile, kSpecularShaderEntry);
-
-        Sampler::Desc samplerDesc;
-        samplerDesc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Point);
-        samplerDesc.setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp);
-
-        mpSampler = Sampler::create(samplerDesc);
+        ResourceFormat format = input.srgb ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+        std::scoped_lock lock(mMutex);
+        return Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), format, 1, Texture::kMaxPossible, pBitmap->getData());
     }
 
-    // Convert textured opacity to textured specular transparency.
-    Texture::SharedPtr PreviewSurfaceConverter::createSpecularTransmissionTexture(ConvertedInput& opacity, RenderContext* pRenderContext)
+    Texture::SharedPtr PreviewSurfaceConverter::createTexture(uint2 resolution, ResourceFormat format, const std::vector<uint8_t>& data)
     {
+        FALCOR_ASSERT(data.size() == (size_t)resolution.x * resolution.y * 4);
         std::scoped_lock lock(mMutex);
+        return Texture::create2D(resolution.x, resolution.y, format, 1, Texture::kMaxPossible, data.data());
+    }
 
+    // Convert textured opacity to textured specular transparency.
+    Texture::SharedPtr PreviewSurfaceConverter::createSpecularTransmissionTexture(const ConvertedInput& opacity)
+    {
         if (popcount((uint32_t)opacity.channels) > 1)
         {
             logWarning("Cannot create transmission texture; opacity texture provides more than one channel of data.");
             return nullptr;
         }
 
-        uint2 resolution(opacity.pTexture->getWidth(), opacity.pTexture->getHeight());
-        Texture::SharedPtr pTexture = Texture::create2D(resolution.x, resolution.y, ResourceFormat::RGBA8Unorm, 1, Texture::kMaxPossible, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess | Resource::BindFlags::RenderTarget);
-
-        mpSpecTransPass["CB"]["outDim"] = resolution;
-        mpSpecTransPass["CB"]["opacityChannel"] = getChannelIndex(opacity.channels);
-        mpSpecTransPass["opacityTexture"] = opacity.pTexture;
-        mpSpecTransPass["outputTexture"] = pTexture;
+        SHA1 sha1;
+        hashString(sha1, "SpecularTransmission");
+        hashInput(sha1, opacity.path, opacity.srgb, opacity.channels, opacity.uniformValue);
+        SHA1::MD key = sha1.final();
 
-        mpSpecTransPass->execute(pRenderContext, resolution.x, resolution.y);
+        uint2 resolution;
+        std::vector<uint8_t> data;
+        if (!readCachedTexels(key, resolution, data))
+        {
+            Bitmap::UniqueConstPtr pOpacity = loadImage(opacity.path);
+            if (!pOpacity) return nullptr;
 
-        pTexture->generateMips(pRenderContext);
+            BitmapReader opacityReader(*pOpacity, opacity.srgb);
+            data = PreviewSurfaceTexels::createSpecularTransmission({ &opacityReader, getChannelIndex(opacity.channels), opacity.uniformValue }, resolution);
+            writeCachedTexels(key, resolution, data);
+        }
 
-        return pTexture;
+        return createTexture(resolution, ResourceFormat::RGBA8Unorm, data);
     }
 
     // Combine base color and alpha, one or both of which may be textured, into a single texture.
     // If both are textured, they may be of different resolutions.
     // This is only performed when a material makes use of cutout opacity.
-    Texture::SharedPtr PreviewSurfaceConverter::packBaseColorAlpha(ConvertedInput& baseColor, ConvertedInput& opacity, RenderContext* pRenderContext)
+    Texture::SharedPtr PreviewSurfaceConverter::packBaseColorAlpha(const ConvertedInput& baseColor, const ConvertedInput& opacity)
     {
-        std::scoped_lock lock(mMutex);
-
-        if (opacity.pTexture && popcount((uint32_t)opacity.channels) > 1)
+        if (opacity.isTextured() && popcount((uint32_t)opacity.channels) > 1)
         {
             logWarning("Cannot set alpha channel; opacity texture provides more than one channel.");
             return nullptr;
         }
 
-        // Set output resolution to the maxium of the input dimensions
-        uint32_t width  = std::max<uint32_t>((opacity.pTexture ? opacity.pTexture->getWidth() : 0), (baseColor.pTexture ? baseColor.pTexture->getWidth() : 0));
-        uint32_t height = std::max<uint32_t>((opacity.pTexture ? opacity.pTexture->getHeight() : 0), (baseColor.pTexture ? baseColor.pTexture->getHeight() : 0));
-        uint2 resolution(width, height);
-
-        // sRGB format textures can't be bound as UAVs. Render to an RGBA32Float intermediate texture, and then blit to RGBA8UnormSrgb to preserve precision near zero.
-        Texture::SharedPtr pTexture = Texture::create2D(resolution.x, resolution.y, ResourceFormat::RGBA32Float, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+        SHA1 sha1;
+        hashString(sha1, "PackBaseColorAlpha");
+        hashInput(sha1, baseColor.path, baseColor.srgb, baseColor.channels, baseColor.uniformValue);
+        hashInput(sha1, opacity.path, opacity.srgb, opacity.channels, opacity.uniformValue);
+        SHA1::MD key = sha1.final();
 
-        mpPackAlphaPass["CB"]["opacityChannel"] = opacity.pTexture ? getChannelIndex(opacity.channels) : -1;
-        mpPackAlphaPass["CB"]["opacityValue"] = opacity.uniformValue.r;
-        mpPackAlphaPass["CB"]["baseColorTextureValid"] = baseColor.pTexture ? 1 : 0;
-        mpPackAlphaPass["CB"]["baseColorValue"] = baseColor.uniformValue;
-        mpPackAlphaPass["CB"]["outDim"] = resolution;
-        mpPackAlphaPass["opacityTexture"] = opacity.pTexture;
-        mpPackAlphaPass["baseColorTexture"] = baseColor.pTexture;
-        mpPackAlphaPass["sampler"] = mpSampler;
-        mpPackAlphaPass["outputTexture"] = pTexture;
-
-        mpPackAlphaPass->execute(pRenderContext, resolution.x, resolution.y);
+        uint2 resolution;
+        std::vector<uint8_t> data;
+        if (!readCachedTexels(key, resolution, data))
+        {
+            // Inputs with images that fail to load use their uniform value instead.
+            Bitmap::UniqueConstPtr pBaseColor = loadImage(baseColor.path);
+            Bitmap::UniqueConstPtr pOpacity = loadImage(opacity.path);
+            if (!pBaseColor && !pOpacity) return nullptr;
 
-        // Create the output mipmapped sRGB texture
-        Texture::SharedPtr pFinal = Texture::create2D(resolution.x, resolution.y, ResourceFormat::RGBA8UnormSrgb, 1, Texture::kMaxPossible, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::RenderTarget);
+            std::optional<BitmapReader> baseColorReader;
+            std::optional<BitmapReader> opacityReader;
+            if (pBaseColor) baseColorReader.emplace(*pBaseColor, baseColor.srgb);
+            if (pOpacity) opacityReader.emplace(*pOpacity, opacity.srgb);
 
-        // Blit the intermediate texture to the output texture to perform format conversion
-        pRenderContext->blit(pTexture->getSRV(), pFinal->getRTV());
+            data = PreviewSurfaceTexels::packBaseColorAlpha(
+                { baseColorReader ? &*baseColorReader : nullptr, 0, baseColor.uniformValue },
+                { opacityReader ? &*opacityReader : nullptr, getChannelIndex(opacity.channels), opacity.uniformValue },
+                resolution);
 
-        pFinal->generateMips(pRenderContext);
+            // Only cache the result if all images could be loaded.
+            if ((pBaseColor || !baseColor.isTextured()) && (pOpacity || !opacity.isTextured())) writeCachedTexels(key, resolution, data);
+        }
 
-        return pFinal;
+        return createTexture(resolution, ResourceFormat::RGBA8UnormSrgb, data);
     }
 
     // Combine roughness and metallic parameters, one or both of which are textured, into a specular/ORM texture.
     // If both are textured, they may be of different resolutions.
-    Texture::SharedPtr PreviewSurfaceConverter::createSpecularTexture(ConvertedInput& roughness, ConvertedInput& metallic, RenderContext* pRenderContext)
+    Texture::SharedPtr PreviewSurfaceConverter::createSpecularTexture(const ConvertedInput& roughness, const ConvertedInput& metallic)
     {
-        std::scoped_lock lock(mMutex);
-
-        if (roughness.pTexture && popcount((uint32_t)roughness.channels) > 1)
+        if (roughness.isTextured() && popcount((uint32_t)roughness.channels) > 1)
         {
             logWarning("Cannot create specular texture; roughness texture provides more than one channel.");
             return nullptr;
         }
-        if (metallic.pTexture && popcount((uint32_t)metallic.channels) > 1)
+        if (metallic.isTextured() && popcount((uint32_t)metallic.channels) > 1)
         {
             logWarning("Cannot create specular texture; metallic texture provides more than one channel.");
             return nullptr;
         }
 
-        // Set output resolution to the maxium of the input dimensions
-        uint32_t width  = std::max<uint32_t>((roughness.pTexture ? roughness.pTexture->getWidth() : 0), (metallic.pTexture ? metallic.pTexture->getWidth() : 0));
-        uint32_t height = std::max<uint32_t>((roughness.pTexture ? roughness.pTexture->getHeight() : 0), (metallic.pTexture ? metallic.pTexture->getHeight() : 0));
-        uint2 resolution(width, height);
+        SHA1 sha1;
+        hashString(sha1, "Specular");
+        hashInput(sha1, roughness.path, roughness.srgb, roughness.channels, roughness.uniformValue);
+        hashInput(sha1, metallic.path, metallic.srgb, metallic.channels, metallic.uniformValue);
+        SHA1::MD key = sha1.final();
 
-        Texture::SharedPtr pTexture = Texture::create2D(width, height, ResourceFormat::RGBA8Unorm, 1, Texture::kMaxPossible, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess | Resource::BindFlags::RenderTarget);
+        uint2 resolution;
+        std::vector<uint8_t> data;
+        if (!readCachedTexels(key, resolution, data))
+        {
+            // Inputs with images that fail to load use their uniform value instead.
+            Bitmap::UniqueConstPtr pRoughness = loadImage(roughness.path);
+            Bitmap::UniqueConstPtr pMetallic = loadImage(metallic.path);
+            if (!pRoughness && !pMetallic) return nullptr;
 
-        mpSpecularPass["CB"]["roughnessChannel"] = roughness.pTexture ? getChannelIndex(roughness.channels) : -1;
-        mpSpecularPass["CB"]["roughnessValue"] = roughness.uniformValue.r;
-        mpSpecularPass["CB"]["metallicChannel"] = metallic.pTexture ? getChannelIndex(metallic.channels) : -1;
-        mpSpecularPass["CB"]["metallicValue"] = metallic.uniformValue.r;
-        mpSpecularPass["CB"]["outDim"] = resolution;
-        mpSpecularPass["metallicTexture"] = metallic.pTexture;
-        mpSpecularPass["roughnessTexture"] = roughness.pTexture;
-        mpSpecularPass["sampler"] = mpSampler;
-        mpSpecularPass["outputTexture"] = pTexture;
+            std::optional<BitmapReader> roughnessReader;
+            std::optional<BitmapReader> metallicReader;
+            if (pRoughness) roughnessReader.emplace(*pRoughness, roughness.srgb);
+            if (pMetallic) metallicReader.emplace(*pMetallic, metallic.srgb);
 
-        mpSpecularPass->execute(pRenderContext, resolution.x, resolution.y);
+            data = PreviewSurfaceTexels::createSpecular(
+                { roughnessReader ? &*roughnessReader : nullptr, getChannelIndex(roughness.channels), roughness.uniformValue },
+                { metallicReader ? &*metallicReader : nullptr, getChannelIndex(metallic.channels), metallic.uniformValue },
+                resolution);
 
-        pTexture->generateMips(pRenderContext);
+            // Only cache the result if all images could be loaded.
+            if ((pRoughness || !roughness.isTextured()) && (pMetallic || !metallic.isTextured())) writeCachedTexels(key, resolution, data);
+        }
 
-        return pTexture;
+        return createTexture(resolution, ResourceFormat::RGBA8Unorm, data);
     }
 
     Material::SharedPtr PreviewSurfaceConverter::convert(const UsdShadeMaterial& material, const std::string& primName, RenderContext* pRenderContext)
@@ -598,9 +664,10 @@ namespace Falcor
             {
                 // Get color value(s), assume that textures are sRGB by default.
                 ConvertedInput emissive = convertColor(input, true);
-                if (emissive.pTexture)
+                Texture::SharedPtr pEmissiveTexture = emissive.isTextured() ? createTexture(emissive) : nullptr;
+                if (pEmissiveTexture)
                 {
-                    pMaterial->setEmissiveTexture(emissive.pTexture);
+                    pMaterial->setEmissiveTexture(pEmissiveTexture);
                 }
                 else
                 {
@@ -697,9 +764,10 @@ namespace Falcor
                 else if (typeName == SdfValueTypeNames->Asset)
                 {
                     ConvertedInput norm = convertTexture(input);
-                    if (norm.pTexture)
+                    Texture::SharedPtr pNormalMap = norm.isTextured() ? createTexture(norm) : nullptr;
+                    if (pNormalMap)
                     {
-                        pMaterial->setNormalMap(norm.pTexture);
+                        pMaterial->setNormalMap(pNormalMap);
                     }
                 }
                 else
@@ -714,9 +782,10 @@ namespace Falcor
                 {
                     logWarning("Falcor does not support uniform displacement.");
                 }
-                else if (disp.pTexture)
+                else if (disp.isTextured())
                 {
-                    pMaterial->setDisplacementMap(disp.pTexture);
+                    Texture::SharedPtr pDisplacementMap = createTexture(disp);
+                    if (pDisplacementMap) pMaterial->setDisplacementMap(pDisplacementMap);
                 }
             }
             else if (inputName == "occlusion")
@@ -732,9 +801,9 @@ namespace Falcor
         pMaterial->setIndexOfRefraction(ior);
 
         // If there is either a roughness or metallic texture, convert texture(s) and constant (if any) to an ORM texture.
-        if (metallic.pTexture || roughness.pTexture)
+        Texture::SharedPtr pSpecularTex = (metallic.isTextured() || roughness.isTextured()) ? createSpecularTexture(roughness, metallic) : nullptr;
+        if (pSpecularTex)
         {
-            Texture::SharedPtr pSpecularTex = createSpecularTexture(roughness, metallic, pRenderContext);
             pMaterial->setSpecularTexture(pSpecularTex);
         }
         else
@@ -742,16 +811,19 @@ namespace Falcor
             pMaterial->setSpecularParams(float4(0.f, roughness.uniformValue.r, metallic.uniformValue.r, 1.f));
         }
 
-        if (opacity.uniformValue.r < 1.f || opacity.pTexture)
+        Texture::SharedPtr pBaseColorTex;
+        bool packedBaseColor = false;
+        if (opacity.uniformValue.r < 1.f || opacity.isTextured())
         {
             // Handle non-unit opacity
             if (opacityThreshold > 0.f)
             {
                 // Opacity encodes cutout values
                 // Pack opacity into the alpha channel
-                if (baseColor.pTexture|| opacity.pTexture)
+                if (baseColor.isTextured() || opacity.isTextured())
                 {
-                    baseColor.pTexture = packBaseColorAlpha(baseColor, opacity, pRenderContext);
+                    pBaseColorTex = packBaseColorAlpha(baseColor, opacity);
+                    packedBaseColor = true;
                 }
                 else
                 {
@@ -759,22 +831,33 @@ namespace Falcor
                 }
                 pMaterial->setAlphaThreshold(opacityThreshold);
             }
-            else if (opacity.pTexture)
+            else if (opacity.isTextured())
             {
                 // Opacity encodes (1 - specular-transmission)
                 // Create a greyscale specular transmission color texture using (1-opacity), as a slightly hacky means of supporting textured specular transmission.
-                Texture::SharedPtr pTransmissionTexture = createSpecularTransmissionTexture(opacity, pRenderContext);
-                pMaterial->setTransmissionTexture(pTransmissionTexture);
-                pMaterial->setSpecularTransmission(1.f);
+                Texture::SharedPtr pTransmissionTexture = createSpecularTransmissionTexture(opacity);
+                if (pTransmissionTexture)
+                {
+                    pMaterial->setTransmissionTexture(pTransmissionTexture);
+                    pMaterial->setSpecularTransmission(1.f);
+                }
+                else
+                {
+                    pMaterial->setSpecularTransmission(1.f - opacity.uniformValue.r);
+                }
             }
             else
             {
                 pMaterial->setSpecularTransmission(1.f - opacity.uniformValue.r);
             }
         }
-        if (baseColor.pTexture)
+        if (!packedBaseColor && baseColor.isTextured())
+        {
+            pBaseColorTex = createTexture(baseColor);
+        }
+        if (pBaseColorTex)
         {
-            pMaterial->setBaseColorTexture(baseColor.pTexture);
+            pMaterial->setBaseColorTexture(pBaseColorTex);
         }
         else
         {
@@ -35,13 +35,18 @@
 namespace Falcor
 {
     /** Class to create Falcor::Material instances from UsdPreviewSurfaces.
+
+        Materials may be converted concurrently from multiple threads. Textures that need to be combined or converted
+        (specular, specular transmission and base color/alpha) are processed on the CPU by the converting thread, and the
+        results are cached on disk, keyed by a hash of the source images and conversion parameters (see PreviewSurfaceTexelCache).
+        Only the creation of GPU textures is serialized.
     */
     class PreviewSurfaceConverter
     {
     public:
-        /** Create a new converter, compiling required compute shaders.
+        /** Create a new converter.
         */
-        PreviewSurfaceConverter();
+        PreviewSurfaceConverter() = default;
 
         /** Create a Falcor material from a material containing a UsdPreviewSurface.
             \param material UsdShadeMaterial that contains the UsdPreviewSurface to be converted
@@ -65,14 +70,25 @@ namespace Falcor
                 uniformValue(v)
             {
             }
-            Texture::SharedPtr pTexture;
+            bool isTextured() const { return !path.empty(); }
+
+            std::filesystem::path path;                         ///< Path of the source image. Empty if the input is not textured. The image is loaded on demand.
+            bool srgb = false;                                  ///< True if the source image stores sRGB-encoded color.
             TextureChannelFlags channels = TextureChannelFlags::None;
             float4 uniformValue;
         };
 
-        Texture::SharedPtr createSpecularTransmissionTexture(ConvertedInput& opacity, RenderContext* pRenderContext);
-        Texture::SharedPtr packBaseColorAlpha(ConvertedInput& baseColor, ConvertedInput& opacity, RenderContext* pRenderContext);
-        Texture::SharedPtr createSpecularTexture(ConvertedInput& roughness, ConvertedInput& metallic, RenderContext* pRenderContext);
+        Texture::SharedPtr createSpecularTransmissionTexture(const ConvertedInput& opacity);
+        Texture::SharedPtr packBaseColorAlpha(const ConvertedInput& baseColor, const ConvertedInput& opacity);
+        Texture::SharedPtr createSpecularTexture(const ConvertedInput& roughness, const ConvertedInput& metallic);
+
+        /** Create a texture from the source image of a textured input.
+        */
+        Texture::SharedPtr createTexture(const ConvertedInput& input);
+
+        /** Create a mipmapped RGBA8 texture from CPU-side texel data.
+        */
+        Texture::SharedPtr createTexture(uint2 resolution, ResourceFormat format, const std::vector<uint8_t>& data);
 
         ConvertedInput convertTexture(const pxr::UsdShadeInput& input, bool assumeSrgb = false);
         ConvertedInput convertFloat(const pxr::UsdShadeInput& input);
@@ -81,15 +97,9 @@ namespace Falcor
         StandardMaterial::SharedPtr getCachedMaterial(const pxr::UsdShadeShader& shader);
         void cacheMaterial(const UsdShadeShader& shader, StandardMaterial::SharedPtr pMaterial);
 
-        ComputePass::SharedPtr mpSpecTransPass;                 //< Pass to convert opacity to transparency
-        ComputePass::SharedPtr mpPackAlphaPass;                 //< Pass to convert separate RGB and A to RGBA
-        ComputePass::SharedPtr mpSpecularPass;                  //< Pass to create ORM texture
-
-        Sampler::SharedPtr mpSampler;                           //< Bilinear clamp sampler
-
         std::unordered_map<pxr::UsdPrim, StandardMaterial::SharedPtr, UsdObjHash> mMaterialCache;    //< Map from UsdPreviewSurface-defining UsdShadeShader to Falcor material instance. An entry with a null instance indicates in-progress conversion.
 
-        std::mutex mMutex;                                      //< Mutex to ensure serial invocation of calls that are not thread safe (e.g., texture creation and compute program execution).
+        std::mutex mMutex;                                      //< Mutex to ensure serial invocation of calls that are not thread safe (e.g., texture creation).
         std::mutex mCacheMutex;                                 //< Mutex controlling access to the material cache.
         std::condition_variable mCacheUpdated;                  //< Condition variable for threads waiting on cache update.
     };
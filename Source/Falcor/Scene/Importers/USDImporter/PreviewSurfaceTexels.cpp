@@ -0,0 +1,266 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "PreviewSurfaceTexels.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Color/ColorHelpers.slang"
+
+#include <fstream>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Texture cache directory (subdirectory in the application data directory).
+        */
+        const std::string kTextureCacheDirectory = "NVIDIA/Falcor/USDTextureCache";
+        const uint32_t kTextureCacheMagic = 0x58545355; // "USTX"
+        const uint32_t kTextureCacheVersion = 1;
+
+        /** Environment variable to disable the cache by setting it to 0.
+        */
+        const std::string kTextureCacheEnvVar = "FALCOR_USD_TEXTURE_CACHE";
+
+        struct TextureCacheHeader
+        {
+            uint32_t magic = kTextureCacheMagic;
+            uint32_t version = kTextureCacheVersion;
+            uint32_t width = 0;
+            uint32_t height = 0;
+        };
+
+        std::atomic<bool>& getEnabledFlag()
+        {
+            static std::atomic<bool> sEnabled{ []() { std::string value; return !(getEnvironmentVariable(kTextureCacheEnvVar, value) && value == "0"); }() };
+            return sEnabled;
+        }
+
+        uint2 getResolution(const PreviewSurfaceTexels::Input& a, const PreviewSurfaceTexels::Input& b)
+        {
+            return glm::max(a.pReader ? a.pReader->getResolution() : uint2(0), b.pReader ? b.pReader->getResolution() : uint2(0));
+        }
+    }
+
+    BitmapReader::BitmapReader(const Bitmap& bitmap, bool srgb)
+        : mBitmap(bitmap)
+        , mTexelSize(getFormatBytesPerBlock(bitmap.getFormat()))
+        , mSrgb(srgb && isSrgbFormat(linearToSrgbFormat(bitmap.getFormat())))
+    {
+        FALCOR_ASSERT(isSupportedFormat(bitmap.getFormat()));
+    }
+
+    bool BitmapReader::isSupportedFormat(ResourceFormat format)
+    {
+        switch (format)
+        {
+        case ResourceFormat::RGBA32Float:
+        case ResourceFormat::RGB32Float:
+        case ResourceFormat::RGBA16Float:
+        case ResourceFormat::RGB16Float:
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRX8Unorm:
+        case ResourceFormat::R16Unorm:
+        case ResourceFormat::RG8Unorm:
+        case ResourceFormat::R8Unorm:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    float4 BitmapReader::load(uint32_t x, uint32_t y) const
+    {
+        const uint8_t* pTexel = mBitmap.getData() + (size_t)y * mBitmap.getRowPitch() + (size_t)x * mTexelSize;
+        const float* pFloat = reinterpret_cast<const float*>(pTexel);
+        const float16_t* pHalf = reinterpret_cast<const float16_t*>(pTexel);
+
+        float4 v(0.f, 0.f, 0.f, 1.f);
+        switch (mBitmap.getFormat())
+        {
+        case ResourceFormat::RGBA32Float:
+            v = float4(pFloat[0], pFloat[1], pFloat[2], pFloat[3]);
+            break;
+        case ResourceFormat::RGB32Float:
+            v = float4(pFloat[0], pFloat[1], pFloat[2], 1.f);
+            break;
+        case ResourceFormat::RGBA16Float:
+            v = float4((float)pHalf[0], (float)pHalf[1], (float)pHalf[2], (float)pHalf[3]);
+            break;
+        case ResourceFormat::RGB16Float:
+            v = float4((float)pHalf[0], (float)pHalf[1], (float)pHalf[2], 1.f);
+            break;
+        case ResourceFormat::BGRA8Unorm:
+            v = float4(pTexel[2], pTexel[1], pTexel[0], pTexel[3]) / 255.f;
+            break;
+        case ResourceFormat::BGRX8Unorm:
+            v = float4(pTexel[2] / 255.f, pTexel[1] / 255.f, pTexel[0] / 255.f, 1.f);
+            break;
+        case ResourceFormat::R16Unorm:
+            v.r = *reinterpret_cast<const uint16_t*>(pTexel) / 65535.f;
+            break;
+        case ResourceFormat::RG8Unorm:
+            v.r = pTexel[0] / 255.f;
+            v.g = pTexel[1] / 255.f;
+            break;
+        case ResourceFormat::R8Unorm:
+            v.r = pTexel[0] / 255.f;
+            break;
+        default:
+            FALCOR_UNREACHABLE();
+        }
+
+        if (mSrgb) v = float4(sRGBToLinear(float3(v.r, v.g, v.b)), v.a);
+        return v;
+    }
+
+    float4 BitmapReader::sample(uint2 pos, uint2 outDim) const
+    {
+        int2 maxCoord = int2(getResolution()) - 1;
+        float2 p = (float2(pos) + 0.5f) / float2(outDim) * float2(getResolution()) - 0.5f;
+        float2 p0(std::floor(p.x), std::floor(p.y));
+        float2 w = p - p0;
+
+        uint32_t x0 = (uint32_t)std::clamp((int)p0.x, 0, maxCoord.x);
+        uint32_t x1 = (uint32_t)std::clamp((int)p0.x + 1, 0, maxCoord.x);
+        uint32_t y0 = (uint32_t)std::clamp((int)p0.y, 0, maxCoord.y);
+        uint32_t y1 = (uint32_t)std::clamp((int)p0.y + 1, 0, maxCoord.y);
+
+        float4 top = glm::mix(load(x0, y0), load(x1, y0), w.x);
+        float4 bottom = glm::mix(load(x0, y1), load(x1, y1), w.x);
+        return glm::mix(top, bottom, w.y);
+    }
+
+    std::vector<uint8_t> PreviewSurfaceTexels::createSpecularTransmission(const Input& opacity, uint2& resolution)
+    {
+        resolution = getResolution(opacity, opacity);
+        return convertTexels(resolution, [&](uint2 pos)
+        {
+            float value = 1.f - opacity.sampleScalar(pos, resolution);
+            return float4(value, value, value, 1.f);
+        });
+    }
+
+    std::vector<uint8_t> PreviewSurfaceTexels::packBaseColorAlpha(const Input& baseColor, const Input& opacity, uint2& resolution)
+    {
+        // The output is sRGB encoded. Convert on the CPU at full precision, so no intermediate texture is needed to preserve precision near zero.
+        resolution = getResolution(baseColor, opacity);
+        return convertTexels(resolution, [&](uint2 pos)
+        {
+            float4 color = baseColor.sample(pos, resolution);
+            float alpha = opacity.sampleScalar(pos, resolution);
+            return float4(linearToSRGB(float3(color.r, color.g, color.b)), alpha);
+        });
+    }
+
+    std::vector<uint8_t> PreviewSurfaceTexels::createSpecular(const Input& roughness, const Input& metallic, uint2& resolution)
+    {
+        resolution = getResolution(roughness, metallic);
+        return convertTexels(resolution, [&](uint2 pos)
+        {
+            return float4(0.f, roughness.sampleScalar(pos, resolution), metallic.sampleScalar(pos, resolution), 1.f);
+        });
+    }
+
+    bool PreviewSurfaceTexelCache::read(const Key& key, uint2& resolution, std::vector<uint8_t>& data, const std::filesystem::path& directory)
+    {
+        auto cachePath = getCachePath(key, directory);
+        std::ifstream fs(cachePath, std::ios_base::binary);
+        if (!fs) return false;
+
+        TextureCacheHeader header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs || header.magic != kTextureCacheMagic || header.version != kTextureCacheVersion) return false;
+
+        resolution = uint2(header.width, header.height);
+        data.resize((size_t)header.width * header.height * 4);
+        fs.read(reinterpret_cast<char*>(data.data()), data.size());
+        if (!fs)
+        {
+            logWarning("Failed to read USD texture cache file '{}'.", cachePath);
+            return false;
+        }
+
+        logDebug("Loaded converted texture from USD texture cache file '{}'.", cachePath);
+        return true;
+    }
+
+    void PreviewSurfaceTexelCache::write(const Key& key, uint2 resolution, const std::vector<uint8_t>& data, const std::filesystem::path& directory)
+    {
+        FALCOR_ASSERT(data.size() == (size_t)resolution.x * resolution.y * 4);
+        auto cachePath = getCachePath(key, directory);
+
+        // Write to a temporary file first, so that other threads or processes never see a partially written file.
+        std::stringstream ss;
+        ss << cachePath.string() << "." << std::this_thread::get_id() << ".tmp";
+        std::filesystem::path tempPath = ss.str();
+
+        std::error_code ec;
+        std::filesystem::create_directories(cachePath.parent_path(), ec);
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            TextureCacheHeader header;
+            header.width = resolution.x;
+            header.height = resolution.y;
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!fs)
+            {
+                logWarning("Failed to write USD texture cache file '{}'.", tempPath);
+                fs.close();
+                std::filesystem::remove(tempPath, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec) std::filesystem::remove(tempPath, ec);
+    }
+
+    std::filesystem::path PreviewSurfaceTexelCache::getDefaultDirectory()
+    {
+        return getAppDataDirectory() / kTextureCacheDirectory;
+    }
+
+    void PreviewSurfaceTexelCache::setEnabled(bool enabled)
+    {
+        getEnabledFlag() = enabled;
+    }
+
+    bool PreviewSurfaceTexelCache::isEnabled()
+    {
+        return getEnabledFlag();
+    }
+
+    std::filesystem::path PreviewSurfaceTexelCache::getCachePath(const Key& key, const std::filesystem::path& directory)
+    {
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (auto c : key) ss << std::setw(2) << (int)c;
+        return (directory.empty() ? getDefaultDirectory() : directory) / ss.str();
+    }
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Image/Bitmap.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/NumericRange.h"
+
+#include <execution>
+#include <filesystem>
+
+namespace Falcor
+{
+    /** CPU-side reader returning the same texel values that a Texture2D<float4> created from the bitmap would return on the GPU.
+    */
+    class FALCOR_API BitmapReader
+    {
+    public:
+        /** Create a reader.
+            \param[in] bitmap Bitmap to read. Must have a supported format and outlive the reader.
+            \param[in] srgb True if the bitmap stores sRGB-encoded color. Only applies to formats that have an sRGB variant.
+        */
+        BitmapReader(const Bitmap& bitmap, bool srgb);
+
+        /** Check if a bitmap format can be read.
+        */
+        static bool isSupportedFormat(ResourceFormat format);
+
+        uint2 getResolution() const { return uint2(mBitmap.getWidth(), mBitmap.getHeight()); }
+
+        /** Load a texel, decoded to linear values.
+        */
+        float4 load(uint32_t x, uint32_t y) const;
+
+        /** Sample the image at the center of a pixel of an output image of the given resolution.
+            The output resolution is never smaller than the image resolution, so this is a bilinear lookup with clamp addressing.
+        */
+        float4 sample(uint2 pos, uint2 outDim) const;
+
+    private:
+        const Bitmap& mBitmap;
+        uint32_t mTexelSize;
+        bool mSrgb;
+    };
+
+    /** Conversions of UsdPreviewSurface inputs to RGBA8 texels, evaluated on the CPU.
+        Each input is either read from an image or given by a uniform value.
+        The output resolution is the maximum of the resolutions of the images.
+    */
+    class FALCOR_API PreviewSurfaceTexels
+    {
+    public:
+        struct Input
+        {
+            const BitmapReader* pReader = nullptr;      ///< Image to read, or nullptr to use the uniform value.
+            int32_t channel = 0;                        ///< Channel of the image to read for scalar inputs.
+            float4 uniformValue = float4(0.f, 0.f, 0.f, 1.f);
+
+            float4 sample(uint2 pos, uint2 outDim) const { return pReader ? pReader->sample(pos, outDim) : uniformValue; }
+            float sampleScalar(uint2 pos, uint2 outDim) const { return pReader ? pReader->sample(pos, outDim)[channel] : uniformValue.r; }
+        };
+
+        /** Convert opacity to specular transmission (1 - opacity) in the RGB channels.
+        */
+        static std::vector<uint8_t> createSpecularTransmission(const Input& opacity, uint2& resolution);
+
+        /** Pack linear base color into sRGB-encoded RGB and opacity into the alpha channel.
+        */
+        static std::vector<uint8_t> packBaseColorAlpha(const Input& baseColor, const Input& opacity, uint2& resolution);
+
+        /** Pack roughness into the green and metallic into the blue channel of a specular (ORM) texture.
+        */
+        static std::vector<uint8_t> createSpecular(const Input& roughness, const Input& metallic, uint2& resolution);
+
+        /** Evaluate a conversion function for all pixels of an RGBA8 image, processing rows in parallel.
+            The function returns values in [0,1] that are already encoded for the output format.
+        */
+        template<typename F>
+        static std::vector<uint8_t> convertTexels(uint2 resolution, F func)
+        {
+            std::vector<uint8_t> data((size_t)resolution.x * resolution.y * 4);
+
+            NumericRange<uint32_t> rows(0, resolution.y);
+            std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+            {
+                uint8_t* pRow = data.data() + (size_t)y * resolution.x * 4;
+                for (uint32_t x = 0; x < resolution.x; x++)
+                {
+                    float4 v = func(uint2(x, y));
+                    for (uint32_t c = 0; c < 4; c++) pRow[x * 4 + c] = (uint8_t)(std::clamp(v[c], 0.f, 1.f) * 255.f + 0.5f);
+                }
+            });
+
+            return data;
+        }
+    };
+
+    /** Disk cache for converted UsdPreviewSurface texels.
+        Cache entries are keyed by a hash of the source images and conversion parameters, computed by the caller.
+        Cache files are stored in the application data directory, unless another directory is passed to read() and write().
+        The cache is enabled by default. It can be disabled with setEnabled(), or by setting the environment variable
+        FALCOR_USD_TEXTURE_CACHE to 0.
+    */
+    class FALCOR_API PreviewSurfaceTexelCache
+    {
+    public:
+        using Key = SHA1::MD;
+
+        /** Read cached texels.
+            \param[in] key Cache key.
+            \param[out] resolution Resolution of the cached image.
+            \param[out] data RGBA8 texels.
+            \param[in] directory Cache directory. If empty, the default directory in the application data directory is used.
+            \return True if a valid cache entry was read.
+        */
+        static bool read(const Key& key, uint2& resolution, std::vector<uint8_t>& data, const std::filesystem::path& directory = {});
+
+        /** Write texels to the cache.
+            \param[in] key Cache key.
+            \param[in] resolution Image resolution.
+            \param[in] data RGBA8 texels.
+            \param[in] directory Cache directory. If empty, the default directory in the application data directory is used.
+        */
+        static void write(const Key& key, uint2 resolution, const std::vector<uint8_t>& data, const std::filesystem::path& directory = {});
+
+        /** Get the default cache directory in the application data directory.
+        */
+        static std::filesystem::path getDefaultDirectory();
+
+        /** Enable/disable the cache.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled.
+        */
+        static bool isEnabled();
+
+    private:
+        static std::filesystem::path getCachePath(const Key& key, const std::filesystem::path& directory);
+    };
+}
@@ -0,0 +1,96 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/AABB.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** Bounds of a set of instances, stored in an implicit binary tree so that the union can be refit when only some instances move.
+        The leaf of instance i is stored at index instanceCount + i. Each inner node n holds the union of its children 2n and 2n + 1,
+        so node 1 holds the bounds of all instances. This layout works for any instance count, not only powers of two.
+    */
+    class InstanceBoundsTree
+    {
+    public:
+        /** Build the tree.
+            \param[in] instanceCount Number of instances.
+            \param[in] getInstanceBounds Function returning the bounds of an instance given its index.
+        */
+        template<typename F>
+        void build(size_t instanceCount, F getInstanceBounds)
+        {
+            mNodes.assign(2 * instanceCount, AABB());
+            for (size_t i = 0; i < instanceCount; i++) mNodes[instanceCount + i] = getInstanceBounds((uint32_t)i);
+            for (size_t node = instanceCount > 0 ? instanceCount - 1 : 0; node > 0; node--)
+            {
+                mNodes[node] = mNodes[2 * node] | mNodes[2 * node + 1];
+            }
+        }
+
+        /** Update the bounds of some instances and refit the nodes on their paths to the root.
+            \param[in] instanceIDs Indices of the instances to update.
+            \param[in] getInstanceBounds Function returning the bounds of an instance given its index.
+        */
+        template<typename F>
+        void update(const std::vector<uint32_t>& instanceIDs, F getInstanceBounds)
+        {
+            const size_t instanceCount = getInstanceCount();
+            for (uint32_t instanceID : instanceIDs)
+            {
+                FALCOR_ASSERT(instanceID < instanceCount);
+                size_t node = instanceCount + instanceID;
+                mNodes[node] = getInstanceBounds(instanceID);
+
+                // Walk towards the root. Once a node is unchanged, its ancestors are too.
+                while (node > 1)
+                {
+                    node /= 2;
+                    AABB bounds = mNodes[2 * node] | mNodes[2 * node + 1];
+                    if (bounds == mNodes[node]) break;
+                    mNodes[node] = bounds;
+                }
+            }
+        }
+
+        /** Get the number of instances.
+        */
+        size_t getInstanceCount() const { return mNodes.size() / 2; }
+
+        /** Get the bounds of an instance.
+        */
+        const AABB& getInstanceBounds(uint32_t instanceID) const { return mNodes[getInstanceCount() + instanceID]; }
+
+        /** Get the union of the bounds of all instances. Returns an invalid AABB if there are no instances.
+        */
+        AABB getBounds() const { return mNodes.empty() ? AABB() : mNodes[1]; }
+
+    private:
+        std::vector<AABB> mNodes;   ///< Tree nodes. Index 0 is unused.
+    };
+}
@@ -29,7 +29,11 @@
 #include "LightCollection.h"
 #include "LightCollectionShared.slang"
 #include "Scene/Scene.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Color/ColorHelpers.slang"
 #include <sstream>
+#include <numeric>
+#include <execution>
 
 namespace Falcor
 {
@@ -43,6 +47,33 @@ namespace Falcor
         const char kBuildTriangleListFile[] = "Scene/Lights/BuildTriangleList.cs.slang";
         const char kUpdateTriangleVerticesFile[] = "Scene/Lights/UpdateTriangleVertices.cs.slang";
         const char kFinalizeIntegrationFile[] = "Scene/Lights/FinalizeIntegration.cs.slang";
+
+        const uint32_t kCPUBuildBlockSize = 4096;   ///< Number of triangles processed per task when building the triangle list on the CPU.
+
+        /** Computes the world-space geometry of an emissive triangle on the CPU.
+            This matches the computations in BuildTriangleList.cs.slang and UpdateTriangleVertices.cs.slang.
+        */
+        EmissiveTriangle computeEmissiveTriangle(const Scene::EmissiveMeshData& meshData, const glm::mat4& worldMat, bool isWorldFrontFaceCW, uint32_t triangleIndex)
+        {
+            EmissiveTriangle tri;
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                uint32_t vtxIdx = meshData.indices.empty() ? triangleIndex * 3 + j : meshData.indices[triangleIndex * 3 + j];
+                const PackedStaticVertexData& vertex = meshData.vertices[vtxIdx];
+                tri.posW[j] = float3(worldMat * float4(vertex.position, 1.f));
+                tri.texCoords[j] = vertex.texCrd;
+            }
+
+            // The length of the cross product is twice the triangle area in world space.
+            float3 N = glm::cross(tri.posW[1] - tri.posW[0], tri.posW[2] - tri.posW[0]);
+            tri.area = 0.5f * glm::length(N);
+
+            // Flip the normal depending on final winding order in world space.
+            if (isWorldFrontFaceCW) N = -N;
+            tri.normal = tri.area > 0.f ? glm::normalize(N) : float3(0.f);
+
+            return tri;
+        }
     }
 
     LightCollection::SharedPtr LightCollection::create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene)
@@ -176,6 +207,8 @@ namespace Falcor
         mMeshLights.clear();
         mpSamplerState = nullptr;
         mTriangleCount = 0;
+        mCPUBuild = true;
+        mHasTexturedEmissive = false;
 
         // Create mesh lights for all emissive mesh instances.
         for (uint32_t instanceID = 0; instanceID < scene.getGeometryInstanceCount(); instanceID++)
@@ -202,10 +235,15 @@ namespace Falcor
                 mMeshLights.push_back(meshLight);
                 mTriangleCount += meshLight.triangleCount;
 
+                // The triangle list can only be built on the CPU if the scene kept a copy of the mesh data.
+                if (!scene.getEmissiveMeshData(instanceData.geometryID)) mCPUBuild = false;
+
                 // Store ptr to texture sampler. We currently assume all the mesh lights' materials have the same sampler, which is true in current Falcor.
                 // If this changes in the future, we'll have to support multiple samplers.
                 if (pMaterial->getEmissiveTexture())
                 {
+                    mHasTexturedEmissive = true;
+
                     if (!mpSamplerState)
                     {
                         mpSamplerState = pMaterial->getDefaultTextureSampler();
@@ -242,14 +280,24 @@ namespace Falcor
             timeReport.measure("LightCollection::build preparation");
 
             // Pre-integrate emissive triangles.
+            // Textured emissives are integrated on the GPU, which requires reading back the flux data.
             // TODO: We might want to redo this in update() for animated meshes or after scale changes as that affects the flux.
-            integrateEmissive(pRenderContext, scene);
+            if (mCPUBuild && !mHasTexturedEmissive)
+            {
+                integrateEmissiveCPU(scene);
+                mCPUInvalidData = CPUOutOfDateFlags::None;
+                mStagingBufferValid = true;
+            }
+            else
+            {
+                integrateEmissive(pRenderContext, scene);
+                mCPUInvalidData = mCPUBuild ? CPUOutOfDateFlags::FluxData : CPUOutOfDateFlags::All;
+                mStagingBufferValid = false;
+            }
 
             timeReport.measure("LightCollection::build integrate emissive");
 
             // Build list of active triangles.
-            mCPUInvalidData = CPUOutOfDateFlags::All;
-            mStagingBufferValid = false;
             mStatsValid = false;
 
             prepareSyncCPUData(pRenderContext);
@@ -274,7 +322,16 @@ namespace Falcor
         if (mpFluxData->getStructSize() != sizeof(EmissiveFlux)) throw RuntimeError("Struct EmissiveFlux size mismatch between CPU/GPU");
 
         // Compute triangle data (vertices, uv-coordinates, materialID) for all mesh lights.
-        buildTriangleList(pRenderContext, scene);
+        if (mCPUBuild)
+        {
+            std::vector<uint32_t> lights(mMeshLights.size());
+            std::iota(lights.begin(), lights.end(), 0);
+            buildTriangleListCPU(scene, lights);
+        }
+        else
+        {
+            buildTriangleList(pRenderContext, scene);
+        }
     }
 
     void LightCollection::prepareMeshData(const Scene& scene)
@@ -488,6 +545,124 @@ namespace Falcor
         }
     }
 
+    void LightCollection::buildTriangleListCPU(const Scene& scene, const std::vector<uint32_t>& lights)
+    {
+        FALCOR_ASSERT(mCPUBuild);
+
+        // Split the triangles of the mesh lights into blocks that are processed in parallel.
+        // The packed triangles of the given lights are stored consecutively in a scratch buffer sized for just these lights,
+        // so that updating a few lights costs time proportional to their triangle count.
+        struct Block
+        {
+            uint32_t lightIdx;
+            uint32_t firstTriangle;
+            uint32_t triangleCount;
+            uint32_t scratchOffset;     ///< Offset of the block's first triangle in the scratch buffer.
+        };
+
+        std::vector<Block> blocks;
+        uint32_t scratchTriangleCount = 0;
+        for (uint32_t lightIdx : lights)
+        {
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            for (uint32_t first = 0; first < meshLight.triangleCount; first += kCPUBuildBlockSize)
+            {
+                blocks.push_back({ lightIdx, first, std::min(kCPUBuildBlockSize, meshLight.triangleCount - first), scratchTriangleCount + first });
+            }
+            scratchTriangleCount += meshLight.triangleCount;
+        }
+
+        // The CPU copy holds all triangles. It is only allocated on the first build, partial updates overwrite the triangles of the given lights.
+        if (mMeshLightTriangles.size() != mTriangleCount) mMeshLightTriangles.resize(mTriangleCount);
+        std::vector<PackedEmissiveTriangle> packedTriangles(scratchTriangleCount);
+        const auto& globalMatrices = scene.getAnimationController()->getGlobalMatrices();
+
+        auto range = NumericRange<size_t>(0, blocks.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t blockIdx)
+        {
+            const Block& block = blocks[blockIdx];
+            const MeshLightData& meshLight = mMeshLights[block.lightIdx];
+            const GeometryInstanceData& instanceData = scene.getGeometryInstance(meshLight.instanceID);
+            const Scene::EmissiveMeshData* pMeshData = scene.getEmissiveMeshData(instanceData.geometryID);
+            FALCOR_ASSERT(pMeshData);
+
+            const glm::mat4& worldMat = globalMatrices[instanceData.globalMatrixID];
+            const bool isWorldFrontFaceCW = instanceData.isWorldFrontFaceCW();
+
+            for (uint32_t triangleIndex = block.firstTriangle; triangleIndex < block.firstTriangle + block.triangleCount; triangleIndex++)
+            {
+                EmissiveTriangle tri = computeEmissiveTriangle(*pMeshData, worldMat, isWorldFrontFaceCW, triangleIndex);
+                tri.materialID = meshLight.materialID;
+                tri.lightIdx = block.lightIdx;
+
+                const uint32_t triIdx = meshLight.triangleOffset + triangleIndex;
+                PackedEmissiveTriangle& packedTri = packedTriangles[block.scratchOffset + triangleIndex - block.firstTriangle];
+                packedTri.pack(tri);
+
+                // Store the unpacked data so that the CPU copy matches the quantized GPU data.
+                tri = packedTri.unpack();
+                auto& meshLightTri = mMeshLightTriangles[triIdx];
+                meshLightTri.lightIdx = tri.lightIdx;
+                meshLightTri.normal = tri.normal;
+                meshLightTri.area = tri.area;
+
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    meshLightTri.vtx[j].pos = tri.posW[j];
+                    meshLightTri.vtx[j].uv = tri.texCoords[j];
+                }
+            }
+        });
+
+        // Upload the triangle data. Mesh lights with consecutive indices are stored consecutively, so we upload them as a single range.
+        uint32_t scratchOffset = 0;
+        for (size_t i = 0; i < lights.size();)
+        {
+            const uint32_t offset = mMeshLights[lights[i]].triangleOffset;
+            uint32_t count = 0;
+            for (; i < lights.size() && mMeshLights[lights[i]].triangleOffset == offset + count; i++)
+            {
+                count += mMeshLights[lights[i]].triangleCount;
+            }
+            if (count > 0) mpTriangleData->setBlob(packedTriangles.data() + scratchOffset, offset * sizeof(PackedEmissiveTriangle), count * sizeof(PackedEmissiveTriangle));
+            scratchOffset += count;
+        }
+        FALCOR_ASSERT(scratchOffset == scratchTriangleCount);
+    }
+
+    void LightCollection::integrateEmissiveCPU(const Scene& scene)
+    {
+        FALCOR_ASSERT(mCPUBuild && !mHasTexturedEmissive);
+        FALCOR_ASSERT(mMeshLightTriangles.size() == (size_t)mTriangleCount);
+
+        // Without emissive textures the radiance is constant over each mesh light.
+        std::vector<float3> radiance(mMeshLights.size());
+        for (size_t lightIdx = 0; lightIdx < mMeshLights.size(); lightIdx++)
+        {
+            auto pMaterial = scene.getMaterial(mMeshLights[lightIdx].materialID)->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+            const BasicMaterialData& materialData = pMaterial->getData();
+            radiance[lightIdx] = (float3)materialData.emissive * materialData.emissiveFactor;
+        }
+
+        // Pre-compute the flux in the same way as FinalizeIntegration.cs.slang.
+        std::vector<EmissiveFlux> fluxData(mTriangleCount);
+        auto range = NumericRange<uint32_t>(0, mTriangleCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t triIdx)
+        {
+            auto& meshLightTri = mMeshLightTriangles[triIdx];
+            const float3 averageRadiance = radiance[meshLightTri.lightIdx];
+            const float flux = luminance(averageRadiance) * meshLightTri.area * (float)M_PI;
+
+            meshLightTri.averageRadiance = averageRadiance;
+            meshLightTri.flux = flux;
+            fluxData[triIdx].flux = flux;
+            fluxData[triIdx].averageRadiance = averageRadiance;
+        });
+
+        mpFluxData->setBlob(fluxData.data(), 0, fluxData.size() * sizeof(EmissiveFlux));
+    }
+
     void LightCollection::updateActiveTriangleList()
     {
         // This function updates the list of active (non-culled) triangles based on the pre-integrated flux.
@@ -553,6 +728,23 @@ namespace Falcor
         // Alternatively, upload the list of updated meshes and early out unnecessary threads at runtime.
         FALCOR_ASSERT(!updatedLights.empty());
 
+        // With the CPU build only the updated mesh lights are recomputed, and the CPU data stays valid.
+        // The scene releases its CPU copies of static emissive meshes, so moving those falls back to the GPU.
+        if (mCPUBuild)
+        {
+            for (uint32_t lightIdx : updatedLights)
+            {
+                const auto& instanceData = scene.getGeometryInstance(mMeshLights[lightIdx].instanceID);
+                if (!scene.getEmissiveMeshData(instanceData.geometryID)) mCPUBuild = false;
+            }
+        }
+
+        if (mCPUBuild)
+        {
+            buildTriangleListCPU(scene, updatedLights);
+            return;
+        }
+
         // Bind scene.
         mpTrianglePositionUpdater["gScene"] = scene.getParameterBlock();
 
@@ -613,7 +805,8 @@ namespace Falcor
         {
             mpStagingBuffer = Buffer::create(stagingSize, Resource::BindFlags::None, Buffer::CpuAccess::Read);
             mpStagingBuffer->setName("LightCollection::mpStagingBuffer");
-            mCPUInvalidData = CPUOutOfDateFlags::All;
+            // With the CPU build the triangle data is never read back.
+            mCPUInvalidData = mCPUBuild ? CPUOutOfDateFlags::FluxData : CPUOutOfDateFlags::All;
         }
 
         // Schedule the copy operations for data that is invalid.
@@ -156,6 +156,13 @@ namespace Falcor
         */
         void prepareSyncCPUData(RenderContext* pRenderContext) const { copyDataToStagingBuffer(pRenderContext); }
 
+        /** Returns true if the emissive triangles are built on the CPU.
+            This is the case when the scene retained CPU copies of the data of all emissive meshes (see Scene::getEmissiveMeshData()).
+            The triangle geometry and the flux of non-textured emitters are then computed without any GPU readback.
+            Updates switch to the GPU once a moved mesh light no longer has CPU data.
+        */
+        bool isCPUBuild() const { return mCPUBuild; }
+
         /** Get the total GPU memory usage in bytes.
         */
         uint64_t getMemoryUsageInBytes() const;
@@ -184,6 +191,9 @@ namespace Falcor
         void updateActiveTriangleList();
         void updateTrianglePositions(RenderContext* pRenderContext, const Scene& scene, const std::vector<uint32_t>& updatedLights);
 
+        void buildTriangleListCPU(const Scene& scene, const std::vector<uint32_t>& lights);
+        void integrateEmissiveCPU(const Scene& scene);
+
         void copyDataToStagingBuffer(RenderContext* pRenderContext) const;
         void syncCPUData() const;
 
@@ -192,6 +202,8 @@ namespace Falcor
 
         std::vector<MeshLightData>              mMeshLights;            ///< List of all mesh lights.
         uint32_t                                mTriangleCount = 0;     ///< Total number of triangles in all mesh lights (= mMeshLightTriangles.size()). This may include culled triangles.
+        bool                                    mCPUBuild = false;      ///< True if the emissive triangles are built on the CPU from the scene's emissive mesh data.
+        bool                                    mHasTexturedEmissive = false; ///< True if any mesh light has a textured emissive material. These are integrated on the GPU.
 
         mutable std::vector<MeshLightTriangle>  mMeshLightTriangles;    ///< List of all pre-processed mesh light triangles.
         mutable std::vector<uint32_t>           mActiveTriangleList;    ///< List of active (non-culled) emissive triangles.
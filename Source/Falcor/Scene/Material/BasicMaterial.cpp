@@ -30,6 +30,7 @@
 #include "Core/Program/GraphicsProgram.h"
 #include "Core/Program/ProgramVars.h"
 #include "Utils/Color/ColorHelpers.slang"
+#include "Utils/HashUtils.h"
 
 namespace Falcor
 {
@@ -602,6 +603,39 @@ namespace Falcor
         return true;
     }
 
+    size_t BasicMaterial::getHash() const
+    {
+        // This hashes the same data that is compared in operator==.
+        size_t hash = Material::getHash();
+        hashValue(hash, mData.flags);
+        hashValue(hash, mData.displacementScale);
+        hashValue(hash, mData.displacementOffset);
+        hashValue(hash, (float4)mData.baseColor);
+        hashValue(hash, (float4)mData.specular);
+        hashValue(hash, (float3)mData.emissive);
+        hashValue(hash, mData.emissiveFactor);
+        hashValue(hash, (float)mData.IoR);
+        hashValue(hash, (float)mData.diffuseTransmission);
+        hashValue(hash, (float)mData.specularTransmission);
+        hashValue(hash, (float3)mData.transmission);
+        hashValue(hash, (float3)mData.volumeAbsorption);
+        hashValue(hash, (float)mData.volumeAnisotropy);
+        hashValue(hash, (float3)mData.volumeScattering);
+
+        for (const auto& pSampler : { mpDefaultSampler, mpDisplacementMinSampler, mpDisplacementMaxSampler })
+        {
+            hashValue(hash, (uint32_t)pSampler->getMagFilter());
+            hashValue(hash, (uint32_t)pSampler->getMinFilter());
+            hashValue(hash, (uint32_t)pSampler->getMipFilter());
+            hashValue(hash, (uint32_t)pSampler->getAddressModeU());
+            hashValue(hash, (uint32_t)pSampler->getAddressModeV());
+            hashValue(hash, (uint32_t)pSampler->getAddressModeW());
+            hashValue(hash, pSampler->getMaxAnisotropy());
+        }
+
+        return hash;
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
@@ -68,6 +68,10 @@ namespace Falcor
         */
         bool isEqual(const Material::SharedPtr& pOther) const override;
 
+        /** Computes a structural hash of the material, see Material::getHash().
+        */
+        size_t getHash() const override;
+
         /** Set the alpha mode.
         */
         void setAlphaMode(AlphaMode alphaMode) override;
@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "MERLMaterial.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
+#include "Utils/HashUtils.h"
 #include <fstream>
 
 namespace Falcor
@@ -118,6 +119,13 @@ namespace Falcor
         return true;
     }
 
+    size_t MERLMaterial::getHash() const
+    {
+        size_t hash = Material::getHash();
+        hashCombine(hash, std::filesystem::hash_value(mPath));
+        return hash;
+    }
+
     bool MERLMaterial::loadBRDF(const std::filesystem::path& path)
     {
         std::filesystem::path fullPath;
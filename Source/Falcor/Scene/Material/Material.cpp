@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "Material.h"
 #include "Rendering/Materials/LobeType.slang"
+#include "Utils/HashUtils.h"
 
 namespace Falcor
 {
@@ -287,6 +288,30 @@ namespace Falcor
         return true;
     }
 
+    size_t Material::getHash() const
+    {
+        // This hashes the same data that is compared in isBaseEqual().
+        size_t hash = 0;
+        hashValue(hash, mHeader.packedData);
+
+        hashValue(hash, mTextureTransform.getTranslation());
+        hashValue(hash, mTextureTransform.getScaling());
+        const glm::quat& rotation = mTextureTransform.getRotation();
+        hashValue(hash, float4(rotation.x, rotation.y, rotation.z, rotation.w));
+
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            if (!hasTextureSlot((TextureSlot)i)) continue;
+            hashValue(hash, i);
+            hashValue(hash, mTextureSlotInfo[i].name);
+            hashValue(hash, (uint32_t)mTextureSlotInfo[i].mask);
+            hashValue(hash, mTextureSlotInfo[i].srgb);
+            hashValue(hash, mTextureSlotData[i].pTexture.get());
+        }
+
+        return hash;
+    }
+
     FALCOR_SCRIPT_BINDING(Material)
     {
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Transform)
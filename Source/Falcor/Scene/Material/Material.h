@@ -142,6 +142,13 @@ namespace Falcor
         */
         virtual bool isEqual(const Material::SharedPtr& pOther) const = 0;
 
+        /** Computes a structural hash of the material.
+            Materials that are equal according to isEqual() are guaranteed to have the same hash. The name is not included.
+            Derived classes that compare additional properties in isEqual() should include them in the hash.
+            \return Hash value.
+        */
+        virtual size_t getHash() const;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
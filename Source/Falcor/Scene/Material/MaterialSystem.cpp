@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "MaterialSystem.h"
 #include <numeric>
+#include <execution>
 
 namespace Falcor
 {
@@ -42,6 +43,7 @@ namespace Falcor
         const size_t kMaxSamplerCount = 1ull << MaterialHeader::kSamplerIDBits;
         const size_t kMaxTextureCount = 1ull << TextureHandle::kTextureIDBits;
         const size_t kMaxBufferCountPerMaterial = 1; // This is a conservative estimation of how many buffer descriptors to allocate per material. Most materials don't use any auxiliary data buffers.
+        const uint32_t kMaxMaterialUploadGap = 16; // Max number of unchanged materials between two changed ones for which their uploads are merged.
 
         // Helper to check if a material is a standard material using the SpecGloss shading model.
         // We keep track of these as an optimization because most scenes do not use this shading model.
@@ -94,10 +96,14 @@ namespace Falcor
             const auto& pMaterial = mMaterials[materialID];
             if (auto materialGroup = widget.group(label))
             {
-                if (pMaterial->renderUI(materialGroup)) uploadMaterial(materialID);
+                // Changes are tracked by the material's update callback and uploaded in the next update.
+                pMaterial->renderUI(materialGroup);
             }
         };
 
+        widget.text(fmt::format("Last update: {} materials updated, {} changed, {} coalesced ({} in {} uploads)",
+            mUpdateStats.materialsScanned, mUpdateStats.materialsChanged, mUpdateStats.materialsCoalesced, formatByteSize(mUpdateStats.bytesUploaded), mUpdateStats.uploadCount));
+
         widget.checkbox("Sort by name", mSortMaterialsByName);
         if (mSortMaterialsByName)
         {
@@ -196,9 +202,9 @@ namespace Falcor
         FALCOR_ASSERT(pMaterial);
 
         // Reuse previously added materials.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            return (uint32_t)std::distance(mMaterials.begin(), it);
+            return it->second;
         }
 
         // Add material.
@@ -213,8 +219,10 @@ namespace Falcor
             pMaterial->setDefaultTextureSampler(mpDefaultTextureSampler);
         }
 
-        pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
         mMaterials.push_back(pMaterial);
+        mMaterialIDs[pMaterial.get()] = materialID;
+        mMaterialDirty.push_back(false);
+        trackMaterialUpdates(materialID);
         mMaterialsChanged = true;
 
         // Update metadata.
@@ -251,20 +259,29 @@ namespace Falcor
         std::vector<Material::SharedPtr> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
+        // Compute the material hashes. Equal materials are guaranteed to have equal hashes.
+        std::vector<size_t> hashes(mMaterials.size());
+        std::transform(std::execution::par, mMaterials.begin(), mMaterials.end(), hashes.begin(), [](const auto& pMaterial) { return pMaterial->getHash(); });
+
         // Find unique set of materials.
+        // Each bucket holds the IDs of the unique materials with a given hash in the order they were found,
+        // so the first equal material in the bucket is the same one a linear search would have found.
+        std::unordered_map<size_t, std::vector<uint32_t>> buckets;
         for (uint32_t id = 0; id < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = buckets[hashes[id]];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](uint32_t uniqueID) { return uniqueMaterials[uniqueID]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id] = (uint32_t)uniqueMaterials.size();
+                bucket.push_back(idMap[id]);
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id] = (uint32_t)std::distance(uniqueMaterials.begin(), it);
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[*it]->getName());
+                idMap[id] = *it;
 
                 // Update metadata.
                 if (isSpecGloss(pMaterial)) mSpecGlossMaterialCount--;
@@ -274,8 +291,23 @@ namespace Falcor
         size_t removed = mMaterials.size() - uniqueMaterials.size();
         if (removed > 0)
         {
+            // Materials that were removed no longer report updates. The remaining ones report with their new IDs.
+            for (uint32_t id = 0; id < idMap.size(); ++id)
+            {
+                if (uniqueMaterials[idMap[id]] != mMaterials[id]) mMaterials[id]->registerUpdateCallback(nullptr);
+            }
+
             mMaterials = uniqueMaterials;
             mMaterialsChanged = true;
+
+            mMaterialIDs.clear();
+            mDirtyMaterialIDs.clear();
+            mMaterialDirty.assign(mMaterials.size(), false);
+            for (uint32_t id = 0; id < mMaterials.size(); ++id)
+            {
+                mMaterialIDs[mMaterials[id].get()] = id;
+                trackMaterialUpdates(id);
+            }
         }
 
         return removed;
@@ -377,23 +409,37 @@ namespace Falcor
             forceUpdate = true; // Trigger full upload of all materials
         }
 
-        // Update all materials.
-        if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
+        // Update materials. Unless forced, only the materials that raised update flags are visited.
+        std::vector<uint32_t> materialIDs;
+        if (forceUpdate)
         {
-            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
-            {
-                auto& pMaterial = mMaterials[materialID];
-                const auto materialUpdates = pMaterial->update(this);
+            materialIDs.resize(mMaterials.size());
+            std::iota(materialIDs.begin(), materialIDs.end(), 0);
+        }
+        else
+        {
+            materialIDs.swap(mDirtyMaterialIDs);
+            std::sort(materialIDs.begin(), materialIDs.end());
+        }
+        mDirtyMaterialIDs.clear();
+        for (uint32_t materialID : materialIDs) mMaterialDirty[materialID] = false;
 
-                if (forceUpdate || materialUpdates != Material::UpdateFlags::None)
-                {
-                    uploadMaterial(materialID);
+        std::vector<uint32_t> changedIDs;
+        for (uint32_t materialID : materialIDs)
+        {
+            const auto materialUpdates = mMaterials[materialID]->update(this);
 
-                    flags |= materialUpdates;
-                }
+            if (forceUpdate || materialUpdates != Material::UpdateFlags::None)
+            {
+                changedIDs.push_back(materialID);
+                flags |= materialUpdates;
             }
         }
 
+        mUpdateStats = {};
+        mUpdateStats.materialsScanned = materialIDs.size();
+        uploadMaterials(changedIDs);
+
         // Update samplers.
         if (forceUpdate || mSamplersChanged)
         {
@@ -417,7 +463,6 @@ namespace Falcor
         mSamplersChanged = false;
         mBuffersChanged = false;
         mMaterialsChanged = false;
-        mMaterialUpdates = Material::UpdateFlags::None;
 
         return flags;
     }
@@ -537,15 +582,49 @@ namespace Falcor
         mpMaterialsBlock["materialCount"] = getMaterialCount();
     }
 
-    void MaterialSystem::uploadMaterial(const uint32_t materialID)
+    void MaterialSystem::trackMaterialUpdates(const uint32_t materialID)
     {
-        FALCOR_ASSERT(materialID < mMaterials.size());
-        const auto& pMaterial = mMaterials[materialID];
-        FALCOR_ASSERT(pMaterial);
+        FALCOR_ASSERT(materialID < mMaterials.size() && materialID < mMaterialDirty.size());
 
-        // TODO: On initial upload of materials, we could improve this by not having separate calls to setElement()
-        // but instead prepare a buffer containing all data.
+        // Put the material on the dirty list the first time it raises update flags.
+        mMaterials[materialID]->registerUpdateCallback([this, materialID](Material::UpdateFlags flags)
+        {
+            if (flags == Material::UpdateFlags::None || mMaterialDirty[materialID]) return;
+            mMaterialDirty[materialID] = true;
+            mDirtyMaterialIDs.push_back(materialID);
+        });
+    }
+
+    void MaterialSystem::uploadMaterials(const std::vector<uint32_t>& materialIDs)
+    {
+        FALCOR_ASSERT(std::is_sorted(materialIDs.begin(), materialIDs.end()));
+        if (materialIDs.empty()) return;
         FALCOR_ASSERT(mpMaterialDataBuffer);
-        mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
+
+        // Coalesce the materials into contiguous ranges and upload each range at once.
+        // Small gaps of unchanged materials are included in the range, as their data is identical to what is on the GPU
+        // and a few redundant bytes are cheaper than separate uploads.
+        std::vector<MaterialDataBlob> blobs;
+        for (size_t i = 0; i < materialIDs.size();)
+        {
+            const size_t firstIndex = i;
+            const uint32_t firstID = materialIDs[i];
+            uint32_t lastID = firstID;
+            for (++i; i < materialIDs.size() && materialIDs[i] - lastID <= kMaxMaterialUploadGap + 1; ++i) lastID = materialIDs[i];
+
+            blobs.resize(lastID - firstID + 1);
+            for (uint32_t materialID = firstID; materialID <= lastID; ++materialID)
+            {
+                blobs[materialID - firstID] = mMaterials[materialID]->getDataBlob();
+            }
+
+            const size_t byteSize = blobs.size() * sizeof(MaterialDataBlob);
+            mpMaterialDataBuffer->setBlob(blobs.data(), firstID * sizeof(MaterialDataBlob), byteSize);
+
+            mUpdateStats.materialsChanged += i - firstIndex;
+            mUpdateStats.materialsCoalesced += blobs.size() - (i - firstIndex);
+            mUpdateStats.uploadCount++;
+            mUpdateStats.bytesUploaded += byteSize;
+        }
     }
 }
@@ -60,6 +60,15 @@ namespace Falcor
             uint64_t textureMemoryInBytes = 0;          ///< Total memory in bytes used by the textures.
         };
 
+        struct UpdateStats
+        {
+            uint64_t materialsScanned = 0;              ///< Number of materials that were updated.
+            uint64_t materialsChanged = 0;              ///< Number of changed materials whose data was uploaded.
+            uint64_t materialsCoalesced = 0;            ///< Number of unchanged materials uploaded only because they fall in a gap between changed materials.
+            uint64_t uploadCount = 0;                   ///< Number of contiguous uploads to the material data buffer.
+            uint64_t bytesUploaded = 0;                 ///< Number of bytes uploaded to the material data buffer.
+        };
+
         /** Create a material system.
             \return New object, or throws an exception if creation failed.
         */
@@ -81,6 +90,10 @@ namespace Falcor
         void renderUI(Gui::Widgets& widget);
 
         /** Update material system. This prepares all resources for rendering.
+            Only materials that raised update flags since the last call are updated, unless a full update is forced.
+            The data of the changed materials is uploaded in contiguous ranges.
+            \param[in] forceUpdate Update and upload all materials.
+            \return Combined update flags of all updated materials.
         */
         Material::UpdateFlags update(bool forceUpdate);
 
@@ -171,6 +184,8 @@ namespace Falcor
         Material::SharedPtr getMaterialByName(const std::string& name) const;
 
         /** Remove all duplicate materials.
+            Materials are bucketed by Material::getHash() and only compared within a bucket.
+            The first occurrence of each unique material is kept, so the new material IDs follow the original order.
             \param[in] idMap Vector that holds for each material the ID of the material that replaces it.
             \return The number of materials removed.
         */
@@ -185,6 +200,10 @@ namespace Falcor
         */
         MaterialStats getStats() const;
 
+        /** Get stats for the most recent call to update().
+        */
+        const UpdateStats& getUpdateStats() const { return mUpdateStats; }
+
         /** Get texture manager. This holds all textures.
         */
         const TextureManager::SharedPtr& getTextureManager() { return mpTextureManager; }
@@ -194,9 +213,13 @@ namespace Falcor
 
         void updateUI();
         void createParameterBlock();
-        void uploadMaterial(const uint32_t materialID);
+        void trackMaterialUpdates(const uint32_t materialID);
+        void uploadMaterials(const std::vector<uint32_t>& materialIDs);
 
         std::vector<Material::SharedPtr> mMaterials;                ///< List of all materials.
+        std::unordered_map<const Material*, uint32_t> mMaterialIDs; ///< Map from material to its ID in mMaterials.
+        std::vector<uint32_t> mDirtyMaterialIDs;                    ///< IDs of materials that raised update flags since the last update.
+        std::vector<bool> mMaterialDirty;                           ///< Per-material flag indicating if the material is in mDirtyMaterialIDs.
         std::vector<uint32_t> mMaterialCountByType;                 ///< Number of materials of each type, indexed by MaterialType.
         std::set<MaterialType> mMaterialTypes;                      ///< Set of all material types used.
         uint32_t mSpecGlossMaterialCount = 0;                       ///< Number of standard materials using the SpecGloss shading model.
@@ -207,7 +230,7 @@ namespace Falcor
         bool mSamplersChanged = false;                              ///< Flag indicating if samplers were added/removed since last update.
         bool mBuffersChanged = false;                               ///< Flag indicating if buffers were added/removed since last update.
         bool mMaterialsChanged = false;                             ///< Flag indicating if materials were added/removed since last update. Per-material updates are tracked by each material's update flags.
-        Material::UpdateFlags mMaterialUpdates = Material::UpdateFlags::None; ///< Material updates across all materials since last update.
+        UpdateStats mUpdateStats;                                   ///< Stats for the most recent update.
 
         // GPU resources
         GpuFence::SharedPtr mpFence;
@@ -0,0 +1,440 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "MeshSimplifier.h"
+#include <queue>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Minimum cosine of the angle between a triangle normal before and after a collapse.
+        // Collapses that rotate a triangle further are rejected as they are likely to fold the surface over.
+        const double kMinNormalCos = 0.25;
+
+        // Weight of the constraint planes placed along open boundaries. These keep boundaries from shrinking.
+        const double kBoundaryWeight = 10.0;
+
+        using double3 = glm::dvec3;
+
+        /** Symmetric 4x4 matrix representing the weighted sum of squared distances to a set of planes.
+            Only the 10 unique coefficients are stored. Planes are weighted by area, the total weight is tracked
+            to convert the sum to a mean squared distance that is used as geometric error.
+        */
+        struct Quadric
+        {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+            double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+            double a22 = 0.0, a23 = 0.0;
+            double a33 = 0.0;
+            double weight = 0.0;
+
+            /** Create the quadric for the plane dot(n, p) + d = 0 scaled by weight w. The normal must be normalized.
+            */
+            static Quadric fromPlane(const double3& n, double d, double w)
+            {
+                Quadric q;
+                q.a00 = w * n.x * n.x; q.a01 = w * n.x * n.y; q.a02 = w * n.x * n.z; q.a03 = w * n.x * d;
+                q.a11 = w * n.y * n.y; q.a12 = w * n.y * n.z; q.a13 = w * n.y * d;
+                q.a22 = w * n.z * n.z; q.a23 = w * n.z * d;
+                q.a33 = w * d * d;
+                q.weight = w;
+                return q;
+            }
+
+            Quadric& operator+=(const Quadric& q)
+            {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+                a11 += q.a11; a12 += q.a12; a13 += q.a13;
+                a22 += q.a22; a23 += q.a23;
+                a33 += q.a33;
+                weight += q.weight;
+                return *this;
+            }
+
+            Quadric operator+(const Quadric& q) const
+            {
+                Quadric r = *this;
+                r += q;
+                return r;
+            }
+
+            /** Evaluate the weighted sum of squared plane distances at p.
+            */
+            double evaluate(const double3& p) const
+            {
+                double x = p.x, y = p.y, z = p.z;
+                double e =
+                    a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+                    a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+                    a22 * z * z + 2.0 * a23 * z +
+                    a33;
+                return std::max(e, 0.0);
+            }
+
+            /** Evaluate the mean squared plane distance at p.
+            */
+            double evaluateError(const double3& p) const
+            {
+                return weight > 0.0 ? evaluate(p) / weight : 0.0;
+            }
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(const float3& p) const
+            {
+                // Adding zero maps -0 to +0 so that positions comparing equal also hash equal.
+                size_t h = std::hash<float>()(p.x + 0.f);
+                h ^= std::hash<float>()(p.y + 0.f) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                h ^= std::hash<float>()(p.z + 0.f) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                return h;
+            }
+        };
+
+        /** Candidate collapse of vertex u onto vertex v.
+        */
+        struct Collapse
+        {
+            double cost;
+            uint32_t u;
+            uint32_t v;
+            uint32_t version;   ///< Version of vertex u when the candidate was computed. Stale candidates are skipped.
+
+            bool operator>(const Collapse& other) const { return cost > other.cost; }
+        };
+
+        uint64_t edgeKey(uint32_t a, uint32_t b)
+        {
+            if (a > b) std::swap(a, b);
+            return (uint64_t(a) << 32) | b;
+        }
+
+        class Simplifier
+        {
+        public:
+            Simplifier(const std::vector<float3>& positions, const std::vector<uint32_t>& indices)
+            {
+                // Weld vertices with identical positions.
+                std::unordered_map<float3, uint32_t, PositionHash> positionToVertex;
+                std::vector<uint32_t> weldMap(positions.size());
+                for (size_t i = 0; i < positions.size(); i++)
+                {
+                    auto [it, inserted] = positionToVertex.emplace(positions[i], (uint32_t)mPositions.size());
+                    if (inserted) mPositions.push_back(double3(positions[i]));
+                    weldMap[i] = it->second;
+                }
+
+                // Setup triangles. Triangles that are degenerate after welding are dropped.
+                const size_t inputTriangleCount = indices.size() / 3;
+                mCorners.reserve(indices.size());
+                mCornerVertices.reserve(indices.size());
+                for (size_t t = 0; t < inputTriangleCount; t++)
+                {
+                    uint32_t w0 = weldMap[indices[3 * t + 0]], w1 = weldMap[indices[3 * t + 1]], w2 = weldMap[indices[3 * t + 2]];
+                    if (w0 == w1 || w1 == w2 || w2 == w0) continue;
+                    mCorners.insert(mCorners.end(), { w0, w1, w2 });
+                    mCornerVertices.insert(mCornerVertices.end(), { indices[3 * t + 0], indices[3 * t + 1], indices[3 * t + 2] });
+                }
+                mTriangleCount = (uint32_t)(mCorners.size() / 3);
+                mTriangleAlive.assign(mTriangleCount, true);
+
+                const size_t vertexCount = mPositions.size();
+                mVertexTriangles.resize(vertexCount);
+                mQuadrics.resize(vertexCount);
+                mBoundary.assign(vertexCount, false);
+                mAlive.assign(vertexCount, true);
+                mVersions.assign(vertexCount, 0);
+
+                // Accumulate triangle plane quadrics and count edge uses to find open boundaries.
+                std::unordered_map<uint64_t, uint32_t> edgeUseCount;
+                edgeUseCount.reserve(mCorners.size());
+                for (uint32_t t = 0; t < mTriangleCount; t++)
+                {
+                    double3 n = getTriangleNormal(t);
+                    double len = glm::length(n);
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t w = mCorners[3 * t + i];
+                        mVertexTriangles[w].push_back(t);
+                        edgeUseCount[edgeKey(w, mCorners[3 * t + (i + 1) % 3])]++;
+                    }
+                    if (len == 0.0) continue;
+                    Quadric q = Quadric::fromPlane(n / len, -glm::dot(n / len, mPositions[mCorners[3 * t]]), 0.5 * len);
+                    for (uint32_t i = 0; i < 3; i++) mQuadrics[mCorners[3 * t + i]] += q;
+                }
+
+                // Add constraint planes perpendicular to the surface along open boundary edges.
+                for (uint32_t t = 0; t < mTriangleCount; t++)
+                {
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t a = mCorners[3 * t + i], b = mCorners[3 * t + (i + 1) % 3];
+                        if (edgeUseCount[edgeKey(a, b)] != 1) continue;
+                        mBoundary[a] = mBoundary[b] = true;
+
+                        double3 edge = mPositions[b] - mPositions[a];
+                        double3 m = glm::cross(edge, getTriangleNormal(t));
+                        double len = glm::length(m);
+                        if (len == 0.0) continue;
+                        m /= len;
+                        Quadric q = Quadric::fromPlane(m, -glm::dot(m, mPositions[a]), kBoundaryWeight * glm::dot(edge, edge));
+                        mQuadrics[a] += q;
+                        mQuadrics[b] += q;
+                    }
+                }
+            }
+
+            MeshSimplifier::Result run(uint32_t targetTriangleCount, float maxError)
+            {
+                const double maxSquaredError = (double)maxError * (double)maxError;
+                double appliedSquaredError = 0.0;
+
+                for (uint32_t w = 0; w < (uint32_t)mPositions.size(); w++) pushBestCollapse(w);
+
+                std::vector<std::pair<double, uint32_t>> candidates;
+                while (mTriangleCount > targetTriangleCount && !mQueue.empty())
+                {
+                    Collapse collapse = mQueue.top();
+                    mQueue.pop();
+                    if (!mAlive[collapse.u] || collapse.version != mVersions[collapse.u]) continue;
+
+                    // The cheapest candidate may have become invalid. Find the cheapest valid one and defer it if it costs more.
+                    getCandidates(collapse.u, candidates);
+                    auto it = std::find_if(candidates.begin(), candidates.end(), [&](const auto& c) { return isCollapseValid(collapse.u, c.second); });
+                    if (it == candidates.end()) continue;
+                    if (it->first > collapse.cost)
+                    {
+                        mQueue.push({ it->first, collapse.u, it->second, collapse.version });
+                        continue;
+                    }
+
+                    // Skip collapses exceeding the error bound. The vertex is reconsidered when its neighborhood changes.
+                    double squaredError = (mQuadrics[collapse.u] + mQuadrics[it->second]).evaluateError(mPositions[it->second]);
+                    if (squaredError > maxSquaredError) continue;
+
+                    applyCollapse(collapse.u, it->second);
+                    appliedSquaredError = std::max(appliedSquaredError, squaredError);
+                }
+
+                MeshSimplifier::Result result;
+                result.indices.reserve(3 * (size_t)mTriangleCount);
+                for (uint32_t t = 0; t < (uint32_t)mTriangleAlive.size(); t++)
+                {
+                    if (!mTriangleAlive[t]) continue;
+                    result.indices.insert(result.indices.end(), { mCornerVertices[3 * t], mCornerVertices[3 * t + 1], mCornerVertices[3 * t + 2] });
+                }
+                result.error = (float)std::sqrt(appliedSquaredError);
+                return result;
+            }
+
+        private:
+            double3 getTriangleNormal(uint32_t t) const
+            {
+                const double3& p0 = mPositions[mCorners[3 * t]];
+                return glm::cross(mPositions[mCorners[3 * t + 1]] - p0, mPositions[mCorners[3 * t + 2]] - p0);
+            }
+
+            bool containsVertex(uint32_t t, uint32_t w) const
+            {
+                return mCorners[3 * t] == w || mCorners[3 * t + 1] == w || mCorners[3 * t + 2] == w;
+            }
+
+            void compactTriangles(uint32_t w)
+            {
+                auto& triangles = mVertexTriangles[w];
+                triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [this](uint32_t t) { return !mTriangleAlive[t]; }), triangles.end());
+            }
+
+            void gatherNeighbors(uint32_t w, std::vector<uint32_t>& neighbors) const
+            {
+                neighbors.clear();
+                for (uint32_t t : mVertexTriangles[w])
+                {
+                    if (!mTriangleAlive[t]) continue;
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t n = mCorners[3 * t + i];
+                        if (n != w && std::find(neighbors.begin(), neighbors.end(), n) == neighbors.end()) neighbors.push_back(n);
+                    }
+                }
+            }
+
+            double getCost(uint32_t u, uint32_t v) const
+            {
+                return (mQuadrics[u] + mQuadrics[v]).evaluate(mPositions[v]);
+            }
+
+            /** Get all collapses of u onto its neighbors sorted by increasing cost.
+            */
+            void getCandidates(uint32_t u, std::vector<std::pair<double, uint32_t>>& candidates)
+            {
+                gatherNeighbors(u, mNeighborsU);
+                candidates.clear();
+                for (uint32_t v : mNeighborsU)
+                {
+                    // Boundary vertices may only move along the boundary.
+                    if (mBoundary[u] && !mBoundary[v]) continue;
+                    candidates.push_back({ getCost(u, v), v });
+                }
+                std::sort(candidates.begin(), candidates.end());
+            }
+
+            void pushBestCollapse(uint32_t u)
+            {
+                mVersions[u]++;
+                getCandidates(u, mCandidates);
+                if (!mCandidates.empty()) mQueue.push({ mCandidates[0].first, u, mCandidates[0].second, mVersions[u] });
+            }
+
+            bool isCollapseValid(uint32_t u, uint32_t v)
+            {
+                uint32_t sharedTriangles = 0;
+                for (uint32_t t : mVertexTriangles[u])
+                {
+                    if (mTriangleAlive[t] && containsVertex(t, v)) sharedTriangles++;
+                }
+                if (sharedTriangles == 0) return false;
+
+                // A boundary vertex must collapse along a boundary edge, otherwise the boundary is pinched.
+                if (mBoundary[u] && sharedTriangles != 1) return false;
+
+                // Link condition: the vertices may only share the neighbors opposite of the collapsed edge.
+                gatherNeighbors(u, mNeighborsU);
+                gatherNeighbors(v, mNeighborsV);
+                uint32_t sharedNeighbors = 0;
+                for (uint32_t n : mNeighborsU)
+                {
+                    if (std::find(mNeighborsV.begin(), mNeighborsV.end(), n) != mNeighborsV.end()) sharedNeighbors++;
+                }
+                if (sharedNeighbors != sharedTriangles) return false;
+
+                // Reject collapses that degenerate or flip the remaining triangles around u.
+                for (uint32_t t : mVertexTriangles[u])
+                {
+                    if (!mTriangleAlive[t] || containsVertex(t, v)) continue;
+
+                    double3 p[3];
+                    for (uint32_t i = 0; i < 3; i++) p[i] = mPositions[mCorners[3 * t + i]];
+                    double3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        if (mCorners[3 * t + i] == u) p[i] = mPositions[v];
+                    }
+                    double3 n1 = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+                    double len0 = glm::length(n0), len1 = glm::length(n1);
+                    if (len1 == 0.0) return false;
+                    if (len0 > 0.0 && glm::dot(n0, n1) < kMinNormalCos * len0 * len1) return false;
+                }
+
+                return true;
+            }
+
+            void applyCollapse(uint32_t u, uint32_t v)
+            {
+                // Map the attribute vertices of u to those of v using the triangles that are removed by the collapse.
+                // Corners on the other side of an attribute seam that is not crossed by a removed triangle fall back to the first match.
+                std::vector<std::pair<uint32_t, uint32_t>> vertexMap;
+                for (uint32_t t : mVertexTriangles[u])
+                {
+                    if (!mTriangleAlive[t] || !containsVertex(t, v)) continue;
+                    uint32_t from = 0, to = 0;
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        if (mCorners[3 * t + i] == u) from = mCornerVertices[3 * t + i];
+                        if (mCorners[3 * t + i] == v) to = mCornerVertices[3 * t + i];
+                    }
+                    vertexMap.push_back({ from, to });
+                    mTriangleAlive[t] = false;
+                    mTriangleCount--;
+                }
+                FALCOR_ASSERT(!vertexMap.empty());
+
+                for (uint32_t t : mVertexTriangles[u])
+                {
+                    if (!mTriangleAlive[t]) continue;
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        if (mCorners[3 * t + i] != u) continue;
+                        uint32_t vertex = mCornerVertices[3 * t + i];
+                        auto it = std::find_if(vertexMap.begin(), vertexMap.end(), [vertex](const auto& m) { return m.first == vertex; });
+                        mCorners[3 * t + i] = v;
+                        mCornerVertices[3 * t + i] = it != vertexMap.end() ? it->second : vertexMap[0].second;
+                    }
+                    mVertexTriangles[v].push_back(t);
+                }
+
+                mQuadrics[v] += mQuadrics[u];
+                mAlive[u] = false;
+                mVertexTriangles[u].clear();
+                mVertexTriangles[u].shrink_to_fit();
+
+                // Update the candidates of all vertices whose collapse costs changed.
+                compactTriangles(v);
+                std::vector<uint32_t> neighbors;
+                gatherNeighbors(v, neighbors);
+                pushBestCollapse(v);
+                for (uint32_t n : neighbors)
+                {
+                    compactTriangles(n);
+                    pushBestCollapse(n);
+                }
+            }
+
+            std::vector<double3> mPositions;                    ///< Welded vertex positions.
+            std::vector<uint32_t> mCorners;                     ///< Welded vertex for each triangle corner.
+            std::vector<uint32_t> mCornerVertices;              ///< Input vertex for each triangle corner.
+            std::vector<bool> mTriangleAlive;
+            uint32_t mTriangleCount = 0;                        ///< Number of alive triangles.
+
+            std::vector<std::vector<uint32_t>> mVertexTriangles; ///< Triangles referencing each welded vertex. May contain removed triangles.
+            std::vector<Quadric> mQuadrics;
+            std::vector<bool> mBoundary;
+            std::vector<bool> mAlive;
+            std::vector<uint32_t> mVersions;
+
+            std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> mQueue;
+            std::vector<std::pair<double, uint32_t>> mCandidates;
+            std::vector<uint32_t> mNeighborsU;
+            std::vector<uint32_t> mNeighborsV;
+        };
+    }
+
+    MeshSimplifier::Result MeshSimplifier::simplify(const std::vector<float3>& positions, const std::vector<uint32_t>& indices, uint32_t targetTriangleCount, float maxError)
+    {
+        checkArgument(indices.size() % 3 == 0, "'indices' must hold a triangle list.");
+        for (uint32_t index : indices)
+        {
+            checkArgument(index < positions.size(), "'indices' references vertex {} but there are only {} vertices.", index, positions.size());
+        }
+
+        Simplifier simplifier(positions, indices);
+        return simplifier.run(targetTriangleCount, maxError);
+    }
+}
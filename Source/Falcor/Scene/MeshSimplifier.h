@@ -0,0 +1,63 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+
+namespace Falcor
+{
+    /** Triangle mesh simplification using quadric error metrics.
+
+        The simplifier performs half-edge collapses in order of increasing quadric error (Garland and Heckbert 1997).
+        A collapse moves one vertex onto a neighboring vertex, so the output references a subset of the input vertices
+        and no new vertex attributes have to be interpolated. Vertices sharing the same position are welded during
+        simplification, which lets collapses cross attribute seams while the output still references the original vertices.
+        Collapses that flip triangles, change the mesh topology or shrink open boundaries are rejected.
+    */
+    class FALCOR_API MeshSimplifier
+    {
+    public:
+        struct Result
+        {
+            std::vector<uint32_t> indices;  ///< Triangle list indices referencing the input vertices.
+            float error = 0.f;              ///< Geometric error of the simplified mesh in the units of the input positions.
+        };
+
+        /** Simplify a triangle mesh.
+            \param[in] positions Vertex positions.
+            \param[in] indices Triangle list indices.
+            \param[in] targetTriangleCount Simplification stops when the triangle count drops to this number.
+            \param[in] maxError Simplification stops before a collapse would exceed this geometric error.
+            \return Simplified triangle list and the geometric error introduced.
+        */
+        static Result simplify(const std::vector<float3>& positions, const std::vector<uint32_t>& indices, uint32_t targetTriangleCount, float maxError = std::numeric_limits<float>::infinity());
+
+    private:
+        MeshSimplifier() = default;
+        MeshSimplifier(const MeshSimplifier&) = delete;
+        void operator=(const MeshSimplifier&) = delete;
+    };
+}
@@ -77,5 +77,7 @@ namespace Falcor
 
         // GPU data.
         std::vector<Texture::SharedPtr> mNDSDFTextures;
+
+        friend class SceneCache;
     };
 }
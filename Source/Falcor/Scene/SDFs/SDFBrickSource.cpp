@@ -0,0 +1,326 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "SDFBrickSource.h"
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kMagic[4] = { 'S', 'D', 'F', 'B' };
+        const uint32_t kVersion = 1;
+
+        const uint32_t kDefaultBrickBatchSize = 4096;
+
+        int8_t quantizeSnorm8(float value, float normalizationMultiplier)
+        {
+            float normalizedValue = glm::clamp(value * normalizationMultiplier, -1.0f, 1.0f);
+            float integerScale = normalizedValue * float(INT8_MAX);
+            return integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+        }
+
+        bool isMaskBitSet(const std::vector<uint32_t>& mask, uint64_t index)
+        {
+            return (mask[index >> 5] & (1u << (index & 31))) != 0;
+        }
+    }
+
+    const char SDFBrickFile::kFileExtension[] = ".sdfb";
+
+    SDFBrickFile::SharedPtr SDFBrickFile::open(const std::filesystem::path& path)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath))
+        {
+            logWarning("SDFBrickFile::open() file '{}' could not be found!", path);
+            return nullptr;
+        }
+
+        SharedPtr pFile = SharedPtr(new SDFBrickFile());
+        std::ifstream& file = pFile->mFile;
+        file.open(fullPath, std::ios::in | std::ios::binary);
+
+        if (!file.is_open())
+        {
+            logWarning("SDFBrickFile::open() file '{}' could not be opened!", path);
+            return nullptr;
+        }
+
+        char magic[4];
+        uint32_t version = 0;
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(&pFile->mGridWidth), sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(&pFile->mBrickWidth), sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(&pFile->mBrickCount), sizeof(uint32_t));
+
+        if (!file || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kVersion || pFile->mBrickWidth == 0)
+        {
+            logWarning("SDFBrickFile::open() file '{}' is not a valid sparse SDF grid file!", path);
+            return nullptr;
+        }
+
+        uint64_t bricksPerAxis = pFile->getBricksPerAxis();
+        pFile->mInsideMask.resize(div_round_up(bricksPerAxis * bricksPerAxis * bricksPerAxis, uint64_t(32)));
+        file.read(reinterpret_cast<char*>(pFile->mInsideMask.data()), pFile->mInsideMask.size() * sizeof(uint32_t));
+
+        if (!file)
+        {
+            logWarning("SDFBrickFile::open() file '{}' is truncated!", path);
+            return nullptr;
+        }
+
+        pFile->mFirstBrickPos = file.tellg();
+        return pFile;
+    }
+
+    bool SDFBrickFile::convertDenseFile(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, uint32_t brickWidth)
+    {
+        checkArgument(brickWidth > 0, "'brickWidth' must be larger than 0.");
+
+        std::filesystem::path fullSrcPath;
+        if (!findFileInDataDirectories(srcPath, fullSrcPath))
+        {
+            logWarning("SDFBrickFile::convertDenseFile() file '{}' could not be found!", srcPath);
+            return false;
+        }
+
+        std::ifstream srcFile(fullSrcPath, std::ios::in | std::ios::binary);
+        std::ofstream dstFile(dstPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!srcFile.is_open() || !dstFile.is_open())
+        {
+            logWarning("SDFBrickFile::convertDenseFile() could not open '{}' or '{}'!", srcPath, dstPath);
+            return false;
+        }
+
+        uint32_t gridWidth = 0;
+        srcFile.read(reinterpret_cast<char*>(&gridWidth), sizeof(uint32_t));
+
+        const uint64_t gridWidthInValues = gridWidth + 1;
+        const uint64_t planeValueCount = gridWidthInValues * gridWidthInValues;
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        const uint32_t bricksPerAxis = (gridWidth + brickWidth - 1) / brickWidth;
+        const uint64_t totalBrickCount = uint64_t(bricksPerAxis) * bricksPerAxis * bricksPerAxis;
+        const std::streamoff valuesOffset = sizeof(uint32_t);
+
+        // Write the header, the brick count and inside mask are patched once all bricks have been written.
+        uint32_t brickCount = 0;
+        std::vector<uint32_t> insideMask(div_round_up(totalBrickCount, uint64_t(32)), 0);
+        dstFile.write(kMagic, sizeof(kMagic));
+        dstFile.write(reinterpret_cast<const char*>(&kVersion), sizeof(uint32_t));
+        dstFile.write(reinterpret_cast<const char*>(&gridWidth), sizeof(uint32_t));
+        dstFile.write(reinterpret_cast<const char*>(&brickWidth), sizeof(uint32_t));
+        std::streampos brickCountPos = dstFile.tellp();
+        dstFile.write(reinterpret_cast<const char*>(&brickCount), sizeof(uint32_t));
+        dstFile.write(reinterpret_cast<const char*>(insideMask.data()), insideMask.size() * sizeof(uint32_t));
+
+        // Only one slab of brickWidth + 1 value planes is kept in memory at a time.
+        std::vector<float> slab(brickWidthInValues * planeValueCount);
+        std::vector<float> brickValues(brickWidthInValues * brickWidthInValues * brickWidthInValues);
+
+        for (uint32_t bz = 0; bz < bricksPerAxis; bz++)
+        {
+            uint32_t firstPlane = bz * brickWidth;
+            uint32_t planeCount = std::min(brickWidthInValues, gridWidth + 1 - firstPlane);
+
+            srcFile.seekg(valuesOffset + std::streamoff(firstPlane * planeValueCount * sizeof(float)));
+            srcFile.read(reinterpret_cast<char*>(slab.data()), planeCount * planeValueCount * sizeof(float));
+            if (!srcFile)
+            {
+                logWarning("SDFBrickFile::convertDenseFile() file '{}' is truncated!", srcPath);
+                return false;
+            }
+
+            for (uint32_t by = 0; by < bricksPerAxis; by++)
+            {
+                for (uint32_t bx = 0; bx < bricksPerAxis; bx++)
+                {
+                    uint3 brickCoords(bx, by, bz);
+                    uint3 brickGridCoords = brickCoords * brickWidth;
+                    float minValue = std::numeric_limits<float>::max();
+                    float maxValue = std::numeric_limits<float>::lowest();
+
+                    // Gather the brick values, coordinates outside of the grid are clamped to the grid border.
+                    for (uint32_t z = 0; z < brickWidthInValues; z++)
+                    {
+                        uint32_t slabZ = std::min(z, planeCount - 1);
+                        for (uint32_t y = 0; y < brickWidthInValues; y++)
+                        {
+                            uint64_t gridY = std::min(brickGridCoords.y + y, gridWidth);
+                            for (uint32_t x = 0; x < brickWidthInValues; x++)
+                            {
+                                uint64_t gridX = std::min(brickGridCoords.x + x, gridWidth);
+                                float value = slab[gridX + gridWidthInValues * (gridY + gridWidthInValues * slabZ)];
+                                brickValues[x + brickWidthInValues * (y + brickWidthInValues * z)] = value;
+                                minValue = std::min(minValue, value);
+                                maxValue = std::max(maxValue, value);
+                            }
+                        }
+                    }
+
+                    // A brick contains the surface if any of its voxels contain a sign change, which is the case iff its values contain both signs.
+                    if (minValue <= 0.0f && maxValue >= 0.0f)
+                    {
+                        dstFile.write(reinterpret_cast<const char*>(&brickCoords), sizeof(uint3));
+                        dstFile.write(reinterpret_cast<const char*>(brickValues.data()), brickValues.size() * sizeof(float));
+                        brickCount++;
+                    }
+                    else if (maxValue < 0.0f)
+                    {
+                        uint64_t brickIndex = bx + uint64_t(bricksPerAxis) * (by + uint64_t(bricksPerAxis) * bz);
+                        insideMask[brickIndex >> 5] |= 1u << (brickIndex & 31);
+                    }
+                }
+            }
+        }
+
+        dstFile.seekp(brickCountPos);
+        dstFile.write(reinterpret_cast<const char*>(&brickCount), sizeof(uint32_t));
+        dstFile.write(reinterpret_cast<const char*>(insideMask.data()), insideMask.size() * sizeof(uint32_t));
+        dstFile.close();
+
+        logInfo("SDFBrickFile::convertDenseFile() wrote {} of {} bricks to '{}'.", brickCount, totalBrickCount, dstPath);
+        return true;
+    }
+
+    bool SDFBrickFile::isBrickInside(const uint3& brickCoords) const
+    {
+        uint64_t bricksPerAxis = getBricksPerAxis();
+        return isMaskBitSet(mInsideMask, brickCoords.x + bricksPerAxis * (brickCoords.y + bricksPerAxis * brickCoords.z));
+    }
+
+    uint32_t SDFBrickFile::readBricks(uint32_t maxBrickCount, std::vector<uint3>& brickCoords, std::vector<float>& values)
+    {
+        uint32_t brickCount = std::min(maxBrickCount, mBrickCount - mNextBrick);
+        uint32_t valuesPerBrick = getValuesPerBrick();
+
+        brickCoords.resize(brickCount);
+        values.resize((size_t)brickCount * valuesPerBrick);
+
+        for (uint32_t i = 0; i < brickCount; i++)
+        {
+            mFile.read(reinterpret_cast<char*>(&brickCoords[i]), sizeof(uint3));
+            mFile.read(reinterpret_cast<char*>(values.data() + (size_t)i * valuesPerBrick), valuesPerBrick * sizeof(float));
+        }
+
+        if (!mFile) throw RuntimeError("SDFBrickFile::readBricks() failed to read bricks, the file is truncated.");
+
+        mNextBrick += brickCount;
+        return brickCount;
+    }
+
+    void SDFBrickFile::rewind()
+    {
+        mFile.clear();
+        mFile.seekg(mFirstBrickPos);
+        mNextBrick = 0;
+    }
+
+    SDFQuantizedBricks::SDFQuantizedBricks(SDFBrickSource& source, float normalizationMultiplier)
+        : mGridWidth(source.getGridWidth())
+        , mBrickWidth(source.getBrickWidth())
+        , mBricksPerAxis(source.getBricksPerAxis())
+    {
+        const uint32_t valuesPerBrick = source.getValuesPerBrick();
+
+        // Quantize bricks batch by batch so that the full precision values are never all resident.
+        mBrickCoords.reserve(source.getBrickCount());
+        mValues.reserve((size_t)source.getBrickCount() * valuesPerBrick);
+        mBrickIndices.reserve(source.getBrickCount());
+
+        std::vector<uint3> batchCoords;
+        std::vector<float> batchValues;
+        source.rewind();
+        while (uint32_t batchSize = source.readBricks(kDefaultBrickBatchSize, batchCoords, batchValues))
+        {
+            size_t valueOffset = mValues.size();
+            mValues.resize(valueOffset + (size_t)batchSize * valuesPerBrick);
+
+            auto range = NumericRange<size_t>(0, (size_t)batchSize * valuesPerBrick);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t v)
+            {
+                mValues[valueOffset + v] = quantizeSnorm8(batchValues[v], normalizationMultiplier);
+            });
+
+            for (uint32_t i = 0; i < batchSize; i++)
+            {
+                mBrickIndices[getBrickKey(batchCoords[i])] = (uint32_t)mBrickCoords.size();
+                mBrickCoords.push_back(batchCoords[i]);
+            }
+        }
+
+        // Keep a local copy of the inside mask, it is tiny compared to the bricks.
+        uint64_t totalBrickCount = uint64_t(mBricksPerAxis) * mBricksPerAxis * mBricksPerAxis;
+        mInsideMask.resize(div_round_up(totalBrickCount, uint64_t(32)), 0);
+        for (uint32_t z = 0; z < mBricksPerAxis; z++)
+        {
+            for (uint32_t y = 0; y < mBricksPerAxis; y++)
+            {
+                for (uint32_t x = 0; x < mBricksPerAxis; x++)
+                {
+                    uint3 brickCoords(x, y, z);
+                    if (source.isBrickInside(brickCoords))
+                    {
+                        uint64_t brickKey = getBrickKey(brickCoords);
+                        mInsideMask[brickKey >> 5] |= 1u << (brickKey & 31);
+                    }
+                }
+            }
+        }
+    }
+
+    int8_t SDFQuantizedBricks::getValue(const uint3& gridCoords) const
+    {
+        uint3 brickCoords = glm::min(gridCoords / mBrickWidth, uint3(mBricksPerAxis - 1));
+
+        // Grid points on brick borders are shared by up to eight bricks, any of them may store the value.
+        uint3 sharedAxes = uint3(
+            brickCoords.x > 0 && gridCoords.x == brickCoords.x * mBrickWidth ? 1 : 0,
+            brickCoords.y > 0 && gridCoords.y == brickCoords.y * mBrickWidth ? 1 : 0,
+            brickCoords.z > 0 && gridCoords.z == brickCoords.z * mBrickWidth ? 1 : 0);
+
+        for (uint32_t dz = 0; dz <= sharedAxes.z; dz++)
+        {
+            for (uint32_t dy = 0; dy <= sharedAxes.y; dy++)
+            {
+                for (uint32_t dx = 0; dx <= sharedAxes.x; dx++)
+                {
+                    uint3 candidateCoords = brickCoords - uint3(dx, dy, dz);
+                    auto it = mBrickIndices.find(getBrickKey(candidateCoords));
+                    if (it != mBrickIndices.end())
+                    {
+                        return getBrickValue(it->second, gridCoords - candidateCoords * mBrickWidth);
+                    }
+                }
+            }
+        }
+
+        return isMaskBitSet(mInsideMask, getBrickKey(brickCoords)) ? int8_t(-INT8_MAX) : int8_t(INT8_MAX);
+    }
+}
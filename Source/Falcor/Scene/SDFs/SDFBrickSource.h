@@ -0,0 +1,175 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <fstream>
+
+namespace Falcor
+{
+    /** Narrow-band, brick based source of SDF values.
+        The grid is divided into bricks of brickWidth^3 voxels. A source provides distance values only for bricks that contain the implicit surface,
+        each brick stores (brickWidth + 1)^3 corner values in x-major order. For all other bricks the source provides the sign of the (far away) distance,
+        which allows consumers to reconstruct values anywhere in the grid without ever storing the dense grid.
+        Bricks are read in batches so that consumers can stream them and only keep the data they need.
+    */
+    class FALCOR_API SDFBrickSource
+    {
+    public:
+        virtual ~SDFBrickSource() = default;
+
+        /** Returns the width of the grid in voxels.
+        */
+        virtual uint32_t getGridWidth() const = 0;
+
+        /** Returns the width of a brick in voxels.
+        */
+        virtual uint32_t getBrickWidth() const = 0;
+
+        /** Returns the number of bricks that contain values.
+        */
+        virtual uint32_t getBrickCount() const = 0;
+
+        /** Returns true if the region covered by an empty brick lies inside the surface, i.e., its distances are negative.
+            \param[in] brickCoords Coordinates of the brick, in bricks.
+        */
+        virtual bool isBrickInside(const uint3& brickCoords) const = 0;
+
+        /** Reads the next batch of bricks.
+            \param[in] maxBrickCount The maximum number of bricks to read.
+            \param[out] brickCoords Coordinates of the bricks that were read.
+            \param[out] values Corner values of the bricks that were read, (brickWidth + 1)^3 values per brick.
+            \return The number of bricks read, 0 when all bricks have been read.
+        */
+        virtual uint32_t readBricks(uint32_t maxBrickCount, std::vector<uint3>& brickCoords, std::vector<float>& values) = 0;
+
+        /** Restarts reading from the first brick.
+        */
+        virtual void rewind() = 0;
+
+        /** Returns the number of bricks per axis.
+        */
+        uint32_t getBricksPerAxis() const { return (getGridWidth() + getBrickWidth() - 1) / getBrickWidth(); }
+
+        /** Returns the number of values stored per brick.
+        */
+        uint32_t getValuesPerBrick() const { uint32_t w = getBrickWidth() + 1; return w * w * w; }
+    };
+
+    /** Streams SDF bricks from a sparse SDF grid file (.sdfb).
+        The file layout is:
+            char[4]     magic "SDFB"
+            uint32_t    version
+            uint32_t    gridWidth
+            uint32_t    brickWidth
+            uint32_t    brickCount
+            uint32_t    insideMask[ceil(bricksPerAxis^3 / 32)]      Bit set if an empty brick lies inside the surface.
+            brickCount x { uint32_t coords[3]; float values[(brickWidth + 1)^3]; }
+    */
+    class FALCOR_API SDFBrickFile : public SDFBrickSource
+    {
+    public:
+        using SharedPtr = std::shared_ptr<SDFBrickFile>;
+
+        /** Open a sparse SDF grid file for streaming.
+            \param[in] path The path of a .sdfb file, searched for in the data directories.
+            \return A new object, or nullptr if the file could not be opened or is invalid.
+        */
+        static SharedPtr open(const std::filesystem::path& path);
+
+        /** Convert a dense SDF grid file (.sdfg) to a sparse SDF grid file (.sdfb).
+            The dense file is streamed one slab of bricks at a time, so memory usage is proportional to a single slab.
+            \param[in] srcPath The path of the dense .sdfg file.
+            \param[in] dstPath The path of the .sdfb file to write.
+            \param[in] brickWidth The width of a brick in voxels.
+            \return true if the file could be written, otherwise false.
+        */
+        static bool convertDenseFile(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, uint32_t brickWidth = 8);
+
+        virtual uint32_t getGridWidth() const override { return mGridWidth; }
+        virtual uint32_t getBrickWidth() const override { return mBrickWidth; }
+        virtual uint32_t getBrickCount() const override { return mBrickCount; }
+        virtual bool isBrickInside(const uint3& brickCoords) const override;
+        virtual uint32_t readBricks(uint32_t maxBrickCount, std::vector<uint3>& brickCoords, std::vector<float>& values) override;
+        virtual void rewind() override;
+
+        static const char kFileExtension[];
+
+    private:
+        SDFBrickFile() = default;
+
+        std::ifstream mFile;
+        std::streampos mFirstBrickPos;
+        uint32_t mGridWidth = 0;
+        uint32_t mBrickWidth = 0;
+        uint32_t mBrickCount = 0;
+        uint32_t mNextBrick = 0;
+        std::vector<uint32_t> mInsideMask;
+    };
+
+    /** CPU-side narrow band of SDF values quantized to snorm8, used by SDF grid implementations to build their representations from bricks.
+        Only bricks provided by the source are stored, memory therefore scales with the surface area of the SDF and not its volume.
+    */
+    class FALCOR_API SDFQuantizedBricks
+    {
+    public:
+        /** Stream all bricks from a source and quantize them.
+            \param[in] source The brick source, it is rewound before reading.
+            \param[in] normalizationMultiplier Distances are multiplied by this factor and clamped to [-1, 1] before quantization.
+        */
+        SDFQuantizedBricks(SDFBrickSource& source, float normalizationMultiplier);
+
+        uint32_t getGridWidth() const { return mGridWidth; }
+        uint32_t getBrickWidth() const { return mBrickWidth; }
+        uint32_t getBricksPerAxis() const { return mBricksPerAxis; }
+        uint32_t getBrickCount() const { return (uint32_t)mBrickCoords.size(); }
+        const uint3& getBrickCoords(uint32_t brickIndex) const { return mBrickCoords[brickIndex]; }
+
+        /** Returns the quantized value stored by a brick at brick local value coordinates.
+        */
+        int8_t getBrickValue(uint32_t brickIndex, const uint3& localCoords) const
+        {
+            uint32_t w = mBrickWidth + 1;
+            return mValues[(size_t)brickIndex * w * w * w + localCoords.x + w * (localCoords.y + w * localCoords.z)];
+        }
+
+        /** Returns the quantized value at grid coordinates in [0, gridWidth]^3.
+            Values outside of the stored bricks are reconstructed from the brick sign, i.e., they are either -127 or 127.
+        */
+        int8_t getValue(const uint3& gridCoords) const;
+
+    private:
+        uint64_t getBrickKey(const uint3& brickCoords) const { return brickCoords.x + uint64_t(mBricksPerAxis) * (brickCoords.y + uint64_t(mBricksPerAxis) * brickCoords.z); }
+
+        uint32_t mGridWidth = 0;
+        uint32_t mBrickWidth = 0;
+        uint32_t mBricksPerAxis = 0;
+        std::vector<uint3> mBrickCoords;
+        std::vector<int8_t> mValues;
+        std::unordered_map<uint64_t, uint32_t> mBrickIndices;
+        std::vector<uint32_t> mInsideMask;
+    };
+}
@@ -334,8 +334,28 @@ namespace Falcor
         setValuesInternal(cornerValues);
     }
 
+    void SDFGrid::setValues(SDFBrickSource& source)
+    {
+        uint32_t gridWidth = source.getGridWidth();
+        checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2.", gridWidth);
+
+        mOriginalGridWidth = gridWidth;
+        mGridWidth = gridWidth;
+
+        setBrickValuesInternal(source);
+    }
+
     bool SDFGrid::loadValuesFromFile(const std::filesystem::path& path)
     {
+        if (hasExtension(path, SDFBrickFile::kFileExtension))
+        {
+            SDFBrickFile::SharedPtr pBrickFile = SDFBrickFile::open(path);
+            if (!pBrickFile) return false;
+
+            setValues(*pBrickFile);
+            return true;
+        }
+
         std::filesystem::path fullPath;
         if (findFileInDataDirectories(path, fullPath))
         {
@@ -360,6 +380,65 @@ namespace Falcor
         return false;
     }
 
+    void SDFGrid::setBrickValuesInternal(SDFBrickSource& source)
+    {
+        const uint32_t brickWidth = source.getBrickWidth();
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        const uint32_t bricksPerAxis = source.getBricksPerAxis();
+        const uint32_t gridWidthInValues = mGridWidth + 1;
+        const float kFarDistance = glm::root_three<float>();
+
+        std::vector<float> cornerValues((size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues);
+
+        auto forEachBrickValue = [&](const uint3& brickCoords, auto func)
+        {
+            uint3 brickGridCoords = brickCoords * brickWidth;
+            uint3 brickEnd = glm::min(brickGridCoords + brickWidthInValues, uint3(gridWidthInValues));
+            for (uint32_t z = brickGridCoords.z; z < brickEnd.z; z++)
+            {
+                for (uint32_t y = brickGridCoords.y; y < brickEnd.y; y++)
+                {
+                    for (uint32_t x = brickGridCoords.x; x < brickEnd.x; x++)
+                    {
+                        func(x + gridWidthInValues * (y + (size_t)gridWidthInValues * z), uint3(x, y, z) - brickGridCoords);
+                    }
+                }
+            }
+        };
+
+        // Fill the regions of empty bricks with far distances of the correct sign.
+        for (uint32_t z = 0; z < bricksPerAxis; z++)
+        {
+            for (uint32_t y = 0; y < bricksPerAxis; y++)
+            {
+                for (uint32_t x = 0; x < bricksPerAxis; x++)
+                {
+                    uint3 brickCoords(x, y, z);
+                    float value = source.isBrickInside(brickCoords) ? -kFarDistance : kFarDistance;
+                    forEachBrickValue(brickCoords, [&](size_t index, const uint3&) { cornerValues[index] = value; });
+                }
+            }
+        }
+
+        // Stream the narrow band bricks into the dense grid.
+        std::vector<uint3> brickCoords;
+        std::vector<float> brickValues;
+        source.rewind();
+        while (uint32_t brickCount = source.readBricks(4096, brickCoords, brickValues))
+        {
+            for (uint32_t b = 0; b < brickCount; b++)
+            {
+                const float* pValues = brickValues.data() + (size_t)b * source.getValuesPerBrick();
+                forEachBrickValue(brickCoords[b], [&](size_t index, const uint3& local)
+                {
+                    cornerValues[index] = pValues[local.x + brickWidthInValues * (local.y + brickWidthInValues * local.z)];
+                });
+            }
+        }
+
+        setValuesInternal(cornerValues);
+    }
+
     void SDFGrid::generateCheeseValues(uint32_t gridWidth, uint32_t seed)
     {
         const float kHalfCheeseExtent = 0.4f;
@@ -622,6 +701,7 @@ namespace Falcor
         sdfGrid.def_static("createSBS", createSBS);
         sdfGrid.def_static("createSVO", [](){ return SDFGrid::SharedPtr(SDFSVO::create()); });
         sdfGrid.def("loadValuesFromFile", &SDFGrid::loadValuesFromFile, "path"_a);
+        sdfGrid.def_static("convertValuesFileToBricks", &SDFBrickFile::convertDenseFile, "srcPath"_a, "dstPath"_a, "brickWidth"_a = 8);
         sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "path"_a, "gridWidth"_a, "dir"_a = "");
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
         sdfGrid.def_property("name", &SDFGrid::getName, &SDFGrid::setName);
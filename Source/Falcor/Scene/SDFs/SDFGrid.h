@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Scene/SDFs/SDF3DPrimitiveCommon.slang"
+#include "Scene/SDFs/SDFBrickSource.h"
 
 namespace Falcor
 {
@@ -122,8 +123,14 @@ namespace Falcor
         */
         void setValues(const std::vector<float>& cornerValues, uint32_t gridWidth);
 
+        /** Set the signed distance values of the SDF grid from a narrow-band brick source.
+            SDF grid types that can be built from bricks (SDFSBS and SDFSVO) never create the dense grid, other types expand the bricks to a dense grid.
+            \param[in] source The brick source, bricks are streamed from it and it is not referenced after the call.
+        */
+        void setValues(SDFBrickSource& source);
+
         /** Set the signed distance values of the SDF grid from a file.
-            \param[in] path The path of a .sdfg file.
+            \param[in] path The path of a dense .sdfg file or a sparse .sdfb file.
             \return true if the values could be set, otherwise false.
         */
         bool loadValuesFromFile(const std::filesystem::path& path);
@@ -214,6 +221,10 @@ namespace Falcor
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) = 0;
 
+        /** Set values from a brick source. The default implementation expands the bricks to a dense grid and calls setValuesInternal() with it.
+        */
+        virtual void setBrickValuesInternal(SDFBrickSource& source);
+
         void updatePrimitivesBuffer();
 
         std::string mName;
@@ -228,6 +239,8 @@ namespace Falcor
         Buffer::SharedPtr mpPrimitivesBuffer;
 
         ComputePass::SharedPtr mpEvaluatePrimitivesPass;
+
+        friend class SceneCache;
     };
 
     FALCOR_ENUM_CLASS_OPERATORS(SDFGrid::UpdateFlags);
@@ -29,6 +29,8 @@
 #include "SDFSBS.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
 #include "Utils/Math/MathHelpers.h"
+#include "Scene/Volume/BC4Encode.h"
+#include <execution>
 
 namespace Falcor
 {
@@ -48,6 +50,36 @@ namespace Falcor
 
         const bool kEnableCoarseBrickPruning = true;
         const bool kEnableFineBrickPruning = true;
+
+        const uint32_t kCompressionWidth = 4;
+
+        bool containsSurface(const int8_t* pValues, uint32_t widthInValues, uint32_t x, uint32_t y, uint32_t z)
+        {
+            bool anyNonPositive = false;
+            bool anyNonNegative = false;
+            for (uint32_t c = 0; c < 8; c++)
+            {
+                int8_t v = pValues[(x + (c & 1)) + widthInValues * ((y + ((c >> 1) & 1)) + widthInValues * (z + (c >> 2)))];
+                anyNonPositive |= v <= 0;
+                anyNonNegative |= v >= 0;
+            }
+            return anyNonPositive && anyNonNegative;
+        }
+
+        /** Encodes a 4x4 tile of snorm8 values into a BC4Snorm block.
+            The unorm encoder is used on values biased by 128. BC4 interpolation is linear and the bias preserves endpoint ordering,
+            so the resulting block decodes to the same values when its endpoints are interpreted as snorm.
+        */
+        void compressSnormBlock(const int8_t* pTile, uint8_t* pBlock)
+        {
+            uint8_t unormTile[16];
+            for (uint32_t i = 0; i < 16; i++) unormTile[i] = uint8_t(int(pTile[i]) + 128);
+
+            CompressAlphaDxt5(unormTile, pBlock);
+
+            pBlock[0] = uint8_t(int8_t(int(pBlock[0]) - 128));
+            pBlock[1] = uint8_t(int8_t(int(pBlock[1]) - 128));
+        }
     }
 
     SDFSBS::SharedPtr SDFSBS::create(uint32_t brickWidth, bool compressed)
@@ -93,7 +125,12 @@ namespace Falcor
         // Calculate the maximum number of bricks that could be created.
         mVirtualBricksPerAxis = std::max(mVirtualBricksPerAxis, (uint32_t)std::ceilf(float(mGridWidth) / mBrickWidth));
 
-        if (!mPrimitives.empty() && mValues.empty())
+        if (!mBrickVirtualIDs.empty() && !mPrimitivesDirty)
+        {
+            // Bricks were built on the CPU or restored from the scene cache, only upload them.
+            createResourcesFromBricks(pRenderContext);
+        }
+        else if (!mPrimitives.empty() && mValues.empty())
         {
             createResourcesFromPrimitives(pRenderContext, deleteScratchData);
         }
@@ -134,6 +171,11 @@ namespace Falcor
         // Assume AABBs will change.
         UpdateFlags updateFlags = UpdateFlags::AABBsChanged;
 
+        // Bricks uploaded from the CPU are stale once the primitives change.
+        mBrickVirtualIDs.clear();
+        mBrickAABBs.clear();
+        mBrickTextureData.clear();
+
         // Chunk width must be equal to 4 for now.
         static const uint32_t kChunkWidth = 4;
 
@@ -703,6 +745,55 @@ namespace Falcor
         }
     }
 
+    SDFGrid::UpdateFlags SDFSBS::createResourcesFromBricks(RenderContext* pRenderContext)
+    {
+        // All brick data was prepared on the CPU by setBrickValuesInternal(), the dense grid texture is never created.
+        mBrickCount = (uint32_t)mBrickVirtualIDs.size();
+
+        mpBrickAABBsBuffer = Buffer::createStructured(sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, mBrickAABBs.data(), false);
+
+        // Upload the indirection texture one slice at a time so that the dense indirection data is never resident on the host.
+        if (!mpIndirectionTexture || mpIndirectionTexture->getWidth() < mVirtualBricksPerAxis)
+        {
+            mpIndirectionTexture = Texture::create3D(mVirtualBricksPerAxis, mVirtualBricksPerAxis, mVirtualBricksPerAxis, ResourceFormat::R32Uint, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        }
+
+        // Bricks built from primitives are not ordered by virtual brick ID, visit them in sorted order.
+        std::vector<uint32_t> sortedBrickIDs(mBrickCount);
+        std::iota(sortedBrickIDs.begin(), sortedBrickIDs.end(), 0);
+        if (!std::is_sorted(mBrickVirtualIDs.begin(), mBrickVirtualIDs.end()))
+        {
+            std::sort(std::execution::par, sortedBrickIDs.begin(), sortedBrickIDs.end(), [this](uint32_t a, uint32_t b) { return mBrickVirtualIDs[a] < mBrickVirtualIDs[b]; });
+        }
+
+        const uint32_t sliceBrickCount = mVirtualBricksPerAxis * mVirtualBricksPerAxis;
+        std::vector<uint32_t> indirectionSlice(sliceBrickCount);
+        auto brickIt = sortedBrickIDs.begin();
+        for (uint32_t z = 0; z < mVirtualBricksPerAxis; z++)
+        {
+            std::fill(indirectionSlice.begin(), indirectionSlice.end(), std::numeric_limits<uint32_t>::max());
+
+            uint32_t sliceEnd = (z + 1) * sliceBrickCount;
+            for (; brickIt != sortedBrickIDs.end() && mBrickVirtualIDs[*brickIt] < sliceEnd; ++brickIt)
+            {
+                indirectionSlice[mBrickVirtualIDs[*brickIt] - z * sliceBrickCount] = *brickIt;
+            }
+
+            pRenderContext->updateSubresourceData(mpIndirectionTexture.get(), 0, indirectionSlice.data(), uint3(0, 0, z), uint3(mVirtualBricksPerAxis, mVirtualBricksPerAxis, 1));
+        }
+
+        if (mCompressed)
+        {
+            mpBrickTexture = Texture::create2D(mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::BC4Snorm, 1, 1, mBrickTextureData.data());
+        }
+        else
+        {
+            mpBrickTexture = Texture::create2D(mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::R8Snorm, 1, 1, mBrickTextureData.data(), ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource);
+        }
+
+        return UpdateFlags::All;
+    }
+
     void SDFSBS::allocatePrimitiveBits()
     {
         // Calculate bits required to encode brick coords and brick local voxel coords.
@@ -712,6 +803,10 @@ namespace Falcor
 
     void SDFSBS::setValuesInternal(const std::vector<float>& cornerValues)
     {
+        mBrickVirtualIDs.clear();
+        mBrickAABBs.clear();
+        mBrickTextureData.clear();
+
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mValues.resize(valueCount);
@@ -726,6 +821,156 @@ namespace Falcor
         }
     }
 
+    void SDFSBS::setBrickValuesInternal(SDFBrickSource& source)
+    {
+        mValues.clear();
+
+        SDFQuantizedBricks bricks(source, 2.0f * mGridWidth / glm::root_three<float>());
+
+        mVirtualBricksPerAxis = std::max(mVirtualBricksPerAxis, (uint32_t)std::ceilf(float(mGridWidth) / mBrickWidth));
+
+        const uint32_t brickWidthInValues = mBrickWidth + 1;
+        const uint32_t brickValueCount = brickWidthInValues * brickWidthInValues * brickWidthInValues;
+        const uint32_t sourceBrickWidth = bricks.getBrickWidth();
+
+        // Only bricks overlapping a source brick can contain the surface, everything else lies outside of the narrow band.
+        std::vector<uint32_t> candidateIDs;
+        for (uint32_t i = 0; i < bricks.getBrickCount(); i++)
+        {
+            uint3 voxelMin = bricks.getBrickCoords(i) * sourceBrickWidth;
+            uint3 voxelMax = glm::min(voxelMin + sourceBrickWidth, uint3(mGridWidth)) - 1u;
+            uint3 brickMin = voxelMin / mBrickWidth;
+            uint3 brickMax = voxelMax / mBrickWidth;
+
+            for (uint32_t z = brickMin.z; z <= brickMax.z; z++)
+            {
+                for (uint32_t y = brickMin.y; y <= brickMax.y; y++)
+                {
+                    for (uint32_t x = brickMin.x; x <= brickMax.x; x++)
+                    {
+                        candidateIDs.push_back(x + mVirtualBricksPerAxis * (y + mVirtualBricksPerAxis * z));
+                    }
+                }
+            }
+        }
+        std::sort(candidateIDs.begin(), candidateIDs.end());
+        candidateIDs.erase(std::unique(candidateIDs.begin(), candidateIDs.end()), candidateIDs.end());
+
+        auto virtualBrickCoords = [this](uint32_t virtualBrickID)
+        {
+            return uint3(virtualBrickID % mVirtualBricksPerAxis, (virtualBrickID / mVirtualBricksPerAxis) % mVirtualBricksPerAxis, virtualBrickID / (mVirtualBricksPerAxis * mVirtualBricksPerAxis));
+        };
+
+        // Gathers the brick values, coordinates not less than the grid width are set to the maximum distance like the GPU build does.
+        auto gatherBrickValues = [&](uint32_t virtualBrickID, int8_t* pValues)
+        {
+            uint3 brickGridCoords = virtualBrickCoords(virtualBrickID) * mBrickWidth;
+            for (uint32_t z = 0; z < brickWidthInValues; z++)
+            {
+                for (uint32_t y = 0; y < brickWidthInValues; y++)
+                {
+                    for (uint32_t x = 0; x < brickWidthInValues; x++)
+                    {
+                        uint3 gridCoords = brickGridCoords + uint3(x, y, z);
+                        pValues[x + brickWidthInValues * (y + brickWidthInValues * z)] = glm::all(glm::lessThan(gridCoords, uint3(mGridWidth))) ? bricks.getValue(gridCoords) : int8_t(INT8_MAX);
+                    }
+                }
+            }
+        };
+
+        // A brick is valid if any of its voxels inside the grid contains the surface.
+        std::vector<uint8_t> candidateValid(candidateIDs.size(), 0);
+        auto candidateRange = NumericRange<size_t>(0, candidateIDs.size());
+        std::for_each(std::execution::par, candidateRange.begin(), candidateRange.end(), [&](size_t c)
+        {
+            std::vector<int8_t> values(brickValueCount);
+            gatherBrickValues(candidateIDs[c], values.data());
+
+            uint3 voxelEnd = glm::min(uint3(mBrickWidth), uint3(mGridWidth) - virtualBrickCoords(candidateIDs[c]) * mBrickWidth);
+            for (uint32_t z = 0; z < voxelEnd.z && !candidateValid[c]; z++)
+            {
+                for (uint32_t y = 0; y < voxelEnd.y && !candidateValid[c]; y++)
+                {
+                    for (uint32_t x = 0; x < voxelEnd.x; x++)
+                    {
+                        if (containsSurface(values.data(), brickWidthInValues, x, y, z))
+                        {
+                            candidateValid[c] = 1;
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+
+        // Brick IDs are assigned in virtual brick order, matching the prefix sum used by the GPU build.
+        mBrickVirtualIDs.clear();
+        for (size_t c = 0; c < candidateIDs.size(); c++)
+        {
+            if (candidateValid[c]) mBrickVirtualIDs.push_back(candidateIDs[c]);
+        }
+        mBrickCount = (uint32_t)mBrickVirtualIDs.size();
+
+        // Lay out the brick texture like createResourcesFromValues() does.
+        uint32_t bricksAlongX = std::max(1u, (uint32_t)std::ceilf(std::sqrtf((float)mBrickCount / brickWidthInValues)));
+        uint32_t bricksAlongY = std::max(1u, (uint32_t)std::ceilf((float)mBrickCount / bricksAlongX));
+        mBricksPerAxis = uint2(bricksAlongX, bricksAlongY);
+        mBrickTextureDimensions = uint2(brickWidthInValues * brickWidthInValues * bricksAlongX, brickWidthInValues * bricksAlongY);
+
+        const size_t textureRowPitch = mCompressed ? (mBrickTextureDimensions.x / kCompressionWidth) * 8 : mBrickTextureDimensions.x;
+        const size_t textureRowCount = mCompressed ? mBrickTextureDimensions.y / kCompressionWidth : mBrickTextureDimensions.y;
+        mBrickTextureData.assign(textureRowPitch * textureRowCount, 0);
+        mBrickAABBs.resize(mBrickCount);
+
+        auto brickRange = NumericRange<uint32_t>(0, mBrickCount);
+        std::for_each(std::execution::par, brickRange.begin(), brickRange.end(), [&](uint32_t brickID)
+        {
+            uint32_t virtualBrickID = mBrickVirtualIDs[brickID];
+            uint3 brickCoords = virtualBrickCoords(virtualBrickID);
+
+            float3 brickAABBMin = -0.5f + float3(brickCoords * mBrickWidth) / float(mGridWidth);
+            float3 brickAABBMax = glm::min(brickAABBMin + float(mBrickWidth) / float(mGridWidth), float3(0.5f));
+            mBrickAABBs[brickID] = AABB(brickAABBMin, brickAABBMax);
+
+            std::vector<int8_t> values(brickValueCount);
+            gatherBrickValues(virtualBrickID, values.data());
+
+            uint2 brickTextureCoords = uint2(brickID % bricksAlongX, brickID / bricksAlongX) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+
+            for (uint32_t z = 0; z < brickWidthInValues; z++)
+            {
+                if (mCompressed)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y += kCompressionWidth)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x += kCompressionWidth)
+                        {
+                            int8_t tile[16];
+                            for (uint32_t bY = 0; bY < kCompressionWidth; bY++)
+                            {
+                                for (uint32_t bX = 0; bX < kCompressionWidth; bX++)
+                                {
+                                    tile[bX + kCompressionWidth * bY] = values[(x + bX) + brickWidthInValues * ((y + bY) + brickWidthInValues * z)];
+                                }
+                            }
+
+                            uint2 blockCoords = (brickTextureCoords + uint2(x + z * brickWidthInValues, y)) / kCompressionWidth;
+                            compressSnormBlock(tile, &mBrickTextureData[blockCoords.y * textureRowPitch + blockCoords.x * 8]);
+                        }
+                    }
+                }
+                else
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y++)
+                    {
+                        uint2 texelCoords = brickTextureCoords + uint2(z * brickWidthInValues, y);
+                        std::memcpy(&mBrickTextureData[texelCoords.y * textureRowPitch + texelCoords.x], &values[brickWidthInValues * (y + brickWidthInValues * z)], brickWidthInValues);
+                    }
+                }
+            }
+        });
+    }
+
     SDFSBS::SDFSBS(uint32_t brickWidth, bool compressed) :
         mBrickWidth(brickWidth),
         mCompressed(compressed)
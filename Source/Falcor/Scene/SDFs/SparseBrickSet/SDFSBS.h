@@ -66,10 +66,12 @@ namespace Falcor
     protected:
         UpdateFlags createResourcesFromPrimitives(RenderContext* pRenderContext, bool deleteScratchData);
         void createResourcesFromValues(RenderContext* pRenderContext, bool deleteScratchData);
+        UpdateFlags createResourcesFromBricks(RenderContext* pRenderContext);
 
         void allocatePrimitiveBits();
 
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setBrickValuesInternal(SDFBrickSource& source) override;
 
     private:
         SDFSBS(uint32_t brickWidth, bool compressed);
@@ -77,6 +79,11 @@ namespace Falcor
         // CPU data.
         std::vector<int8_t> mValues;
 
+        // CPU data when built from narrow-band bricks or restored from the scene cache, ready to be uploaded.
+        std::vector<uint32_t> mBrickVirtualIDs;         ///< Virtual brick IDs of all valid bricks, the index is the brick ID.
+        std::vector<AABB> mBrickAABBs;                  ///< AABB of each valid brick.
+        std::vector<uint8_t> mBrickTextureData;         ///< Brick texture data, R8Snorm texels or BC4Snorm blocks.
+
         // Specs.
         uint32_t mVirtualBricksPerAxis = 0;
         uint32_t mVoxelCount = 0;
@@ -126,5 +133,7 @@ namespace Falcor
         Buffer::SharedPtr mpSubChunkCoordsBuffer;
         Buffer::SharedPtr mpSubdivisionArgBuffer;
         GpuFence::SharedPtr mpReadbackFence;
+
+        friend class SceneCache;
     };
 }
@@ -29,6 +29,7 @@
 #include "SDFSVO.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
 #include "Utils/Math/MathHelpers.h"
+#include <execution>
 
 namespace Falcor
 {
@@ -54,6 +55,37 @@ namespace Falcor
             v |= v >> 16;
             return ++v;
         }
+
+        // CPU equivalents of the location code helpers in SDFVoxelCommon.slang.
+        const uint32_t kMaxLevel = 19;
+        const uint64_t kLocationCodeVoxelCoordsMask = (1ull << (3 * kMaxLevel)) - 1;
+        const uint32_t kLocationCodeLevelOffset = 3 * kMaxLevel;
+        const uint64_t kLocationCodeValidBit = 1ull << 63;
+
+        uint64_t shiftCoord(uint32_t x)
+        {
+            uint64_t y = uint64_t(x);
+            y = (y | y << 32) & 0x1f00000000ffffull;
+            y = (y | y << 16) & 0x1f0000ff0000ffull;
+            y = (y | y << 8) & 0x100f00f00f00f00full;
+            y = (y | y << 4) & 0x10c30c30c30c30c3ull;
+            y = (y | y << 2) & 0x1249249249249249ull;
+            return y;
+        }
+
+        /** Encodes level local voxel coordinates into a location code with the valid bit set.
+        */
+        uint64_t encodeLocation(const uint3& levelLocalVoxelCoords, uint32_t level)
+        {
+            uint3 globalCoords = levelLocalVoxelCoords << (kMaxLevel - level);
+            uint64_t coordBits = (shiftCoord(globalCoords.x) << 2) | (shiftCoord(globalCoords.y) << 1) | shiftCoord(globalCoords.z);
+            return kLocationCodeValidBit | (uint64_t(level) << kLocationCodeLevelOffset) | (coordBits & kLocationCodeVoxelCoordsMask);
+        }
+
+        uint64_t getCoordsKey(const uint3& coords)
+        {
+            return (uint64_t(coords.z) << 42) | (uint64_t(coords.y) << 21) | uint64_t(coords.x);
+        }
     }
 
     SDFSVO::SharedPtr SDFSVO::create()
@@ -88,6 +120,14 @@ namespace Falcor
             throw RuntimeError("An SDFSVO instance cannot be created from primitives!");
         }
 
+        // The octree was already built on the CPU from narrow-band bricks, only upload it.
+        if (!mSVOVoxels.empty())
+        {
+            mSVOElementCount = (uint32_t)mSVOVoxels.size();
+            mpSVOBuffer = Buffer::create(mSVOElementCount * sizeof(SDFSVOVoxel), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, mSVOVoxels.data());
+            return;
+        }
+
         // Create source grid texture to read from.
         if (mpSDFGridTexture && mpSDFGridTexture->getWidth() == mGridWidth + 1)
         {
@@ -387,6 +427,8 @@ namespace Falcor
 
     void SDFSVO::setValuesInternal(const std::vector<float>& cornerValues)
     {
+        mSVOVoxels.clear();
+
         mLevelCount = bitScanReverse(mGridWidth) + 1;
 
         uint32_t gridWidthInValues = mGridWidth + 1;
@@ -402,4 +444,123 @@ namespace Falcor
             mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
         }
     }
+
+    void SDFSVO::setBrickValuesInternal(SDFBrickSource& source)
+    {
+        mValues.clear();
+        mLevelCount = bitScanReverse(mGridWidth) + 1;
+
+        SDFQuantizedBricks bricks(source, mGridWidth / (0.5f * glm::root_three<float>()));
+        const uint32_t brickWidth = bricks.getBrickWidth();
+
+        struct LevelVoxel
+        {
+            uint3 coords;
+            uint32_t validMask;
+        };
+
+        std::vector<std::vector<LevelVoxel>> levels(mLevelCount);
+
+        // Find surface voxels of the finest level, they can only be located inside the narrow-band bricks.
+        {
+            std::vector<std::vector<LevelVoxel>> brickVoxels(bricks.getBrickCount());
+            auto range = NumericRange<uint32_t>(0, bricks.getBrickCount());
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t brickIndex)
+            {
+                uint3 brickGridCoords = bricks.getBrickCoords(brickIndex) * brickWidth;
+                uint3 voxelEnd = glm::min(uint3(brickWidth), uint3(mGridWidth) - brickGridCoords);
+
+                for (uint32_t z = 0; z < voxelEnd.z; z++)
+                {
+                    for (uint32_t y = 0; y < voxelEnd.y; y++)
+                    {
+                        for (uint32_t x = 0; x < voxelEnd.x; x++)
+                        {
+                            bool anyNonPositive = false;
+                            bool anyNonNegative = false;
+                            for (uint32_t c = 0; c < 8; c++)
+                            {
+                                int8_t v = bricks.getBrickValue(brickIndex, uint3(x + (c >> 2), y + ((c >> 1) & 1), z + (c & 1)));
+                                anyNonPositive |= v <= 0;
+                                anyNonNegative |= v >= 0;
+                            }
+
+                            if (anyNonPositive && anyNonNegative) brickVoxels[brickIndex].push_back({ brickGridCoords + uint3(x, y, z), 0 });
+                        }
+                    }
+                }
+            });
+
+            for (auto& voxels : brickVoxels)
+            {
+                levels.back().insert(levels.back().end(), voxels.begin(), voxels.end());
+                voxels = {};
+            }
+        }
+
+        // Create the coarser levels, a voxel is only created if one of its children exists.
+        for (int32_t l = mLevelCount - 1; l > 0; l--)
+        {
+            std::unordered_map<uint64_t, uint32_t> parentIndices;
+            std::vector<LevelVoxel>& parents = levels[l - 1];
+
+            for (const LevelVoxel& child : levels[l])
+            {
+                uint3 parentCoords = child.coords >> 1u;
+                uint32_t childID = ((child.coords.x & 1) << 2) | ((child.coords.y & 1) << 1) | (child.coords.z & 1);
+
+                auto [it, inserted] = parentIndices.try_emplace(getCoordsKey(parentCoords), (uint32_t)parents.size());
+                if (inserted) parents.push_back({ parentCoords, 0 });
+                parents[it->second].validMask |= 1u << childID;
+            }
+        }
+
+        // Sort all voxels by location code, this gives the same layout as the GPU build which sorts the location codes in the hash table.
+        std::vector<std::pair<uint64_t, const LevelVoxel*>> sortedVoxels;
+        for (uint32_t l = 0; l < mLevelCount; l++)
+        {
+            for (const LevelVoxel& voxel : levels[l]) sortedVoxels.emplace_back(encodeLocation(voxel.coords, l), &voxel);
+        }
+        std::sort(std::execution::par, sortedVoxels.begin(), sortedVoxels.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        mSVOElementCount = (uint32_t)sortedVoxels.size();
+        mSVOVoxels.resize(mSVOElementCount);
+
+        auto range = NumericRange<uint32_t>(0, mSVOElementCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t svoOffset)
+        {
+            uint64_t locationCode = sortedVoxels[svoOffset].first;
+            const LevelVoxel& voxel = *sortedVoxels[svoOffset].second;
+            uint32_t level = uint32_t((locationCode >> kLocationCodeLevelOffset) & 0x1f);
+
+            SDFSVOVoxel& svoVoxel = mSVOVoxels[svoOffset];
+            svoVoxel.locationCode = uint2(uint32_t(locationCode), uint32_t(locationCode >> 32));
+            svoVoxel.relationData = voxel.validMask;
+
+            // Encode the offset of the first valid child, children of a voxel are stored consecutively.
+            if (voxel.validMask != 0)
+            {
+                uint32_t firstValidChildID = bitScanForward(voxel.validMask);
+                uint3 childCoords = (voxel.coords << 1u) + uint3(firstValidChildID >> 2, (firstValidChildID >> 1) & 1, firstValidChildID & 1);
+                uint64_t childLocationCode = encodeLocation(childCoords, level + 1);
+
+                auto childIt = std::lower_bound(sortedVoxels.begin(), sortedVoxels.end(), childLocationCode, [](const auto& a, uint64_t code) { return a.first < code; });
+                FALCOR_ASSERT(childIt != sortedVoxels.end() && childIt->first == childLocationCode);
+                svoVoxel.relationData |= uint32_t(childIt - sortedVoxels.begin()) << 8;
+            }
+
+            // Read the eight corner values, coarser levels read values at their corners in the finest grid.
+            uint32_t hierarchy = mLevelCount - level - 1;
+            uint3 gridCoords = voxel.coords << hierarchy;
+            uint32_t voxelWidth = 1 << hierarchy;
+
+            uint32_t packedValues[2] = { 0, 0 };
+            for (uint32_t c = 0; c < 8; c++)
+            {
+                uint3 cornerCoords = gridCoords + voxelWidth * uint3(c >> 2, (c >> 1) & 1, c & 1);
+                packedValues[c >> 2] |= uint32_t(uint8_t(bricks.getValue(cornerCoords))) << (8 * (c & 3));
+            }
+            svoVoxel.packedValues = uint2(packedValues[0], packedValues[1]);
+        });
+    }
 }
@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Scene/SDFs/SDFGrid.h"
+#include "Scene/SDFs/SDFVoxelTypes.slang"
 #include "Core/API/Buffer.h"
 #include "Core/API/Texture.h"
 
@@ -61,12 +62,14 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setBrickValuesInternal(SDFBrickSource& source) override;
 
     private:
         SDFSVO() = default;
 
         // CPU data.
         std::vector<int8_t> mValues;
+        std::vector<SDFSVOVoxel> mSVOVoxels;    ///< Octree built on the CPU from narrow-band bricks or restored from the scene cache, ready to be uploaded.
 
         // Specs.
         uint32_t mLevelCount = 0;
@@ -97,5 +100,7 @@ namespace Falcor
         Buffer::SharedPtr mpHashTableBuffer;
         Buffer::SharedPtr mpLocationCodesBuffer;
         GpuFence::SharedPtr mpReadbackFence;
+
+        friend class SceneCache;
     };
 }
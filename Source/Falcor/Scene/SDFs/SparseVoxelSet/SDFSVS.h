@@ -79,5 +79,7 @@ namespace Falcor
         Buffer::SharedPtr mpSurfaceVoxelCounter;
         Buffer::SharedPtr mpSurfaceVoxelCounterStagingBuffer;
         Texture::SharedPtr mpSDFGridTexture;
+
+        friend class SceneCache;
     };
 }
@@ -30,9 +30,11 @@
 #include "SceneDefines.slangh"
 #include "Scene/Curves/CurveConfig.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/NumericRange.h"
 
 #include <sstream>
 #include <numeric>
+#include <execution>
 
 namespace Falcor
 {
@@ -84,6 +86,27 @@ namespace Falcor
         const std::string kAddViewpoint = "addViewpoint";
         const std::string kRemoveViewpoint = "kRemoveViewpoint";
         const std::string kSelectViewpoint = "selectViewpoint";
+        const std::string kLODEnabled = "lodEnabled";
+        const std::string kLODMaxScreenError = "lodMaxScreenError";
+
+        // Number of TLAS instance descs copied to the upload heap per worker task.
+        const size_t kInstanceDescCopyBatchSize = 4096;
+
+        // Writes TLAS instance descs to a CPU writable buffer on worker threads.
+        // The buffer memory is discarded first as the previous contents may still be read by frames in flight.
+        void uploadInstanceDescs(Buffer* pBuffer, const std::vector<RtInstanceDesc>& instanceDescs)
+        {
+            FALCOR_ASSERT(pBuffer->getSize() >= instanceDescs.size() * sizeof(RtInstanceDesc));
+            RtInstanceDesc* pDst = reinterpret_cast<RtInstanceDesc*>(pBuffer->map(Buffer::MapType::WriteDiscard));
+
+            auto range = NumericRange<size_t>(0, div_round_up(instanceDescs.size(), kInstanceDescCopyBatchSize));
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t batch)
+            {
+                const size_t first = batch * kInstanceDescCopyBatchSize;
+                const size_t count = std::min(kInstanceDescCopyBatchSize, instanceDescs.size() - first);
+                std::memcpy(pDst + first, instanceDescs.data() + first, count * sizeof(RtInstanceDesc));
+            });
+        }
 
         // Checks if the transform flips the coordinate system handedness (its determinant is negative).
         bool doesTransformFlip(const glm::mat4& m)
@@ -135,6 +158,21 @@ namespace Falcor
         mCurveIndexData = std::move(sceneData.curveIndexData);
         mCurveStaticData = std::move(sceneData.curveStaticData);
 
+        // Setup level of detail selection for all instances of geometries with simplified levels.
+        // The simplified geometries have no instances of their own, the instances of the full detail geometry are switched between them.
+        mMeshLODs = std::move(sceneData.meshLODs);
+        mCurveLODs = std::move(sceneData.curveLODs);
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
+        {
+            const auto& inst = mGeometryInstanceData[instanceID];
+            bool hasLODs = false;
+            if (inst.getType() == GeometryType::TriangleMesh) hasLODs = inst.geometryID < mMeshLODs.size() && !mMeshLODs[inst.geometryID].empty();
+            else if (inst.getType() == GeometryType::Curve) hasLODs = inst.geometryID < mCurveLODs.size() && !mCurveLODs[inst.geometryID].empty();
+            if (hasLODs) mLODInstances.push_back({ instanceID, inst.geometryID, 0 });
+        }
+        for (const auto& lods : mCurveLODs) mCurveLODCount += (uint32_t)lods.size();
+        if (!mMeshLODs.empty()) mMeshGroupIDs = getMeshBlasIDs();
+
         mSDFGrids = std::move(sceneData.sdfGrids);
         mSDFGridDesc = std::move(sceneData.sdfGridDesc);
         mSDFGridMaxLODCount = std::move(sceneData.sdfGridMaxLODCount);
@@ -156,10 +194,16 @@ namespace Falcor
         // Set default SDF grid config.
         setSDFGridConfig();
 
+        // Buffer data is uploaded in batches during scene construction.
+        mpUploadQueue = std::make_unique<SceneUploadQueue>();
+
         // Create vertex array objects for meshes and curves.
         createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshSkinningData);
         createCurveVao(mCurveIndexData, mCurveStaticData);
 
+        // Keep CPU copies of the static emissive mesh data for building the light collection.
+        retainEmissiveMeshData(sceneData.meshIndexData, sceneData.meshStaticData);
+
         // Create animation controller.
         mpAnimationController = AnimationController::create(this, sceneData.meshStaticData, sceneData.meshSkinningData, sceneData.prevVertexCount, sceneData.animations);
 
@@ -277,6 +321,10 @@ namespace Falcor
             mpLightCollection->setShaderData(mpSceneBlock["lightCollection"]);
 
             mSceneStats.emissiveMemoryInBytes = mpLightCollection->getMemoryUsageInBytes();
+
+            // The CPU copies of the emissive meshes are only needed again to rebuild animated mesh lights.
+            // Release them for static scenes, the light collection falls back to the GPU if a mesh is moved later.
+            if (!mpAnimationController->hasAnimations()) mEmissiveMeshData.clear();
         }
         return mpLightCollection;
     }
@@ -362,7 +410,8 @@ namespace Falcor
         if (ibSize > 0)
         {
             ResourceBindFlags ibBindFlags = Resource::BindFlags::Index | ResourceBindFlags::ShaderResource;
-            pIB = Buffer::create(ibSize, ibBindFlags, Buffer::CpuAccess::None, indexData.data());
+            pIB = Buffer::create(ibSize, ibBindFlags, Buffer::CpuAccess::None);
+            mpUploadQueue->upload(pIB, indexData.data(), 0, ibSize);
         }
 
         // Create the vertex data structured buffer.
@@ -378,6 +427,7 @@ namespace Falcor
         {
             ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex;
             pStaticBuffer = Buffer::createStructured(sizeof(PackedStaticVertexData), (uint32_t)vertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+            mpUploadQueue->upload(pStaticBuffer, staticData.data(), 0, staticVbSize);
         }
 
         Vao::BufferVec pVBs(kVertexBufferCount);
@@ -393,13 +443,15 @@ namespace Falcor
             FALCOR_ASSERT(drawCount <= (1 << 16));
             std::vector<uint16_t> drawIDs(drawCount);
             for (uint32_t i = 0; i < drawCount; i++) drawIDs[i] = i;
-            pDrawIDBuffer = Buffer::create(drawCount * sizeof(uint16_t), ResourceBindFlags::Vertex, Buffer::CpuAccess::None, drawIDs.data());
+            pDrawIDBuffer = Buffer::create(drawCount * sizeof(uint16_t), ResourceBindFlags::Vertex, Buffer::CpuAccess::None);
+            mpUploadQueue->uploadCopy(pDrawIDBuffer, drawIDs.data(), 0, drawCount * sizeof(uint16_t));
         }
         else if (drawIDFormat == ResourceFormat::R32Uint)
         {
             std::vector<uint32_t> drawIDs(drawCount);
             for (uint32_t i = 0; i < drawCount; i++) drawIDs[i] = i;
-            pDrawIDBuffer = Buffer::create(drawCount * sizeof(uint32_t), ResourceBindFlags::Vertex, Buffer::CpuAccess::None, drawIDs.data());
+            pDrawIDBuffer = Buffer::create(drawCount * sizeof(uint32_t), ResourceBindFlags::Vertex, Buffer::CpuAccess::None);
+            mpUploadQueue->uploadCopy(pDrawIDBuffer, drawIDs.data(), 0, drawCount * sizeof(uint32_t));
         }
         else FALCOR_UNREACHABLE();
 
@@ -445,7 +497,8 @@ namespace Falcor
         if (ibSize > 0)
         {
             ResourceBindFlags ibBindFlags = Resource::BindFlags::Index | ResourceBindFlags::ShaderResource;
-            pIB = Buffer::create(ibSize, ibBindFlags, Buffer::CpuAccess::None, indexData.data());
+            pIB = Buffer::create(ibSize, ibBindFlags, Buffer::CpuAccess::None);
+            mpUploadQueue->upload(pIB, indexData.data(), 0, ibSize);
         }
 
         // Create the vertex data as structured buffers.
@@ -458,7 +511,8 @@ namespace Falcor
 
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex;
         // Also upload the curve vertex data.
-        Buffer::SharedPtr pStaticBuffer = Buffer::createStructured(sizeof(StaticCurveVertexData), (uint32_t)vertexCount, vbBindFlags, Buffer::CpuAccess::None, staticData.data(), false);
+        Buffer::SharedPtr pStaticBuffer = Buffer::createStructured(sizeof(StaticCurveVertexData), (uint32_t)vertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+        mpUploadQueue->upload(pStaticBuffer, staticData.data(), 0, staticVbSize);
 
         // Curves do not need DrawIDBuffer.
         Vao::BufferVec pVBs(kVertexBufferCount - 1);
@@ -479,6 +533,52 @@ namespace Falcor
         mpCurveVao = Vao::create(Vao::Topology::LineStrip, pLayout, pVBs, pIB, ResourceFormat::R32Uint);
     }
 
+    void Scene::retainEmissiveMeshData(const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData)
+    {
+        mEmissiveMeshData.clear();
+
+        for (const auto& instance : mGeometryInstanceData)
+        {
+            if (instance.getType() != GeometryType::TriangleMesh) continue;
+            if (mEmissiveMeshData.find(instance.geometryID) != mEmissiveMeshData.end()) continue;
+
+            // Dynamic meshes are updated on the GPU, so a CPU copy would go stale.
+            const MeshDesc& mesh = mMeshDesc[instance.geometryID];
+            if (mesh.isDynamic()) continue;
+
+            auto pMaterial = mpMaterials->getMaterial(instance.materialID)->toBasicMaterial();
+            if (!pMaterial || !pMaterial->isEmissive()) continue;
+
+            EmissiveMeshData data;
+            FALCOR_ASSERT(mesh.vbOffset + mesh.vertexCount <= staticData.size());
+            data.vertices.assign(staticData.begin() + mesh.vbOffset, staticData.begin() + mesh.vbOffset + mesh.vertexCount);
+
+            if (mesh.indexCount > 0)
+            {
+                data.indices.resize(mesh.indexCount);
+                if (mesh.use16BitIndices())
+                {
+                    FALCOR_ASSERT(mesh.ibOffset + div_round_up(mesh.indexCount, 2u) <= indexData.size());
+                    const uint16_t* pIndices = reinterpret_cast<const uint16_t*>(indexData.data() + mesh.ibOffset);
+                    std::copy(pIndices, pIndices + mesh.indexCount, data.indices.begin());
+                }
+                else
+                {
+                    FALCOR_ASSERT(mesh.ibOffset + mesh.indexCount <= indexData.size());
+                    std::copy(indexData.begin() + mesh.ibOffset, indexData.begin() + mesh.ibOffset + mesh.indexCount, data.indices.begin());
+                }
+            }
+
+            mEmissiveMeshData.emplace(instance.geometryID, std::move(data));
+        }
+    }
+
+    const Scene::EmissiveMeshData* Scene::getEmissiveMeshData(uint32_t meshID) const
+    {
+        auto it = mEmissiveMeshData.find(meshID);
+        return it != mEmissiveMeshData.end() ? &it->second : nullptr;
+    }
+
     void Scene::setSDFGridConfig()
     {
         if (mSDFGrids.empty()) return;
@@ -634,8 +734,8 @@ namespace Falcor
         FALCOR_ASSERT(mpAnimationController);
 
         // Upload geometry.
-        if (!mMeshDesc.empty()) mpMeshesBuffer->setBlob(mMeshDesc.data(), 0, sizeof(MeshDesc) * mMeshDesc.size());
-        if (!mCurveDesc.empty()) mpCurvesBuffer->setBlob(mCurveDesc.data(), 0, sizeof(CurveDesc) * mCurveDesc.size());
+        if (!mMeshDesc.empty()) mpUploadQueue->upload(mpMeshesBuffer, mMeshDesc.data(), 0, sizeof(MeshDesc) * mMeshDesc.size());
+        if (!mCurveDesc.empty()) mpUploadQueue->upload(mpCurvesBuffer, mCurveDesc.data(), 0, sizeof(CurveDesc) * mCurveDesc.size());
 
         mpSceneBlock->setBuffer(kGeometryInstanceBufferName, mpGeometryInstancesBuffer);
         mpSceneBlock->setBuffer(kMeshBufferName, mpMeshesBuffer);
@@ -672,13 +772,34 @@ namespace Falcor
         getCamera()->setShaderData(mpSceneBlock[kCamera]);
     }
 
-    void Scene::updateBounds()
+    void Scene::createMatrixInstanceLists()
     {
-        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
-
-        mSceneBB = AABB();
+        const size_t matrixCount = mpAnimationController->getGlobalMatrices().size();
 
+        // Count the instances per matrix and compute the offset of each matrix's list.
+        mMatrixInstanceOffsets.assign(matrixCount + 1, 0);
         for (const auto& inst : mGeometryInstanceData)
+        {
+            FALCOR_ASSERT(inst.globalMatrixID < matrixCount);
+            mMatrixInstanceOffsets[inst.globalMatrixID + 1]++;
+        }
+        std::partial_sum(mMatrixInstanceOffsets.begin(), mMatrixInstanceOffsets.end(), mMatrixInstanceOffsets.begin());
+
+        // Distribute the instance IDs to the lists.
+        std::vector<uint32_t> listSizes(matrixCount, 0);
+        mMatrixInstanceIDs.resize(mGeometryInstanceData.size());
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
+        {
+            uint32_t matrixID = mGeometryInstanceData[instanceID].globalMatrixID;
+            mMatrixInstanceIDs[mMatrixInstanceOffsets[matrixID] + listSizes[matrixID]++] = instanceID;
+        }
+    }
+
+    Scene::UpdateFlags Scene::updateBounds(bool forceUpdate)
+    {
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        auto getInstanceBounds = [&](const GeometryInstanceData& inst)
         {
             const glm::mat4& transform = globalMatrices[inst.globalMatrixID];
             switch (inst.getType())
@@ -687,14 +808,12 @@ namespace Falcor
             case GeometryType::DisplacedTriangleMesh:
             {
                 const AABB& meshBB = mMeshBBs[inst.geometryID];
-                mSceneBB |= meshBB.transform(transform);
-                break;
+                return meshBB.transform(transform);
             }
             case GeometryType::Curve:
             {
                 const AABB& curveBB = mCurveBBs[inst.geometryID];
-                mSceneBB |= curveBB.transform(transform);
-                break;
+                return curveBB.transform(transform);
             }
             case GeometryType::SDFGrid:
             {
@@ -704,11 +823,28 @@ namespace Falcor
                 transform3x3[2] = glm::abs(transform3x3[2]);
                 float3 center = transform[3];
                 float3 halfExtent = transform3x3 * float3(0.5f);
-                mSceneBB |= AABB(center - halfExtent, center + halfExtent);
-                break;
+                return AABB(center - halfExtent, center + halfExtent);
             }
+            default:
+                return AABB();
             }
+        };
+
+        // When only some instances moved, just their bounds and the tree nodes on their paths to the root are refit.
+        const size_t instanceCount = mGeometryInstanceData.size();
+        auto getBounds = [&](uint32_t instanceID) { return getInstanceBounds(mGeometryInstanceData[instanceID]); };
+
+        if (forceUpdate || mInstanceBoundsTree.getInstanceCount() != instanceCount)
+        {
+            mInstanceBoundsTree.build(instanceCount, getBounds);
         }
+        else
+        {
+            mInstanceBoundsTree.update(mMovedInstanceIDs, getBounds);
+        }
+
+        const AABB prevSceneBB = mSceneBB;
+        mSceneBB = mInstanceBoundsTree.getBounds();
 
         for (const auto& aabb : mCustomPrimitiveAABBs)
         {
@@ -719,38 +855,50 @@ namespace Falcor
         {
             mSceneBB |= pGridVolume->getBounds();
         }
+
+        return mSceneBB != prevSceneBB ? UpdateFlags::SceneBoundsChanged : UpdateFlags::None;
     }
 
     void Scene::updateGeometryInstances(bool forceUpdate)
     {
         if (mGeometryInstanceData.empty()) return;
 
-        bool dataChanged = false;
         const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-        for (auto& inst : mGeometryInstanceData)
+        // Updates the winding flags of an instance and returns true if they changed.
+        auto updateInstanceFlags = [&](GeometryInstanceData& inst)
         {
-            if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
-            {
-                uint32_t prevFlags = inst.flags;
+            if (inst.getType() != GeometryType::TriangleMesh && inst.getType() != GeometryType::DisplacedTriangleMesh) return false;
 
-                FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
-                const glm::mat4& transform = globalMatrices[inst.globalMatrixID];
-                bool isTransformFlipped = doesTransformFlip(transform);
-                bool isObjectFrontFaceCW = getMesh(inst.geometryID).isFrontFaceCW();
-                bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+            uint32_t prevFlags = inst.flags;
 
-                if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
+            FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
+            const glm::mat4& transform = globalMatrices[inst.globalMatrixID];
+            bool isTransformFlipped = doesTransformFlip(transform);
+            bool isObjectFrontFaceCW = getMesh(inst.geometryID).isFrontFaceCW();
+            bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
 
-                if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+            if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
+            else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
 
-                if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+            if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+            else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
 
-                dataChanged |= (inst.flags != prevFlags);
-            }
+            if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+            else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+
+            return inst.flags != prevFlags;
+        };
+
+        bool dataChanged = false;
+
+        if (forceUpdate)
+        {
+            for (auto& inst : mGeometryInstanceData) dataChanged |= updateInstanceFlags(inst);
+        }
+        else
+        {
+            for (uint32_t instanceID : mMovedInstanceIDs) dataChanged |= updateInstanceFlags(mGeometryInstanceData[instanceID]);
         }
 
         if (forceUpdate || dataChanged)
@@ -1040,11 +1188,13 @@ namespace Falcor
         initSDFGrids();
         mHitInfo.init(*this, mUseCompressedHitInfo);
         initResources(); // Requires scene defines
+        mpUploadQueue->flush(gpDevice->getRenderContext()); // Vertex data must be uploaded before animating
         mpAnimationController->animate(gpDevice->getRenderContext(), 0); // Requires Scene block to exist
         updateGeometry(true); // Requires scene defines
+        createMatrixInstanceLists();
         updateGeometryInstances(true);
 
-        updateBounds();
+        updateBounds(true);
         createDrawList();
         if (mCameras.size() == 0)
         {
@@ -1061,6 +1211,18 @@ namespace Falcor
         updateEnvMap(true);
         updateMaterials(true);
         uploadResources(); // Upload data after initialization is complete
+        mpUploadQueue->flush(gpDevice->getRenderContext());
+
+        // Record load telemetry. The upload queue is only used during construction.
+        const auto& uploadStats = mpUploadQueue->getStats();
+        mSceneStats.loadUploadCount = uploadStats.uploadCount;
+        mSceneStats.loadUploadCopyCount = uploadStats.copyCount;
+        mSceneStats.loadUploadedBytes = uploadStats.bytesUploaded;
+        mSceneStats.loadUploadStagingTime = uploadStats.stagingTime;
+        mSceneStats.loadUploadStallTime = uploadStats.stallTime;
+        logInfo("Scene upload: {} uploads in {} copies, {} uploaded, {:.3f} s staging, {:.3f} s stalled.",
+            uploadStats.uploadCount, uploadStats.copyCount, formatByteSize(uploadStats.bytesUploaded), uploadStats.stagingTime, uploadStats.stallTime);
+        mpUploadQueue.reset();
 
         updateGeometryStats();
         updateMaterialStats();
@@ -1314,11 +1476,13 @@ namespace Falcor
         s.gridVolumeMemoryInBytes = mpGridVolumesBuffer ? mpGridVolumesBuffer->getSize() : 0;
 
         s.gridCount = mGrids.size();
+        s.gridResidentCount = 0;
         s.gridVoxelCount = 0;
         s.gridMemoryInBytes = 0;
 
         for (const auto& pGrid : mGrids)
         {
+            if (pGrid->isResident()) s.gridResidentCount++;
             s.gridVoxelCount += pGrid->getVoxelCount();
             s.gridMemoryInBytes += pGrid->getGridSizeInBytes();
         }
@@ -1447,6 +1611,20 @@ namespace Falcor
                 mGrids[i]->setShaderData(var[i]);
             }
         }
+        else if (is_set(combinedUpdates, GridVolume::UpdateFlags::ResidencyChanged))
+        {
+            // Rebind streamed grids that were made resident or evicted.
+            auto var = mpSceneBlock["grids"];
+            for (const auto& pGridVolume : mGridVolumes)
+            {
+                for (const auto& pGrid : pGridVolume->getResidencyChanges())
+                {
+                    auto it = mGridIDs.find(pGrid);
+                    if (it != mGridIDs.end()) pGrid->setShaderData(var[it->second]);
+                }
+            }
+            updateGridVolumeStats();
+        }
 
         // Upload volumes and clear updates.
         uint32_t volumeIndex = 0;
@@ -1455,12 +1633,14 @@ namespace Falcor
             if (forceUpdate || pGridVolume->getUpdates() != GridVolume::UpdateFlags::None)
             {
                 // Fetch copy of volume data.
+                // Streamed grids that have not been resident yet are not bound.
                 auto data = pGridVolume->getData();
-                data.densityGrid = pGridVolume->getDensityGrid() ? mGridIDs.at(pGridVolume->getDensityGrid()) : kInvalidGrid;
-                data.emissionGrid = pGridVolume->getEmissionGrid() ? mGridIDs.at(pGridVolume->getEmissionGrid()) : kInvalidGrid;
-                // Merge grid and volume transforms.
                 const auto& densityGrid = pGridVolume->getDensityGrid();
-                if (densityGrid)
+                const auto& emissionGrid = pGridVolume->getEmissionGrid();
+                data.densityGrid = densityGrid && densityGrid->isResident() ? mGridIDs.at(densityGrid) : kInvalidGrid;
+                data.emissionGrid = emissionGrid && emissionGrid->isResident() ? mGridIDs.at(emissionGrid) : kInvalidGrid;
+                // Merge grid and volume transforms.
+                if (data.densityGrid != kInvalidGrid)
                 {
                     data.transform = data.transform * densityGrid->getTransform();
                     data.invTransform = densityGrid->getInvTransform() * data.invTransform;
@@ -1557,19 +1737,21 @@ namespace Falcor
         if (mUpdateCallback) mUpdateCallback(shared_from_this(), currentTime);
 
         mUpdates = UpdateFlags::None;
+        mMovedInstanceIDs.clear();
 
         if (mpAnimationController->animate(pContext, currentTime))
         {
             mUpdates |= UpdateFlags::SceneGraphChanged;
             if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= UpdateFlags::MeshesChanged;
 
-            for (const auto& inst : mGeometryInstanceData)
+            // Gather the geometry instances transformed by the changed matrices.
+            for (uint32_t matrixID : mpAnimationController->getChangedMatrixIDs())
             {
-                if (mpAnimationController->isMatrixChanged(inst.globalMatrixID))
-                {
-                    mUpdates |= UpdateFlags::GeometryMoved;
-                }
+                auto first = mMatrixInstanceIDs.begin() + mMatrixInstanceOffsets[matrixID];
+                auto last = mMatrixInstanceIDs.begin() + mMatrixInstanceOffsets[matrixID + 1];
+                mMovedInstanceIDs.insert(mMovedInstanceIDs.end(), first, last);
             }
+            if (!mMovedInstanceIDs.empty()) mUpdates |= UpdateFlags::GeometryMoved;
 
             // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
             if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= UpdateFlags::CurvesMoved;
@@ -1581,19 +1763,31 @@ namespace Falcor
             pGridVolume->updatePlayback(currentTime);
         }
 
-        mUpdates |= updateSelectedCamera(false);
+        mUpdateCamera.index = mSelectedCamera;
+        mUpdateCamera.updates = updateSelectedCamera(false);
+        mUpdates |= mUpdateCamera.updates;
         mUpdates |= updateLights(false);
         mUpdates |= updateGridVolumes(false);
         mUpdates |= updateEnvMap(false);
         mUpdates |= updateMaterials(false);
         mUpdates |= updateGeometry(false);
         mUpdates |= updateSDFGrids(pContext);
+        mUpdates |= updateLODs(false);
         pContext->flush();
 
         if (is_set(mUpdates, UpdateFlags::GeometryMoved))
         {
-            invalidateTlasCache();
+            // Record which global matrices changed so that the cached TLAS instance descs can be updated incrementally.
+            mMatrixUpdateIDs.resize(mpAnimationController->getGlobalMatrices().size(), 0);
+            mTransformUpdateID++;
+            for (uint32_t matrixID : mpAnimationController->getChangedMatrixIDs())
+            {
+                mMatrixUpdateIDs[matrixID] = mTransformUpdateID;
+            }
+
+            invalidateTlasCache(true);
             updateGeometryInstances(false);
+            mUpdates |= updateBounds(false);
         }
 
         // Update existing BLASes if skinned animation and/or procedural primitives moved.
@@ -1602,10 +1796,17 @@ namespace Falcor
 
         if (mBlasDataValid && blasUpdateRequired)
         {
-            invalidateTlasCache();
+            // BLASes are updated in place, so the instance descs remain valid unless buildBlas() does a full rebuild.
+            invalidateTlasCache(true);
             buildBlas(pContext);
         }
 
+        // Build the BLASes needed by the selected levels of detail.
+        if (mBlasDataValid && is_set(mUpdates, UpdateFlags::LODsChanged))
+        {
+            updateLODBlases(pContext);
+        }
+
         // Update light collection
         if (mpLightCollection && mpLightCollection->update(pContext))
         {
@@ -1733,6 +1934,22 @@ namespace Falcor
             renderSettingsGroup.tooltip("This enables rendering of grid volumes.", true);
         }
 
+        if (hasLODs())
+        {
+            if (auto lodGroup = widget.group("Level of Detail"))
+            {
+                bool enabled = mLODEnabled;
+                if (lodGroup.checkbox("Enable", enabled)) setLODEnabled(enabled);
+
+                float maxScreenError = mLODMaxScreenError;
+                if (lodGroup.var("Max screen error", maxScreenError, 0.f, 1.f, 0.0001f)) setLODMaxScreenError(maxScreenError);
+                lodGroup.tooltip("Maximum geometric error of a selected level of detail, as a fraction of the viewport height.", true);
+
+                size_t simplifiedCount = std::count_if(mLODInstances.begin(), mLODInstances.end(), [](const auto& lodInstance) { return lodInstance.level > 0; });
+                lodGroup.text(fmt::format("Instances using simplified geometry: {} of {}", simplifiedCount, mLODInstances.size()));
+            }
+        }
+
         if (mSDFGridConfig.implementation != SDFGrid::Type::None)
         {
             if (auto sdfGridConfigGroup = widget.group("SDF Grid Settings"))
@@ -1924,10 +2141,20 @@ namespace Falcor
             // Grid stats.
             oss << "Grid stats:" << std::endl
                 << "  Grid count: " << s.gridCount << std::endl
+                << "  Grid resident count: " << s.gridResidentCount << std::endl
                 << "  Grid voxel count: " << s.gridVoxelCount << std::endl
                 << "  Grid memory: " << formatByteSize(s.gridMemoryInBytes) << std::endl
                 << std::endl;
 
+            // Load stats.
+            oss << "Load stats:" << std::endl
+                << "  Buffer uploads: " << s.loadUploadCount << std::endl
+                << "  Buffer upload copies: " << s.loadUploadCopyCount << std::endl
+                << "  Uploaded memory: " << formatByteSize(s.loadUploadedBytes) << std::endl
+                << "  Upload staging time: " << std::fixed << std::setprecision(3) << s.loadUploadStagingTime << " s" << std::endl
+                << "  Upload stall time: " << std::fixed << std::setprecision(3) << s.loadUploadStallTime << " s" << std::endl
+                << std::endl;
+
             if (statsGroup.button("Print to log")) logInfo("\n" + oss.str());
 
             statsGroup.text(oss.str());
@@ -1989,6 +2216,36 @@ namespace Falcor
         setCameraController(mCamCtrlType);
     }
 
+    void Scene::setFrameCamera(const Camera::SharedPtr& pCamera)
+    {
+        auto it = std::find(mCameras.begin(), mCameras.end(), pCamera);
+        if (it == mCameras.end()) throw ArgumentError("Camera '{}' does not exist in the scene.", pCamera ? pCamera->getName() : "");
+        const uint32_t index = (uint32_t)std::distance(mCameras.begin(), it);
+
+        // Replace the camera changes of the frame by the changes of the new camera.
+        // The camera selected during update() was already animated and its changes are restored when switching back to it.
+        const UpdateFlags cameraFlags = UpdateFlags::CameraMoved | UpdateFlags::CameraPropertiesChanged | UpdateFlags::CameraSwitched;
+        mUpdates &= ~cameraFlags;
+
+        if (index == mUpdateCamera.index)
+        {
+            mUpdates |= mUpdateCamera.updates;
+        }
+        else
+        {
+            const auto& camera = mCameras[index];
+            if (camera->hasAnimation() && camera->isAnimated()) updateAnimatable(*camera, *mpAnimationController);
+
+            auto cameraChanges = camera->beginFrame();
+            if (is_set(cameraChanges, Camera::Changes::Movement)) mUpdates |= UpdateFlags::CameraMoved;
+            if ((cameraChanges & (~Camera::Changes::Movement)) != Camera::Changes::None) mUpdates |= UpdateFlags::CameraPropertiesChanged;
+        }
+
+        // The camera controller stays attached to the camera selected during update().
+        mSelectedCamera = index;
+        uploadSelectedCamera();
+    }
+
     void Scene::resetCamera(bool resetDepthRange)
     {
         auto camera = getCamera();
@@ -2294,6 +2551,114 @@ namespace Falcor
         mBlasUpdateMode = mode;
     }
 
+    void Scene::setLODEnabled(bool enabled)
+    {
+        if (enabled != mLODEnabled) mLODSettingsChanged = true;
+        mLODEnabled = enabled;
+    }
+
+    void Scene::setLODMaxScreenError(float maxScreenError)
+    {
+        maxScreenError = std::max(maxScreenError, 0.f);
+        if (maxScreenError != mLODMaxScreenError) mLODSettingsChanged = true;
+        mLODMaxScreenError = maxScreenError;
+    }
+
+    Scene::UpdateFlags Scene::updateLODs(bool forceUpdate)
+    {
+        // This function selects the level of detail to use for each instance of a geometry with simplified levels.
+        // The selection is based on the geometric error of each level projected to the screen at the distance
+        // of the instance bounds from the camera. The coarsest level with a small enough error is selected.
+        if (mLODInstances.empty()) return UpdateFlags::None;
+
+        bool selectionRequired = forceUpdate || mLODSettingsChanged ||
+            is_set(mUpdates, UpdateFlags::CameraMoved) ||
+            is_set(mUpdates, UpdateFlags::CameraPropertiesChanged) ||
+            is_set(mUpdates, UpdateFlags::CameraSwitched) ||
+            is_set(mUpdates, UpdateFlags::SceneGraphChanged);
+        if (!selectionRequired) return UpdateFlags::None;
+        mLODSettingsChanged = false;
+
+        const auto& pCamera = mCameras[mSelectedCamera];
+        const float3 cameraPos = pCamera->getPosition();
+        const float projScale = 0.5f * pCamera->getProjMatrix()[1][1]; // Converts a size at unit distance to a fraction of the viewport height.
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        std::vector<uint32_t> levels(mLODInstances.size(), 0);
+        if (mLODEnabled && mLODMaxScreenError > 0.f)
+        {
+            auto range = NumericRange<uint32_t>(0, (uint32_t)mLODInstances.size());
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
+            {
+                const auto& lodInstance = mLODInstances[i];
+                const auto& inst = mGeometryInstanceData[lodInstance.instanceID];
+                const bool isCurve = inst.getType() == GeometryType::Curve;
+                const auto& lods = isCurve ? mCurveLODs[lodInstance.baseGeometryID] : mMeshLODs[lodInstance.baseGeometryID];
+                const AABB& bounds = isCurve ? mCurveBBs[lodInstance.baseGeometryID] : mMeshBBs[lodInstance.baseGeometryID];
+                const glm::mat4& transform = globalMatrices[inst.globalMatrixID];
+
+                // Use full detail if the camera is inside the instance bounds.
+                AABB worldBounds = bounds.transform(transform);
+                float3 delta = glm::max(glm::max(worldBounds.minPoint - cameraPos, cameraPos - worldBounds.maxPoint), float3(0.f));
+                float distance = glm::length(delta);
+                if (distance <= 0.f) return;
+
+                // Convert the screen error bound to an object space error bound for this instance.
+                float scale = std::max({ glm::length(float3(transform[0])), glm::length(float3(transform[1])), glm::length(float3(transform[2])) });
+                float maxError = mLODMaxScreenError * distance / (projScale * scale);
+
+                // Levels are ordered by increasing error.
+                uint32_t level = 0;
+                while (level < lods.size() && lods[level].error <= maxError) level++;
+                levels[i] = level;
+            });
+        }
+
+        // Switch the instances to their selected geometry.
+        bool meshesChanged = false;
+        bool curvesChanged = false;
+        for (size_t i = 0; i < mLODInstances.size(); i++)
+        {
+            auto& lodInstance = mLODInstances[i];
+            if (levels[i] == lodInstance.level) continue;
+            lodInstance.level = levels[i];
+
+            auto& inst = mGeometryInstanceData[lodInstance.instanceID];
+            if (inst.getType() == GeometryType::Curve)
+            {
+                uint32_t curveID = lodInstance.level == 0 ? lodInstance.baseGeometryID : mCurveLODs[lodInstance.baseGeometryID][lodInstance.level - 1].geometryID;
+                const auto& curve = mCurveDesc[curveID];
+                inst.geometryID = curveID;
+                inst.vbOffset = curve.vbOffset;
+                inst.ibOffset = curve.ibOffset;
+                curvesChanged = true;
+            }
+            else
+            {
+                uint32_t meshID = lodInstance.level == 0 ? lodInstance.baseGeometryID : mMeshLODs[lodInstance.baseGeometryID][lodInstance.level - 1].geometryID;
+                const auto& mesh = mMeshDesc[meshID];
+                inst.geometryID = meshID;
+                inst.vbOffset = mesh.vbOffset;
+                inst.ibOffset = mesh.ibOffset;
+                if (mesh.use16BitIndices()) inst.flags |= (uint32_t)GeometryInstanceFlags::Use16BitIndices;
+                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::Use16BitIndices;
+                meshesChanged = true;
+            }
+        }
+
+        if (!meshesChanged && !curvesChanged) return UpdateFlags::None;
+
+        updateGeometryInstances(true);
+        if (meshesChanged) createDrawList();
+
+        // Simplified meshes have their own BLASes, so switching meshes only requires a new TLAS.
+        // The BLASes of newly selected levels and the curve BLAS are rebuilt by updateLODBlases().
+        if (curvesChanged) mCurveLODsChanged = true;
+        invalidateTlasCache();
+
+        return UpdateFlags::LODsChanged;
+    }
+
     void Scene::createDrawList()
     {
         // This function creates argument buffers for draw indirect calls to rasterize the scene.
@@ -2435,6 +2800,7 @@ namespace Falcor
                 auto& geomDescs = blas.geomDescs;
                 geomDescs.resize(meshList.size());
                 blas.hasProceduralPrimitives = false;
+                blas.isLODLevel = meshList.size() == 1 && mMeshIdToInstanceIds[meshList[0]].empty();
 
                 // Track what types of triangle winding exist in the final BLAS.
                 // The SceneBuilder should have ensured winding is consistent, but keeping the check here as a safeguard.
@@ -2556,26 +2922,16 @@ namespace Falcor
         {
             FALCOR_ASSERT(mpRtAABBBuffer && mpRtAABBBuffer->getElementCount() >= mRtAABBRaw.size());
 
+            // Simplified curves are stored after the full detail curves and have no geometry of their own in the BLAS.
+            // Each full detail curve geometry references the AABBs of the level of detail selected for its instance, see setCurveGeomDescs().
             auto& blas = mBlasData[blasDataIndex++];
-            blas.geomDescs.resize(mCurveDesc.size());
+            blas.geomDescs.resize(mCurveDesc.size() - mCurveLODCount);
             blas.hasProceduralPrimitives = true;
             blas.hasDynamicCurve |= mpAnimationController->hasAnimatedCurveCaches();
+            blas.hasCurveLODs = mCurveLODCount > 0;
+            setCurveGeomDescs(true);
 
-            uint32_t geomIndexOffset = 0;
-
-            for (const auto& curve : mCurveDesc)
-            {
-                // One geometry desc per curve.
-                RtGeometryDesc& desc = blas.geomDescs[geomIndexOffset++];
-
-                desc.type = RtGeometryType::ProcedurePrimitives;
-                desc.flags = RtGeometryFlags::Opaque;
-                desc.content.proceduralAABBs.count = curve.indexCount;
-                desc.content.proceduralAABBs.data = mpRtAABBBuffer->getGpuAddress() + bbAddressOffset;
-                desc.content.proceduralAABBs.stride = sizeof(RtAABB);
-
-                bbAddressOffset += sizeof(RtAABB) * curve.indexCount;
-            }
+            for (const auto& curve : mCurveDesc) bbAddressOffset += sizeof(RtAABB) * curve.indexCount;
         }
 
         if (!mSDFGrids.empty())
@@ -2649,13 +3005,56 @@ namespace Falcor
         }
 
         // Verify that the total geometry count matches the expectation.
-        size_t totalGeometries = 0;
+        // Simplified curves are not geometries in the curve BLAS, see above.
+        size_t totalGeometries = mCurveLODCount;
         for (const auto& blas : mBlasData) totalGeometries += blas.geomDescs.size();
         if (totalGeometries != getGeometryCount()) throw RuntimeError("Total geometry count mismatch");
 
         mBlasDataValid = true;
     }
 
+    void Scene::setCurveGeomDescs(bool useSelectedLODs)
+    {
+        // The curve BLAS is placed after the mesh group BLASes.
+        // The AABBs of all curves, including the simplified ones, are stored first in the AABB buffer, ordered by curve ID.
+        FALCOR_ASSERT(!mCurveDesc.empty() && mBlasData.size() > mMeshGroups.size());
+        auto& blas = mBlasData[mMeshGroups.size()];
+        const size_t baseCurveCount = mCurveDesc.size() - mCurveLODCount;
+        FALCOR_ASSERT(blas.geomDescs.size() == baseCurveCount);
+
+        std::vector<uint32_t> selectedCurves(baseCurveCount);
+        std::iota(selectedCurves.begin(), selectedCurves.end(), 0);
+        if (useSelectedLODs)
+        {
+            for (const auto& inst : mGeometryInstanceData)
+            {
+                if (inst.getType() == GeometryType::Curve) selectedCurves[inst.geometryIndex] = inst.geometryID;
+            }
+        }
+
+        std::vector<uint64_t> curveAABBOffsets(mCurveDesc.size());
+        uint64_t bbAddressOffset = 0;
+        for (size_t curveID = 0; curveID < mCurveDesc.size(); curveID++)
+        {
+            curveAABBOffsets[curveID] = bbAddressOffset;
+            bbAddressOffset += sizeof(RtAABB) * mCurveDesc[curveID].indexCount;
+        }
+
+        for (size_t geomIndex = 0; geomIndex < baseCurveCount; geomIndex++)
+        {
+            // One geometry desc per curve.
+            const uint32_t curveID = selectedCurves[geomIndex];
+            const auto& curve = mCurveDesc[curveID];
+            RtGeometryDesc& desc = blas.geomDescs[geomIndex];
+
+            desc.type = RtGeometryType::ProcedurePrimitives;
+            desc.flags = RtGeometryFlags::Opaque;
+            desc.content.proceduralAABBs.count = curve.indexCount;
+            desc.content.proceduralAABBs.data = mpRtAABBBuffer->getGpuAddress() + curveAABBOffsets[curveID];
+            desc.content.proceduralAABBs.stride = sizeof(RtAABB);
+        }
+    }
+
     void Scene::preparePrebuildInfo(RenderContext* pContext)
     {
         for (auto& blas : mBlasData)
@@ -2665,8 +3064,9 @@ namespace Falcor
             // For all other BLASes, compaction just adds overhead.
             // TODO: Add compaction on/off switch for profiling.
             // TODO: Disable compaction for skinned meshes if update performance becomes a problem.
+            // The curve BLAS with levels of detail is not compacted, as it is rebuilt in place with a varying number of AABBs.
             blas.updateMode = mBlasUpdateMode;
-            blas.useCompaction = (!blas.hasDynamicGeometry()) || blas.updateMode != UpdateMode::Rebuild;
+            blas.useCompaction = !blas.hasCurveLODs && ((!blas.hasDynamicGeometry()) || blas.updateMode != UpdateMode::Rebuild);
 
             // Setup build parameters.
             RtAccelerationStructureBuildInputs& inputs = blas.buildInputs;
@@ -2709,12 +3109,12 @@ namespace Falcor
         }
     }
 
-    void Scene::computeBlasGroups()
+    void Scene::computeBlasGroups(const std::vector<uint32_t>& blasIDs)
     {
-        mBlasGroups.clear();
+        const size_t firstGroupIndex = mBlasGroups.size();
         uint64_t groupSize = 0;
 
-        for (uint32_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        for (uint32_t blasId : blasIDs)
         {
             auto& blas = mBlasData[blasId];
             size_t blasSize = blas.resultByteSize + blas.scratchByteSize;
@@ -2744,9 +3144,9 @@ namespace Falcor
         // Validation that all offsets and sizes are correct.
         uint64_t totalResultSize = 0;
         uint64_t totalScratchSize = 0;
-        std::set<uint32_t> blasIDs;
+        std::set<uint32_t> groupedBlasIDs;
 
-        for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
+        for (size_t blasGroupIndex = firstGroupIndex; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
         {
             uint64_t resultSize = 0;
             uint64_t scratchSize = 0;
@@ -2759,7 +3159,7 @@ namespace Falcor
                 FALCOR_ASSERT(blasId < mBlasData.size());
                 const auto& blas = mBlasData[blasId];
 
-                FALCOR_ASSERT(blasIDs.insert(blasId).second);
+                FALCOR_ASSERT(groupedBlasIDs.insert(blasId).second);
                 FALCOR_ASSERT(blas.blasGroupIndex == blasGroupIndex);
 
                 FALCOR_ASSERT(blas.resultByteSize > 0);
@@ -2777,7 +3177,7 @@ namespace Falcor
             FALCOR_ASSERT(resultSize == group.resultByteSize);
             FALCOR_ASSERT(scratchSize == group.scratchByteSize);
         }
-        FALCOR_ASSERT(blasIDs.size() == mBlasData.size());
+        FALCOR_ASSERT(groupedBlasIDs.size() == blasIDs.size());
     }
 
     void Scene::buildBlas(RenderContext* pContext)
@@ -2855,184 +3255,26 @@ namespace Falcor
 
                 // Compute pre-build info per BLAS and organize the BLASes into groups
                 // in order to limit GPU memory usage during BLAS build.
+                // The curve BLAS is sized for the full detail curves, so that it can be rebuilt in place for any selection of curve levels of detail.
+                if (!mCurveDesc.empty()) setCurveGeomDescs(false);
                 preparePrebuildInfo(pContext);
-                computeBlasGroups();
+                if (!mCurveDesc.empty()) setCurveGeomDescs(true);
+                mCurveLODsChanged = false;
 
-                logInfo("BLAS build split into {} groups", mBlasGroups.size());
-
-                // Compute the required maximum size of the result and scratch buffers.
-                uint64_t resultByteSize = 0;
-                uint64_t scratchByteSize = 0;
-                size_t maxBlasCount = 0;
-
-                for (const auto& group : mBlasGroups)
-                {
-                    resultByteSize = std::max(resultByteSize, group.resultByteSize);
-                    scratchByteSize = std::max(scratchByteSize, group.scratchByteSize);
-                    maxBlasCount = std::max(maxBlasCount, group.blasIndices.size());
-                }
-                FALCOR_ASSERT(resultByteSize > 0 && scratchByteSize > 0);
-
-                logInfo("BLAS build result buffer size: {}", formatByteSize(resultByteSize));
-                logInfo("BLAS build scratch buffer size: {}", formatByteSize(scratchByteSize));
-
-                // Allocate result and scratch buffers.
-                // The scratch buffer we'll retain because it's needed for subsequent rebuilds and updates.
-                // TODO: Save memory by reducing the scratch buffer to the minimum required for the dynamic objects.
-                if (mpBlasScratch == nullptr || mpBlasScratch->getSize() < scratchByteSize)
+                // BLASes of simplified mesh levels of detail are only built once an instance selects them, see updateLODBlases().
+                for (auto& blas : mBlasData)
                 {
-                    mpBlasScratch = Buffer::create(scratchByteSize, Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
-                    mpBlasScratch->setName("Scene::mpBlasScratch");
+                    blas.blasByteOffset = 0;
+                    blas.blasByteSize = 0;
                 }
-
-                Buffer::SharedPtr pResultBuffer = Buffer::create(resultByteSize, Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
-                FALCOR_ASSERT(pResultBuffer && mpBlasScratch);
-
-                // Create post-build info pool for readback.
-                RtAccelerationStructurePostBuildInfoPool::Desc compactedSizeInfoPoolDesc;
-                compactedSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CompactedSize;
-                compactedSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
-                RtAccelerationStructurePostBuildInfoPool::SharedPtr compactedSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(compactedSizeInfoPoolDesc);
-
-                RtAccelerationStructurePostBuildInfoPool::Desc currentSizeInfoPoolDesc;
-                currentSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CurrentSize;
-                currentSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
-                RtAccelerationStructurePostBuildInfoPool::SharedPtr currentSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(currentSizeInfoPoolDesc);
-
-                bool hasDynamicGeometry = false;
-                bool hasProceduralPrimitives = false;
-
+                mBlasGroups.clear();
+                mBlasObjects.clear();
                 mBlasObjects.resize(mBlasData.size());
+                computeBlasGroups(getRequiredBlasIDs());
 
-                // Iterate over BLAS groups. For each group build and compact all BLASes.
-                for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
-                {
-                    auto& group = mBlasGroups[blasGroupIndex];
-
-                    // Allocate array to hold intermediate blases for the group.
-                    std::vector<RtAccelerationStructure::SharedPtr> intermediateBlases(group.blasIndices.size());
-
-                    // Insert barriers. The buffers are now ready to be written.
-                    pContext->uavBarrier(pResultBuffer.get());
-                    pContext->uavBarrier(mpBlasScratch.get());
-
-                    // Reset the post-build info pools to receive new info.
-                    compactedSizeInfoPool->reset(pContext);
-                    currentSizeInfoPool->reset(pContext);
-
-                    // Build the BLASes into the intermediate result buffer.
-                    // We output post-build info in order to find out the final size requirements.
-                    for (size_t i = 0; i < group.blasIndices.size(); ++i)
-                    {
-                        const uint32_t blasId = group.blasIndices[i];
-                        const auto& blas = mBlasData[blasId];
-
-                        hasDynamicGeometry |= blas.hasDynamicGeometry();
-                        hasProceduralPrimitives |= blas.hasProceduralPrimitives;
-
-                        RtAccelerationStructure::Desc createDesc = {};
-                        createDesc.setBuffer(pResultBuffer, blas.resultByteOffset, blas.resultByteSize);
-                        createDesc.setKind(RtAccelerationStructureKind::BottomLevel);
-                        auto blasObject = RtAccelerationStructure::create(createDesc);
-                        intermediateBlases[i] = blasObject;
-
-                        RtAccelerationStructure::BuildDesc asDesc = {};
-                        asDesc.inputs = blas.buildInputs;
-                        asDesc.scratchData = mpBlasScratch->getGpuAddress() + blas.scratchByteOffset;
-                        asDesc.dest = blasObject.get();
-
-                        // Need to find out the post-build compacted BLAS size to know the final allocation size.
-                        RtAccelerationStructurePostBuildInfoDesc postbuildInfoDesc = {};
-                        if (blas.useCompaction)
-                        {
-                            postbuildInfoDesc.type = RtAccelerationStructurePostBuildInfoQueryType::CompactedSize;
-                            postbuildInfoDesc.index = (uint32_t)i;
-                            postbuildInfoDesc.pool = compactedSizeInfoPool.get();
-                        }
-                        else
-                        {
-                            postbuildInfoDesc.type = RtAccelerationStructurePostBuildInfoQueryType::CurrentSize;
-                            postbuildInfoDesc.index = (uint32_t)i;
-                            postbuildInfoDesc.pool = currentSizeInfoPool.get();
-                        }
-
-                        pContext->buildAccelerationStructure(asDesc, 1, &postbuildInfoDesc);
-                    }
-
-                    // Read back the calculated final size requirements for each BLAS.
-
-                    group.finalByteSize = 0;
-                    for (size_t i = 0; i < group.blasIndices.size(); i++)
-                    {
-                        const uint32_t blasId = group.blasIndices[i];
-                        auto& blas = mBlasData[blasId];
-
-                        // Check the size. Upon failure a zero size may be reported.
-                        uint64_t byteSize = 0;
-                        if (blas.useCompaction)
-                        {
-                            byteSize = compactedSizeInfoPool->getElement(pContext, (uint32_t)i);
-                        }
-                        else
-                        {
-                            byteSize = currentSizeInfoPool->getElement(pContext, (uint32_t)i);
-                            // For platforms that does not support current size query, use prebuild size.
-                            if (byteSize == 0)
-                            {
-                                byteSize = blas.prebuildInfo.resultDataMaxSize;
-                            }
-                        }
-                        FALCOR_ASSERT(byteSize <= blas.prebuildInfo.resultDataMaxSize);
-                        if (byteSize == 0) throw RuntimeError("Acceleration structure build failed for BLAS index {}", blasId);
-
-                        blas.blasByteSize = align_to(kAccelerationStructureByteAlignment, byteSize);
-                        blas.blasByteOffset = group.finalByteSize;
-                        group.finalByteSize += blas.blasByteSize;
-                    }
-                    FALCOR_ASSERT(group.finalByteSize > 0);
-
-                    logInfo("BLAS group " + std::to_string(blasGroupIndex) + " final size: " + formatByteSize(group.finalByteSize));
-
-                    // Allocate final BLAS buffer.
-                    auto& pBlas = group.pBlas;
-                    if (pBlas == nullptr || pBlas->getSize() < group.finalByteSize)
-                    {
-                        pBlas = Buffer::create(group.finalByteSize, Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
-                        pBlas->setName("Scene::mBlasGroups[" + std::to_string(blasGroupIndex) + "].pBlas");
-                    }
-                    else
-                    {
-                        // If we didn't need to reallocate, just insert a barrier so it's safe to use.
-                        pContext->uavBarrier(pBlas.get());
-                    }
-
-                    // Insert barrier. The result buffer is now ready to be consumed.
-                    // TOOD: This is probably not necessary since we flushed above, but it's not going to hurt.
-                    pContext->uavBarrier(pResultBuffer.get());
-
-                    // Compact/clone all BLASes to their final location.
-                    for (size_t i = 0; i < group.blasIndices.size(); ++i)
-                    {
-                        const uint32_t blasId = group.blasIndices[i];
-                        auto& blas = mBlasData[blasId];
-
-                        RtAccelerationStructure::Desc blasDesc = {};
-                        blasDesc.setBuffer(pBlas, blas.blasByteOffset, blas.blasByteSize);
-                        blasDesc.setKind(RtAccelerationStructureKind::BottomLevel);
-                        mBlasObjects[blasId] = RtAccelerationStructure::create(blasDesc);
-
-                        pContext->copyAccelerationStructure(
-                            mBlasObjects[blasId].get(),
-                            intermediateBlases[i].get(),
-                            blas.useCompaction ? RenderContext::RtAccelerationStructureCopyMode::Compact : RenderContext::RtAccelerationStructureCopyMode::Clone);
-                    }
-
-                    // Insert barrier. The BLAS buffer is now ready for use.
-                    pContext->uavBarrier(pBlas.get());
-                }
+                logInfo("BLAS build split into {} groups", mBlasGroups.size());
 
-                // Release scratch buffer if there is no animated content. We will not need it.
-                if (!hasDynamicGeometry && !hasProceduralPrimitives) mpBlasScratch.reset();
+                buildBlasGroups(pContext, 0);
             }
 
             updateRaytracingBLASStats();
@@ -3101,42 +3343,350 @@ namespace Falcor
         }
     }
 
-    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayCount, bool perMeshHitEntry) const
+    void Scene::buildBlasGroups(RenderContext* pContext, size_t firstGroupIndex)
+    {
+        // Compute the required maximum size of the result and scratch buffers.
+        uint64_t resultByteSize = 0;
+        uint64_t scratchByteSize = 0;
+        size_t maxBlasCount = 0;
+
+        for (size_t blasGroupIndex = firstGroupIndex; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
+        {
+            const auto& group = mBlasGroups[blasGroupIndex];
+            resultByteSize = std::max(resultByteSize, group.resultByteSize);
+            scratchByteSize = std::max(scratchByteSize, group.scratchByteSize);
+            maxBlasCount = std::max(maxBlasCount, group.blasIndices.size());
+        }
+        FALCOR_ASSERT(resultByteSize > 0 && scratchByteSize > 0);
+
+        logInfo("BLAS build result buffer size: {}", formatByteSize(resultByteSize));
+        logInfo("BLAS build scratch buffer size: {}", formatByteSize(scratchByteSize));
+
+        // Allocate result and scratch buffers.
+        // The scratch buffer we'll retain because it's needed for subsequent rebuilds and updates.
+        // TODO: Save memory by reducing the scratch buffer to the minimum required for the dynamic objects.
+        if (mpBlasScratch == nullptr || mpBlasScratch->getSize() < scratchByteSize)
+        {
+            mpBlasScratch = Buffer::create(scratchByteSize, Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
+            mpBlasScratch->setName("Scene::mpBlasScratch");
+        }
+
+        Buffer::SharedPtr pResultBuffer = Buffer::create(resultByteSize, Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
+        FALCOR_ASSERT(pResultBuffer && mpBlasScratch);
+
+        // Create post-build info pool for readback.
+        RtAccelerationStructurePostBuildInfoPool::Desc compactedSizeInfoPoolDesc;
+        compactedSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CompactedSize;
+        compactedSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
+        RtAccelerationStructurePostBuildInfoPool::SharedPtr compactedSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(compactedSizeInfoPoolDesc);
+
+        RtAccelerationStructurePostBuildInfoPool::Desc currentSizeInfoPoolDesc;
+        currentSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CurrentSize;
+        currentSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
+        RtAccelerationStructurePostBuildInfoPool::SharedPtr currentSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(currentSizeInfoPoolDesc);
+
+        // Iterate over BLAS groups. For each group build and compact all BLASes.
+        for (size_t blasGroupIndex = firstGroupIndex; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
+        {
+            auto& group = mBlasGroups[blasGroupIndex];
+
+            // Allocate array to hold intermediate blases for the group.
+            std::vector<RtAccelerationStructure::SharedPtr> intermediateBlases(group.blasIndices.size());
+
+            // Insert barriers. The buffers are now ready to be written.
+            pContext->uavBarrier(pResultBuffer.get());
+            pContext->uavBarrier(mpBlasScratch.get());
+
+            // Reset the post-build info pools to receive new info.
+            compactedSizeInfoPool->reset(pContext);
+            currentSizeInfoPool->reset(pContext);
+
+            // Build the BLASes into the intermediate result buffer.
+            // We output post-build info in order to find out the final size requirements.
+            for (size_t i = 0; i < group.blasIndices.size(); ++i)
+            {
+                const uint32_t blasId = group.blasIndices[i];
+                const auto& blas = mBlasData[blasId];
+
+                RtAccelerationStructure::Desc createDesc = {};
+                createDesc.setBuffer(pResultBuffer, blas.resultByteOffset, blas.resultByteSize);
+                createDesc.setKind(RtAccelerationStructureKind::BottomLevel);
+                auto blasObject = RtAccelerationStructure::create(createDesc);
+                intermediateBlases[i] = blasObject;
+
+                RtAccelerationStructure::BuildDesc asDesc = {};
+                asDesc.inputs = blas.buildInputs;
+                asDesc.scratchData = mpBlasScratch->getGpuAddress() + blas.scratchByteOffset;
+                asDesc.dest = blasObject.get();
+
+                // Need to find out the post-build compacted BLAS size to know the final allocation size.
+                RtAccelerationStructurePostBuildInfoDesc postbuildInfoDesc = {};
+                if (blas.useCompaction)
+                {
+                    postbuildInfoDesc.type = RtAccelerationStructurePostBuildInfoQueryType::CompactedSize;
+                    postbuildInfoDesc.index = (uint32_t)i;
+                    postbuildInfoDesc.pool = compactedSizeInfoPool.get();
+                }
+                else
+                {
+                    postbuildInfoDesc.type = RtAccelerationStructurePostBuildInfoQueryType::CurrentSize;
+                    postbuildInfoDesc.index = (uint32_t)i;
+                    postbuildInfoDesc.pool = currentSizeInfoPool.get();
+                }
+
+                pContext->buildAccelerationStructure(asDesc, 1, &postbuildInfoDesc);
+            }
+
+            // Read back the calculated final size requirements for each BLAS.
+
+            group.finalByteSize = 0;
+            for (size_t i = 0; i < group.blasIndices.size(); i++)
+            {
+                const uint32_t blasId = group.blasIndices[i];
+                auto& blas = mBlasData[blasId];
+
+                // Check the size. Upon failure a zero size may be reported.
+                uint64_t byteSize = 0;
+                if (blas.useCompaction)
+                {
+                    byteSize = compactedSizeInfoPool->getElement(pContext, (uint32_t)i);
+                }
+                else
+                {
+                    byteSize = currentSizeInfoPool->getElement(pContext, (uint32_t)i);
+                    // For platforms that does not support current size query, use prebuild size.
+                    if (byteSize == 0)
+                    {
+                        byteSize = blas.prebuildInfo.resultDataMaxSize;
+                    }
+                }
+                // Reserve the full detail size for the curve BLAS so that it can be rebuilt in place when curve levels are switched.
+                if (blas.hasCurveLODs) byteSize = blas.prebuildInfo.resultDataMaxSize;
+                FALCOR_ASSERT(byteSize <= blas.prebuildInfo.resultDataMaxSize);
+                if (byteSize == 0) throw RuntimeError("Acceleration structure build failed for BLAS index {}", blasId);
+
+                blas.blasByteSize = align_to(kAccelerationStructureByteAlignment, byteSize);
+                blas.blasByteOffset = group.finalByteSize;
+                group.finalByteSize += blas.blasByteSize;
+            }
+            FALCOR_ASSERT(group.finalByteSize > 0);
+
+            logInfo("BLAS group " + std::to_string(blasGroupIndex) + " final size: " + formatByteSize(group.finalByteSize));
+
+            // Allocate final BLAS buffer.
+            auto& pBlas = group.pBlas;
+            if (pBlas == nullptr || pBlas->getSize() < group.finalByteSize)
+            {
+                pBlas = Buffer::create(group.finalByteSize, Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
+                pBlas->setName("Scene::mBlasGroups[" + std::to_string(blasGroupIndex) + "].pBlas");
+            }
+            else
+            {
+                // If we didn't need to reallocate, just insert a barrier so it's safe to use.
+                pContext->uavBarrier(pBlas.get());
+            }
+
+            // Insert barrier. The result buffer is now ready to be consumed.
+            // TOOD: This is probably not necessary since we flushed above, but it's not going to hurt.
+            pContext->uavBarrier(pResultBuffer.get());
+
+            // Compact/clone all BLASes to their final location.
+            for (size_t i = 0; i < group.blasIndices.size(); ++i)
+            {
+                const uint32_t blasId = group.blasIndices[i];
+                auto& blas = mBlasData[blasId];
+
+                RtAccelerationStructure::Desc blasDesc = {};
+                blasDesc.setBuffer(pBlas, blas.blasByteOffset, blas.blasByteSize);
+                blasDesc.setKind(RtAccelerationStructureKind::BottomLevel);
+                mBlasObjects[blasId] = RtAccelerationStructure::create(blasDesc);
+
+                pContext->copyAccelerationStructure(
+                    mBlasObjects[blasId].get(),
+                    intermediateBlases[i].get(),
+                    blas.useCompaction ? RenderContext::RtAccelerationStructureCopyMode::Compact : RenderContext::RtAccelerationStructureCopyMode::Clone);
+            }
+
+            // Insert barrier. The BLAS buffer is now ready for use.
+            pContext->uavBarrier(pBlas.get());
+        }
+
+        // Release scratch buffer if there is no animated content. We will not need it.
+        // It is recreated if BLASes of mesh levels of detail are built later on.
+        bool needsScratch = false;
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        {
+            if (mBlasObjects[blasId] == nullptr) continue;
+            needsScratch |= mBlasData[blasId].hasDynamicGeometry() || mBlasData[blasId].hasProceduralPrimitives;
+        }
+        if (!needsScratch) mpBlasScratch.reset();
+    }
+
+    std::vector<uint32_t> Scene::getRequiredBlasIDs() const
+    {
+        // The BLAS of a simplified mesh level of detail is required once an instance has selected it.
+        std::vector<bool> isSelected(mBlasData.size(), false);
+        for (const auto& lodInstance : mLODInstances)
+        {
+            if (lodInstance.level == 0) continue;
+            const auto& instance = mGeometryInstanceData[lodInstance.instanceID];
+            if (instance.getType() != GeometryType::TriangleMesh && instance.getType() != GeometryType::DisplacedTriangleMesh) continue;
+            isSelected[mMeshGroupIDs[instance.geometryID]] = true;
+        }
+
+        std::vector<uint32_t> blasIDs;
+        for (uint32_t blasId = 0; blasId < (uint32_t)mBlasData.size(); blasId++)
+        {
+            if (mBlasData[blasId].isLODLevel && !isSelected[blasId]) continue;
+            blasIDs.push_back(blasId);
+        }
+        return blasIDs;
+    }
+
+    void Scene::updateLODBlases(RenderContext* pContext)
+    {
+        FALCOR_PROFILE("updateLODBlases");
+
+        if (mRebuildBlas)
+        {
+            buildBlas(pContext);
+            return;
+        }
+
+        // Build the BLASes of newly selected mesh levels into new BLAS groups.
+        std::vector<uint32_t> newBlasIDs;
+        for (uint32_t blasId : getRequiredBlasIDs())
+        {
+            if (mBlasObjects[blasId] == nullptr) newBlasIDs.push_back(blasId);
+        }
+
+        if (!newBlasIDs.empty())
+        {
+            if (mpMeshVao)
+            {
+                const Buffer::SharedPtr& pVb = mpMeshVao->getVertexBuffer(kStaticDataBufferIndex);
+                const Buffer::SharedPtr& pIb = mpMeshVao->getIndexBuffer();
+                pContext->resourceBarrier(pVb.get(), Resource::State::NonPixelShader);
+                if (pIb) pContext->resourceBarrier(pIb.get(), Resource::State::NonPixelShader);
+            }
+
+            const size_t firstGroupIndex = mBlasGroups.size();
+            computeBlasGroups(newBlasIDs);
+            logInfo("Building {} BLASes for mesh levels of detail", newBlasIDs.size());
+            buildBlasGroups(pContext, firstGroupIndex);
+
+            invalidateTlasCache();
+            updateRaytracingBLASStats();
+        }
+
+        // Rebuild the curve BLAS in place for the selected curve levels.
+        // Its buffer and scratch memory were reserved for the full detail curves, so the BLAS address stays the same.
+        if (mCurveLODsChanged)
+        {
+            mCurveLODsChanged = false;
+
+            const uint32_t blasId = (uint32_t)mMeshGroups.size();
+            FALCOR_ASSERT(blasId < mBlasData.size() && mBlasData[blasId].hasCurveLODs);
+            auto& blas = mBlasData[blasId];
+
+            setCurveGeomDescs(true);
+            RtAccelerationStructurePrebuildInfo prebuildInfo = RtAccelerationStructure::getPrebuildInfo(blas.buildInputs);
+            if (prebuildInfo.resultDataMaxSize > blas.blasByteSize || prebuildInfo.scratchDataSize > blas.scratchByteSize)
+            {
+                mRebuildBlas = true;
+                buildBlas(pContext);
+                return;
+            }
+
+            if (mpCurveVao)
+            {
+                pContext->resourceBarrier(mpCurveVao->getVertexBuffer(kStaticDataBufferIndex).get(), Resource::State::NonPixelShader);
+                pContext->resourceBarrier(mpCurveVao->getIndexBuffer().get(), Resource::State::NonPixelShader);
+            }
+            pContext->resourceBarrier(mpRtAABBBuffer.get(), Resource::State::NonPixelShader);
+
+            const auto& pBlas = mBlasGroups[blas.blasGroupIndex].pBlas;
+            pContext->uavBarrier(pBlas.get());
+            pContext->uavBarrier(mpBlasScratch.get());
+
+            RtAccelerationStructure::BuildDesc asDesc = {};
+            asDesc.inputs = blas.buildInputs;
+            asDesc.scratchData = mpBlasScratch->getGpuAddress() + blas.scratchByteOffset;
+            asDesc.dest = mBlasObjects[blasId].get();
+            pContext->buildAccelerationStructure(asDesc, 0, nullptr);
+
+            pContext->uavBarrier(pBlas.get());
+        }
+    }
+
+    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& instanceMatrixIDs, uint32_t rayCount, bool perMeshHitEntry) const
     {
-        instanceDescs.clear();
+        // Compute the first instance desc, instance ID and hit group index of each mesh group.
+        // This allows the instance descs of all mesh instances to be generated in parallel below.
+        struct MeshGroupOffsets
+        {
+            uint32_t descIndex;
+            uint32_t instanceID;
+            uint32_t hitGroupIndex;
+        };
+        std::vector<MeshGroupOffsets> groupOffsets(mMeshGroups.size());
+        uint32_t meshInstanceCount = 0;
         uint32_t instanceContributionToHitGroupIndex = 0;
         uint32_t instanceID = 0;
 
         for (size_t i = 0; i < mMeshGroups.size(); i++)
         {
+            const auto& meshList = mMeshGroups[i].meshList;
+            FALCOR_ASSERT(!meshList.empty());
+
+            // We expect all meshes in a group to have identical triangle winding. Verify that assumption here.
+            for (size_t j = 1; j < meshList.size(); j++)
+            {
+                FALCOR_ASSERT(mMeshDesc[meshList[j]].isFrontFaceCW() == mMeshDesc[meshList[0]].isFrontFaceCW());
+            }
+
+            // Mesh groups of simplified meshes have no instances of their own.
+            // Their BLASes are referenced by the instances of the full detail mesh below.
+            const uint32_t instanceCount = (uint32_t)mMeshIdToInstanceIds[meshList[0]].size();
+
+            groupOffsets[i] = { meshInstanceCount, instanceID, instanceContributionToHitGroupIndex };
+            meshInstanceCount += instanceCount;
+            instanceID += instanceCount * (uint32_t)meshList.size();
+            instanceContributionToHitGroupIndex += rayCount * (uint32_t)meshList.size();
+        }
+
+        instanceDescs.resize(meshInstanceCount);
+        instanceMatrixIDs.resize(meshInstanceCount);
+
+        auto range = NumericRange<uint32_t>(0, meshInstanceCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t descIndex)
+        {
+            // Find the mesh group of the instance. Groups without instances share their offset with the next group,
+            // so the last group starting at or before the instance is the one holding it.
+            auto it = std::upper_bound(groupOffsets.begin(), groupOffsets.end(), descIndex, [](uint32_t index, const MeshGroupOffsets& offsets) { return index < offsets.descIndex; });
+            FALCOR_ASSERT(it != groupOffsets.begin());
+            const size_t i = std::distance(groupOffsets.begin(), it) - 1;
+            const uint32_t instanceIdx = descIndex - groupOffsets[i].descIndex;
+
             const auto& meshList = mMeshGroups[i].meshList;
             const bool isStatic = mMeshGroups[i].isStatic;
+            const size_t instanceCount = mMeshIdToInstanceIds[meshList[0]].size();
+            FALCOR_ASSERT(instanceIdx < instanceCount);
 
             FALCOR_ASSERT(mBlasData[i].blasGroupIndex < mBlasGroups.size());
             const auto& pBlas = mBlasGroups[mBlasData[i].blasGroupIndex].pBlas;
             FALCOR_ASSERT(pBlas);
 
             RtInstanceDesc desc = {};
-            desc.accelerationStructure = pBlas->getGpuAddress() + mBlasData[i].blasByteOffset;
             desc.instanceMask = 0xFF;
-            desc.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
-
-            instanceContributionToHitGroupIndex += rayCount * (uint32_t)meshList.size();
-
-            // We expect all meshes in a group to have identical triangle winding. Verify that assumption here.
-            FALCOR_ASSERT(!meshList.empty());
-            const bool frontFaceCW = mMeshDesc[meshList[0]].isFrontFaceCW();
-            for (size_t i = 1; i < meshList.size(); i++)
-            {
-                FALCOR_ASSERT(mMeshDesc[meshList[i]].isFrontFaceCW() == frontFaceCW);
-            }
+            desc.instanceContributionToHitGroupIndex = perMeshHitEntry ? groupOffsets[i].hitGroupIndex : 0;
 
             // Set the triangle winding for the instance if it differs from the default.
             // The default in DXR is that a triangle is front facing if its vertices appear clockwise
             // from the ray origin, in object space in a left-handed coordinate system.
             // Note that Falcor uses a right-handed coordinate system, so we have to invert the flag.
             // Since these winding direction rules are defined in object space, they are unaffected by instance transforms.
-            if (frontFaceCW) desc.flags = desc.flags | RtGeometryInstanceFlags::TriangleFrontCounterClockwise;
+            if (mMeshDesc[meshList[0]].isFrontFaceCW()) desc.flags = desc.flags | RtGeometryInstanceFlags::TriangleFrontCounterClockwise;
 
             // From the scene builder we can expect the following:
             //
@@ -3148,50 +3698,55 @@ namespace Falcor
             // - The meshes are guaranteed to be non-instanced or be identically instanced, one INSTANCE_DESC per TLAS instance is needed.
             // - The global matrices are the same for all meshes in an instance.
             //
-            FALCOR_ASSERT(!meshList.empty());
-            size_t instanceCount = mMeshIdToInstanceIds[meshList[0]].size();
+            desc.instanceID = groupOffsets[i].instanceID + instanceIdx * (uint32_t)meshList.size();
 
-            FALCOR_ASSERT(instanceCount > 0);
-            for (size_t instanceIdx = 0; instanceIdx < instanceCount; instanceIdx++)
+            // Validate that the ordering is matching our expectations:
+            // InstanceID() + GeometryIndex() should look up the correct mesh instance.
+            for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
             {
-                // Validate that the ordering is matching our expectations:
-                // InstanceID() + GeometryIndex() should look up the correct mesh instance.
-                for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
-                {
-                    const auto& instances = mMeshIdToInstanceIds[meshList[geometryIndex]];
-                    FALCOR_ASSERT(instances.size() == instanceCount);
-                    FALCOR_ASSERT(instances[instanceIdx] == instanceID + geometryIndex);
-                }
-
-                desc.instanceID = instanceID;
-                instanceID += (uint32_t)meshList.size();
+                const auto& instances = mMeshIdToInstanceIds[meshList[geometryIndex]];
+                FALCOR_ASSERT(instances.size() == instanceCount);
+                FALCOR_ASSERT(instances[instanceIdx] == desc.instanceID + geometryIndex);
+            }
 
-                glm::mat4 transform4x4 = glm::identity<glm::mat4>();
-                if (!isStatic)
-                {
-                    // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
-                    // Just pick the matrix from the first mesh.
-                    const uint32_t matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
-                    transform4x4 = transpose(mpAnimationController->getGlobalMatrices()[matrixId]);
+            // Instances of meshes with levels of detail reference the BLAS of the selected level.
+            // These meshes are always placed in mesh groups of their own.
+            desc.accelerationStructure = pBlas->getGpuAddress() + mBlasData[i].blasByteOffset;
+            const uint32_t selectedMeshID = mGeometryInstanceData[desc.instanceID].geometryID;
+            if (selectedMeshID != meshList[0])
+            {
+                FALCOR_ASSERT(meshList.size() == 1 && selectedMeshID < mMeshGroupIDs.size());
+                const auto& blasData = mBlasData[mMeshGroupIDs[selectedMeshID]];
+                desc.accelerationStructure = mBlasGroups[blasData.blasGroupIndex].pBlas->getGpuAddress() + blasData.blasByteOffset;
+            }
 
-                    // Verify that all meshes have matching tranforms.
-                    for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
-                    {
-                        FALCOR_ASSERT(matrixId == mGeometryInstanceData[desc.instanceID + geometryIndex].globalMatrixID);
-                    }
-                }
-                std::memcpy(desc.transform, &transform4x4, sizeof(desc.transform));
+            uint32_t matrixId = kInvalidIndex;
+            glm::mat4 transform4x4 = glm::identity<glm::mat4>();
+            if (!isStatic)
+            {
+                // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
+                // Just pick the matrix from the first mesh.
+                matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
+                transform4x4 = transpose(mpAnimationController->getGlobalMatrices()[matrixId]);
 
-                // Verify that instance data has the correct instanceIndex and geometryIndex.
+                // Verify that all meshes have matching tranforms.
                 for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
                 {
-                    FALCOR_ASSERT((uint32_t)instanceDescs.size() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
-                    FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].geometryIndex);
+                    FALCOR_ASSERT(matrixId == mGeometryInstanceData[desc.instanceID + geometryIndex].globalMatrixID);
                 }
+            }
+            std::memcpy(desc.transform, &transform4x4, sizeof(desc.transform));
 
-                instanceDescs.push_back(desc);
+            // Verify that instance data has the correct instanceIndex and geometryIndex.
+            for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
+            {
+                FALCOR_ASSERT(descIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
+                FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].geometryIndex);
             }
-        }
+
+            instanceDescs[descIndex] = desc;
+            instanceMatrixIDs[descIndex] = matrixId;
+        });
 
         uint32_t totalBlasCount = (uint32_t)mMeshGroups.size() + (mCurveDesc.empty() ? 0 : 1) + getSDFGridGeometryCount() + (mCustomPrimitiveDesc.empty() ? 0 : 1);
         FALCOR_ASSERT((uint32_t)mBlasData.size() == totalBlasCount);
@@ -3209,7 +3764,7 @@ namespace Falcor
             desc.accelerationStructure = pBlas->getGpuAddress() + blasData.blasByteOffset;
             desc.instanceMask = 0xFF;
             desc.instanceID = instanceID;
-            instanceID += (uint32_t)mCurveDesc.size();
+            instanceID += (uint32_t)(mCurveDesc.size() - mCurveLODCount);
 
             // Start procedural primitive hit group after the triangle hit groups.
             desc.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
@@ -3224,13 +3779,14 @@ namespace Falcor
             desc.setTransform(mpAnimationController->getGlobalMatrices()[matrixId]);
 
             // Verify that instance data has the correct instanceIndex and geometryIndex.
-            for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)mCurveDesc.size(); geometryIndex++)
+            for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)(mCurveDesc.size() - mCurveLODCount); geometryIndex++)
             {
                 FALCOR_ASSERT((uint32_t)instanceDescs.size() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
                 FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].geometryIndex);
             }
 
             instanceDescs.push_back(desc);
+            instanceMatrixIDs.push_back(matrixId);
         }
 
         // One instance per SDF grid instance.
@@ -3274,6 +3830,7 @@ namespace Falcor
                 FALCOR_ASSERT(0 == instance.geometryIndex);
 
                 instanceDescs.push_back(desc);
+                instanceMatrixIDs.push_back(instance.globalMatrixID);
             }
 
             blasDataIndex += (sdfGridInstancesHaveUniqueBLASes ? mSDFGrids.size() : 1);
@@ -3301,14 +3858,30 @@ namespace Falcor
             glm::mat4 identityMat = glm::identity<glm::mat4>();
             std::memcpy(desc.transform, &identityMat, sizeof(desc.transform));
             instanceDescs.push_back(desc);
+            instanceMatrixIDs.push_back((uint32_t)kInvalidIndex);
         }
     }
 
-    void Scene::invalidateTlasCache()
+    void Scene::updateInstanceDescTransforms(std::vector<RtInstanceDesc>& instanceDescs, const std::vector<uint32_t>& instanceMatrixIDs, uint64_t transformUpdateID) const
+    {
+        FALCOR_ASSERT(instanceDescs.size() == instanceMatrixIDs.size());
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        auto range = NumericRange<size_t>(0, instanceDescs.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            const uint32_t matrixID = instanceMatrixIDs[i];
+            if (matrixID == kInvalidIndex || mMatrixUpdateIDs[matrixID] <= transformUpdateID) return;
+            instanceDescs[i].setTransform(globalMatrices[matrixID]);
+        });
+    }
+
+    void Scene::invalidateTlasCache(bool transformsOnly)
     {
         for (auto& tlas : mTlasCache)
         {
             tlas.second.pTlasObject = nullptr;
+            if (!transformsOnly) tlas.second.instanceDescs.clear();
         }
     }
 
@@ -3316,17 +3889,27 @@ namespace Falcor
     {
         FALCOR_PROFILE("buildTlas");
 
-        TlasData tlas;
-        auto it = mTlasCache.find(rayCount);
-        if (it != mTlasCache.end()) tlas = it->second;
+        TlasData& tlas = mTlasCache[rayCount];
 
         // Prepare instance descs.
+        // The cached instance descs are regenerated if the instances or BLASes changed. Otherwise only
+        // the transforms of instances that moved since the TLAS was last built are updated.
         // Note if there are no instances, we'll build an empty TLAS.
-        fillInstanceDesc(mInstanceDescs, rayCount, perMeshHitEntry);
+        if (tlas.instanceDescs.empty() || tlas.perMeshHitEntry != perMeshHitEntry)
+        {
+            fillInstanceDesc(tlas.instanceDescs, tlas.instanceMatrixIDs, rayCount, perMeshHitEntry);
+            tlas.perMeshHitEntry = perMeshHitEntry;
+        }
+        else if (tlas.transformUpdateID != mTransformUpdateID)
+        {
+            updateInstanceDescTransforms(tlas.instanceDescs, tlas.instanceMatrixIDs, tlas.transformUpdateID);
+        }
+        tlas.transformUpdateID = mTransformUpdateID;
+        const auto& instanceDescs = tlas.instanceDescs;
 
         RtAccelerationStructureBuildInputs inputs = {};
         inputs.kind = RtAccelerationStructureKind::TopLevel;
-        inputs.descCount = (uint32_t)mInstanceDescs.size();
+        inputs.descCount = (uint32_t)instanceDescs.size();
         inputs.flags = RtAccelerationStructureBuildFlags::None;
 
         // Add build flags for dynamic scenes if TLAS should be updating instead of rebuilt
@@ -3367,17 +3950,17 @@ namespace Falcor
                     tlas.pTlasBuffer->setName("Scene TLAS buffer");
                 }
             }
-            if (!mInstanceDescs.empty())
+            if (!instanceDescs.empty())
             {
                 // Allocate a new buffer for the TLAS instance desc input only if the existing buffer isn't big enough.
-                if (!tlas.pInstanceDescs || tlas.pInstanceDescs->getSize() < mInstanceDescs.size() * sizeof(RtInstanceDesc))
+                if (!tlas.pInstanceDescs || tlas.pInstanceDescs->getSize() < instanceDescs.size() * sizeof(RtInstanceDesc))
                 {
-                    tlas.pInstanceDescs = Buffer::create((uint32_t)mInstanceDescs.size() * sizeof(RtInstanceDesc), Buffer::BindFlags::None, Buffer::CpuAccess::Write, mInstanceDescs.data());
+                    tlas.pInstanceDescs = Buffer::create((uint32_t)instanceDescs.size() * sizeof(RtInstanceDesc), Buffer::BindFlags::None, Buffer::CpuAccess::Write, instanceDescs.data());
                     tlas.pInstanceDescs->setName("Scene instance descs buffer");
                 }
                 else
                 {
-                    tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, mInstanceDescs.size() * sizeof(RtInstanceDesc));
+                    uploadInstanceDescs(tlas.pInstanceDescs.get(), instanceDescs);
                 }
             }
 
@@ -3394,8 +3977,8 @@ namespace Falcor
             pContext->uavBarrier(mpTlasScratch.get());
             if (tlas.pInstanceDescs)
             {
-                FALCOR_ASSERT(!mInstanceDescs.empty());
-                tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, inputs.descCount * sizeof(RtInstanceDesc));
+                FALCOR_ASSERT(!instanceDescs.empty());
+                uploadInstanceDescs(tlas.pInstanceDescs.get(), instanceDescs);
             }
             asDesc.source = tlas.pTlasObject.get(); // Perform the update in-place
         }
@@ -3421,7 +4004,6 @@ namespace Falcor
         pContext->buildAccelerationStructure(asDesc, 0, nullptr);
         pContext->uavBarrier(tlas.pTlasBuffer.get());
 
-        mTlasCache[rayCount] = tlas;
         updateRaytracingTLASStats();
     }
 
@@ -3749,9 +4331,17 @@ namespace Falcor
 
         // Grid stats
         d["gridCount"] = gridCount;
+        d["gridResidentCount"] = gridResidentCount;
         d["gridVoxelCount"] = gridVoxelCount;
         d["gridMemoryInBytes"] = gridMemoryInBytes;
 
+        // Load stats
+        d["loadUploadCount"] = loadUploadCount;
+        d["loadUploadCopyCount"] = loadUploadCopyCount;
+        d["loadUploadedBytes"] = loadUploadedBytes;
+        d["loadUploadStagingTime"] = loadUploadStagingTime;
+        d["loadUploadStallTime"] = loadUploadStallTime;
+
         return d;
     }
 
@@ -3774,6 +4364,8 @@ namespace Falcor
         scene.def_property(kLoopAnimations.c_str(), &Scene::isLooped, &Scene::setIsLooped);
         scene.def_property(kRenderSettings.c_str(), pybind11::overload_cast<void>(&Scene::getRenderSettings, pybind11::const_), &Scene::setRenderSettings);
         scene.def_property(kUpdateCallback.c_str(), &Scene::getUpdateCallback, &Scene::setUpdateCallback);
+        scene.def_property(kLODEnabled.c_str(), &Scene::isLODEnabled, &Scene::setLODEnabled);
+        scene.def_property(kLODMaxScreenError.c_str(), &Scene::getLODMaxScreenError, &Scene::setLODMaxScreenError);
 
         scene.def(kSetEnvMap.c_str(), &Scene::loadEnvMap, "path"_a);
         scene.def(kGetLight.c_str(), &Scene::getLight, "index"_a);
@@ -48,6 +48,8 @@
 #include "Displacement/DisplacementUpdateTask.slang"
 #include "SceneTypes.slang"
 #include "HitInfo.h"
+#include "InstanceBoundsTree.h"
+#include "SceneUploadQueue.h"
 
 namespace Falcor
 {
@@ -133,6 +135,8 @@ namespace Falcor
             SDFGridConfigChanged        = 0x400000,     ///< SDF grid config changed.
             SDFGeometryChanged          = 0x800000,     ///< SDF grid geometry changed.
             MeshesChanged               = 0x1000000,    ///< Mesh data changed (skinning or vertex animations).
+            LODsChanged                 = 0x2000000,    ///< The level of detail selected for some geometry instances changed.
+            SceneBoundsChanged          = 0x4000000,    ///< The scene bounds changed.
             All                         = -1
         };
 
@@ -257,6 +261,15 @@ namespace Falcor
             bool isDisplaced = false;           ///< True if group uses displacement mapping.
         };
 
+        /** Represents one simplified level of detail of a mesh or curve.
+            The levels are stored per base geometry, ordered from finest to coarsest.
+        */
+        struct GeometryLOD
+        {
+            uint32_t geometryID = 0;            ///< Mesh or curve ID of the simplified geometry.
+            float error = 0.f;                  ///< Approximate geometric error in object space units.
+        };
+
         /** Scene graph node.
         */
         struct Node
@@ -296,6 +309,7 @@ namespace Falcor
             std::vector<GeometryInstanceData> meshInstanceData;     ///< List of mesh instances.
             std::vector<std::vector<uint32_t>> meshIdToInstanceIds; ///< Mapping of what instances belong to which mesh.
             std::vector<MeshGroup> meshGroups;                      ///< List of mesh groups. Each group maps to a BLAS for ray tracing.
+            std::vector<std::vector<GeometryLOD>> meshLODs;         ///< Simplified levels of detail per mesh. Empty for meshes without levels of detail.
             std::vector<CachedMesh> cachedMeshes;                   ///< Cached data for vertex-animated meshes.
             uint32_t prevVertexCount = 0;                           ///< Number of vertices that the AnimationController needs to allocate to store previous frame vertices.
 
@@ -316,6 +330,7 @@ namespace Falcor
             std::vector<uint32_t> curveIndexData;                   ///< Vertex indices for all curves in 32-bit.
             std::vector<StaticCurveVertexData> curveStaticData;     ///< Vertex attributes for all curves.
             std::vector<CachedCurve> cachedCurves;                  ///< Vertex cache for dynamic (vertex animated) curves.
+            std::vector<std::vector<GeometryLOD>> curveLODs;        ///< Simplified levels of detail per curve. Empty for curves without levels of detail.
 
             // SDF grid data
             std::vector<SDFGrid::SharedPtr> sdfGrids;               ///< List of SDF grids.
@@ -399,9 +414,17 @@ namespace Falcor
 
             // Grid stats
             uint64_t gridCount = 0;                     ///< Number of grids.
+            uint64_t gridResidentCount = 0;             ///< Number of grids resident in memory. Streamed grids are only resident around the current frame.
             uint64_t gridVoxelCount = 0;                ///< Total number of voxels in all grids.
             uint64_t gridMemoryInBytes = 0;             ///< Total memory in bytes used by the grids.
 
+            // Load stats
+            uint64_t loadUploadCount = 0;               ///< Number of buffer uploads recorded during scene construction.
+            uint64_t loadUploadCopyCount = 0;           ///< Number of GPU copies the uploads were coalesced into.
+            uint64_t loadUploadedBytes = 0;             ///< Total number of bytes uploaded during scene construction.
+            double loadUploadStagingTime = 0.0;         ///< Time in seconds spent copying upload data to staging memory.
+            double loadUploadStallTime = 0.0;           ///< Time in seconds spent waiting for the GPU to release staging memory.
+
             /** Get the total memory usage.
             */
             uint64_t getTotalMemory() const
@@ -552,6 +575,15 @@ namespace Falcor
         */
         void selectCamera(std::string name);
 
+        /** Select the camera to render the current frame from, after update() has been called for the frame.
+            This is used to render the same frame from several cameras. Unlike setCamera(), it is not reported as a camera switch,
+            and the update flags of the frame are kept except for the camera changes, which are those of the new camera.
+            Each camera should be rendered by its own render graph instances, as temporal passes keep their history across frames.
+            Select the camera that was used during update() again before the next update(). Levels of detail remain selected for that camera.
+            \param[in] pCamera The camera to render from. It must already exist in the scene.
+        */
+        void setFrameCamera(const Camera::SharedPtr& pCamera);
+
         /** Sets whether the camera controls are enabled or disabled.
         */
         void setCameraControlsEnabled(bool value) { mCameraControlsEnabled = value; }
@@ -649,6 +681,24 @@ namespace Falcor
         */
         const MeshDesc& getMesh(uint32_t meshID) const { return mMeshDesc[meshID]; }
 
+        /** CPU copy of the vertex and index data of a single mesh.
+        */
+        struct EmissiveMeshData
+        {
+            std::vector<uint32_t> indices;                  ///< Vertex indices local to the mesh, three per triangle in 32-bit. Empty for non-indexed meshes.
+            std::vector<PackedStaticVertexData> vertices;   ///< Vertex attributes of the mesh.
+        };
+
+        /** Get the CPU copy of a mesh's vertex and index data.
+            The data is only retained for static (non-skinned, non-animated) meshes that have an instance with an emissive material when the scene is created.
+            It is used by the light collection to build the emissive triangle list without reading back GPU data.
+            The copies cost the size of the vertex and index data of the emissive meshes on the host. They are released
+            when the light collection is created, unless the scene has animations that rebuild the mesh lights.
+            \param[in] meshID Mesh ID.
+            \return Pointer to the mesh data, or nullptr if it was not retained.
+        */
+        const EmissiveMeshData* getEmissiveMeshData(uint32_t meshID) const;
+
         /** Get the number of curves.
         */
         uint32_t getCurveCount() const { return (uint32_t)mCurveDesc.size(); }
@@ -801,6 +851,7 @@ namespace Falcor
         const HitInfo& getHitInfo() const { return mHitInfo; }
 
         /** Get the scene bounds in world space.
+            The bounds follow animated geometry, so they may change every frame. UpdateFlags::SceneBoundsChanged is set when they do.
         */
         const AABB& getSceneBounds() const { return mSceneBB; }
 
@@ -870,6 +921,28 @@ namespace Falcor
         */
         UpdateMode getBlasUpdateMode() { return mBlasUpdateMode; }
 
+        /** Returns true if the scene has geometry with simplified levels of detail.
+            Levels of detail are generated by the SceneBuilder when the GenerateLODs flag is set.
+        */
+        bool hasLODs() const { return !mLODInstances.empty(); }
+
+        /** Enable/disable level of detail selection. When disabled, all instances use their full detail geometry.
+        */
+        void setLODEnabled(bool enabled);
+
+        /** Returns true if level of detail selection is enabled.
+        */
+        bool isLODEnabled() const { return mLODEnabled; }
+
+        /** Set the maximum geometric error allowed for a level of detail, as a fraction of the viewport height.
+            The coarsest level whose projected error is below this bound is selected for each instance.
+        */
+        void setLODMaxScreenError(float maxScreenError);
+
+        /** Get the maximum geometric error allowed for a level of detail, as a fraction of the viewport height.
+        */
+        float getLODMaxScreenError() const { return mLODMaxScreenError; }
+
         /** Update the scene. Call this once per frame to update the camera location, animations, etc.
             \param[in] pContext
             \param[in] currentTime The current time in seconds
@@ -1035,6 +1108,7 @@ namespace Falcor
 
         void createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<SkinningVertexData>& skinningData);
         void createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData);
+        void retainEmissiveMeshData(const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData);
 
         Shader::DefineList getSceneSDFGridDefines() const;
 
@@ -1058,11 +1132,18 @@ namespace Falcor
         */
         void uploadSelectedCamera();
 
+        /** Create the lists of geometry instances transformed by each global matrix.
+        */
+        void createMatrixInstanceLists();
+
         /** Update the scene's global bounding box.
+            \param[in] forceUpdate Recompute the bounds of all geometry instances. Otherwise only the bounds of the moved instances are updated.
+            \return UpdateFlags::SceneBoundsChanged if the bounds changed, UpdateFlags::None otherwise.
         */
-        void updateBounds();
+        UpdateFlags updateBounds(bool forceUpdate);
 
         /** Update geometry instances.
+            \param[in] forceUpdate Update and upload all geometry instances. Otherwise only the moved instances are updated.
         */
         void updateGeometryInstances(bool forceUpdate);
 
@@ -1082,22 +1163,51 @@ namespace Falcor
         */
         void initGeomDesc(RenderContext* pContext);
 
+        /** Set the geometry descs of the curve BLAS.
+            \param[in] useSelectedLODs If true, use the AABBs of the currently selected curve levels of detail. Otherwise use the full detail curves.
+        */
+        void setCurveGeomDescs(bool useSelectedLODs);
+
         /** Initialize pre-build information for each BLAS.
         */
         void preparePrebuildInfo(RenderContext* pContext);
 
-        /** Compute BLAS groups.
+        /** Compute BLAS groups for the given BLASes. The new groups are appended to the existing ones.
+            \param[in] blasIDs Indices into mBlasData of the BLASes to group.
         */
-        void computeBlasGroups();
+        void computeBlasGroups(const std::vector<uint32_t>& blasIDs);
 
         /** Generate bottom level acceleration structures for all meshes.
         */
         void buildBlas(RenderContext* pContext);
 
-        /** Generate data for creating a TLAS.
+        /** Build and compact the BLASes of the BLAS groups starting at the given group index.
+        */
+        void buildBlasGroups(RenderContext* pContext, size_t firstGroupIndex);
+
+        /** Get the indices of the BLASes that are needed by the scene.
+            This excludes the BLASes of simplified mesh levels that have not been selected by any instance yet.
+        */
+        std::vector<uint32_t> getRequiredBlasIDs() const;
+
+        /** Update the BLASes after a level of detail switch.
+            Builds the BLASes of newly selected mesh levels and rebuilds the curve BLAS in place if curve levels changed.
+        */
+        void updateLODBlases(RenderContext* pContext);
+
+        /** Generate data for creating a TLAS. The instance descs are generated in parallel.
             #SCENE TODO: Add argument to build descs based off a draw list.
+            \param[out] instanceDescs Instance descs for all instances in the TLAS.
+            \param[out] instanceMatrixIDs Global matrix ID per instance desc, or kInvalidIndex if the instance has a fixed identity transform.
         */
-        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayCount, bool perMeshHitEntry) const;
+        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& instanceMatrixIDs, uint32_t rayCount, bool perMeshHitEntry) const;
+
+        /** Update the transforms of previously generated instance descs whose global matrix changed after the given transform update.
+            \param[in,out] instanceDescs Instance descs generated by fillInstanceDesc().
+            \param[in] instanceMatrixIDs Global matrix ID per instance desc as returned by fillInstanceDesc().
+            \param[in] transformUpdateID Value of mTransformUpdateID when the instance descs were last updated.
+        */
+        void updateInstanceDescTransforms(std::vector<RtInstanceDesc>& instanceDescs, const std::vector<uint32_t>& instanceMatrixIDs, uint64_t transformUpdateID) const;
 
         /** Generate top level acceleration structure for the scene. Automatically determines whether to build or refit.
             \param[in] rayCount Number of ray types in the shader. Required to setup how instances index into the Shader Table.
@@ -1105,8 +1215,10 @@ namespace Falcor
         void buildTlas(RenderContext* pContext, uint32_t rayCount, bool perMeshHitEntry);
 
         /** Invalidates the TLAS cache.
+            \param[in] transformsOnly If true, the BLASes and instances are unchanged and only instance transforms may have changed.
+                       The cached instance descs are then updated incrementally on the next build instead of being regenerated.
         */
-        void invalidateTlasCache();
+        void invalidateTlasCache(bool transformsOnly = false);
 
         /** Check whether scene has an index buffer.
         */
@@ -1135,6 +1247,12 @@ namespace Falcor
         UpdateFlags updateDisplacement(bool forceUpdate);
         UpdateFlags updateSDFGrids(RenderContext* pRenderContext);
 
+        /** Select the level of detail of each instance with simplified levels and switch the instances to the selected geometry.
+            Switching mesh levels only requires a new TLAS, once the BLAS of a level has been built on first use.
+            Switching curve levels changes the AABBs of the curve BLAS, which is then rebuilt in place by updateLODBlases().
+        */
+        UpdateFlags updateLODs(bool forceUpdate);
+
         void updateGeometryStats();
         void updateMaterialStats();
         void updateRaytracingBLASStats();
@@ -1157,6 +1275,9 @@ namespace Falcor
         GeometryTypeFlags mGeometryTypes;                           ///< Set of geometry types that exist in the scene.
 
         std::vector<GeometryInstanceData> mGeometryInstanceData;    ///< Geometry instance data (for all types of geometry).
+        std::vector<uint32_t> mMatrixInstanceOffsets;               ///< Offset into mMatrixInstanceIDs per global matrix. Has one extra entry holding the total count.
+        std::vector<uint32_t> mMatrixInstanceIDs;                   ///< Geometry instance IDs grouped by the global matrix transforming them.
+        std::vector<uint32_t> mMovedInstanceIDs;                    ///< Geometry instance IDs whose transform changed in the last update.
 
         bool mUseCompressedHitInfo = false;                         ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
         bool mHas16BitIndices = false;                              ///< True if any meshes use 16-bit indices.
@@ -1172,6 +1293,7 @@ namespace Falcor
         std::vector<MeshGroup> mMeshGroups;                         ///< Groups of meshes. Each group maps to a BLAS for ray tracing.
         std::vector<std::string> mMeshNames;                        ///< Mesh names, indxed by mesh ID
         std::vector<Node> mSceneGraph;                              ///< For each index i, the array element indicates the parent node. Indices are in relation to mLocalToWorldMatrices.
+        std::unordered_map<uint32_t, EmissiveMeshData> mEmissiveMeshData; ///< CPU copies of the vertex/index data of static emissive meshes, indexed by mesh ID.
 
         // Displacement mapping.
         struct
@@ -1204,6 +1326,23 @@ namespace Falcor
         bool mCustomPrimitivesMoved = false;                        ///< Flag indicating that custom primitives were moved since last frame.
         bool mCustomPrimitivesChanged = false;                      ///< Flag indicating that custom primitives were added/removed since last frame.
 
+        // Levels of detail
+        struct LODInstance
+        {
+            uint32_t instanceID = 0;                                ///< Index into mGeometryInstanceData.
+            uint32_t baseGeometryID = 0;                            ///< Mesh or curve ID of the full detail geometry.
+            uint32_t level = 0;                                     ///< Currently selected level. Level 0 is the full detail geometry.
+        };
+        std::vector<std::vector<GeometryLOD>> mMeshLODs;            ///< Simplified levels of detail per mesh.
+        std::vector<std::vector<GeometryLOD>> mCurveLODs;           ///< Simplified levels of detail per curve.
+        std::vector<LODInstance> mLODInstances;                     ///< Geometry instances that have levels of detail to select from.
+        std::vector<uint32_t> mMeshGroupIDs;                        ///< Mesh group (BLAS) index per mesh. Only set up if the scene has mesh levels of detail.
+        uint32_t mCurveLODCount = 0;                                ///< Number of simplified curves. These are stored after the full detail curves and have no instances of their own.
+        bool mLODEnabled = true;                                    ///< True if level of detail selection is enabled.
+        float mLODMaxScreenError = 0.001f;                          ///< Maximum projected geometric error as a fraction of the viewport height.
+        bool mLODSettingsChanged = true;                            ///< Flag indicating that the level of detail settings changed since last frame.
+        bool mCurveLODsChanged = false;                             ///< Flag indicating that the selected curve levels changed and the curve BLAS needs to be rebuilt.
+
         // The following array and buffer records the AABBs of all procedural primitives, including custom primitives, curves, etc.
         std::vector<RtAABB> mRtAABBRaw;                             ///< Raw AABB data (min, max) for all procedural primitives.
         Buffer::SharedPtr mpRtAABBBuffer;                           ///< GPU Buffer of raw AABB data. Used for acceleration structure creation, and bound to the Scene for access in shaders.
@@ -1228,7 +1367,9 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
         AABB mSceneBB;                                              ///< Bounding boxes of the entire scene in world space.
+        InstanceBoundsTree mInstanceBoundsTree;                     ///< World space bounds of the geometry instances.
         SceneStats mSceneStats;                                     ///< Scene statistics.
+        std::unique_ptr<SceneUploadQueue> mpUploadQueue;            ///< Queue for batched buffer uploads. Only valid during scene construction.
         Metadata mMetadata;                                         ///< Importer-provided metadata.
         RenderSettings mRenderSettings;                             ///< Render settings.
         RenderSettings mPrevRenderSettings;
@@ -1250,6 +1391,11 @@ namespace Falcor
         uint32_t mSelectedCamera = 0;
         float mCameraSpeed = 1.0f;
         bool mCameraSwitched = false;
+        struct
+        {
+            uint32_t index = 0;                                     ///< Camera that was selected during the last update().
+            UpdateFlags updates = UpdateFlags::None;                ///< Camera changes found during the last update().
+        } mUpdateCamera;
         bool mCameraControlsEnabled = true;
 
         Gui::DropdownList mCameraList;
@@ -1275,18 +1421,23 @@ namespace Falcor
         UpdateMode mTlasUpdateMode = UpdateMode::Rebuild;   ///< How the TLAS should be updated when there are changes in the scene.
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
 
-        std::vector<RtInstanceDesc> mInstanceDescs; ///< Shared between TLAS builds to avoid reallocating CPU memory.
-
         struct TlasData
         {
             RtAccelerationStructure::SharedPtr pTlasObject;
             Buffer::SharedPtr pTlasBuffer;
             Buffer::SharedPtr pInstanceDescs;               ///< Buffer holding instance descs for the TLAS.
             UpdateMode updateMode = UpdateMode::Rebuild;    ///< Update mode this TLAS was created with.
+
+            std::vector<RtInstanceDesc> instanceDescs;      ///< CPU copy of the instance descs. Empty if they need to be regenerated.
+            std::vector<uint32_t> instanceMatrixIDs;        ///< Global matrix ID per instance desc, or kInvalidIndex for instances with identity transform.
+            uint64_t transformUpdateID = 0;                 ///< Value of mTransformUpdateID when the instance descs were last updated.
+            bool perMeshHitEntry = true;                    ///< Hit group indexing the instance descs were generated with.
         };
 
         std::unordered_map<uint32_t, TlasData> mTlasCache;  ///< Top Level Acceleration Structure for scene data cached per shader ray count.
                                                             ///< Number of ray types in program affects Shader Table indexing.
+        uint64_t mTransformUpdateID = 0;                    ///< Incremented each update in which geometry moved.
+        std::vector<uint64_t> mMatrixUpdateIDs;             ///< Value of mTransformUpdateID when each global matrix last changed.
         Buffer::SharedPtr mpTlasScratch;                    ///< Scratch buffer used for TLAS builds. Can be shared as long as instance desc count is the same, which for now it is.
         RtAccelerationStructurePrebuildInfo mTlasPrebuildInfo; ///< This can be reused as long as the number of instance descs doesn't change.
 
@@ -1313,6 +1464,8 @@ namespace Falcor
             bool hasDynamicCurve = false;                   ///< Whether the BLAS contains an animated curve cache, which means the BLAS may need to be updated.
             bool useCompaction = false;                     ///< Whether the BLAS should be compacted after build.
             UpdateMode updateMode = UpdateMode::Refit;      ///< Update mode this BLAS was created with.
+            bool isLODLevel = false;                        ///< True if the BLAS holds a simplified mesh level of detail. It is only built once selected.
+            bool hasCurveLODs = false;                      ///< True if the BLAS holds curves with levels of detail. It is sized for the full detail curves and rebuilt in place.
 
             bool hasDynamicGeometry() const
             {
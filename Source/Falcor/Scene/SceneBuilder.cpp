@@ -29,12 +29,16 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "MeshSimplifier.h"
 #include "Curves/CurveConfig.h"
+#include "Curves/CurveTessellation.h"
 #include "Utils/Math/MathConstants.slangh"
 #include "Utils/Image/TextureAnalyzer.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/NumericRange.h"
 #include <mikktspace.h>
 #include <filesystem>
+#include <execution>
 
 namespace Falcor
 {
@@ -48,6 +52,17 @@ namespace Falcor
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
 
+        // Level of detail generation. Each level targets a fraction of the primitives of the previous level.
+        // Meshes and curves below the minimum size are not simplified, and the chain ends when a level gets too small
+        // or fails to reduce the primitive count noticeably.
+        const uint32_t kMaxLODCount = 4;
+        const float kLODReduction = 0.25f;
+        const float kLODMinReduction = 0.8f;
+        const uint32_t kLODMinTriangleCount = 4096;
+        const uint32_t kLODMinLevelTriangleCount = 64;
+        const uint32_t kLODMinStrandCount = 256;
+        const uint32_t kLODMinLevelStrandCount = 16;
+
         int largestAxis(const float3& v)
         {
             if (v.x >= v.y && v.x >= v.z) return 0;
@@ -260,6 +275,8 @@ namespace Falcor
         createMeshGroups();
         optimizeGeometry();
         sortMeshes();
+        generateMeshLODs();
+        generateCurveLODs();
         createGlobalBuffers();
         createCurveGlobalBuffers();
         collectVolumeGrids();
@@ -731,6 +748,11 @@ namespace Falcor
     }
 
     uint32_t SceneBuilder::addProcessedCurve(const ProcessedCurve& curve)
+    {
+        return addProcessedCurve(ProcessedCurve(curve));
+    }
+
+    uint32_t SceneBuilder::addProcessedCurve(ProcessedCurve&& curve)
     {
         CurveSpec spec;
 
@@ -741,13 +763,12 @@ namespace Falcor
 
         spec.vertexCount = (uint32_t)curve.staticData.size();
         spec.staticVertexCount = (uint32_t)curve.staticData.size();
+        spec.indexCount = (uint32_t)curve.indexData.size();
 
         spec.indexData = std::move(curve.indexData);
         spec.staticData = std::move(curve.staticData);
 
-        spec.indexCount = (uint32_t)curve.indexData.size();
-
-        mCurves.push_back(spec);
+        mCurves.push_back(std::move(spec));
 
         if (mCurves.size() > std::numeric_limits<uint32_t>::max())
         {
@@ -971,12 +992,100 @@ namespace Falcor
         mSceneData.sdfGridInstances.push_back(instance);
     }
 
+    uint32_t SceneBuilder::addInstancer(const Instancer& instancer)
+    {
+        const size_t instanceCount = instancer.prototypeIndices.size();
+        const bool isAnimated = !instancer.keyframes.empty();
+        if (instanceCount == 0) return kInvalidNode;
+
+        checkArgument(instancer.parent == kInvalidNode || instancer.parent < mSceneGraph.size(), "'parent' ({}) is out of range", instancer.parent);
+        checkArgument(isAnimated || instancer.transforms.size() == instanceCount, "Instancer '{}' has {} instances but {} transforms", instancer.name, instanceCount, instancer.transforms.size());
+        checkArgument(!isAnimated || instancer.keyframes.size() % instanceCount == 0, "Instancer '{}' has {} instances but {} keyframes", instancer.name, instanceCount, instancer.keyframes.size());
+        for (uint32_t prototypeIndex : instancer.prototypeIndices)
+        {
+            checkArgument(prototypeIndex < instancer.prototypes.size(), "Instancer '{}' references prototype {} which is out of range", instancer.name, prototypeIndex);
+        }
+        for (const auto& prototype : instancer.prototypes)
+        {
+            for (const auto& part : prototype)
+            {
+                for (uint32_t meshID : part.meshIDs) checkArgument(meshID < mMeshes.size(), "'meshID' ({}) is out of range", meshID);
+            }
+        }
+
+        const uint32_t firstNodeID = (uint32_t)mSceneGraph.size();
+
+        // Static instances fold the transform of single-part prototypes into the instance node.
+        // All other parts with non-identity transforms get a child node of the instance node.
+        auto isFolded = [&](const Instancer::Prototype& prototype) { return !isAnimated && prototype.size() == 1; };
+        auto needsPartNode = [&](const Instancer::Prototype& prototype, const Instancer::PrototypePart& part)
+        {
+            return !isFolded(prototype) && part.transform != float4x4(1.f);
+        };
+
+        size_t nodeCount = instanceCount;
+        for (uint32_t prototypeIndex : instancer.prototypeIndices)
+        {
+            const auto& prototype = instancer.prototypes[prototypeIndex];
+            for (const auto& part : prototype) nodeCount += needsPartNode(prototype, part) ? 1 : 0;
+        }
+        if (mSceneGraph.size() + nodeCount >= std::numeric_limits<uint32_t>::max()) throw RuntimeError("Scene graph is too large");
+        mSceneGraph.reserve(mSceneGraph.size() + nodeCount);
+
+        // Animated instances are driven by a single animation targeting all instance nodes.
+        // The instance nodes are initialized to the transforms at the first keyframe.
+        Animation::SharedPtr pAnimation;
+        std::vector<float4x4> animatedTransforms;
+        if (isAnimated)
+        {
+            const size_t trackSize = instancer.keyframes.size() / instanceCount;
+            double duration = instancer.keyframes[trackSize - 1].time;
+            pAnimation = Animation::createInstanced(instancer.name, firstNodeID, (uint32_t)instanceCount, duration, instancer.keyframes);
+            animatedTransforms.resize(instanceCount);
+            pAnimation->animate(instancer.keyframes.front().time, animatedTransforms.data());
+        }
+
+        // Add the instance nodes. These are allocated consecutively.
+        for (size_t i = 0; i < instanceCount; i++)
+        {
+            const auto& prototype = instancer.prototypes[instancer.prototypeIndices[i]];
+            Node node;
+            node.transform = isAnimated ? animatedTransforms[i] : instancer.transforms[i];
+            if (isFolded(prototype)) node.transform = node.transform * prototype[0].transform;
+            node.parent = instancer.parent;
+            addNode(node);
+        }
+
+        // Add the prototype meshes.
+        for (size_t i = 0; i < instanceCount; i++)
+        {
+            const uint32_t instanceNodeID = firstNodeID + (uint32_t)i;
+            const auto& prototype = instancer.prototypes[instancer.prototypeIndices[i]];
+            for (const auto& part : prototype)
+            {
+                uint32_t nodeID = instanceNodeID;
+                if (needsPartNode(prototype, part))
+                {
+                    Node node;
+                    node.transform = part.transform;
+                    node.parent = instanceNodeID;
+                    nodeID = addNode(node);
+                }
+                for (uint32_t meshID : part.meshIDs) addMeshInstance(nodeID, meshID);
+            }
+        }
+
+        if (pAnimation) addAnimation(pAnimation);
+
+        return firstNodeID;
+    }
+
     bool SceneBuilder::doesNodeHaveAnimation(uint32_t nodeID) const
     {
         FALCOR_ASSERT(nodeID != kInvalidNode && nodeID < mSceneGraph.size());
         for (const auto& pAnimation : mSceneData.animations)
         {
-            if (pAnimation->getNodeID() == nodeID) return true;
+            if (nodeID >= pAnimation->getNodeID() && nodeID - pAnimation->getNodeID() < pAnimation->getNodeCount()) return true;
         }
 
         return false;
@@ -1001,7 +1110,7 @@ namespace Falcor
         {
             for (const auto& pAnimation : mSceneData.animations)
             {
-                if (pAnimation->getNodeID() == nodeID)
+                if (nodeID >= pAnimation->getNodeID() && nodeID - pAnimation->getNodeID() < pAnimation->getNodeCount())
                 {
                     pAnimation->setInterpolationMode(interpolationMode);
                     pAnimation->setEnableWarping(enableWarping);
@@ -1683,6 +1792,8 @@ namespace Falcor
         //  - Instanced meshes are sorted into groups (BLASes) with identical instances.
         //    The idea is that all parts of an instanced object go in the same BLAS and the TLAS instances apply the transforms.
         //    Note that dynamic (skinned) meshes currently cannot be instanced due to limitations in the scene structures. See #1118.
+        //  - Meshes that get levels of detail are placed in individual groups (BLASes).
+        //    Each level is placed in a BLAS of its own later, so that the TLAS instances can switch between them.
         // TODO: Add build flag to turn off pre-transformation to world space.
 
         // Classify non-instanced meshes.
@@ -1694,6 +1805,7 @@ namespace Falcor
         meshList staticMeshes;
         meshList staticDisplacedMeshes;
         meshList dynamicDisplacedMeshes;
+        meshList lodMeshes;
         size_t nonInstancedMeshCount = 0;
 
         for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
@@ -1708,6 +1820,12 @@ namespace Falcor
             const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId);
             if (pMaterial->isDisplaced()) mesh.isDisplaced = true;
 
+            if (isLODCandidate(mesh))
+            {
+                lodMeshes.push_back(meshID);
+                continue;
+            }
+
             if (mesh.isStatic && mesh.isDisplaced) staticDisplacedMeshes.push_back(meshID);
             else if (mesh.isStatic) staticMeshes.push_back(meshID);
             else if (!mesh.isStatic && mesh.isDisplaced) dynamicDisplacedMeshes.push_back(meshID);
@@ -1740,6 +1858,12 @@ namespace Falcor
             const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId);
             if (pMaterial->isDisplaced()) mesh.isDisplaced = true;
 
+            if (isLODCandidate(mesh))
+            {
+                lodMeshes.push_back(meshID);
+                continue;
+            }
+
             instances inst(mesh.instances.begin(), mesh.instances.end());
             if (mesh.isDisplaced) displacedInstancesToMeshList[inst].push_back(meshID);
             else instancesToMeshList[inst].push_back(meshID);
@@ -1768,6 +1892,7 @@ namespace Falcor
         logInfo("Found {} displaced non-instanced meshes, arranged in 1 mesh group.", staticDisplacedMeshes.size());
         logInfo("Found {} dynamic non-instanced meshes, arranged in {} mesh groups.", nonInstancedDynamicMeshCount, nodeToMeshList.size());
         logInfo("Found {} instanced meshes, arranged in {} mesh groups.", instancedMeshCount, instancesToMeshList.size());
+        if (!lodMeshes.empty()) logInfo("Found {} meshes to generate levels of detail for, arranged in {} mesh groups.", lodMeshes.size(), lodMeshes.size());
 
         // Build final result. Format is a list of Mesh ID's per mesh group.
 
@@ -1818,6 +1943,23 @@ namespace Falcor
         {
             addMeshes(it.second, false, true, is_set(mFlags, Flags::RTDontMergeInstanced));
         }
+
+        // Meshes that get levels of detail each go in an individual group.
+        for (const auto& meshID : lodMeshes)
+        {
+            mMeshGroups.push_back(MeshGroup{ meshList({ meshID }), mMeshes[meshID].isStatic, false });
+        }
+    }
+
+    bool SceneBuilder::isLODCandidate(const MeshSpec& mesh) const
+    {
+        // Levels of detail are generated for large static triangle meshes only.
+        // Emissive meshes are excluded as the light collection samples the full detail triangles.
+        if (!is_set(mFlags, Flags::GenerateLODs)) return false;
+        if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0) return false;
+        if (mesh.isDynamic() || mesh.isDisplaced) return false;
+        if (mesh.getTriangleCount() < kLODMinTriangleCount) return false;
+        return !mSceneData.pMaterials->getMaterial(mesh.materialId)->isEmissive();
     }
 
     std::pair<std::optional<uint32_t>, std::optional<uint32_t>> SceneBuilder::splitMesh(const uint32_t meshID, const int axis, const float pos)
@@ -2233,6 +2375,175 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::generateMeshLODs()
+    {
+        // This function generates a chain of simplified levels of detail for the meshes selected by isLODCandidate().
+        // Each level is added as a new mesh without instances, in a mesh group (BLAS) of its own.
+        // The scene switches the instances of the full detail mesh between the levels at runtime.
+        // The new meshes are appended after all other meshes, so this needs to run after sortMeshes().
+        if (!is_set(mFlags, Flags::GenerateLODs)) return;
+
+        std::vector<uint32_t> baseMeshes;
+        for (const auto& meshGroup : mMeshGroups)
+        {
+            if (meshGroup.meshList.size() == 1 && isLODCandidate(mMeshes[meshGroup.meshList[0]])) baseMeshes.push_back(meshGroup.meshList[0]);
+        }
+        if (baseMeshes.empty()) return;
+
+        auto createLODMesh = [this](const MeshSpec& mesh, const std::vector<uint32_t>& indices, uint32_t level)
+        {
+            MeshSpec spec;
+            spec.name = mesh.name + ".LOD" + std::to_string(level);
+            spec.topology = mesh.topology;
+            spec.materialId = mesh.materialId;
+            spec.isStatic = mesh.isStatic;
+            spec.isFrontFaceCW = mesh.isFrontFaceCW;
+            spec.isLOD = true;
+
+            // The simplified triangles reference a subset of the original vertices. Copy and compact these.
+            const uint32_t invalidIdx = uint32_t(-1);
+            std::vector<uint32_t> indexMap(mesh.staticData.size(), invalidIdx);
+            spec.indexData.reserve(indices.size());
+            for (uint32_t index : indices)
+            {
+                if (indexMap[index] == invalidIdx)
+                {
+                    indexMap[index] = (uint32_t)spec.staticData.size();
+                    spec.staticData.push_back(mesh.staticData[index]);
+                }
+                spec.indexData.push_back(indexMap[index]);
+            }
+
+            spec.indexCount = (uint32_t)spec.indexData.size();
+            spec.vertexCount = (uint32_t)spec.staticData.size();
+            spec.staticVertexCount = spec.vertexCount;
+
+            spec.use16BitIndices = (spec.vertexCount <= (1u << 16)) && !(is_set(mFlags, Flags::Force32BitIndices));
+            if (spec.use16BitIndices) spec.indexData = compact16BitIndices(spec.indexData);
+
+            for (auto& v : spec.staticData) spec.boundingBox.include(v.position);
+            return spec;
+        };
+
+        // Simplify the meshes in parallel. Each level is simplified from the previous one until the triangle count
+        // gets too small or the simplifier can't reduce it noticeably anymore.
+        std::vector<std::vector<std::pair<MeshSpec, float>>> levels(baseMeshes.size());
+        auto range = NumericRange<uint32_t>(0, (uint32_t)baseMeshes.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
+        {
+            const auto& mesh = mMeshes[baseMeshes[i]];
+
+            std::vector<float3> positions(mesh.staticData.size());
+            for (size_t j = 0; j < positions.size(); j++) positions[j] = mesh.staticData[j].position;
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (size_t j = 0; j < indices.size(); j++) indices[j] = mesh.getIndex(j);
+
+            uint32_t triangleCount = mesh.getTriangleCount();
+            float error = 0.f;
+            for (uint32_t level = 1; level <= kMaxLODCount; level++)
+            {
+                uint32_t targetTriangleCount = (uint32_t)(triangleCount * kLODReduction);
+                if (targetTriangleCount < kLODMinLevelTriangleCount) break;
+
+                auto result = MeshSimplifier::simplify(positions, indices, targetTriangleCount);
+                uint32_t resultTriangleCount = (uint32_t)result.indices.size() / 3;
+                if (resultTriangleCount == 0 || resultTriangleCount > triangleCount * kLODMinReduction) break;
+
+                // The error is measured against the previous level. Accumulate it to bound the error against the full detail mesh.
+                error += result.error;
+                indices = std::move(result.indices);
+                triangleCount = resultTriangleCount;
+
+                levels[i].emplace_back(createLODMesh(mesh, indices, level), error);
+            }
+        });
+
+        // Add the levels as new meshes, each in a mesh group of its own.
+        const size_t baseMeshCount = mMeshes.size();
+        mSceneData.meshLODs.resize(baseMeshCount);
+        for (size_t i = 0; i < baseMeshes.size(); i++)
+        {
+            auto& lods = mSceneData.meshLODs[baseMeshes[i]];
+            for (auto& [spec, error] : levels[i])
+            {
+                uint32_t meshID = (uint32_t)mMeshes.size();
+                mMeshes.push_back(std::move(spec));
+                mMeshGroups.push_back(MeshGroup{ std::vector<uint32_t>({ meshID }), false, false });
+                lods.push_back({ meshID, error });
+            }
+        }
+        mSceneData.meshLODs.resize(mMeshes.size());
+
+        logInfo("Generated {} levels of detail for {} meshes.", mMeshes.size() - baseMeshCount, baseMeshes.size());
+    }
+
+    void SceneBuilder::generateCurveLODs()
+    {
+        // This function generates a chain of levels of detail for large linear swept sphere curves.
+        // The strands of each curve are clustered into fewer, wider strands (see CurveTessellation::clusterStrands()).
+        // Each level is clustered from the full detail curve and added as a new curve without instances after all other curves.
+        // Curves with vertex caches are skipped as only the full detail curves are animated.
+        if (!is_set(mFlags, Flags::GenerateLODs) || !mSceneData.cachedCurves.empty()) return;
+
+        const uint32_t baseCurveCount = (uint32_t)mCurves.size();
+        mSceneData.curveLODs.resize(baseCurveCount);
+        uint32_t curvesWithLODs = 0;
+
+        for (uint32_t curveID = 0; curveID < baseCurveCount; curveID++)
+        {
+            std::vector<CurveSpec> lodCurves;
+            {
+                const auto& curve = mCurves[curveID];
+                if (curve.instances.size() != 1 || curve.degree != 1 || curve.indexData.empty()) continue;
+
+                // Strands are runs of segments with consecutive vertices.
+                uint32_t strandCount = 1;
+                for (size_t i = 1; i < curve.indexData.size(); i++)
+                {
+                    if (curve.indexData[i] != curve.indexData[i - 1] + 1) strandCount++;
+                }
+                if (strandCount < kLODMinStrandCount) continue;
+
+                uint32_t prevStrandCount = strandCount;
+                float targetStrandCount = (float)strandCount;
+                for (uint32_t level = 1; level <= kMaxLODCount; level++)
+                {
+                    targetStrandCount *= kLODReduction;
+                    if (targetStrandCount < kLODMinLevelStrandCount) break;
+
+                    auto result = CurveTessellation::clusterStrands(curve.indexData.data(), (uint32_t)curve.indexData.size(), curve.staticData.data(), (uint32_t)targetStrandCount);
+                    if (result.strandCount > prevStrandCount * kLODMinReduction) break;
+                    prevStrandCount = result.strandCount;
+
+                    CurveSpec spec;
+                    spec.name = curve.name + ".LOD" + std::to_string(level);
+                    spec.topology = curve.topology;
+                    spec.materialId = curve.materialId;
+                    spec.degree = curve.degree;
+                    spec.vertexCount = (uint32_t)result.vertices.size();
+                    spec.staticVertexCount = spec.vertexCount;
+                    spec.indexCount = (uint32_t)result.indices.size();
+                    spec.indexData = std::move(result.indices);
+                    spec.staticData = std::move(result.vertices);
+                    lodCurves.push_back(std::move(spec));
+
+                    mSceneData.curveLODs[curveID].push_back({ 0, result.error });
+                }
+            }
+
+            // Add the levels as new curves.
+            for (size_t level = 0; level < lodCurves.size(); level++)
+            {
+                mSceneData.curveLODs[curveID][level].geometryID = (uint32_t)mCurves.size();
+                mCurves.push_back(std::move(lodCurves[level]));
+            }
+            if (!lodCurves.empty()) curvesWithLODs++;
+        }
+        mSceneData.curveLODs.resize(mCurves.size());
+
+        if (curvesWithLODs > 0) logInfo("Generated {} levels of detail for {} curves.", mCurves.size() - baseCurveCount, curvesWithLODs);
+    }
+
     void SceneBuilder::createGlobalBuffers()
     {
         FALCOR_ASSERT(mSceneData.meshIndexData.empty());
@@ -2596,7 +2907,8 @@ namespace Falcor
             const auto& firstMesh = mMeshes[meshList[0]];
             size_t instanceCount = firstMesh.instances.size();
 
-            FALCOR_ASSERT(instanceCount > 0);
+            // Simplified levels of detail have no instances of their own.
+            FALCOR_ASSERT(instanceCount > 0 || firstMesh.isLOD);
             for (size_t instanceIdx = 0; instanceIdx < instanceCount; instanceIdx++)
             {
                 uint32_t blasGeometryIndex = 0;
@@ -2775,6 +3087,7 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("GenerateLODs", SceneBuilder::Flags::GenerateLODs);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -64,6 +64,7 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            GenerateLODs                    = 0x20000,  ///< Generate simplified levels of detail for large static meshes and curves. The scene selects a level per instance based on its projected size.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -312,6 +313,31 @@ namespace Falcor
             uint32_t parent = kInvalidNode;
         };
 
+        /** Point instancer placing many instances of a set of prototypes.
+            Instance data is passed in packed arrays, but the instances are expanded when added to the builder:
+            each instance gets an unnamed scene graph node, and each prototype mesh gets a regular mesh instance per instance.
+            The scene therefore holds one transform and one geometry instance per mesh per instance, as with individually added instances.
+            What is saved are per-instance names, prototype subgraph copies and animations; animated instances share a single animation.
+        */
+        struct Instancer
+        {
+            /** Part of a prototype, consisting of meshes sharing the same transform relative to the instance.
+            */
+            struct PrototypePart
+            {
+                std::vector<uint32_t> meshIDs;              ///< Mesh IDs.
+                float4x4 transform = float4x4(1.f);         ///< Transform relative to the instance.
+            };
+            using Prototype = std::vector<PrototypePart>;
+
+            std::string name;                               ///< Instancer name. Used as name of the animation of animated instances.
+            uint32_t parent = kInvalidNode;                 ///< Parent node of all instances.
+            std::vector<Prototype> prototypes;              ///< List of prototypes.
+            std::vector<uint32_t> prototypeIndices;         ///< Prototype index per instance.
+            std::vector<float4x4> transforms;               ///< Transform per instance. Only used if the instances are not animated.
+            std::vector<Animation::Keyframe> keyframes;     ///< Keyframes of animated instances, otherwise empty. Stored as one track per instance, all with the same length and keyframe times.
+        };
+
         using InstanceMatrices = std::vector<float4x4>;
 
         /** Create a new object
@@ -437,6 +463,12 @@ namespace Falcor
         */
         uint32_t addProcessedCurve(const ProcessedCurve& curve);
 
+        /** Add a pre-processed curve. The curve data is moved into the scene builder without copying.
+            \param curve The pre-processed curve.
+            \return The ID of the curve in the scene. Note that all of the instances share the same curve ID.
+        */
+        uint32_t addProcessedCurve(ProcessedCurve&& curve);
+
         /** Set curve vertex cache for animation.
             \param[in] cachedCurves The dynamic curve vertex cache data.
         */
@@ -603,6 +635,14 @@ namespace Falcor
         */
         void addSDFGridInstance(uint32_t nodeID, uint32_t sdfGridID);
 
+        /** Add the instances of a point instancer.
+            One node is added per instance, and one mesh instance per prototype mesh and instance.
+            The instance nodes are allocated consecutively, followed by nodes for prototype parts with non-identity transforms where needed.
+            \param[in] instancer The instancer.
+            \return The node ID of the first instance, or kInvalidNode if the instancer has no instances.
+        */
+        uint32_t addInstancer(const Instancer& instancer);
+
         /** Check if a scene node is animated. This check is done recursively through parent nodes.
             \return Returns true if node is animated.
         */
@@ -652,6 +692,7 @@ namespace Falcor
             bool isFrontFaceCW = false;             ///< Indicate whether front-facing side has clockwise winding in object space.
             bool isDisplaced = false;               ///< True if mesh has displacement map.
             bool isAnimated = false;                ///< True if mesh has vertex animations.
+            bool isLOD = false;                     ///< True if mesh is a simplified level of detail of another mesh. These meshes have no instances of their own.
             AABB boundingBox;                       ///< Mesh bounding-box in object space.
             std::vector<uint32_t> instances;        ///< Node IDs of all instances of this mesh.
 
@@ -748,6 +789,9 @@ namespace Falcor
         MeshGroupList splitMeshGroupMedian(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
 
+        // Level of detail
+        bool isLODCandidate(const MeshSpec& mesh) const;
+
         // Post processing
         void prepareDisplacementMaps();
         void prepareSceneGraph();
@@ -761,6 +805,8 @@ namespace Falcor
         void createMeshGroups();
         void optimizeGeometry();
         void sortMeshes();
+        void generateMeshLODs();
+        void generateCurveLODs();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
         void optimizeMaterials();
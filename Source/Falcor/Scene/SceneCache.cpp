@@ -38,7 +38,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 29;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -57,6 +57,21 @@ namespace Falcor
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        template<typename T>
+        std::vector<T> readBackBuffer(RenderContext* pRenderContext, const Buffer::SharedPtr& pBuffer, uint32_t elementCount)
+        {
+            std::vector<T> data(elementCount);
+            if (elementCount == 0) return data;
+
+            size_t size = elementCount * sizeof(T);
+            Buffer::SharedPtr pStagingBuffer = Buffer::create(size, Resource::BindFlags::None, Buffer::CpuAccess::Read);
+            pRenderContext->copyBufferRegion(pStagingBuffer.get(), 0, pBuffer.get(), 0, size);
+            pRenderContext->flush(true);
+            std::memcpy(data.data(), pStagingBuffer->map(Buffer::MapType::Read), size);
+            pStagingBuffer->unmap();
+            return data;
+        }
     }
 
     /** Wrapper around std::ostream to ease serialization of basic types.
@@ -286,6 +301,19 @@ namespace Falcor
         stream.write((uint32_t)sceneData.gridVolumes.size());
         for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
 
+        writeMarker(stream, "SDFGrids");
+        stream.write((uint32_t)sceneData.sdfGrids.size());
+        for (const auto& pSDFGrid : sceneData.sdfGrids) writeSDFGrid(stream, pSDFGrid);
+        stream.write((uint32_t)sceneData.sdfGridDesc.size());
+        for (const auto& desc : sceneData.sdfGridDesc)
+        {
+            stream.write(desc.sdfGridID);
+            stream.write(desc.materialID);
+            stream.write(desc.instances);
+        }
+        stream.write(sceneData.sdfGridInstances);
+        stream.write(sceneData.sdfGridMaxLODCount);
+
         writeMarker(stream, "EnvMap");
         bool hasEnvMap = sceneData.pEnvMap != nullptr;
         stream.write(hasEnvMap);
@@ -332,6 +360,11 @@ namespace Falcor
             stream.write(group.isStatic);
             stream.write(group.isDisplaced);
         }
+        stream.write((uint32_t)sceneData.meshLODs.size());
+        for (const auto& lods : sceneData.meshLODs)
+        {
+            stream.write(lods);
+        }
         stream.write((uint32_t)sceneData.cachedMeshes.size());
         for (const auto& cachedMesh : sceneData.cachedMeshes)
         {
@@ -354,6 +387,11 @@ namespace Falcor
         stream.write(sceneData.curveInstanceData);
         stream.write(sceneData.curveIndexData);
         stream.write(sceneData.curveStaticData);
+        stream.write((uint32_t)sceneData.curveLODs.size());
+        for (const auto& lods : sceneData.curveLODs)
+        {
+            stream.write(lods);
+        }
 
         stream.write((uint32_t)sceneData.cachedCurves.size());
         for (const auto& cachedCurve : sceneData.cachedCurves)
@@ -402,6 +440,19 @@ namespace Falcor
         sceneData.gridVolumes.resize(stream.read<uint32_t>());
         for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids);
 
+        readMarker(stream, "SDFGrids");
+        sceneData.sdfGrids.resize(stream.read<uint32_t>());
+        for (auto& pSDFGrid : sceneData.sdfGrids) pSDFGrid = readSDFGrid(stream);
+        sceneData.sdfGridDesc.resize(stream.read<uint32_t>());
+        for (auto& desc : sceneData.sdfGridDesc)
+        {
+            stream.read(desc.sdfGridID);
+            stream.read(desc.materialID);
+            stream.read(desc.instances);
+        }
+        stream.read(sceneData.sdfGridInstances);
+        stream.read(sceneData.sdfGridMaxLODCount);
+
         readMarker(stream, "EnvMap");
         auto hasEnvMap = stream.read<bool>();
         if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream);
@@ -409,7 +460,7 @@ namespace Falcor
         // Material textures are loaded asynchronously to allow loading other data
         // in parallel while loading textures from files and uploading them to the GPU.
         // Due to the current implementation, we need to make sure no other GPU operations (transfers)
-        // are executed while loading material textures. Due to this, we load volume grids and the envmap
+        // are executed while loading material textures. Due to this, we load volume grids, SDF grids and the envmap
         // before material textures, as they upload buffers to the GPU when created.
         // Make sure no other GPU operations are executed until calling pMaterialTextureLoader.reset()
         // further down which blocks until all textures are loaded.
@@ -453,6 +504,11 @@ namespace Falcor
             stream.read(group.isStatic);
             stream.read(group.isDisplaced);
         }
+        sceneData.meshLODs.resize(stream.read<uint32_t>());
+        for (auto& lods : sceneData.meshLODs)
+        {
+            stream.read(lods);
+        }
         sceneData.cachedMeshes.resize(stream.read<uint32_t>());
         for (auto& cachedMesh : sceneData.cachedMeshes)
         {
@@ -475,6 +531,11 @@ namespace Falcor
         stream.read(sceneData.curveInstanceData);
         stream.read(sceneData.curveIndexData);
         stream.read(sceneData.curveStaticData);
+        sceneData.curveLODs.resize(stream.read<uint32_t>());
+        for (auto& lods : sceneData.curveLODs)
+        {
+            stream.read(lods);
+        }
 
         sceneData.cachedCurves.resize(stream.read<uint32_t>());
         for (auto& cachedCurve : sceneData.cachedCurves)
@@ -819,6 +880,7 @@ namespace Falcor
         }
         stream.write(pGridVolume->mGridFrame);
         stream.write(pGridVolume->mGridFrameCount);
+        stream.write(pGridVolume->mStreamingWindow);
         stream.write(pGridVolume->mBounds);
         stream.write(pGridVolume->mData);
     }
@@ -843,9 +905,15 @@ namespace Falcor
         }
         stream.read(pGridVolume->mGridFrame);
         stream.read(pGridVolume->mGridFrameCount);
+        stream.read(pGridVolume->mStreamingWindow);
         stream.read(pGridVolume->mBounds);
         stream.read(pGridVolume->mData);
 
+        // Make the current frame of streamed grid sequences resident.
+        pGridVolume->updateSequence();
+        pGridVolume->updateStreaming();
+        pGridVolume->clearUpdates();
+
         return pGridVolume;
     }
 
@@ -853,6 +921,15 @@ namespace Falcor
 
     void SceneCache::writeGrid(OutputStream& stream, const Grid::SharedPtr& pGrid)
     {
+        // Streamed grids only store a reference to their file.
+        stream.write(pGrid->isStreamed());
+        if (pGrid->isStreamed())
+        {
+            stream.write(pGrid->mPath.string());
+            stream.write(pGrid->mGridname);
+            return;
+        }
+
         const nanovdb::HostBuffer& buffer = pGrid->mGridHandle.buffer();
         stream.write((uint64_t)buffer.size());
         stream.write(buffer.data(), buffer.size());
@@ -860,12 +937,216 @@ namespace Falcor
 
     Grid::SharedPtr SceneCache::readGrid(InputStream& stream)
     {
+        bool streamed = stream.read<bool>();
+        if (streamed)
+        {
+            std::string path = stream.read<std::string>();
+            std::string gridname = stream.read<std::string>();
+            auto pGrid = Grid::createStreamed(path, gridname);
+            if (!pGrid) throw RuntimeError("Failed to load streamed grid '{}' from '{}'.", gridname, path);
+            return pGrid;
+        }
+
         uint64_t size = stream.read<uint64_t>();
         auto buffer = nanovdb::HostBuffer::create(size);
         stream.read(buffer.data(), buffer.size());
         return Grid::SharedPtr(new Grid(nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer))));
     }
 
+    // SDFGrid
+
+    void SceneCache::writeSDFGrid(OutputStream& stream, const SDFGrid::SharedPtr& pSDFGrid)
+    {
+        readBackSDFGrid(pSDFGrid);
+
+        SDFGrid::Type type = pSDFGrid->getType();
+        stream.write(type);
+
+        switch (type)
+        {
+        case SDFGrid::Type::NormalizedDenseGrid:
+        {
+            const NDSDFGrid* pNDSDFGrid = static_cast<const NDSDFGrid*>(pSDFGrid.get());
+            stream.write(pNDSDFGrid->mNarrowBandThickness);
+            stream.write(pNDSDFGrid->mCoarsestLODGridWidth);
+            stream.write(pNDSDFGrid->mCoarsestLODNormalizationFactor);
+            stream.write((uint32_t)pNDSDFGrid->mValues.size());
+            for (const auto& lodValues : pNDSDFGrid->mValues) stream.write(lodValues);
+            break;
+        }
+        case SDFGrid::Type::SparseVoxelSet:
+        {
+            const SDFSVS* pSVS = static_cast<const SDFSVS*>(pSDFGrid.get());
+            stream.write(pSVS->mValues);
+            break;
+        }
+        case SDFGrid::Type::SparseBrickSet:
+        {
+            const SDFSBS* pSBS = static_cast<const SDFSBS*>(pSDFGrid.get());
+            stream.write(pSBS->mBrickWidth);
+            stream.write(pSBS->mCompressed);
+            stream.write(pSBS->mVirtualBricksPerAxis);
+            stream.write(pSBS->mBricksPerAxis);
+            stream.write(pSBS->mBrickTextureDimensions);
+            stream.write(pSBS->mBrickVirtualIDs);
+            stream.write(pSBS->mBrickAABBs);
+            stream.write(pSBS->mBrickTextureData);
+            break;
+        }
+        case SDFGrid::Type::SparseVoxelOctree:
+        {
+            const SDFSVO* pSVO = static_cast<const SDFSVO*>(pSDFGrid.get());
+            stream.write(pSVO->mLevelCount);
+            stream.write(pSVO->mSVOVoxels);
+            break;
+        }
+        default:
+            throw RuntimeError("Unsupported SDF grid type '{}'.", SDFGrid::getTypeName(type));
+        }
+
+        stream.write(pSDFGrid->mName);
+        stream.write(pSDFGrid->mOriginalGridWidth);
+        stream.write(pSDFGrid->mGridWidth);
+
+        // Primitives are stored to allow editing the SDF grid after loading it from the cache.
+        stream.write(pSDFGrid->mPrimitives);
+        stream.write((uint32_t)pSDFGrid->mPrimitiveIDToIndex.size());
+        for (const auto& [id, index] : pSDFGrid->mPrimitiveIDToIndex)
+        {
+            stream.write(id);
+            stream.write(index);
+        }
+        stream.write(pSDFGrid->mNextPrimitiveID);
+    }
+
+    SDFGrid::SharedPtr SceneCache::readSDFGrid(InputStream& stream)
+    {
+        SDFGrid::SharedPtr pSDFGrid;
+
+        SDFGrid::Type type = stream.read<SDFGrid::Type>();
+        switch (type)
+        {
+        case SDFGrid::Type::NormalizedDenseGrid:
+        {
+            NDSDFGrid::SharedPtr pNDSDFGrid = NDSDFGrid::create(stream.read<float>());
+            stream.read(pNDSDFGrid->mCoarsestLODGridWidth);
+            stream.read(pNDSDFGrid->mCoarsestLODNormalizationFactor);
+            pNDSDFGrid->mValues.resize(stream.read<uint32_t>());
+            for (auto& lodValues : pNDSDFGrid->mValues) stream.read(lodValues);
+            pSDFGrid = pNDSDFGrid;
+            break;
+        }
+        case SDFGrid::Type::SparseVoxelSet:
+        {
+            SDFSVS::SharedPtr pSVS = SDFSVS::create();
+            stream.read(pSVS->mValues);
+            pSDFGrid = pSVS;
+            break;
+        }
+        case SDFGrid::Type::SparseBrickSet:
+        {
+            uint32_t brickWidth = stream.read<uint32_t>();
+            bool compressed = stream.read<bool>();
+            SDFSBS::SharedPtr pSBS = SDFSBS::create(brickWidth, compressed);
+            stream.read(pSBS->mVirtualBricksPerAxis);
+            stream.read(pSBS->mBricksPerAxis);
+            stream.read(pSBS->mBrickTextureDimensions);
+            stream.read(pSBS->mBrickVirtualIDs);
+            stream.read(pSBS->mBrickAABBs);
+            stream.read(pSBS->mBrickTextureData);
+            pSBS->mBrickCount = (uint32_t)pSBS->mBrickVirtualIDs.size();
+            pSDFGrid = pSBS;
+            break;
+        }
+        case SDFGrid::Type::SparseVoxelOctree:
+        {
+            SDFSVO::SharedPtr pSVO = SDFSVO::create();
+            stream.read(pSVO->mLevelCount);
+            stream.read(pSVO->mSVOVoxels);
+            pSVO->mSVOElementCount = (uint32_t)pSVO->mSVOVoxels.size();
+            pSDFGrid = pSVO;
+            break;
+        }
+        default:
+            throw RuntimeError("Unsupported SDF grid type '{}'.", (uint32_t)type);
+        }
+
+        stream.read(pSDFGrid->mName);
+        stream.read(pSDFGrid->mOriginalGridWidth);
+        stream.read(pSDFGrid->mGridWidth);
+
+        stream.read(pSDFGrid->mPrimitives);
+        uint32_t primitiveIDCount = stream.read<uint32_t>();
+        pSDFGrid->mPrimitiveIDToIndex.reserve(primitiveIDCount);
+        for (uint32_t i = 0; i < primitiveIDCount; i++)
+        {
+            uint32_t id = stream.read<uint32_t>();
+            pSDFGrid->mPrimitiveIDToIndex[id] = stream.read<uint32_t>();
+        }
+        stream.read(pSDFGrid->mNextPrimitiveID);
+
+        // The cached representation already reflects the primitives, so they are not marked dirty.
+        if (!pSDFGrid->mPrimitives.empty()) pSDFGrid->updatePrimitivesBuffer();
+        pSDFGrid->mPrimitivesDirty = false;
+
+        return pSDFGrid;
+    }
+
+    void SceneCache::readBackSDFGrid(const SDFGrid::SharedPtr& pSDFGrid)
+    {
+        RenderContext* pRenderContext = gpDevice->getRenderContext();
+
+        if (pSDFGrid->getType() == SDFGrid::Type::SparseBrickSet)
+        {
+            SDFSBS* pSBS = static_cast<SDFSBS*>(pSDFGrid.get());
+
+            // Bricks built on the CPU are already available.
+            if (!pSBS->mBrickVirtualIDs.empty() && !pSBS->mPrimitivesDirty) return;
+
+            pSBS->createResources(pRenderContext);
+
+            const uint32_t brickCount = pSBS->mBrickCount;
+            pSBS->mBrickAABBs = readBackBuffer<AABB>(pRenderContext, pSBS->mpBrickAABBsBuffer, brickCount);
+
+            // Invert the indirection texture to get the virtual brick ID of each brick.
+            const Texture* pIndirectionTexture = pSBS->mpIndirectionTexture.get();
+            std::vector<uint8_t> indirectionData = pRenderContext->readTextureSubresource(pIndirectionTexture, 0);
+            const uint32_t* pIndirection = reinterpret_cast<const uint32_t*>(indirectionData.data());
+            const uint32_t textureWidth = pIndirectionTexture->getWidth();
+            const uint32_t textureHeight = pIndirectionTexture->getHeight();
+            const uint32_t virtualBricksPerAxis = pSBS->mVirtualBricksPerAxis;
+
+            pSBS->mBrickVirtualIDs.assign(brickCount, std::numeric_limits<uint32_t>::max());
+            for (uint32_t z = 0; z < virtualBricksPerAxis; z++)
+            {
+                for (uint32_t y = 0; y < virtualBricksPerAxis; y++)
+                {
+                    for (uint32_t x = 0; x < virtualBricksPerAxis; x++)
+                    {
+                        uint32_t brickID = pIndirection[x + textureWidth * (y + textureHeight * z)];
+                        if (brickID < brickCount) pSBS->mBrickVirtualIDs[brickID] = x + virtualBricksPerAxis * (y + virtualBricksPerAxis * z);
+                    }
+                }
+            }
+
+            pSBS->mBrickTextureData = pRenderContext->readTextureSubresource(pSBS->mpBrickTexture.get(), 0);
+
+            // The dense values are not needed anymore, the scene uploads the bricks instead of rebuilding them.
+            pSBS->mValues.clear();
+        }
+        else if (pSDFGrid->getType() == SDFGrid::Type::SparseVoxelOctree)
+        {
+            SDFSVO* pSVO = static_cast<SDFSVO*>(pSDFGrid.get());
+
+            // An octree built on the CPU is already available.
+            if (!pSVO->mSVOVoxels.empty()) return;
+
+            pSVO->createResources(pRenderContext);
+            pSVO->mSVOVoxels = readBackBuffer<SDFSVOVoxel>(pRenderContext, pSVO->mpSVOBuffer, pSVO->mSVOElementCount);
+            pSVO->mValues.clear();
+        }
+    }
+
     // EnvMap
 
     void SceneCache::writeEnvMap(OutputStream& stream, const EnvMap::SharedPtr& pEnvMap)
@@ -910,6 +1191,7 @@ namespace Falcor
     {
         stream.write(pAnimation->mName);
         stream.write(pAnimation->mNodeID);
+        stream.write(pAnimation->mNodeCount);
         stream.write(pAnimation->mDuration);
         stream.write(pAnimation->mPreInfinityBehavior);
         stream.write(pAnimation->mPostInfinityBehavior);
@@ -923,6 +1205,7 @@ namespace Falcor
         Animation::SharedPtr pAnimation = Animation::create("", 0, 0.0);
         stream.read(pAnimation->mName);
         stream.read(pAnimation->mNodeID);
+        stream.read(pAnimation->mNodeCount);
         stream.read(pAnimation->mDuration);
         stream.read(pAnimation->mPreInfinityBehavior);
         stream.read(pAnimation->mPostInfinityBehavior);
@@ -95,6 +95,15 @@ namespace Falcor
         static void writeGrid(OutputStream& stream, const Grid::SharedPtr& pGrid);
         static Grid::SharedPtr readGrid(InputStream& stream);
 
+        static void writeSDFGrid(OutputStream& stream, const SDFGrid::SharedPtr& pSDFGrid);
+        static SDFGrid::SharedPtr readSDFGrid(InputStream& stream);
+
+        /** Builds an SDFSBS or SDFSVO on the GPU if required and reads the final representation back into its CPU data.
+            This allows cached scenes to upload the representation directly instead of rebuilding it.
+            \param[in] pSDFGrid The SDF grid, other SDF grid types are left untouched.
+        */
+        static void readBackSDFGrid(const SDFGrid::SharedPtr& pSDFGrid);
+
         static void writeEnvMap(OutputStream& stream, const EnvMap::SharedPtr& pEnvMap);
         static EnvMap::SharedPtr readEnvMap(InputStream& stream);
 
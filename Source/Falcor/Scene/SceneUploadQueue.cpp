@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "SceneUploadQueue.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kStagingAlignment = 16;
+        const size_t kStagingPieceSize = 1024 * 1024; // Large uploads are staged in pieces of this size to spread them over worker threads.
+    }
+
+    SceneUploadQueue::SceneUploadQueue(size_t chunkSize, uint32_t chunkCount)
+        : mChunkSize(chunkSize)
+        , mChunks(chunkCount)
+    {
+        checkArgument(chunkSize > 0, "'chunkSize' must be larger than zero.");
+        checkArgument(chunkCount > 0, "'chunkCount' must be larger than zero.");
+    }
+
+    void SceneUploadQueue::upload(const Buffer::SharedPtr& pBuffer, const void* pData, size_t offset, size_t size)
+    {
+        FALCOR_ASSERT(pBuffer && pData);
+        if (size == 0) return;
+        if (offset + size > pBuffer->getSize())
+        {
+            throw ArgumentError("'offset' ({}) and 'size' ({}) don't fit the buffer size {}.", offset, size, pBuffer->getSize());
+        }
+
+        mUploads.push_back({ pBuffer, static_cast<const uint8_t*>(pData), offset, size });
+    }
+
+    void SceneUploadQueue::uploadCopy(const Buffer::SharedPtr& pBuffer, const void* pData, size_t offset, size_t size)
+    {
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        mOwnedData.emplace_back(pBytes, pBytes + size);
+        upload(pBuffer, mOwnedData.back().data(), offset, size);
+    }
+
+    void SceneUploadQueue::flush(RenderContext* pRenderContext, bool wait)
+    {
+        FALCOR_ASSERT(pRenderContext);
+
+        struct Copy
+        {
+            const Buffer* pDst;
+            size_t dstOffset;
+            size_t srcOffset;
+            size_t size;
+        };
+
+        struct Staging
+        {
+            uint8_t* pDst;
+            const uint8_t* pSrc;
+            size_t size;
+        };
+
+        // Group uploads by destination buffer. The sort is stable, so overlapping uploads to a buffer are applied in the order they were recorded.
+        std::stable_sort(mUploads.begin(), mUploads.end(), [](const Upload& a, const Upload& b) { return a.pBuffer.get() < b.pBuffer.get(); });
+
+        size_t uploadIndex = 0;
+        size_t uploadDone = 0; // Bytes of the current upload that have been assigned to a chunk.
+        while (uploadIndex < mUploads.size())
+        {
+            Chunk& chunk = acquireChunk();
+
+            // Assign uploads to the chunk. Uploads that don't fit are split and continued in the next chunk.
+            std::vector<Copy> copies;
+            std::vector<Staging> stagings;
+            size_t chunkOffset = 0;
+            while (uploadIndex < mUploads.size())
+            {
+                const Upload& upload = mUploads[uploadIndex];
+                size_t dstOffset = upload.offset + uploadDone;
+
+                // Coalesce with the previous copy if it ends where this one starts in the same buffer.
+                bool coalesce = !copies.empty() && copies.back().pDst == upload.pBuffer.get() && copies.back().dstOffset + copies.back().size == dstOffset;
+                size_t srcOffset = coalesce ? chunkOffset : align_to(kStagingAlignment, chunkOffset);
+                if (srcOffset >= mChunkSize) break;
+
+                size_t size = std::min(upload.size - uploadDone, mChunkSize - srcOffset);
+                if (coalesce) copies.back().size += size;
+                else copies.push_back({ upload.pBuffer.get(), dstOffset, srcOffset, size });
+
+                for (size_t i = 0; i < size; i += kStagingPieceSize)
+                {
+                    stagings.push_back({ chunk.pData + srcOffset + i, upload.pData + uploadDone + i, std::min(kStagingPieceSize, size - i) });
+                }
+
+                chunkOffset = srcOffset + size;
+                uploadDone += size;
+                mStats.bytesUploaded += size;
+                if (uploadDone == upload.size)
+                {
+                    uploadIndex++;
+                    uploadDone = 0;
+                }
+            }
+
+            // Copy the data to staging memory on worker threads.
+            auto stagingStart = CpuTimer::getCurrentTimePoint();
+            std::for_each(std::execution::par, stagings.begin(), stagings.end(), [](const Staging& staging)
+            {
+                std::memcpy(staging.pDst, staging.pSrc, staging.size);
+            });
+            mStats.stagingTime += CpuTimer::calcDuration(stagingStart, CpuTimer::getCurrentTimePoint()) * 1e-3;
+
+            // Record the copies and submit them, so that the GPU executes them while the next chunk is staged.
+            for (const auto& copy : copies)
+            {
+                pRenderContext->copyBufferRegion(copy.pDst, copy.dstOffset, chunk.pBuffer.get(), copy.srcOffset, copy.size);
+            }
+            mStats.copyCount += copies.size();
+
+            pRenderContext->flush(false);
+            chunk.fenceValue = mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+            chunk.submitted = true;
+        }
+
+        mStats.uploadCount += mUploads.size();
+        mUploads.clear();
+        mOwnedData.clear();
+
+        if (wait && mpFence)
+        {
+            auto stallStart = CpuTimer::getCurrentTimePoint();
+            mpFence->syncCpu();
+            mStats.stallTime += CpuTimer::calcDuration(stallStart, CpuTimer::getCurrentTimePoint()) * 1e-3;
+        }
+    }
+
+    SceneUploadQueue::Chunk& SceneUploadQueue::acquireChunk()
+    {
+        if (!mpFence) mpFence = GpuFence::create();
+
+        Chunk& chunk = mChunks[mNextChunk];
+        mNextChunk = (mNextChunk + 1) % (uint32_t)mChunks.size();
+
+        if (!chunk.pBuffer)
+        {
+            chunk.pBuffer = Buffer::create(mChunkSize, Resource::BindFlags::None, Buffer::CpuAccess::Write, nullptr);
+            chunk.pBuffer->setName("SceneUploadQueue::Chunk");
+            chunk.pData = static_cast<uint8_t*>(chunk.pBuffer->map(Buffer::MapType::Write));
+        }
+        else if (chunk.submitted)
+        {
+            // Wait for the GPU to finish the previous copies from this chunk before overwriting it.
+            auto stallStart = CpuTimer::getCurrentTimePoint();
+            mpFence->syncCpu(chunk.fenceValue);
+            mStats.stallTime += CpuTimer::calcDuration(stallStart, CpuTimer::getCurrentTimePoint()) * 1e-3;
+        }
+        chunk.submitted = false;
+
+        return chunk;
+    }
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/Buffer.h"
+#include "Core/API/GpuFence.h"
+#include "Core/API/RenderContext.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** Queue for deferred, batched buffer uploads during scene construction.
+
+        Instead of each buffer being filled by its own upload when created or updated, uploads are recorded
+        and executed in batches when the queue is flushed:
+        - Source data is copied to a ring of large staging chunks on the upload heap, so many small uploads share a chunk.
+        - Uploads to adjacent ranges of the same buffer are coalesced into a single GPU copy.
+        - Staging copies are done on worker threads. The GPU copies of a chunk are submitted before the next chunk is
+          staged, so staging on the CPU overlaps with copying on the GPU.
+
+        The source data of upload() must stay valid until the queue is flushed.
+    */
+    class FALCOR_API SceneUploadQueue
+    {
+    public:
+        static constexpr size_t kDefaultChunkSize = 64 * 1024 * 1024;
+        static constexpr uint32_t kDefaultChunkCount = 3;
+
+        struct Stats
+        {
+            uint64_t uploadCount = 0;       ///< Number of recorded uploads.
+            uint64_t copyCount = 0;         ///< Number of GPU copies after coalescing.
+            uint64_t bytesUploaded = 0;     ///< Total number of bytes uploaded.
+            double stagingTime = 0.0;       ///< Time in seconds spent copying data to staging memory.
+            double stallTime = 0.0;         ///< Time in seconds spent waiting for the GPU to release staging memory or finish copies.
+        };
+
+        /** Create an upload queue.
+            \param[in] chunkSize Size of each staging chunk in bytes.
+            \param[in] chunkCount Number of staging chunks in the ring.
+        */
+        SceneUploadQueue(size_t chunkSize = kDefaultChunkSize, uint32_t chunkCount = kDefaultChunkCount);
+
+        /** Record an upload to a buffer.
+            \param[in] pBuffer Destination buffer.
+            \param[in] pData Source data. Must stay valid until the queue is flushed.
+            \param[in] offset Byte offset into the destination buffer.
+            \param[in] size Number of bytes to upload.
+        */
+        void upload(const Buffer::SharedPtr& pBuffer, const void* pData, size_t offset, size_t size);
+
+        /** Record an upload to a buffer, keeping a copy of the source data until the queue is flushed.
+            \param[in] pBuffer Destination buffer.
+            \param[in] pData Source data.
+            \param[in] offset Byte offset into the destination buffer.
+            \param[in] size Number of bytes to upload.
+        */
+        void uploadCopy(const Buffer::SharedPtr& pBuffer, const void* pData, size_t offset, size_t size);
+
+        /** Execute all recorded uploads.
+            The copies are recorded and submitted on the given render context, before any work recorded after this call.
+            \param[in] pRenderContext Render context.
+            \param[in] wait If true, wait for the GPU to finish all copies before returning.
+        */
+        void flush(RenderContext* pRenderContext, bool wait = false);
+
+        /** Returns true if there are no recorded uploads.
+        */
+        bool isEmpty() const { return mUploads.empty(); }
+
+        /** Get upload statistics accumulated over all flushes.
+        */
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        struct Upload
+        {
+            Buffer::SharedPtr pBuffer;
+            const uint8_t* pData;
+            size_t offset;
+            size_t size;
+        };
+
+        struct Chunk
+        {
+            Buffer::SharedPtr pBuffer;
+            uint8_t* pData = nullptr;
+            uint64_t fenceValue = 0;    ///< Fence value signaled after the last copy from this chunk.
+            bool submitted = false;     ///< True if copies from this chunk have been submitted.
+        };
+
+        Chunk& acquireChunk();
+
+        size_t mChunkSize;
+        std::vector<Chunk> mChunks;
+        uint32_t mNextChunk = 0;
+        GpuFence::SharedPtr mpFence;
+
+        std::vector<Upload> mUploads;
+        std::vector<std::vector<uint8_t>> mOwnedData;
+        Stats mStats;
+    };
+}
@@ -183,6 +183,19 @@ static void WriteAlphaBlock7(int alpha0, int alpha1, uint8_t const* indices, voi
 
 static void CompressAlphaDxt5(uint8_t* tile, void* block)
 {
+    // constant tiles are common in volumes and encode exactly with both endpoints set to the value and all indices zero
+    bool constant = true;
+    for (int i = 1; i < 16; ++i)
+        constant &= tile[i] == tile[0];
+    if (constant)
+    {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(block);
+        bytes[0] = tile[0];
+        bytes[1] = tile[0];
+        std::memset(bytes + 2, 0, 6);
+        return;
+    }
+
     // get the range for 5-alpha and 7-alpha interpolation
     int min5 = 255;
     int max5 = 0;
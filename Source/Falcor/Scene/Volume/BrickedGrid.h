@@ -35,4 +35,28 @@ namespace Falcor
         Texture::SharedPtr indirection;
         Texture::SharedPtr atlas;
     };
+
+    /** CPU-side data of a bricked grid.
+        This is the output of the grid to brick conversion, it is used to create the brick textures and to cache converted grids on disk.
+    */
+    struct BrickedGridData
+    {
+        uint3 leafDim = uint3(0);                       ///< Dimensions of the range and indirection textures at mip 0.
+        uint3 atlasSize = uint3(0);                     ///< Dimensions of the atlas texture in pixels.
+        ResourceFormat atlasFormat = ResourceFormat::Unknown;
+        std::vector<uint32_t> range;                    ///< Packed majorant/minorant (fp16) per brick for all 4 mips.
+        std::vector<uint32_t> indirection;              ///< Atlas brick coordinates per brick, zero for constant bricks.
+        std::vector<uint8_t> atlas;                     ///< Atlas texels in the atlas format.
+
+        /** Create the brick textures.
+        */
+        BrickedGrid createTextures() const
+        {
+            BrickedGrid bricks;
+            bricks.range = Texture::create3D(leafDim.x, leafDim.y, leafDim.z, ResourceFormat::RG16Float, 4, range.data(), ResourceBindFlags::ShaderResource, false);
+            bricks.indirection = Texture::create3D(leafDim.x, leafDim.y, leafDim.z, ResourceFormat::RGBA8Uint, 1, indirection.data(), ResourceBindFlags::ShaderResource, false);
+            bricks.atlas = Texture::create3D(atlasSize.x, atlasSize.y, atlasSize.z, atlasFormat, 1, atlas.data(), ResourceBindFlags::ShaderResource, false);
+            return bricks;
+        }
+    };
 }
@@ -0,0 +1,259 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "BrickedGridCache.h"
+
+#include <lz4_stream/lz4_stream.h>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Specifies the current cache file version.
+            This needs to be incremented every time the file format or the output of the grid to brick conversion changes!
+        */
+        const uint32_t kVersion = 1;
+
+        /** Grid cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/GridCache";
+
+        const size_t kBlockSize = 1 * 1024 * 1024;
+
+        const uint64_t kDefaultMaxSize = 4ull * 1024 * 1024 * 1024;
+
+        const char* kMagic = "FalcorG$";
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+
+            bool isValid() const
+            {
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+            }
+        };
+
+        std::atomic<bool> sEnabled{ true };
+        std::atomic<uint64_t> sMaxSize{ kDefaultMaxSize };
+
+        template<typename T>
+        void writeVector(std::ostream& stream, const std::vector<T>& v)
+        {
+            uint64_t size = v.size();
+            stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            stream.write(reinterpret_cast<const char*>(v.data()), size * sizeof(T));
+        }
+
+        template<typename T>
+        bool readVector(std::istream& stream, std::vector<T>& v, uint64_t expectedSize)
+        {
+            uint64_t size = 0;
+            stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (!stream.good() || size != expectedSize) return false;
+            v.resize(size);
+            stream.read(reinterpret_cast<char*>(v.data()), size * sizeof(T));
+            return !stream.fail();
+        }
+    }
+
+    BrickedGridCache::Key BrickedGridCache::computeKey(const nanovdb::GridHandle<nanovdb::HostBuffer>& gridHandle, ResourceFormat atlasFormat)
+    {
+        SHA1 sha1;
+        sha1.update(&kVersion, sizeof(kVersion));
+        sha1.update(&atlasFormat, sizeof(atlasFormat));
+        sha1.update(gridHandle.data(), gridHandle.size());
+        return sha1.final();
+    }
+
+    std::optional<BrickedGridData> BrickedGridCache::read(const Key& key, const std::filesystem::path& directory)
+    {
+        auto cachePath = getCachePath(key, directory);
+        if (!std::filesystem::exists(cachePath)) return {};
+
+        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
+        if (fs.bad()) return {};
+
+        Header header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs.good() || !header.isValid()) return {};
+
+        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
+        BrickedGridData data;
+        zs.read(reinterpret_cast<char*>(&data.leafDim), sizeof(data.leafDim));
+        zs.read(reinterpret_cast<char*>(&data.atlasSize), sizeof(data.atlasSize));
+        zs.read(reinterpret_cast<char*>(&data.atlasFormat), sizeof(data.atlasFormat));
+        if (!zs.good()) return {};
+
+        if (data.atlasFormat != ResourceFormat::BC4Unorm && data.atlasFormat != ResourceFormat::R8Unorm && data.atlasFormat != ResourceFormat::R16Unorm)
+        {
+            logWarning("Ignoring invalid grid cache file '{}'.", cachePath);
+            return {};
+        }
+
+        // The range data holds 4 mips, each half the size of the previous one.
+        uint64_t rangeSize = 0;
+        for (uint32_t mip = 0; mip < 4; ++mip)
+        {
+            uint3 dim = data.leafDim >> mip;
+            rangeSize += (uint64_t)dim.x * dim.y * dim.z;
+        }
+        const uint64_t indirectionSize = (uint64_t)data.leafDim.x * data.leafDim.y * data.leafDim.z;
+        const uint64_t atlasSize = (uint64_t)getFormatBytesPerBlock(data.atlasFormat) * data.atlasSize.x * data.atlasSize.y * data.atlasSize.z /
+            (getFormatWidthCompressionRatio(data.atlasFormat) * getFormatHeightCompressionRatio(data.atlasFormat));
+
+        if (!readVector(zs, data.range, rangeSize) ||
+            !readVector(zs, data.indirection, indirectionSize) ||
+            !readVector(zs, data.atlas, atlasSize))
+        {
+            logWarning("Ignoring invalid grid cache file '{}'.", cachePath);
+            return {};
+        }
+
+        // Mark the entry as recently used, trim() removes entries in order of their last write time.
+        std::error_code ec;
+        std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), ec);
+
+        logInfo("Loaded converted grid from cache '{}'.", cachePath);
+        return data;
+    }
+
+    void BrickedGridCache::write(const Key& key, const BrickedGridData& data, const std::filesystem::path& directory)
+    {
+        auto cachePath = getCachePath(key, directory);
+        std::filesystem::create_directories(cachePath.parent_path());
+
+        // Write to a temporary file first so that concurrent loads never see a partially written cache file.
+        auto tempPath = cachePath;
+        tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream fs(tempPath.c_str(), std::ios_base::binary);
+            if (fs.bad())
+            {
+                logWarning("Failed to create grid cache file '{}'.", tempPath);
+                return;
+            }
+
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            lz4_stream::basic_ostream<kBlockSize> zs(fs);
+            zs.write(reinterpret_cast<const char*>(&data.leafDim), sizeof(data.leafDim));
+            zs.write(reinterpret_cast<const char*>(&data.atlasSize), sizeof(data.atlasSize));
+            zs.write(reinterpret_cast<const char*>(&data.atlasFormat), sizeof(data.atlasFormat));
+            writeVector(zs, data.range);
+            writeVector(zs, data.indirection);
+            writeVector(zs, data.atlas);
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            // Another thread or process may have written the same entry in the meantime.
+            std::filesystem::remove(tempPath, ec);
+        }
+
+        trim(cachePath.parent_path());
+    }
+
+    void BrickedGridCache::setEnabled(bool enabled)
+    {
+        sEnabled = enabled;
+    }
+
+    bool BrickedGridCache::isEnabled()
+    {
+        return sEnabled;
+    }
+
+    void BrickedGridCache::setMaxSize(uint64_t maxSize)
+    {
+        sMaxSize = maxSize;
+    }
+
+    uint64_t BrickedGridCache::getMaxSize()
+    {
+        return sMaxSize;
+    }
+
+    std::filesystem::path BrickedGridCache::getDefaultDirectory()
+    {
+        return getAppDataDirectory() / kDirectory;
+    }
+
+    std::filesystem::path BrickedGridCache::getCachePath(const Key& key, const std::filesystem::path& directory)
+    {
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (auto c : key) ss << std::setw(2) << (int)c;
+        return (directory.empty() ? getDefaultDirectory() : directory) / ss.str();
+    }
+
+    void BrickedGridCache::trim(const std::filesystem::path& directory)
+    {
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastWriteTime;
+            uint64_t size;
+        };
+
+        // Collect the cache entries, temporary files of writes in progress are skipped.
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (!it->is_regular_file(ec) || it->path().extension() == ".tmp") continue;
+            Entry entry{ it->path() };
+            entry.lastWriteTime = it->last_write_time(ec);
+            if (ec) continue;
+            entry.size = it->file_size(ec);
+            if (ec) continue;
+            totalSize += entry.size;
+            entries.push_back(std::move(entry));
+        }
+
+        const uint64_t maxSize = sMaxSize;
+        if (totalSize <= maxSize) return;
+
+        // Remove the least recently used entries first. Entries removed by another process in the meantime are skipped.
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastWriteTime < b.lastWriteTime; });
+        for (const auto& entry : entries)
+        {
+            if (totalSize <= maxSize) break;
+            if (std::filesystem::remove(entry.path, ec)) totalSize -= entry.size;
+        }
+
+        logInfo("Trimmed grid cache '{}' to {}.", directory, formatByteSize(totalSize));
+    }
+}
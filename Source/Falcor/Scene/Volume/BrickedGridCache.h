@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#pragma warning(push)
+#pragma warning(disable : 4244 4267)
+#include <nanovdb/NanoVDB.h>
+#include <nanovdb/util/GridHandle.h>
+#include <nanovdb/util/HostBuffer.h>
+#pragma warning(pop)
+#include "BrickedGrid.h"
+#include "Utils/CryptoUtils.h"
+
+#include <filesystem>
+#include <optional>
+
+namespace Falcor
+{
+    /** Disk cache for grids converted to bricks.
+        Converting a NanoVDB grid to bricks is the dominant cost when loading grids. The cache stores the converted brick data
+        keyed by a hash of the NanoVDB grid data and the conversion settings (atlas format and converter version).
+        Repeated loads of the same grid, including loads from the scene cache, upload the brick textures directly.
+        Cache files are stored in the application data directory, unless another directory is passed to read() and write().
+        The total size of a cache directory is capped, writing an entry removes the least recently used entries when the cap is exceeded.
+    */
+    class FALCOR_API BrickedGridCache
+    {
+    public:
+        using Key = SHA1::MD;
+
+        /** Convert a grid to bricks, using the cache if enabled.
+            Returns the cached bricks if available, otherwise converts the grid and writes the result to the cache.
+            \param[in] gridHandle NanoVDB grid handle of a float grid.
+            \return The converted bricks.
+        */
+        template <typename Converter>
+        static BrickedGridData convert(const nanovdb::GridHandle<nanovdb::HostBuffer>& gridHandle)
+        {
+            if (!isEnabled()) return Converter(gridHandle.grid<float>()).convertBricks();
+
+            Key key = computeKey(gridHandle, Converter::getAtlasFormat());
+            if (auto data = read(key)) return std::move(*data);
+
+            BrickedGridData data = Converter(gridHandle.grid<float>()).convertBricks();
+            write(key, data);
+            return data;
+        }
+
+        /** Compute the cache key of a grid.
+            \param[in] gridHandle NanoVDB grid handle.
+            \param[in] atlasFormat Format of the brick atlas.
+            \return The cache key.
+        */
+        static Key computeKey(const nanovdb::GridHandle<nanovdb::HostBuffer>& gridHandle, ResourceFormat atlasFormat);
+
+        /** Read cached bricks.
+            \param[in] key Cache key.
+            \param[in] directory Cache directory. If empty, the default directory in the application data directory is used.
+            \return The cached bricks, or an empty optional if there is no valid cache entry.
+        */
+        static std::optional<BrickedGridData> read(const Key& key, const std::filesystem::path& directory = {});
+
+        /** Write bricks to the cache.
+            \param[in] key Cache key.
+            \param[in] data Brick data.
+            \param[in] directory Cache directory. If empty, the default directory in the application data directory is used.
+        */
+        static void write(const Key& key, const BrickedGridData& data, const std::filesystem::path& directory = {});
+
+        /** Get the default cache directory in the application data directory.
+        */
+        static std::filesystem::path getDefaultDirectory();
+
+        /** Enable/disable the cache. The cache is enabled by default.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled.
+        */
+        static bool isEnabled();
+
+        /** Set the maximum total size of the entries in a cache directory. The default is 4 GB.
+            \param[in] maxSize Maximum size in bytes.
+        */
+        static void setMaxSize(uint64_t maxSize);
+
+        /** Get the maximum total size of the entries in a cache directory.
+        */
+        static uint64_t getMaxSize();
+
+    private:
+        static std::filesystem::path getCachePath(const Key& key, const std::filesystem::path& directory);
+
+        /** Remove the least recently used entries until the directory is within the maximum size.
+        */
+        static void trim(const std::filesystem::path& directory);
+    };
+}
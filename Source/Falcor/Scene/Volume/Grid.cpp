@@ -37,6 +37,7 @@
 #pragma warning(pop)
 #include <glm/gtc/type_ptr.hpp>
 #include "GridConverter.h"
+#include "BrickedGridCache.h"
 
 
 namespace Falcor
@@ -59,6 +60,14 @@ namespace Falcor
         }
     }
 
+    using NanoVDBGridConverter = NanoVDBConverterBC4;
+
+    struct Grid::HostData
+    {
+        nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle;
+        BrickedGridData bricks;
+    };
+
     Grid::SharedPtr Grid::createSphere(float radius, float voxelSize, float blendRange)
     {
         auto handle = nanovdb::createFogVolumeSphere(radius, nanovdb::Vec3R(0.0), voxelSize, blendRange);
@@ -95,9 +104,102 @@ namespace Falcor
         }
     }
 
+    Grid::SharedPtr Grid::createStreamed(const std::filesystem::path& path, const std::string& gridname)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath))
+        {
+            logWarning("Error when loading grid. Can't find grid file '{}'.", path);
+            return nullptr;
+        }
+
+        if (!hasExtension(fullPath, "nvdb"))
+        {
+            logWarning("Error when loading grid. Streaming is only supported for NanoVDB files, '{}' is not supported.", fullPath);
+            return nullptr;
+        }
+
+        // Only read the grid metadata, the grid data is loaded when the grid is made resident.
+        auto metaData = nanovdb::io::readGridMetaData(fullPath.string());
+        auto it = std::find_if(metaData.begin(), metaData.end(), [&gridname](const auto& m) { return m.gridName == gridname; });
+        if (it == metaData.end())
+        {
+            logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, fullPath);
+            return nullptr;
+        }
+
+        if (it->gridType != nanovdb::GridType::Float)
+        {
+            logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, fullPath);
+            return nullptr;
+        }
+
+        if (it->voxelCount == 0)
+        {
+            logWarning("Grid '{}' in '{}' is empty.", gridname, fullPath);
+            return nullptr;
+        }
+
+        SharedPtr pGrid(new Grid(fullPath, gridname));
+        pGrid->mMinIndex = cast(it->indexBBox.min()) & (~7);
+        pGrid->mMaxIndex = (cast(it->indexBBox.max()) + 7) & (~7);
+        pGrid->mVoxelCount = it->voxelCount;
+        pGrid->mWorldBounds = AABB(cast(it->worldBBox.min()), cast(it->worldBBox.max()));
+        return pGrid;
+    }
+
+    std::shared_ptr<Grid::HostData> Grid::loadHostData(const std::filesystem::path& path, const std::string& gridname)
+    {
+        // The file may have been removed or replaced since the grid metadata was read.
+        nanovdb::GridHandle<nanovdb::HostBuffer> handle;
+        try
+        {
+            handle = readNanoVDBFile(path, gridname);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Error when loading grid '{}' from '{}'. {}", gridname, path, e.what());
+            return nullptr;
+        }
+        if (!handle) return nullptr;
+
+        auto pHostData = std::make_shared<HostData>();
+        pHostData->gridHandle = std::move(handle);
+        auto pFloatGrid = pHostData->gridHandle.grid<float>();
+        if (!pFloatGrid->hasMinMax())
+        {
+            nanovdb::gridStats(*pFloatGrid);
+        }
+        pHostData->bricks = BrickedGridCache::convert<NanoVDBGridConverter>(pHostData->gridHandle);
+        return pHostData;
+    }
+
+    bool Grid::makeResident(const std::shared_ptr<HostData>& pHostData)
+    {
+        FALCOR_ASSERT(isStreamed());
+        if (isResident()) return true;
+        if (!pHostData || !pHostData->gridHandle) return false;
+
+        setHostData(std::move(pHostData->gridHandle));
+        mBrickedGrid = pHostData->bricks.createTextures();
+        pHostData->bricks = {};
+        return true;
+    }
+
+    void Grid::evict()
+    {
+        FALCOR_ASSERT(isStreamed());
+        mpBuffer = nullptr;
+        mBrickedGrid = {};
+        mAccessor.reset();
+        mpFloatGrid = nullptr;
+        mGridHandle = {};
+    }
+
     void Grid::renderUI(Gui::Widgets& widget)
     {
         std::ostringstream oss;
+        if (isStreamed()) oss << "Resident: " << (isResident() ? "Yes" : "No") << std::endl;
         oss << "Voxel count: " << getVoxelCount() << std::endl
             << "Minimum index: " << to_string(getMinIndex()) << std::endl
             << "Maximum index: " << to_string(getMaxIndex()) << std::endl
@@ -121,27 +223,27 @@ namespace Falcor
 
     int3 Grid::getMinIndex() const
     {
-        return cast(mpFloatGrid->indexBBox().min()) & (~7); // The volume texture path requires the index bounding box to fall on a brick boundary (multiple of 8).
+        return mMinIndex;
     }
 
     int3 Grid::getMaxIndex() const
     {
-        return (cast(mpFloatGrid->indexBBox().max()) + 7) & (~7); // The volume texture path requires the index bounding box to fall on a brick boundary (multiple of 8).
+        return mMaxIndex;
     }
 
     float Grid::getMinValue() const
     {
-        return mpFloatGrid->tree().root().valueMin();
+        return mMinValue;
     }
 
     float Grid::getMaxValue() const
     {
-        return mpFloatGrid->tree().root().valueMax();
+        return mMaxValue;
     }
 
     uint64_t Grid::getVoxelCount() const
     {
-        return mpFloatGrid->activeVoxelCount();
+        return mVoxelCount;
     }
 
     uint64_t Grid::getGridSizeInBytes() const
@@ -155,13 +257,13 @@ namespace Falcor
 
     AABB Grid::getWorldBounds() const
     {
-        auto bounds = mpFloatGrid->worldBBox();
-        return AABB(cast(bounds.min()), cast(bounds.max()));
+        return mWorldBounds;
     }
 
     float Grid::getValue(const int3& ijk) const
     {
-        return mAccessor.getValue(nanovdb::Coord(ijk.x, ijk.y, ijk.z));
+        FALCOR_ASSERT(isResident());
+        return mAccessor->getValue(nanovdb::Coord(ijk.x, ijk.y, ijk.z));
     }
 
     const nanovdb::GridHandle<nanovdb::HostBuffer>& Grid::getGridHandle() const
@@ -171,6 +273,7 @@ namespace Falcor
 
     glm::mat4 Grid::getTransform() const
     {
+        FALCOR_ASSERT(isResident());
         const auto& gridMap = mGridHandle.gridMetaData()->map();
         const float3x3 affine = glm::make_mat3(gridMap.mMatF);
         const float3 translation = float3(gridMap.mVecF[0], gridMap.mVecF[1], gridMap.mVecF[2]);
@@ -179,6 +282,7 @@ namespace Falcor
 
     glm::mat4 Grid::getInvTransform() const
     {
+        FALCOR_ASSERT(isResident());
         const auto& gridMap = mGridHandle.gridMetaData()->map();
         const float3x3 invAffine = glm::make_mat3(gridMap.mInvMatF);
         const float3 translation = float3(gridMap.mVecF[0], gridMap.mVecF[1], gridMap.mVecF[2]);
@@ -186,15 +290,37 @@ namespace Falcor
     }
 
     Grid::Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
-        : mGridHandle(std::move(gridHandle))
-        , mpFloatGrid(mGridHandle.grid<float>())
-        , mAccessor(mpFloatGrid->getAccessor())
     {
+        setHostData(std::move(gridHandle));
+        mBrickedGrid = BrickedGridCache::convert<NanoVDBGridConverter>(mGridHandle).createTextures();
+    }
+
+    Grid::Grid(const std::filesystem::path& path, const std::string& gridname)
+        : mPath(path)
+        , mGridname(gridname)
+    {
+    }
+
+    void Grid::setHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    {
+        mGridHandle = std::move(gridHandle);
+        mpFloatGrid = mGridHandle.grid<float>();
+        mAccessor.emplace(mpFloatGrid->getAccessor());
+
         if (!mpFloatGrid->hasMinMax())
         {
             nanovdb::gridStats(*mpFloatGrid);
         }
 
+        // The volume texture path requires the index bounding box to fall on a brick boundary (multiple of 8).
+        mMinIndex = cast(mpFloatGrid->indexBBox().min()) & (~7);
+        mMaxIndex = (cast(mpFloatGrid->indexBBox().max()) + 7) & (~7);
+        mMinValue = mpFloatGrid->tree().root().valueMin();
+        mMaxValue = mpFloatGrid->tree().root().valueMax();
+        mVoxelCount = mpFloatGrid->activeVoxelCount();
+        auto bounds = mpFloatGrid->worldBBox();
+        mWorldBounds = AABB(cast(bounds.min()), cast(bounds.max()));
+
         // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
         mpBuffer = Buffer::createStructured(
             sizeof(uint32_t),
@@ -203,39 +329,45 @@ namespace Falcor
             Buffer::CpuAccess::None,
             mGridHandle.data()
         );
-        using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert();
     }
 
     Grid::SharedPtr Grid::createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
+    {
+        auto handle = readNanoVDBFile(path, gridname);
+        if (!handle) return nullptr;
+
+        return SharedPtr(new Grid(std::move(handle)));
+    }
+
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         auto handle = nanovdb::io::readGrid(path.string(), gridname);
         if (!handle)
         {
             logWarning("Error when loading grid.");
-            return nullptr;
+            return {};
         }
 
         auto floatGrid = handle.grid<float>();
         if (!floatGrid || floatGrid->gridType() != nanovdb::GridType::Float)
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (floatGrid->isEmpty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
-        return SharedPtr(new Grid(std::move(handle)));
+        return handle;
     }
 
     Grid::SharedPtr Grid::createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
@@ -290,11 +422,14 @@ namespace Falcor
         grid.def_property_readonly("maxIndex", &Grid::getMaxIndex);
         grid.def_property_readonly("minValue", &Grid::getMinValue);
         grid.def_property_readonly("maxValue", &Grid::getMaxValue);
+        grid.def_property_readonly("streamed", &Grid::isStreamed);
+        grid.def_property_readonly("resident", &Grid::isResident);
 
         grid.def("getValue", &Grid::getValue, "ijk"_a);
 
         grid.def_static("createSphere", &Grid::createSphere, "radius"_a, "voxelSize"_a, "blendRange"_a = 3.f);
         grid.def_static("createBox", &Grid::createBox, "width"_a, "height"_a, "depth"_a, "voxelSize"_a, "blendRange"_a = 3.f);
         grid.def_static("createFromFile", &Grid::createFromFile, "path"_a, "gridname"_a);
+        grid.def_static("createStreamed", &Grid::createStreamed, "path"_a, "gridname"_a);
     }
 }
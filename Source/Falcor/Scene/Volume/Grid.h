@@ -35,6 +35,7 @@
 #include "BrickedGrid.h"
 
 #include <filesystem>
+#include <optional>
 
 namespace Falcor
 {
@@ -71,6 +72,55 @@ namespace Falcor
         */
         static SharedPtr createFromFile(const std::filesystem::path& path, const std::string& gridname);
 
+        /** Create a grid that is streamed from a file.
+            Only the grid metadata is read, the grid data is loaded on demand using loadHostData() and makeResident().
+            Currently only NanoVDB grids of type float are supported.
+            \param[in] path File path of the grid. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return A new (non-resident) grid, or nullptr if the grid metadata failed to load.
+        */
+        static SharedPtr createStreamed(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Host data of a streamed grid, see loadHostData().
+        */
+        struct HostData;
+
+        /** Load the host data of a streamed grid.
+            This reads the grid from file and converts it to bricks in CPU memory, or loads the bricks from the brick cache.
+            It does not touch the GPU and is safe to call from worker threads.
+            \param[in] path Full path of the grid file.
+            \param[in] gridname Name of the grid to load.
+            \return The host data, or nullptr if the grid failed to load.
+        */
+        static std::shared_ptr<HostData> loadHostData(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Make a streamed grid resident by creating its GPU resources from previously loaded host data.
+            \param[in] pHostData Host data returned by loadHostData().
+            \return True if the grid is resident.
+        */
+        bool makeResident(const std::shared_ptr<HostData>& pHostData);
+
+        /** Release the host and device data of a streamed grid.
+            The cached grid properties (bounds, index range and voxel count) stay valid.
+        */
+        void evict();
+
+        /** Check if the grid is streamed from file.
+        */
+        bool isStreamed() const { return !mPath.empty(); }
+
+        /** Check if the grid data is resident in memory. Grids that are not streamed are always resident.
+        */
+        bool isResident() const { return mpFloatGrid != nullptr; }
+
+        /** Get the full path of the file backing a streamed grid.
+        */
+        const std::filesystem::path& getPath() const { return mPath; }
+
+        /** Get the name of the grid in the file backing a streamed grid.
+        */
+        const std::string& getGridname() const { return mGridname; }
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -89,10 +139,12 @@ namespace Falcor
         int3 getMaxIndex() const;
 
         /** Get the minimum value stored in the grid.
+            Note: For streamed grids this returns 0 until the grid has been resident once.
         */
         float getMinValue() const;
 
         /** Get the maximum value stored in the grid.
+            Note: For streamed grids this returns 0 until the grid has been resident once.
         */
         float getMaxValue() const;
 
@@ -109,33 +161,52 @@ namespace Falcor
         AABB getWorldBounds() const;
 
         /** Get a value stored in the grid.
-            Note: This function is not safe for access from multiple threads.
+            Note: This function is not safe for access from multiple threads. The grid must be resident.
             \param[in] ijk The index-space position to access the data from.
         */
         float getValue(const int3& ijk) const;
 
         /** Get the raw NanoVDB grid handle.
+            Note: The handle is empty if the grid is not resident.
         */
         const nanovdb::GridHandle<nanovdb::HostBuffer>& getGridHandle() const;
 
         /** Get the (affine) NanoVDB transformation matrix.
+            Note: The grid must be resident.
         */
         glm::mat4 getTransform() const;
 
         /** Get the inverse (affine) NanoVDB transformation matrix.
+            Note: The grid must be resident.
         */
         glm::mat4 getInvTransform() const;
 
     private:
         Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        Grid(const std::filesystem::path& path, const std::string& gridname);
 
         static SharedPtr createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
         static SharedPtr createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
+
+        void setHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+
+        // Streaming.
+        std::filesystem::path mPath;    ///< Full path of the grid file for streamed grids, empty otherwise.
+        std::string mGridname;          ///< Name of the grid in the file for streamed grids.
+
+        // Cached grid properties, valid even if the grid is not resident.
+        int3 mMinIndex = int3(0);
+        int3 mMaxIndex = int3(0);
+        float mMinValue = 0.f;
+        float mMaxValue = 0.f;
+        uint64_t mVoxelCount = 0;
+        AABB mWorldBounds;
 
         // Host data.
         nanovdb::GridHandle<nanovdb::HostBuffer> mGridHandle;
-        nanovdb::FloatGrid* mpFloatGrid;
-        nanovdb::FloatGrid::AccessorType mAccessor;
+        nanovdb::FloatGrid* mpFloatGrid = nullptr;
+        std::optional<nanovdb::FloatGrid::AccessorType> mAccessor;
         // Device data.
         Buffer::SharedPtr mpBuffer;
         BrickedGrid mBrickedGrid;
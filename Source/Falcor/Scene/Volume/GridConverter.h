@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include <execution>
+#include <emmintrin.h>
 #pragma warning(push)
 #pragma warning(disable : 4244 4267)
 #include <nanovdb/NanoVDB.h>
@@ -37,6 +38,82 @@
 
 namespace Falcor
 {
+    /** Expand a value range by an array of values using SSE. NaN values are ignored.
+        \param[in] data Values.
+        \param[in] count Number of values.
+        \param[in,out] minorant Minimum of the range.
+        \param[in,out] majorant Maximum of the range.
+    */
+    inline void expandRange(const float* data, size_t count, float& minorant, float& majorant)
+    {
+        size_t i = 0;
+        if (count >= 4)
+        {
+            __m128 vmin = _mm_set1_ps(minorant);
+            __m128 vmax = _mm_set1_ps(majorant);
+            for (; i + 4 <= count; i += 4)
+            {
+                // The loaded values are the first operand so that NaNs are dropped, matching the scalar comparisons.
+                __m128 v = _mm_loadu_ps(data + i);
+                vmin = _mm_min_ps(v, vmin);
+                vmax = _mm_max_ps(v, vmax);
+            }
+            vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+            vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+            vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+            vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+            minorant = _mm_cvtss_f32(vmin);
+            majorant = _mm_cvtss_f32(vmax);
+        }
+        for (; i < count; ++i)
+        {
+            if (data[i] < minorant) minorant = data[i];
+            if (data[i] > majorant) majorant = data[i];
+        }
+    }
+
+    /** Quantize an array of values to unsigned integers using SSE.
+        Computes T((value - offset) * scale) with truncation. The results are expected to be in the range of T.
+        \param[in] src Values.
+        \param[in] count Number of values.
+        \param[in] offset Offset subtracted before scaling.
+        \param[in] scale Scale factor.
+        \param[out] dst Quantized values.
+    */
+    template <typename T>
+    inline void quantizeValues(const float* src, size_t count, float offset, float scale, T* dst)
+    {
+        static_assert(std::is_unsigned_v<T> && sizeof(T) <= 2, "Unsupported quantization type");
+
+        const __m128 voffset = _mm_set1_ps(offset);
+        const __m128 vscale = _mm_set1_ps(scale);
+        auto quantize4 = [&](const float* p) { return _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p), voffset), vscale)); };
+
+        size_t i = 0;
+        if constexpr (sizeof(T) == 1)
+        {
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i lo = _mm_packs_epi32(quantize4(src + i), quantize4(src + i + 4));
+                __m128i hi = _mm_packs_epi32(quantize4(src + i + 8), quantize4(src + i + 12));
+                _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+            }
+        }
+        else
+        {
+            // SSE2 has no unsigned 32-to-16 bit pack, bias to the signed range instead.
+            const __m128i bias = _mm_set1_epi32(0x8000);
+            const __m128i unbias = _mm_set1_epi16((short)0x8000);
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i lo = _mm_sub_epi32(quantize4(src + i), bias);
+                __m128i hi = _mm_sub_epi32(quantize4(src + i + 4), bias);
+                _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi16(_mm_packs_epi32(lo, hi), unbias));
+            }
+        }
+        for (; i < count; ++i) dst[i] = T((src[i] - offset) * scale);
+    }
+
     template <typename TexelType, unsigned int kBitsPerTexel> struct NanoVDBToBricksConverter;
     using NanoVDBConverterBC4 = NanoVDBToBricksConverter<uint64_t, 4>;
     using NanoVDBConverterUNORM8 = NanoVDBToBricksConverter<uint8_t, 8>;
@@ -51,18 +128,21 @@ namespace Falcor
 
         BrickedGrid convert();
 
-    private:
-        const static uint kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
-        const static int kBC4Compress = kBitsPerTexel == 4;
-
-        void convertSlice(int z);
-        void computeMip(int mip);
+        /** Convert the grid to bricks in CPU memory. Does not touch the GPU and can be run on a worker thread.
+            \return The converted bricks. This can only be called once, the data is moved out of the converter.
+        */
+        BrickedGridData convertBricks();
 
-        inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
-        inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
-        inline uint getAtlasMaxBrick() const { return mAtlasSizeBricks.x * mAtlasSizeBricks.y * mAtlasSizeBricks.z; }
+        /** Compute the value range of a brick including the one voxel apron from the neighboring bricks.
+            \param[in] a Grid accessor.
+            \param[in] ijk Index-space origin of the brick. There must be a leaf at this position.
+            \return The range as (majorant, minorant).
+        */
+        static float2 computeBrickRange(nanovdb::FloatGrid::AccessorType& a, const nanovdb::Coord& ijk);
 
-        inline ResourceFormat getAtlasFormat() {
+        /** Get the format of the brick atlas.
+        */
+        static inline ResourceFormat getAtlasFormat() {
             switch (kBitsPerTexel) {
             case 4: return ResourceFormat::BC4Unorm;
             case 8: return ResourceFormat::R8Unorm;
@@ -71,6 +151,21 @@ namespace Falcor
             }
         }
 
+        /** Get the number of non-empty bricks after conversion.
+        */
+        uint32_t getNonEmptyBrickCount() const { return std::min(mNonEmptyCount.load(), getAtlasMaxBrick()); }
+
+    private:
+        const static uint kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
+        const static int kBC4Compress = kBitsPerTexel == 4;
+
+        void convertRow(int y, int z);
+        void computeMipRow(int mip, int y, int z);
+
+        inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
+        inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
+        inline uint getAtlasMaxBrick() const { return mAtlasSizeBricks.x * mAtlasSizeBricks.y * mAtlasSizeBricks.z; }
+
         inline float2 combineMajMin(float2 a, float2 b)
         {
             return float2(std::max(a.x, b.x), std::min(a.y, b.y));
@@ -82,7 +177,7 @@ namespace Falcor
             return float2(f16tof32(data16[0]), f16tof32(data16[1]));
         }
 
-        inline void expandMinorantMajorant(float value, float& min_inout, float& maj_inout)
+        static inline void expandMinorantMajorant(float value, float& min_inout, float& maj_inout)
         {
             if (value < min_inout) min_inout = value;
             if (value > maj_inout) maj_inout = value;
@@ -93,9 +188,7 @@ namespace Falcor
         int3 mLeafDim[4];
         int3 mBBMin, mBBMax, mPixDim;
         uint32_t mLeafCount[4];
-        std::vector<uint32_t> mRangeData;
-        std::vector<uint32_t> mPtrData;
-        std::vector<TexelType> mAtlasData;
+        BrickedGridData mData;
         std::atomic_uint32_t mNonEmptyCount;
     };
 
@@ -120,168 +213,212 @@ namespace Falcor
         mAtlasSizeBricks = uint3(approxdim, approxdim, lastdim);
         uint3 atlasSizePixels = getAtlasSizePixels();
         uint leafTexelCount = atlasSizePixels.x * atlasSizePixels.y * atlasSizePixels.z;
-        mRangeData.resize(mLeafCount[3]);
-        mPtrData.resize(mLeafCount[0]);
-        mAtlasData.resize(kBC4Compress ? (leafTexelCount / 16) : leafTexelCount);
+        mData.leafDim = uint3(mLeafDim[0]);
+        mData.atlasSize = atlasSizePixels;
+        mData.atlasFormat = getAtlasFormat();
+        mData.range.resize(mLeafCount[3]);
+        mData.indirection.resize(mLeafCount[0]);
+        mData.atlas.resize((kBC4Compress ? (leafTexelCount / 16) : leafTexelCount) * sizeof(TexelType));
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertSlice(int z)
+    float2 NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeBrickRange(nanovdb::FloatGrid::AccessorType& a, const nanovdb::Coord& ijk)
+    {
+        const int kSize = (int)kBrickSize;
+        const auto leaf = a.probeLeaf(ijk);
+        FALCOR_ASSERT(leaf);
+
+        // Nanovdb only stores minorant/majorant for active voxels, but we need all of them.
+        const float* data = leaf->voxels();
+        float minorant = data[0], majorant = data[0];
+        expandRange(data, kBrickSize * kBrickSize * kBrickSize, minorant, majorant);
+
+        // We also need the 1-halo from the 26 neighbouring bricks. Each neighbour is probed once: if it is a leaf, the voxels adjacent to
+        // this brick are read directly from its voxel array (x-major, z contiguous), otherwise the neighbour is a constant tile.
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    if (dx == 0 && dy == 0 && dz == 0) continue;
+
+                    const nanovdb::Coord neighbourijk = ijk + nanovdb::Coord(dx * kSize, dy * kSize, dz * kSize);
+                    const auto neighbour = a.probeLeaf(neighbourijk);
+                    if (!neighbour)
+                    {
+                        expandMinorantMajorant(a.getValue(neighbourijk), minorant, majorant);
+                        continue;
+                    }
+
+                    // Adjacent voxels are the last layer for negative offsets, the first layer for positive offsets and all voxels otherwise.
+                    const float* neighbourData = neighbour->voxels();
+                    const int x0 = dx < 0 ? kSize - 1 : 0, x1 = dx > 0 ? 0 : kSize - 1;
+                    const int y0 = dy < 0 ? kSize - 1 : 0, y1 = dy > 0 ? 0 : kSize - 1;
+                    for (int x = x0; x <= x1; ++x)
+                    {
+                        for (int y = y0; y <= y1; ++y)
+                        {
+                            const float* row = neighbourData + x * kSize * kSize + y * kSize;
+                            if (dz == 0) expandRange(row, kBrickSize, minorant, majorant);
+                            else expandMinorantMajorant(row[dz < 0 ? kSize - 1 : 0], minorant, majorant);
+                        }
+                    }
+                }
+            }
+        }
+
+        return float2(majorant, minorant);
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertRow(int y, int z)
     {
         uint3 atlasSizePixels = getAtlasSizePixels();
         uint brickMax = getAtlasMaxBrick();
         uint bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
         uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
 
-        size_t offset = z * mLeafDim[0].x * mLeafDim[0].y;
-        uint32_t* rangedst = mRangeData.data() + offset;
-        uint32_t* ptrdst = mPtrData.data() + offset;
+        size_t offset = ((size_t)z * mLeafDim[0].y + y) * mLeafDim[0].x;
+        uint32_t* rangedst = mData.range.data() + offset;
+        uint32_t* ptrdst = mData.indirection.data() + offset;
         auto a = mpFloatGrid->getAccessor();
-        for (int y = 0; y < mLeafDim[0].y; ++y)
+
+        // Brick voxels quantized to 8 or 16 bits, in NanoVDB leaf order.
+        using QuantizedType = std::conditional_t<kBC4Compress != 0, uint8_t, TexelType>;
+        QuantizedType quantized[kBrickSize * kBrickSize * kBrickSize];
+
+        for (int x = 0; x < mLeafDim[0].x; ++x)
         {
-            for (int x = 0; x < mLeafDim[0].x; ++x)
+            nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
+            auto leaf = a.probeLeaf(ijk);
+            float minorant, majorant;
+            uint myleaf = 0;
+            if (leaf)
             {
-                nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
-                auto val = a.getValue(ijk);
-                auto leaf = a.probeLeaf(ijk);
-                float minorant = val, majorant = val;
-                uint myleaf = 0;
-                if (leaf)
-                {
-                    // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
-                    const float* data = leaf->voxels();
-                    for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
-                    // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
-
-                    if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
-                }
-                if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
-                {
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
-                    *ptrdst++ = 0;
-                }
-                else
-                {
-                    const float* data = leaf->voxels();
-                    majorant = f16tof32(f32tof16(majorant) + 1);
-                    minorant = f16tof32(f32tof16(minorant));
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
-                    uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
-                    uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
-                    uint32_t atlasz = myleaf / bricksPerSlice;
-                    *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
-
-                    if (!kBC4Compress) {
-                        float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
-                        TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                float2 majmin = computeBrickRange(a, ijk);
+                majorant = majmin.x;
+                minorant = majmin.y;
+                if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
+            }
+            else
+            {
+                minorant = majorant = a.getValue(ijk);
+            }
+            if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
+            {
+                *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
+                *ptrdst++ = 0;
+            }
+            else
+            {
+                const float* data = leaf->voxels();
+                majorant = f16tof32(f32tof16(majorant) + 1);
+                minorant = f16tof32(f32tof16(minorant));
+                *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
+                uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
+                uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
+                uint32_t atlasz = myleaf / bricksPerSlice;
+                *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
+
+                // Quantize the whole brick at once, the atlas layout below only reorders the quantized values.
+                const float maxQuantized = kBC4Compress ? 255.f : ((1 << kBitsPerTexel) - 1.f);
+                quantizeValues(data, kBrickSize * kBrickSize * kBrickSize, minorant, maxQuantized / (majorant - minorant), quantized);
+
+                if (!kBC4Compress) {
+                    TexelType* atlasdst = (TexelType*)mData.atlas.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
+                    for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                    {
+                        for (int pixy = 0; pixy < kBrickSize; ++pixy)
                         {
-                            for (int pixy = 0; pixy < kBrickSize; ++pixy)
+                            for (int pixx = 0; pixx < kBrickSize; ++pixx)
                             {
-                                for (int pixx = 0; pixx < kBrickSize; ++pixx)
-                                {
-                                    float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
-                                    *atlasdst++ = TexelType((f - minorant) * invRange);
-                                }
-                                atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
+                                *atlasdst++ = TexelType(quantized[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz]);
                             }
-                            atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
+                            atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
                         }
+                        atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
                     }
-                    else {
-                        // BC4 compression:
-                        float invRange = (255.f) / (majorant - minorant);
-                        uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                }
+                else {
+                    // BC4 compression:
+                    uint64_t* atlasdst = ((uint64_t*)mData.atlas.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
+                    for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                    {
+                        for (int tiley = 0; tiley < kBrickSize; tiley += 4)
                         {
-                            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
-                            {
-                                for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
-                                    uint8_t tilevals[4][4];
-                                    uint8_t tileminorant = 255, tilemajorant = 0;
-                                    for (int pixy = 0; pixy < 4; ++pixy)
+                            for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
+                                uint8_t tilevals[4][4];
+                                for (int pixy = 0; pixy < 4; ++pixy)
+                                {
+                                    for (int pixx = 0; pixx < 4; ++pixx)
                                     {
-                                        for (int pixx = 0; pixx < 4; ++pixx)
-                                        {
-                                            float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
-                                            uint8_t voxel = uint8_t((f - minorant) * invRange);
-                                            tileminorant = std::min(tileminorant, voxel);
-                                            tilemajorant = std::max(tilemajorant, voxel);
-                                            tilevals[pixy][pixx] = voxel;
-                                        }
+                                        tilevals[pixy][pixx] = quantized[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
                                     }
-                                    CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
-                                    atlasdst++;
                                 }
-                                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+                                CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
+                                atlasdst++;
                             }
-                            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
-                        } // z slice loop
-                    } // bc4 compress?
-                } // non empty brick?
-            } // x brick loop
-        } // y brick loop
+                            atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+                        }
+                        atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
+                    } // z slice loop
+                } // bc4 compress?
+            } // non empty brick?
+        } // x brick loop
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMipRow(int mip, int y, int z)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
 
         int3 leafdim_tgt = mLeafDim[mip];
-        uint32_t rowstride_tgt = leafdim_tgt.x;
-        uint32_t slicestride_tgt = leafdim_tgt.y * rowstride_tgt;
+        uint32_t* rangedst = mData.range.data() + mLeafCount[mip - 1] + ((size_t)z * leafdim_tgt.y + y) * leafdim_tgt.x;
+        const uint32_t* rangesrc = mData.range.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0) + 2 * z * slicestride_src + 2 * y * rowstride_src;
 
-        for (int z = 0; z < leafdim_tgt.z; ++z, rangesrc += slicestride_src)
+        for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
         {
-            for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
-            {
-                for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
-                {
-                    float2 majmin_dst = combineMajMin(
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
-                        ),
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
-                        )
-                    );
-                    *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
-                } // x
-            } // y
-        } // z
+            float2 majmin_dst = combineMajMin(
+                combineMajMin(
+                    combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
+                    combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
+                ),
+                combineMajMin(
+                    combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
+                    combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
+                )
+            );
+            *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
+        } // x
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel> typename
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert()
+    {
+        return convertBricks().createTextures();
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGridData NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertBricks()
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
-        auto range = NumericRange<int>(0, mLeafDim[0].z);
-        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
-        for (int mip = 1; mip < 4; ++mip) computeMip(mip);
+
+        // Distribute rows of bricks over the thread pool. Rows are much finer grained than slices, which balances the load for grids with few slices.
+        auto processRows = [](const int3& dim, auto&& func)
+        {
+            auto range = NumericRange<int>(0, dim.y * dim.z);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](int row) { func(row % dim.y, row / dim.y); });
+        };
+
+        processRows(mLeafDim[0], [this](int y, int z) { convertRow(y, z); });
+        for (int mip = 1; mip < 4; ++mip) processRows(mLeafDim[mip], [this, mip](int y, int z) { computeMipRow(mip, y, z); });
+
         double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
         logInfo("converted in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
 
-        BrickedGrid bricks;
-        bricks.range = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.indirection = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.atlas = Texture::create3D(getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
-        return bricks;
+        return std::move(mData);
     }
 }
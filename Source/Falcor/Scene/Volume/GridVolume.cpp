@@ -44,6 +44,10 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+        const uint32_t kMinStreamingWindow = 2;
+        const uint32_t kMaxStreamingWindow = 256;
+        const double kPrefetchTime = 0.25;      ///< Playback time in seconds to prefetch ahead of the current frame.
+        const size_t kMaxPendingLoads = 4;      ///< Maximum number of grids loaded concurrently on worker threads.
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -76,6 +80,14 @@ namespace Falcor
 
             bool playback = isPlaybackEnabled();
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
+
+            if (isStreamed())
+            {
+                uint32_t streamingWindow = getStreamingWindow();
+                if (widget.var("Streaming window", streamingWindow, kMinStreamingWindow, kMaxStreamingWindow, 1u)) setStreamingWindow(streamingWindow);
+                widget.tooltip("Number of frames kept resident in memory. Frames ahead of the current frame are prefetched based on the frame rate.");
+                widget.text(fmt::format("Resident frames: {} / {}", getResidentFrameCount(), mGridFrameCount));
+            }
         }
 
         if (const auto& densityGrid = getDensityGrid())
@@ -124,29 +136,51 @@ namespace Falcor
     }
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
+    {
+        return loadGridSequenceFiles(slot, paths, gridname, keepEmpty, false);
+    }
+
+    uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
+    {
+        auto paths = findGridSequenceFiles(path);
+        return paths.empty() ? 0 : loadGridSequenceFiles(slot, paths, gridname, keepEmpty, false);
+    }
+
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
+    {
+        return loadGridSequenceFiles(slot, paths, gridname, keepEmpty, true);
+    }
+
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
+    {
+        auto paths = findGridSequenceFiles(path);
+        return paths.empty() ? 0 : loadGridSequenceFiles(slot, paths, gridname, keepEmpty, true);
+    }
+
+    uint32_t GridVolume::loadGridSequenceFiles(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty, bool streamed)
     {
         GridSequence grids;
         for (const auto& path : paths)
         {
-            auto grid = Grid::createFromFile(path, gridname);
+            auto grid = streamed ? Grid::createStreamed(path, gridname) : Grid::createFromFile(path, gridname);
             if (keepEmpty || grid) grids.push_back(grid);
         }
         setGridSequence(slot, grids);
         return (uint32_t)grids.size();
     }
 
-    uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
+    std::vector<std::filesystem::path> GridVolume::findGridSequenceFiles(const std::filesystem::path& path)
     {
         std::filesystem::path fullPath;
         if (!findFileInDataDirectories(path, fullPath))
         {
             logWarning("Cannot find directory '{}'.", path);
-            return 0;
+            return {};
         }
         if (!std::filesystem::is_directory(fullPath))
         {
             logWarning("'{}' is not a directory.", path);
-            return 0;
+            return {};
         }
 
         // Enumerate grid files.
@@ -165,7 +199,7 @@ namespace Falcor
         };
         std::sort(paths.begin(), paths.end(), cmp);
 
-        return loadGridSequence(slot, paths, gridname, keepEmpty);
+        return paths;
     }
 
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
@@ -176,7 +210,9 @@ namespace Falcor
         if (mGrids[slotIndex] != grids)
         {
             mGrids[slotIndex] = grids;
+            mResidentGrids[slotIndex] = nullptr;
             updateSequence();
+            updateStreaming();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
         }
@@ -203,8 +239,12 @@ namespace Falcor
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
         const auto& gridSequence = mGrids[slotIndex];
-        uint32_t gridIndex = std::min(mGridFrame, (uint32_t)gridSequence.size() - 1);
-        return gridSequence.empty() ? kNullGrid : gridSequence[gridIndex];
+        if (gridSequence.empty()) return kNullGrid;
+        const auto& grid = gridSequence[std::min(mGridFrame, (uint32_t)gridSequence.size() - 1)];
+
+        // Keep using the last resident grid of a streamed sequence while the grid of the current frame is not resident, e.g., because it failed to load.
+        if (grid && !grid->isResident() && mResidentGrids[slotIndex]) return mResidentGrids[slotIndex];
+        return grid;
     }
 
     std::vector<Grid::SharedPtr> GridVolume::getAllGrids() const
@@ -222,6 +262,7 @@ namespace Falcor
         if (mGridFrame != gridFrame)
         {
             mGridFrame = gridFrame;
+            updateStreaming();
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -245,6 +286,32 @@ namespace Falcor
             uint32_t frameIndex = (uint32_t)std::floor(std::max(0.0, currentTime) * mFrameRate) % frameCount;
             setGridFrame(frameIndex);
         }
+
+        // Pick up finished loads and keep prefetching, also when the frame did not change.
+        updateStreaming();
+    }
+
+    void GridVolume::setStreamingWindow(uint32_t frameCount)
+    {
+        mStreamingWindow = std::clamp(frameCount, kMinStreamingWindow, kMaxStreamingWindow);
+        updateStreaming();
+    }
+
+    uint32_t GridVolume::getResidentFrameCount() const
+    {
+        uint32_t residentFrameCount = 0;
+        for (uint32_t frame = 0; frame < mGridFrameCount; ++frame)
+        {
+            bool resident = true;
+            for (const auto& grids : mGrids)
+            {
+                if (grids.empty()) continue;
+                const auto& grid = grids[std::min(frame, (uint32_t)grids.size() - 1)];
+                if (grid && !grid->isResident()) resident = false;
+            }
+            if (resident) residentFrameCount++;
+        }
+        return residentFrameCount;
     }
 
     void GridVolume::setDensityScale(float densityScale)
@@ -322,10 +389,122 @@ namespace Falcor
     void GridVolume::updateSequence()
     {
         mGridFrameCount = 1;
-        for (const auto& grids : mGrids) mGridFrameCount = std::max(mGridFrameCount, (uint32_t)grids.size());
+        mIsStreamed = false;
+        for (const auto& grids : mGrids)
+        {
+            mGridFrameCount = std::max(mGridFrameCount, (uint32_t)grids.size());
+            mIsStreamed |= std::any_of(grids.begin(), grids.end(), [](const auto& grid) { return grid && grid->isStreamed(); });
+        }
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
+    void GridVolume::updateStreaming()
+    {
+        if (!mIsStreamed && mPendingLoads.empty()) return;
+
+        // Build the list of frames in the streaming window in load priority order.
+        // The current frame comes first, followed by the frames played back within the prefetch time and then the frames behind the current frame.
+        const uint32_t windowSize = std::min(mStreamingWindow, mGridFrameCount);
+        const uint32_t aheadCount = std::min((uint32_t)std::ceil(mFrameRate * kPrefetchTime), windowSize - 1);
+        std::vector<uint32_t> windowFrames;
+        windowFrames.reserve(windowSize);
+        for (uint32_t i = 0; i <= aheadCount; ++i) windowFrames.push_back((mGridFrame + i) % mGridFrameCount);
+        for (uint32_t i = 1; i < windowSize - aheadCount; ++i) windowFrames.push_back((mGridFrame + mGridFrameCount - i) % mGridFrameCount);
+
+        // Collect the grids in the window. Shorter sequences clamp to their last grid, same as getGrid().
+        std::set<Grid*> windowGrids;
+        std::set<Grid*> currentGrids;
+        for (const auto& grids : mGrids)
+        {
+            if (grids.empty()) continue;
+            for (uint32_t frame : windowFrames) windowGrids.insert(grids[std::min(frame, (uint32_t)grids.size() - 1)].get());
+            currentGrids.insert(grids[std::min(mGridFrame, (uint32_t)grids.size() - 1)].get());
+        }
+
+        auto makeResident = [this](const Grid::SharedPtr& pGrid, const std::shared_ptr<Grid::HostData>& pHostData)
+        {
+            if (pGrid->makeResident(pHostData)) mResidencyChanges.push_back(pGrid);
+            else logWarning("Failed to stream grid '{}' from '{}'.", pGrid->getGridname(), pGrid->getPath());
+        };
+
+        // Make finished loads resident. Loads of the current frame are waited for.
+        // Loads that left the window are only dropped once finished, as discarding a running load would block.
+        for (auto it = mPendingLoads.begin(); it != mPendingLoads.end();)
+        {
+            const auto& pGrid = it->pGrid;
+            bool isCurrent = currentGrids.count(pGrid.get()) > 0;
+            if (isCurrent || it->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                auto pHostData = it->future.get();
+                if (windowGrids.count(pGrid.get()) > 0 && !pGrid->isResident()) makeResident(pGrid, pHostData);
+                it = mPendingLoads.erase(it);
+            }
+            else ++it;
+        }
+
+        // Load the current frame synchronously if it is not resident yet.
+        for (const auto& grids : mGrids)
+        {
+            if (grids.empty()) continue;
+            const auto& pGrid = grids[std::min(mGridFrame, (uint32_t)grids.size() - 1)];
+            if (pGrid && pGrid->isStreamed() && !pGrid->isResident())
+            {
+                makeResident(pGrid, Grid::loadHostData(pGrid->getPath(), pGrid->getGridname()));
+            }
+        }
+
+        // Remember the resident grid of the current frame. It stays in use until the grid of a later frame is resident.
+        bool residentGridsChanged = false;
+        for (size_t slotIndex = 0; slotIndex < mGrids.size(); ++slotIndex)
+        {
+            const auto& grids = mGrids[slotIndex];
+            if (grids.empty()) continue;
+            const auto& pGrid = grids[std::min(mGridFrame, (uint32_t)grids.size() - 1)];
+            if (pGrid && pGrid->isStreamed() && pGrid->isResident() && pGrid != mResidentGrids[slotIndex])
+            {
+                mResidentGrids[slotIndex] = pGrid;
+                residentGridsChanged = true;
+            }
+        }
+        if (residentGridsChanged)
+        {
+            markUpdates(UpdateFlags::GridsChanged);
+            updateBounds();
+        }
+
+        // Evict grids outside the window, except for the grids still in use.
+        for (const auto& grids : mGrids)
+        {
+            for (const auto& pGrid : grids)
+            {
+                if (std::find(mResidentGrids.begin(), mResidentGrids.end(), pGrid) != mResidentGrids.end()) continue;
+                if (pGrid && pGrid->isStreamed() && pGrid->isResident() && windowGrids.count(pGrid.get()) == 0)
+                {
+                    pGrid->evict();
+                    mResidencyChanges.push_back(pGrid);
+                }
+            }
+        }
+
+        // Prefetch the remaining frames in the window on worker threads.
+        for (uint32_t frame : windowFrames)
+        {
+            for (const auto& grids : mGrids)
+            {
+                if (grids.empty() || mPendingLoads.size() >= kMaxPendingLoads) continue;
+                const auto& pGrid = grids[std::min(frame, (uint32_t)grids.size() - 1)];
+                if (!pGrid || !pGrid->isStreamed() || pGrid->isResident()) continue;
+                bool isPending = std::any_of(mPendingLoads.begin(), mPendingLoads.end(), [&pGrid](const auto& load) { return load.pGrid == pGrid; });
+                if (isPending) continue;
+
+                auto future = std::async(std::launch::async, [path = pGrid->getPath(), gridname = pGrid->getGridname()]() { return Grid::loadHostData(path, gridname); });
+                mPendingLoads.push_back({ pGrid, std::move(future) });
+            }
+        }
+
+        if (!mResidencyChanges.empty()) markUpdates(UpdateFlags::ResidencyChanged);
+    }
+
     void GridVolume::updateBounds()
     {
         AABB bounds;
@@ -370,6 +549,9 @@ namespace Falcor
         volume.def_property_readonly("gridFrameCount", &GridVolume::getGridFrameCount);
         volume.def_property("frameRate", &GridVolume::getFrameRate, &GridVolume::setFrameRate);
         volume.def_property("playbackEnabled", &GridVolume::isPlaybackEnabled, &GridVolume::setPlaybackEnabled);
+        volume.def_property_readonly("streamed", &GridVolume::isStreamed);
+        volume.def_property("streamingWindow", &GridVolume::getStreamingWindow, &GridVolume::setStreamingWindow);
+        volume.def_property_readonly("residentFrameCount", &GridVolume::getResidentFrameCount);
         volume.def_property("densityGrid", &GridVolume::getDensityGrid, &GridVolume::setDensityGrid);
         volume.def_property("densityScale", &GridVolume::getDensityScale, &GridVolume::setDensityScale);
         volume.def_property("emissionGrid", &GridVolume::getEmissionGrid, &GridVolume::setEmissionGrid);
@@ -386,6 +568,12 @@ namespace Falcor
         volume.def("loadGridSequence",
             pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::loadGridSequence),
             "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
+        volume.def("streamGridSequence",
+            pybind11::overload_cast<GridVolume::GridSlot, const std::vector<std::filesystem::path>&, const std::string&, bool>(&GridVolume::streamGridSequence),
+            "slot"_a, "paths"_a, "gridname"_a, "keepEmpty"_a = true);
+        volume.def("streamGridSequence",
+            pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::streamGridSequence),
+            "slot"_a, "path"_a, "gridname"_a, "keepEmpty"_a = true);
 
         pybind11::enum_<GridVolume::GridSlot> gridSlot(volume, "GridSlot");
         gridSlot.value("Density", GridVolume::GridSlot::Density);
@@ -31,6 +31,7 @@
 #include "Scene/Animation/Animatable.h"
 
 #include <filesystem>
+#include <future>
 
 namespace Falcor
 {
@@ -39,6 +40,7 @@ namespace Falcor
         The emission is defined by an emission voxel grid and additional parameters.
         Grids are stored in grid slots (density, emission) and can either be static, using one grid per slot,
         or dynamic, using a sequence of grids per slot.
+        Grid sequences can be streamed, in which case only a window of frames around the current frame is resident in memory.
     */
     class FALCOR_API GridVolume : public Animatable
     {
@@ -56,6 +58,7 @@ namespace Falcor
             GridsChanged        = 0x2,  ///< Volume grids changed.
             TransformChanged    = 0x4,  ///< Volume transform changed.
             BoundsChanged       = 0x8,  ///< Volume world-space bounds changed.
+            ResidencyChanged    = 0x10, ///< Streamed grids were made resident or evicted.
         };
 
         /** Grid slots available in the volume.
@@ -92,7 +95,11 @@ namespace Falcor
 
         /** Clears the updates.
         */
-        void clearUpdates() { mUpdates = UpdateFlags::None; }
+        void clearUpdates() { mUpdates = UpdateFlags::None; mResidencyChanges.clear(); }
+
+        /** Returns the streamed grids that were made resident or evicted since the last call to clearUpdates.
+        */
+        const std::vector<Grid::SharedPtr>& getResidencyChanges() const { return mResidencyChanges; }
 
         /** Set the volume name.
         */
@@ -131,6 +138,28 @@ namespace Falcor
         */
         uint32_t loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
 
+        /** Load a sequence of grids from files to a grid slot for streamed playback.
+            Only the grid metadata is loaded upfront. A window of frames around the current frame is kept resident
+            and the upcoming frames are loaded on worker threads ahead of playback, see setStreamingWindow().
+            Note: This will replace any existing grid sequence for that slot. Only NanoVDB files are supported.
+            \param[in] slot Grid slot.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] keepEmpty Add empty (nullptr) grids to the sequence if one cannot be loaded from the file.
+            \return Returns the length of the loaded sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty = true);
+
+        /** Load a sequence of grids from a directory to a grid slot for streamed playback.
+            Note: This will replace any existing grid sequence for that slot. Only NanoVDB files are supported.
+            \param[in] slot Grid slot.
+            \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] keepEmpty Add empty (nullptr) grids to the sequence if one cannot be loaded from the file.
+            \return Returns the length of the loaded sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
+
         /** Set the grid sequence for the specified slot.
         */
         void setGridSequence(GridSlot slot, const GridSequence& grids);
@@ -145,6 +174,8 @@ namespace Falcor
         void setGrid(GridSlot slot, const Grid::SharedPtr& grid);
 
         /** Get the current grid from the specified slot.
+            For streamed sequences, this is the last resident grid while the grid of the current frame is not resident.
+            The returned grid is only non-resident if no grid of the sequence has been resident yet.
         */
         const Grid::SharedPtr& getGrid(GridSlot slot) const;
 
@@ -182,9 +213,27 @@ namespace Falcor
         bool isPlaybackEnabled() const { return mPlaybackEnabled; }
 
         /** Update the selected grid frame based on global time in seconds.
+            For streamed grid sequences this also makes finished loads resident, evicts frames outside the streaming window and prefetches upcoming frames.
         */
         void updatePlayback(double curentTime);
 
+        /** Check if any of the grid sequences are streamed.
+        */
+        bool isStreamed() const { return mIsStreamed; }
+
+        /** Set the number of frames kept resident for streamed grid sequences.
+            The window is split into frames prefetched ahead of the current frame, based on the frame rate, and frames kept behind it.
+        */
+        void setStreamingWindow(uint32_t frameCount);
+
+        /** Get the number of frames kept resident for streamed grid sequences.
+        */
+        uint32_t getStreamingWindow() const { return mStreamingWindow; }
+
+        /** Get the number of frames for which all grids are resident.
+        */
+        uint32_t getResidentFrameCount() const;
+
         /** Set the density grid.
         */
         void setDensityGrid(const Grid::SharedPtr& densityGrid) { setGrid(GridSlot::Density, densityGrid); };
@@ -264,6 +313,9 @@ namespace Falcor
 
         void updateSequence();
         void updateBounds();
+        void updateStreaming();
+        uint32_t loadGridSequenceFiles(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty, bool streamed);
+        static std::vector<std::filesystem::path> findGridSequenceFiles(const std::filesystem::path& path);
 
         void markUpdates(UpdateFlags updates);
         void setFlags(uint32_t flags);
@@ -278,6 +330,19 @@ namespace Falcor
         GridVolumeData mData;
         mutable UpdateFlags mUpdates = UpdateFlags::None;
 
+        // Streaming.
+        struct PendingLoad
+        {
+            Grid::SharedPtr pGrid;
+            std::future<std::shared_ptr<Grid::HostData>> future;
+        };
+
+        bool mIsStreamed = false;                           ///< True if any of the grid sequences are streamed.
+        uint32_t mStreamingWindow = 8;                      ///< Number of frames kept resident for streamed grid sequences.
+        std::vector<PendingLoad> mPendingLoads;             ///< Grid loads running on worker threads.
+        std::vector<Grid::SharedPtr> mResidencyChanges;     ///< Streamed grids made resident or evicted since the last call to clearUpdates.
+        std::array<Grid::SharedPtr, (size_t)GridSlot::Count> mResidentGrids; ///< Last resident grid of the current frame per slot. Used while the grid of the current frame is not resident.
+
         friend class SceneCache;
     };
 
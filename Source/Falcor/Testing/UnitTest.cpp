@@ -27,9 +27,19 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "UnitTest.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/error/en.h"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
 #include <regex>
+#include <thread>
 #include <inttypes.h>
 
 namespace Falcor
@@ -48,6 +58,7 @@ namespace Falcor
             std::string skipMessage;
             CPUTestFunc cpuFunc;
             GPUTestFunc gpuFunc;
+            bool runSerially = false;   ///< True if the CPU test must not run concurrently with other tests.
         };
 
         struct TestResult
@@ -64,19 +75,135 @@ namespace Falcor
             uint64_t elapsedMS = 0;
         };
 
+        struct Benchmark
+        {
+            std::string getTitle() const
+            {
+                return path.filename().string() + "/" + name + " (Benchmark)";
+            }
+
+            std::filesystem::path path;
+            std::string name;
+            std::string skipMessage;
+            CPUBenchmarkFunc func;
+        };
+
+        struct BenchmarkResult
+        {
+            std::string name;           ///< Full measurement name, used as key in the baseline.
+            Profiler::Stats stats;
+            uint32_t repetitionCount;
+        };
+
         /** testRegistry is declared as pointer so that we can ensure it can be explicitly
              allocated when register[CG]PUTest() is called.  (The C++ static object
              initialization fiasco.)
          */
         std::vector<Test>* testRegistry;
+        std::vector<Benchmark>* benchmarkRegistry;
+
+        /** Number of tests currently running on any thread. Used to check that serial tests don't overlap with other tests.
+        */
+        std::atomic<uint32_t> runningTestCount{ 0 };
+
+        template<typename T>
+        std::vector<T> filterAndSort(const std::vector<T>* pRegistry, const std::string& filter)
+        {
+            std::vector<T> items;
+            if (!pRegistry) return items;
+
+            // Filter.
+            std::regex filterRegex(filter, std::regex::icase | std::regex::basic);
+            std::copy_if(pRegistry->begin(), pRegistry->end(), std::back_inserter(items),
+                [&filterRegex] (const T& item)
+            {
+                return std::regex_search(item.getTitle(), filterRegex);
+            });
+
+            // Sort by name.
+            std::sort(items.begin(), items.end(),
+                [](const T& a, const T& b)
+            {
+                return (a.path / a.name).string() < (b.path / b.name).string();
+            });
+
+            return items;
+        }
+
+        /** Load the mean times of a benchmark results file written by writeBenchmarkResults().
+        */
+        std::map<std::string, float> loadBenchmarkBaseline(const std::filesystem::path& path)
+        {
+            if (!std::filesystem::exists(path)) throw RuntimeError("Benchmark baseline '{}' does not exist.", path);
+
+            std::string jsonData = readFile(path);
+            rapidjson::Document jsonDocument;
+            jsonDocument.Parse(jsonData.c_str());
+
+            if (jsonDocument.HasParseError())
+            {
+                size_t line = std::count(jsonData.begin(), jsonData.begin() + jsonDocument.GetErrorOffset(), '\n');
+                throw RuntimeError("Error when parsing benchmark baseline '{}'. JSON Parse error in line {}: {}", path, line, rapidjson::GetParseError_En(jsonDocument.GetParseError()));
+            }
+
+            if (!jsonDocument.IsObject() || !jsonDocument.HasMember("benchmarks") || !jsonDocument["benchmarks"].IsArray())
+            {
+                throw RuntimeError("Benchmark baseline '{}' does not contain a 'benchmarks' array.", path);
+            }
+
+            std::map<std::string, float> baseline;
+            for (const auto& benchmark : jsonDocument["benchmarks"].GetArray())
+            {
+                if (!benchmark.IsObject() || !benchmark.HasMember("name") || !benchmark["name"].IsString() || !benchmark.HasMember("mean") || !benchmark["mean"].IsNumber()) continue;
+                baseline[benchmark["name"].GetString()] = benchmark["mean"].GetFloat();
+            }
+            return baseline;
+        }
+
+        void writeBenchmarkResults(const std::filesystem::path& path, const BenchmarkOptions& options, const std::vector<BenchmarkResult>& results)
+        {
+            rapidjson::StringBuffer jsonStringBuffer;
+            rapidjson::PrettyWriter<rapidjson::StringBuffer> jsonWriter(jsonStringBuffer);
+
+            jsonWriter.StartObject();
+            jsonWriter.String("warmupCount");
+            jsonWriter.Uint(options.warmupCount);
+            jsonWriter.String("repetitionCount");
+            jsonWriter.Uint(options.repetitionCount);
+            jsonWriter.String("benchmarks");
+            jsonWriter.StartArray();
+            for (const auto& result : results)
+            {
+                jsonWriter.StartObject();
+                jsonWriter.String("name");
+                jsonWriter.String(result.name.c_str());
+                jsonWriter.String("mean");
+                jsonWriter.Double(result.stats.mean);
+                jsonWriter.String("min");
+                jsonWriter.Double(result.stats.min);
+                jsonWriter.String("max");
+                jsonWriter.Double(result.stats.max);
+                jsonWriter.String("stdDev");
+                jsonWriter.Double(result.stats.stdDev);
+                jsonWriter.String("repetitionCount");
+                jsonWriter.Uint(result.repetitionCount);
+                jsonWriter.EndObject();
+            }
+            jsonWriter.EndArray();
+            jsonWriter.EndObject();
+
+            std::ofstream file(path);
+            if (!file.is_open()) throw RuntimeError("Failed to open benchmark results file '{}'.", path);
+            file << jsonStringBuffer.GetString() << std::endl;
+        }
 
     }   // end anonymous namespace
 
     void registerCPUTest(const std::filesystem::path& path, const std::string& name,
-                         const std::string& skipMessage, CPUTestFunc func)
+                         const std::string& skipMessage, CPUTestFunc func, bool runSerially)
     {
         if (!testRegistry) testRegistry = new std::vector<Test>;
-        testRegistry->push_back({ path, name, skipMessage, std::move(func), {} });
+        testRegistry->push_back({ path, name, skipMessage, std::move(func), {}, runSerially });
     }
 
     void registerGPUTest(const std::filesystem::path& path, const std::string& name,
@@ -86,6 +213,13 @@ namespace Falcor
         testRegistry->push_back({ path, name, skipMessage, {}, std::move(func) });
     }
 
+    void registerCPUBenchmark(const std::filesystem::path& path, const std::string& name,
+                              const std::string& skipMessage, CPUBenchmarkFunc func)
+    {
+        if (!benchmarkRegistry) benchmarkRegistry = new std::vector<Benchmark>;
+        benchmarkRegistry->push_back({ path, name, skipMessage, std::move(func) });
+    }
+
     inline TestResult runTest(const Test& test, RenderContext* pRenderContext)
     {
         if (!test.skipMessage.empty()) return { TestResult::Status::Skipped, { test.skipMessage } };
@@ -99,6 +233,7 @@ namespace Falcor
 
         std::string extraMessage;
 
+        ++runningTestCount;
         try
         {
             if (test.cpuFunc) test.cpuFunc(cpuCtx);
@@ -124,6 +259,7 @@ namespace Falcor
             result.status = TestResult::Status::Failed;
             extraMessage = e.what();
         }
+        --runningTestCount;
 
         result.messages = test.cpuFunc ? cpuCtx.getFailureMessages() : gpuCtx.getFailureMessages();
 
@@ -140,52 +276,330 @@ namespace Falcor
         return result;
     }
 
-    int32_t runTests(std::ostream& stream, RenderContext* pRenderContext, const std::string &testFilter, uint32_t repeatCount)
+    namespace
     {
-        if (testRegistry == nullptr) return 0;
+        /** State shared between the test runner and the CPU test worker threads.
+            It is held by shared pointer, as workers running a timed out test are detached until the process exits.
+        */
+        struct CPUTestQueue
+        {
+            struct Entry
+            {
+                Test test;
+                uint32_t repeatIndex = 0;
+                TestResult result;
+                bool done = false;          ///< True if the result is available (or the test timed out).
+                bool finished = false;      ///< True if the test function has returned.
+                bool started = false;
+                uint32_t workerIndex = 0;
+                std::chrono::steady_clock::time_point startTime;
+            };
+
+            // Internal state. Do not access outside of critical section.
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<Entry> entries;
+            size_t nextEntry = 0;
+        };
+
+        void runCPUTestWorker(std::shared_ptr<CPUTestQueue> pQueue, uint32_t workerIndex)
+        {
+            std::unique_lock<std::mutex> lock(pQueue->mutex);
+            while (pQueue->nextEntry < pQueue->entries.size())
+            {
+                auto& entry = pQueue->entries[pQueue->nextEntry++];
+                entry.started = true;
+                entry.workerIndex = workerIndex;
+                entry.startTime = std::chrono::steady_clock::now();
+                pQueue->condition.notify_all(); // The runner waits for the start time to apply the timeout.
+                lock.unlock();
+
+                TestResult result = runTest(entry.test, nullptr);
+
+                lock.lock();
+                entry.finished = true;
+                if (!entry.done)
+                {
+                    entry.result = std::move(result);
+                    entry.done = true;
+                }
+                pQueue->condition.notify_all();
+            }
+        }
 
-        std::vector<Test> tests;
+        void printTestTitle(std::ostream& stream, const Test& test, uint32_t repeatIndex, uint32_t repeatCount)
+        {
+            stream << "  " << padStringToLength(test.getTitle(), 60) << ": ";
+            if (repeatCount > 1) stream << "[" << (repeatIndex + 1) << "/" << repeatCount << "] ";
+            stream << std::flush;
+        }
 
-        // Filter tests.
-        std::regex testFilterRegex(testFilter, std::regex::icase | std::regex::basic);
-        std::copy_if(testRegistry->begin(), testRegistry->end(), std::back_inserter(tests),
-            [&testFilterRegex] (const Test& test)
+        void printTestResult(std::ostream& stream, const TestResult& result)
         {
-            return std::regex_search(test.getTitle(), testFilterRegex);
-        });
+            switch (result.status)
+            {
+            case TestResult::Status::Passed: stream << colored("PASSED", TermColor::Green, stream); break;
+            case TestResult::Status::Failed: stream << colored("FAILED", TermColor::Red, stream); break;
+            case TestResult::Status::Skipped: stream << colored("SKIPPED", TermColor::Yellow, stream); break;
+            }
+
+            stream << " (" << std::to_string(result.elapsedMS) << " ms)" << std::endl;
+            for (const auto& m : result.messages) stream << "    "  << m << std::endl;
+        }
+    }
+
+    int32_t runTests(std::ostream& stream, RenderContext* pRenderContext, const std::string &testFilter, uint32_t repeatCount, const TestRunOptions& options)
+    {
+        if (testRegistry == nullptr) return 0;
+
+        std::vector<Test> tests = filterAndSort(testRegistry, testFilter);
 
-        // Sort tests by name.
-        std::sort(tests.begin(), tests.end(),
-            [](const Test &a, const Test &b)
+        // Select the tests of this shard. Tests are assigned round-robin in sorted order, so all shards see the same assignment.
+        if (options.shardCount > 1)
         {
-            return (a.path / a.name).string() < (b.path / b.name).string();
-        });
+            if (options.shardIndex >= options.shardCount) throw ArgumentError("Shard index {} is out of range (shard count {}).", options.shardIndex, options.shardCount);
+            std::vector<Test> shardTests;
+            for (size_t i = options.shardIndex; i < tests.size(); i += options.shardCount) shardTests.push_back(tests[i]);
+            tests = std::move(shardTests);
+        }
 
-        stream << "Running " << std::to_string(tests.size()) << " tests" << std::endl;
+        stream << "Running " << std::to_string(tests.size()) << " tests";
+        if (options.shardCount > 1) stream << " (shard " << (options.shardIndex + 1) << "/" << options.shardCount << ")";
+        stream << std::endl;
 
         int32_t failureCount = 0;
 
+        auto checkTimeout = [&options] (TestResult& result)
+        {
+            if (options.timeoutSeconds > 0 && result.elapsedMS > options.timeoutSeconds * 1000ull)
+            {
+                result.status = TestResult::Status::Failed;
+                result.messages.push_back("Test exceeded the timeout of " + std::to_string(options.timeoutSeconds) + " s.");
+            }
+        };
+
+        bool hasBlockedWorkers = false;
+
+        // Run CPU tests concurrently on worker threads before running the GPU tests and the CPU tests that must run serially.
+        // The results are reported in the order of the tests, as soon as they are available.
+        if (options.threadCount > 1)
+        {
+            auto pQueue = std::make_shared<CPUTestQueue>();
+            std::vector<Test> serialTests;
+            for (const auto& test : tests)
+            {
+                if (!test.cpuFunc || test.runSerially)
+                {
+                    serialTests.push_back(test);
+                    continue;
+                }
+                for (uint32_t repeatIndex = 0; repeatIndex < repeatCount; ++repeatIndex)
+                {
+                    CPUTestQueue::Entry entry;
+                    entry.test = test;
+                    entry.repeatIndex = repeatIndex;
+                    pQueue->entries.push_back(std::move(entry));
+                }
+            }
+            tests = std::move(serialTests);
+
+            std::vector<std::thread> threads;
+            uint32_t threadCount = (uint32_t)std::min<size_t>(options.threadCount, pQueue->entries.size());
+            for (uint32_t i = 0; i < threadCount; ++i) threads.emplace_back(runCPUTestWorker, pQueue, i);
+
+            const auto timeout = std::chrono::seconds(options.timeoutSeconds);
+            for (auto& entry : pQueue->entries)
+            {
+                std::unique_lock<std::mutex> lock(pQueue->mutex);
+                while (!entry.done)
+                {
+                    if (options.timeoutSeconds == 0 || !entry.started)
+                    {
+                        pQueue->condition.wait(lock);
+                    }
+                    else if (pQueue->condition.wait_until(lock, entry.startTime + timeout) == std::cv_status::timeout && !entry.done)
+                    {
+                        // The test function cannot be interrupted. Report the failure and start another worker to replace the blocked one.
+                        entry.result = { TestResult::Status::Failed, { "Test timed out after " + std::to_string(options.timeoutSeconds) + " s." } };
+                        entry.result.elapsedMS = options.timeoutSeconds * 1000ull;
+                        entry.done = true;
+                        threads.emplace_back(runCPUTestWorker, pQueue, (uint32_t)threads.size());
+                    }
+                }
+                TestResult result = entry.result;
+                lock.unlock();
+
+                checkTimeout(result);
+                printTestTitle(stream, entry.test, entry.repeatIndex, repeatCount);
+                printTestResult(stream, result);
+
+                if (result.status == TestResult::Status::Failed) ++failureCount;
+            }
+
+            // Wait for the workers to finish. Workers blocked in a timed out test are detached,
+            // and the process is terminated once all tests have been reported (see below).
+            std::vector<bool> blocked(threads.size(), false);
+            {
+                std::lock_guard<std::mutex> lock(pQueue->mutex);
+                for (const auto& entry : pQueue->entries)
+                {
+                    if (entry.started && !entry.finished) blocked[entry.workerIndex] = true;
+                }
+            }
+            for (size_t i = 0; i < threads.size(); ++i)
+            {
+                if (blocked[i]) threads[i].detach();
+                else threads[i].join();
+                hasBlockedWorkers |= blocked[i];
+            }
+        }
+
         for (const auto& test : tests)
         {
             for (uint32_t repeatIndex = 0; repeatIndex < repeatCount; ++repeatIndex)
             {
-                stream << "  " << padStringToLength(test.getTitle(), 60) << ": ";
-                if (repeatCount > 1) stream << "[" << (repeatIndex + 1) << "/" << repeatCount << "] ";
-                stream << std::flush;
+                printTestTitle(stream, test, repeatIndex, repeatCount);
 
                 TestResult result = runTest(test, pRenderContext);
+                checkTimeout(result);
+
+                printTestResult(stream, result);
+
+                if (result.status == TestResult::Status::Failed) ++failureCount;
+            }
+        }
+
+        // A timed out test may still be running and can't be stopped. Exit without tearing down the device and other
+        // global state underneath it. The failure count is returned as the exit code, as by the test runner.
+        if (hasBlockedWorkers)
+        {
+            stream << colored("Terminating because timed out tests are still running.", TermColor::Red, stream) << std::endl;
+            std::_Exit(failureCount);
+        }
+
+        return failureCount;
+    }
 
-                switch (result.status)
+    int32_t runBenchmarks(std::ostream& stream, const std::string& benchmarkFilter, const BenchmarkOptions& options)
+    {
+        std::vector<Benchmark> benchmarks = filterAndSort(benchmarkRegistry, benchmarkFilter);
+
+        int32_t failureCount = 0;
+
+        std::map<std::string, float> baseline;
+        if (!options.baselinePath.empty())
+        {
+            try
+            {
+                baseline = loadBenchmarkBaseline(options.baselinePath);
+            }
+            catch (const std::exception& e)
+            {
+                stream << colored(e.what(), TermColor::Red, stream) << std::endl;
+                ++failureCount;
+            }
+        }
+
+        stream << "Running " << std::to_string(benchmarks.size()) << " benchmarks (" << options.warmupCount << " warmup, " << options.repetitionCount << " timed iterations)" << std::endl;
+
+        std::vector<BenchmarkResult> results;
+
+        for (const auto& benchmark : benchmarks)
+        {
+            stream << "  " << padStringToLength(benchmark.getTitle(), 60) << ": " << std::flush;
+
+            if (!benchmark.skipMessage.empty())
+            {
+                stream << colored("SKIPPED", TermColor::Yellow, stream) << std::endl;
+                stream << "    " << benchmark.skipMessage << std::endl;
+                continue;
+            }
+
+            TestResult result { TestResult::Status::Passed };
+            CPUBenchmarkContext ctx(options.warmupCount, std::max(1u, options.repetitionCount));
+            std::string extraMessage;
+
+            auto startTime = std::chrono::steady_clock::now();
+
+            try
+            {
+                benchmark.func(ctx);
+            }
+            catch (const SkippingTestException& e)
+            {
+                result.status = TestResult::Status::Skipped;
+                extraMessage = e.what();
+            }
+            catch (const TooManyFailedTestsException&)
+            {
+                result.status = TestResult::Status::Failed;
+                extraMessage = "Gave up after " + std::to_string(kMaxTestFailures) + " failures.";
+            }
+            catch (const std::exception& e)
+            {
+                result.status = TestResult::Status::Failed;
+                extraMessage = e.what();
+            }
+
+            result.messages = ctx.getFailureMessages();
+            if (!result.messages.empty()) result.status = TestResult::Status::Failed;
+            if (!extraMessage.empty()) result.messages.push_back(extraMessage);
+
+            auto endTime = std::chrono::steady_clock::now();
+            result.elapsedMS = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+
+            // Report measurements and compare against the baseline.
+            std::vector<std::string> measurementLines;
+            if (result.status == TestResult::Status::Passed)
+            {
+                for (const auto& measurement : ctx.getMeasurements())
                 {
-                case TestResult::Status::Passed: stream << colored("PASSED", TermColor::Green, stream); break;
-                case TestResult::Status::Failed: stream << colored("FAILED", TermColor::Red, stream); break;
-                case TestResult::Status::Skipped: stream << colored("SKIPPED", TermColor::Yellow, stream); break;
+                    std::string name = benchmark.path.filename().string() + "/" + benchmark.name + (measurement.name.empty() ? "" : "/" + measurement.name);
+                    const auto& stats = measurement.stats;
+                    std::string line = fmt::format("{}: mean {:.3f} ms, min {:.3f} ms, max {:.3f} ms, std dev {:.3f} ms", name, stats.mean, stats.min, stats.max, stats.stdDev);
+
+                    auto it = baseline.find(name);
+                    if (it != baseline.end() && it->second > 0.f)
+                    {
+                        float change = stats.mean / it->second - 1.f;
+                        line += fmt::format(" (baseline {:.3f} ms, {:+.1f}%)", it->second, change * 100.f);
+                        if (change > options.tolerance)
+                        {
+                            result.status = TestResult::Status::Failed;
+                            result.messages.push_back(fmt::format("{} regressed by {:.1f}% (tolerance {:.1f}%).", name, change * 100.f, options.tolerance * 100.f));
+                        }
+                    }
+
+                    measurementLines.push_back(line);
+                    results.push_back({ name, stats, measurement.repetitionCount });
                 }
+            }
 
-                stream << " (" << std::to_string(result.elapsedMS) << " ms)" << std::endl;
-                for (const auto& m : result.messages) stream << "    "  << m << std::endl;
+            switch (result.status)
+            {
+            case TestResult::Status::Passed: stream << colored("PASSED", TermColor::Green, stream); break;
+            case TestResult::Status::Failed: stream << colored("FAILED", TermColor::Red, stream); break;
+            case TestResult::Status::Skipped: stream << colored("SKIPPED", TermColor::Yellow, stream); break;
+            }
 
-                if (result.status == TestResult::Status::Failed) ++failureCount;
+            stream << " (" << std::to_string(result.elapsedMS) << " ms)" << std::endl;
+            for (const auto& l : measurementLines) stream << "    " << l << std::endl;
+            for (const auto& m : result.messages) stream << "    " << m << std::endl;
+
+            if (result.status == TestResult::Status::Failed) ++failureCount;
+        }
+
+        if (!options.outputPath.empty())
+        {
+            try
+            {
+                writeBenchmarkResults(options.outputPath, options, results);
+                stream << "Benchmark results written to '" << options.outputPath.string() << "'" << std::endl;
+            }
+            catch (const std::exception& e)
+            {
+                stream << colored(e.what(), TermColor::Red, stream) << std::endl;
+                ++failureCount;
             }
         }
 
@@ -194,6 +608,28 @@ namespace Falcor
 
     ///////////////////////////////////////////////////////////////////////////
 
+    void CPUBenchmarkContext::measure(const std::string& name, const std::function<void()>& func)
+    {
+        for (const auto& measurement : mMeasurements)
+        {
+            if (measurement.name == name) throw ErrorRunningTestException("Benchmark measurement '" + name + "' is not unique.");
+        }
+
+        for (uint32_t i = 0; i < mWarmupCount; ++i) func();
+
+        std::vector<float> times(mRepetitionCount);
+        for (uint32_t i = 0; i < mRepetitionCount; ++i)
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            func();
+            times[i] = (float)CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        }
+
+        mMeasurements.push_back({ name, Profiler::Stats::compute(times.data(), times.size()), mRepetitionCount });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+
     void GPUUnitTestContext::createProgram(const std::filesystem::path& path,
                                            const std::string& entry,
                                            const Program::DefineList& programDefines,
@@ -293,6 +729,25 @@ namespace Falcor
         EXPECT_GE(3, 2);
     }
 
+    CPU_TEST(TestRunningTestCount)
+    {
+        // The running tests include this one, otherwise the check in TestCPUTestSerial would pass trivially.
+        EXPECT_GE(runningTestCount.load(), 1u);
+    }
+
+    CPU_TEST_SERIAL(TestCPUTestSerial)
+    {
+        // Watch the number of running tests for a while. Any test running concurrently with this one would be counted.
+        uint32_t maxRunningTestCount = 0;
+        auto endTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        while (std::chrono::steady_clock::now() < endTime)
+        {
+            maxRunningTestCount = std::max(maxRunningTestCount, runningTestCount.load());
+            std::this_thread::yield();
+        }
+        EXPECT_EQ(maxRunningTestCount, 1u);
+    }
+
     CPU_TEST(TestSingleEval)
     {
         // Make sure that arguments to test macros are only evaluated once.
@@ -313,6 +768,16 @@ namespace Falcor
         EXPECT_EQ(i, 7);
     }
 
+    CPU_BENCHMARK(TestCPUBenchmark)
+    {
+        // Make sure that the measured function runs the warmup and timed iterations.
+        uint32_t count = 0;
+        ctx.measure([&count]() { ++count; });
+        EXPECT_EQ(count, ctx.getWarmupCount() + ctx.getRepetitionCount());
+        EXPECT_EQ(ctx.getMeasurements().size(), 1u);
+        EXPECT_EQ(ctx.getMeasurements()[0].repetitionCount, ctx.getRepetitionCount());
+    }
+
     GPU_TEST(TestGPUTest)
     {
         ctx.createProgram("Testing/UnitTest.cs.slang");
@@ -46,6 +46,7 @@ namespace Falcor
 
     class CPUUnitTestContext;
     class GPUUnitTestContext;
+    class CPUBenchmarkContext;
 
     struct TooManyFailedTestsException : public Exception { };
 
@@ -63,10 +64,38 @@ namespace Falcor
 
     using CPUTestFunc = std::function<void(CPUUnitTestContext& ctx)>;
     using GPUTestFunc = std::function<void(GPUUnitTestContext& ctx)>;
+    using CPUBenchmarkFunc = std::function<void(CPUBenchmarkContext& ctx)>;
 
-    FALCOR_API void registerCPUTest(const std::filesystem::path& path, const std::string& name, const std::string& skipMessage, CPUTestFunc func);
+    /** Options for running benchmarks.
+    */
+    struct BenchmarkOptions
+    {
+        uint32_t warmupCount = 3;               ///< Number of untimed iterations before measuring.
+        uint32_t repetitionCount = 10;          ///< Number of timed iterations.
+        std::filesystem::path outputPath;       ///< Write the results to this JSON file (if not empty).
+        std::filesystem::path baselinePath;     ///< Compare the results against this JSON file written by a previous run (if not empty).
+        float tolerance = 0.1f;                 ///< Relative increase of the mean time over the baseline that is reported as a regression.
+    };
+
+    /** Options for running tests.
+    */
+    struct TestRunOptions
+    {
+        uint32_t threadCount = 1;       ///< Number of worker threads running CPU tests concurrently. GPU tests and CPU tests registered with CPU_TEST_SERIAL() always run serially on the calling thread.
+        uint32_t shardIndex = 0;        ///< Index of the shard of tests to run.
+        uint32_t shardCount = 1;        ///< Number of shards the tests are split into, e.g. to distribute them over several processes.
+        uint32_t timeoutSeconds = 0;    ///< Tests running longer than this fail (0 means no timeout). If a CPU test on a worker thread times out, the process exits after all results are reported.
+    };
+
+    FALCOR_API void registerCPUTest(const std::filesystem::path& path, const std::string& name, const std::string& skipMessage, CPUTestFunc func, bool runSerially = false);
     FALCOR_API void registerGPUTest(const std::filesystem::path& path, const std::string& name, const std::string& skipMessage, GPUTestFunc func);
-    FALCOR_API int32_t runTests(std::ostream& stream, RenderContext* pRenderContext, const std::string& testFilterRegexp, uint32_t repeatCount = 1);
+    FALCOR_API void registerCPUBenchmark(const std::filesystem::path& path, const std::string& name, const std::string& skipMessage, CPUBenchmarkFunc func);
+    FALCOR_API int32_t runTests(std::ostream& stream, RenderContext* pRenderContext, const std::string& testFilterRegexp, uint32_t repeatCount = 1, const TestRunOptions& options = {});
+
+    /** Run all registered benchmarks matching a filter.
+        \return Number of failed benchmarks, including benchmarks that regressed compared to the baseline.
+    */
+    FALCOR_API int32_t runBenchmarks(std::ostream& stream, const std::string& benchmarkFilterRegexp, const BenchmarkOptions& options);
 
     class FALCOR_API UnitTestContext
     {
@@ -202,6 +231,47 @@ namespace Falcor
         std::map<std::string, ParameterBuffer> mStructuredBuffers;
     };
 
+    class FALCOR_API CPUBenchmarkContext : public UnitTestContext
+    {
+    public:
+        struct Measurement
+        {
+            std::string name;           ///< Measurement name (empty for the default measurement).
+            Profiler::Stats stats;      ///< Statistics of the iteration times in milliseconds.
+            uint32_t repetitionCount;   ///< Number of timed iterations.
+        };
+
+        CPUBenchmarkContext(uint32_t warmupCount, uint32_t repetitionCount) : mWarmupCount(warmupCount), mRepetitionCount(repetitionCount) { }
+
+        /** measure runs the given function warmupCount times without timing
+            it, followed by repetitionCount timed iterations. Setup code that
+            should not be measured goes outside of the function. A benchmark
+            can take several measurements, in which case they need unique names.
+            \param[in] name Name of the measurement, appended to the benchmark name.
+            \param[in] func Function to measure.
+        */
+        void measure(const std::string& name, const std::function<void()>& func);
+
+        /** Measure the given function. See measure() above.
+        */
+        void measure(const std::function<void()>& func) { measure("", func); }
+
+        const std::vector<Measurement>& getMeasurements() const { return mMeasurements; }
+
+        /** Returns the number of untimed iterations run by measure().
+        */
+        uint32_t getWarmupCount() const { return mWarmupCount; }
+
+        /** Returns the number of timed iterations run by measure().
+        */
+        uint32_t getRepetitionCount() const { return mRepetitionCount; }
+
+    private:
+        uint32_t mWarmupCount;
+        uint32_t mRepetitionCount;
+        std::vector<Measurement> mMeasurements;
+    };
+
     /** StreamSink is a utility class used by the testing framework that either
         captures values printed via C++'s operator<< (as with regular
         std::ostreams) or discards them.  (If a test has failed, then
@@ -356,6 +426,23 @@ namespace Falcor
     } RegisterCPUTest##Name;                                                    \
     static void CPUUnitTest##Name(CPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/** Macro to define a CPU unit test that never runs concurrently with other tests.
+    Use this for tests that touch global state, such as the logger, caches
+    in the app data directory or the render context.
+    The macro works in the same ways as CPU_TEST().
+*/
+#define CPU_TEST_SERIAL(Name, ...)                                              \
+    static void CPUUnitTest##Name(CPUUnitTestContext& ctx);                     \
+    struct CPUUnitTestRegisterer##Name {                                        \
+        CPUUnitTestRegisterer##Name()                                           \
+        {                                                                       \
+            std::filesystem::path path = __FILE__;                              \
+            const char* skipMessage = "" __VA_ARGS__;                           \
+            registerCPUTest(path, #Name, skipMessage, CPUUnitTest##Name, true); \
+        }                                                                       \
+    } RegisterCPUTest##Name;                                                    \
+    static void CPUUnitTest##Name(CPUUnitTestContext& ctx) /* over to the user for the braces */
+
 /** Macro to define a GPU unit test. The optional skip message will
     disable the test from running without leading to a failure.
     The macro works in the same ways as CPU_TEST().
@@ -372,6 +459,25 @@ namespace Falcor
     } RegisterGPUTest##Name;                                                    \
     static void GPUUnitTest##Name(GPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/** Macro to define a CPU benchmark. The optional skip message will
+    disable the benchmark from running without leading to a failure.
+    Benchmarks are not run as part of the unit tests, use runBenchmarks()
+    (FalcorTest --benchmark) to run them. The benchmark function receives a
+    |CPUBenchmarkContext| and times code by calling ctx.measure(). EXPECT
+    macros can be used to validate the benchmarked code.
+*/
+#define CPU_BENCHMARK(Name, ...)                                                \
+    static void CPUBenchmark##Name(CPUBenchmarkContext& ctx);                   \
+    struct CPUBenchmarkRegisterer##Name {                                       \
+        CPUBenchmarkRegisterer##Name()                                          \
+        {                                                                       \
+            std::filesystem::path path = __FILE__;                              \
+            const char* skipMessage = "" __VA_ARGS__;                           \
+            registerCPUBenchmark(path, #Name, skipMessage, CPUBenchmark##Name); \
+        }                                                                       \
+    } RegisterCPUBenchmark##Name;                                               \
+    static void CPUBenchmark##Name(CPUBenchmarkContext& ctx) /* over to the user for the braces */
+
 /** Macro definitions for the GPU unit testing framework. Note that they
     are all a single statement (including any additional << printed
     values).  Thus, it's perfectly fine to write code like:
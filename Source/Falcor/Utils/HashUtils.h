@@ -25,46 +25,39 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
-import SampleTexture;
+#pragma once
+#include <functional>
+#include <cstdint>
 
-RWTexture2D<float4> outputTexture;
-
-SamplerState sampler;
-Texture2D<float4> metallicTexture;
-Texture2D<float4> roughnessTexture;
-
-cbuffer CB {
-    int roughnessChannel;
-    float roughnessValue;
-    int metallicChannel;
-    float metallicValue;
-    uint2 outDim;
-};
-
-[numthreads(16,16,1)]
-void createSpecularTexture(uint3 threadId : SV_DispatchThreadID)
+namespace Falcor
 {
-    if (any(threadId.xy > outDim)) return;
-
-    float metallic;
-    if (metallicChannel < 0)
+    /** Combines a hash value into a running hash.
+        \param[in,out] hash The running hash.
+        \param[in] value The hash value to combine into it.
+    */
+    inline void hashCombine(size_t& hash, size_t value)
     {
-        metallic = metallicValue;
-    }
-    else
-    {
-        metallic = sampleTexture(metallicTexture, sampler, threadId.xy, outDim)[metallicChannel];
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
     }
 
-    float roughness;
-    if (roughnessChannel < 0)
+    /** Combines the hash of a value into a running hash using std::hash.
+        Note that std::hash maps +0 and -0 to the same value, so floats that compare equal hash equally.
+        \param[in,out] hash The running hash.
+        \param[in] value The value to hash.
+    */
+    template<typename T>
+    void hashValue(size_t& hash, const T& value)
     {
-        roughness = roughnessValue;
+        hashCombine(hash, std::hash<T>()(value));
     }
-    else
+
+    /** Combines the hash of each component of a vector into a running hash.
+        \param[in,out] hash The running hash.
+        \param[in] value The vector to hash.
+    */
+    template<glm::length_t N, typename T, glm::qualifier Q>
+    void hashValue(size_t& hash, const glm::vec<N, T, Q>& value)
     {
-        roughness = sampleTexture(roughnessTexture, sampler, threadId.xy, outDim)[roughnessChannel];
+        for (glm::length_t i = 0; i < N; i++) hashValue(hash, value[i]);
     }
-
-    outputTexture[threadId.xy] = float4(0., saturate(roughness), saturate(metallic), 1.);
 }
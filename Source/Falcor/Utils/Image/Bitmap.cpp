@@ -559,6 +559,10 @@ namespace Falcor
                 {
                     flags |= EXR_B44 | EXR_ZIP;
                 }
+                else if (is_set(exportFlags, ExportFlags::ExrZip))
+                {
+                    flags |= EXR_ZIP;
+                }
             }
         }
         else
@@ -590,7 +594,8 @@ namespace Falcor
 
             // Lossless formats
             case FileFormat::PngFile:
-                flags = is_set(exportFlags, ExportFlags::Uncompressed) ? PNG_Z_NO_COMPRESSION : PNG_Z_BEST_COMPRESSION;
+                if (is_set(exportFlags, ExportFlags::Uncompressed)) flags = PNG_Z_NO_COMPRESSION;
+                else flags = is_set(exportFlags, ExportFlags::FastCompression) ? PNG_Z_BEST_SPEED : PNG_Z_BEST_COMPRESSION;
 
                 if (is_set(exportFlags, ExportFlags::Lossy))
                 {
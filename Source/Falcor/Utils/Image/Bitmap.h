@@ -42,6 +42,8 @@ namespace Falcor
             ExportAlpha = 1u << 0,  //< Save alpha channel as well
             Lossy = 1u << 1,        //< Try to store in a lossy format
             Uncompressed = 1u << 2, //< Prefer faster load to a more compact file size
+            ExrZip = 1u << 3,       //< Use lossless ZIP instead of the default lossless PIZ compression for EXR files
+            FastCompression = 1u << 4, //< Prefer faster compression to a more compact file size for PNG files
         };
 
         enum class FileFormat
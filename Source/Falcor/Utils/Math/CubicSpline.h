@@ -33,11 +33,25 @@ namespace Falcor
     class CubicSpline
     {
     public:
+        /** Creates an empty spline. Use build() to initialize it.
+        */
+        CubicSpline() = default;
+
         /** Creates a position-based cubic spline.
             \param[in] controlPoints Array of control points
             \param[in] pointCount Number of control points
         */
         CubicSpline(const T* controlPoints, uint32_t pointCount)
+        {
+            build(controlPoints, pointCount);
+        }
+
+        /** (Re)builds a position-based cubic spline.
+            The coefficient storage is reused, so rebuilding a spline with at most as many control points as before does not allocate memory.
+            \param[in] controlPoints Array of control points
+            \param[in] pointCount Number of control points (at least 2)
+        */
+        void build(const T* controlPoints, uint32_t pointCount)
         {
             // The following code is based on the article from http://graphicsrunner.blogspot.co.uk/2008/05/camera-animation-part-ii.html
             static const T kHalf  = T(0.5f);
@@ -46,44 +60,46 @@ namespace Falcor
             static const T kThree = T(3);
             static const T kFour = T(4);
 
-            // Calculate Gamma
-            std::vector<T> gamma(pointCount);
-            gamma[0] = kHalf;
+            FALCOR_ASSERT(pointCount >= 2);
+            mCoefficient.resize(pointCount);
+
+            // Calculate Gamma =: mCoefficient.a
+            mCoefficient[0].a = kHalf;
             for(uint32_t i = 1; i < pointCount - 1; i++)
             {
-                gamma[i] = kOne / (kFour - gamma[i - 1]);
+                mCoefficient[i].a = kOne / (kFour - mCoefficient[i - 1].a);
             }
-            gamma[pointCount - 1] = kOne / (kTwo - gamma[pointCount - 2]);
+            mCoefficient[pointCount - 1].a = kOne / (kTwo - mCoefficient[pointCount - 2].a);
 
-            // Calculate Delta
-            std::vector<T> delta(pointCount);
-            delta[0] = kThree * (controlPoints[1] - controlPoints[0]) * gamma[0];
+            // Calculate Delta =: mCoefficient.b
+            mCoefficient[0].b = kThree * (controlPoints[1] - controlPoints[0]) * mCoefficient[0].a;
 
             for(uint32_t i = 1; i < pointCount; i++)
             {
                 uint32_t index = (i == (pointCount - 1)) ? i : i + 1;
-                delta[i] = (kThree * (controlPoints[index] - controlPoints[i - 1]) - delta[i - 1]) * gamma[i];
+                mCoefficient[i].b = (kThree * (controlPoints[index] - controlPoints[i - 1]) - mCoefficient[i - 1].b) * mCoefficient[i].a;
             }
 
-            // Calculate D
-            std::vector<T> D(pointCount);
-            D[pointCount - 1] = delta[pointCount - 1];
+            // Calculate D =: mCoefficient.d
+            mCoefficient[pointCount - 1].d = mCoefficient[pointCount - 1].b;
 
             for(int32_t i = int32_t(pointCount - 2); i >= 0; i--)
             {
-                D[i] = delta[i] - gamma[i] * D[i + 1];
+                mCoefficient[i].d = mCoefficient[i].b - mCoefficient[i].a * mCoefficient[i + 1].d;
             }
 
-            // Calculate the coefficients
-            mCoefficient.resize(pointCount - 1);
-
+            // Calculate the coefficients. D[i + 1] is still stored in mCoefficient[i + 1].d when computing section i.
             for(uint32_t i = 0; i < pointCount - 1; i++)
             {
+                const T D0 = mCoefficient[i].d;
+                const T D1 = mCoefficient[i + 1].d;
                 mCoefficient[i].a = controlPoints[i];
-                mCoefficient[i].b = D[i];
-                mCoefficient[i].c = kThree * (controlPoints[i + 1] - controlPoints[i]) - kTwo * D[i] - D[i + 1];
-                mCoefficient[i].d = kTwo * (controlPoints[i] - controlPoints[i + 1]) + D[i] + D[i + 1];
+                mCoefficient[i].b = D0;
+                mCoefficient[i].c = kThree * (controlPoints[i + 1] - controlPoints[i]) - kTwo * D0 - D1;
+                mCoefficient[i].d = kTwo * (controlPoints[i] - controlPoints[i + 1]) + D0 + D1;
             }
+
+            mCoefficient.resize(pointCount - 1);
         }
 
         /** Create a position and time-based cubic spline
@@ -27,6 +27,9 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "AliasTable.h"
+#include "Utils/NumericRange.h"
+#include <emmintrin.h>
+#include <execution>
 
 namespace Falcor
 {
@@ -43,106 +46,203 @@ namespace Falcor
         var["weightSum"] = (float)mWeightSum;
     }
 
-    // This builds an alias table via the O(N) algorithm from Vose 1991, "A linear algorithm for generating random
-    // numbers with a given distribution," IEEE Transactions on Software Engineering 17(9), 972-975.
+    namespace
+    {
+        // Number of items processed per parallel block. The block size is fixed so that the table does not depend on the number of threads.
+        const size_t kBlockSize = 1 << 16;
+
+        template<typename Func>
+        void forEachBlock(size_t count, Func func)
+        {
+            auto range = NumericRange<size_t>(0, (count + kBlockSize - 1) / kBlockSize);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t block)
+            {
+                func(block, block * kBlockSize, std::min(count, (block + 1) * kBlockSize));
+            });
+        }
+
+        struct BlockInfo
+        {
+            size_t lightCount = 0;
+            double deficit = 0.0;   ///< Sum of (average - weight) over light items.
+            double excess = 0.0;    ///< Sum of (weight - average) over heavy items.
+        };
+
+        /** Sum weights in double precision using SSE.
+        */
+        double sumWeights(const float* weights, size_t count)
+        {
+            __m128d sum0 = _mm_setzero_pd();
+            __m128d sum1 = _mm_setzero_pd();
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 w = _mm_loadu_ps(weights + i);
+                sum0 = _mm_add_pd(sum0, _mm_cvtps_pd(w));
+                sum1 = _mm_add_pd(sum1, _mm_cvtps_pd(_mm_movehl_ps(w, w)));
+            }
+            __m128d sum = _mm_add_pd(sum0, sum1);
+            double result = _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+            for (; i < count; ++i) result += weights[i];
+            return result;
+        }
+
+        /** Classify weights into light (below average) and heavy items and sum their deficit and excess using SSE.
+        */
+        BlockInfo classifyWeights(const float* weights, size_t count, double avgWeight)
+        {
+            BlockInfo info;
+            const __m128d avg = _mm_set1_pd(avgWeight);
+            const __m128d zero = _mm_setzero_pd();
+            __m128d deficit = zero;
+            __m128d excess = zero;
+            size_t i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                __m128d d = _mm_sub_pd(avg, _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(weights + i)))));
+                __m128d light = _mm_cmpgt_pd(d, zero);
+                deficit = _mm_add_pd(deficit, _mm_and_pd(light, d));
+                excess = _mm_sub_pd(excess, _mm_andnot_pd(light, d));
+                int mask = _mm_movemask_pd(light);
+                info.lightCount += (mask & 1) + (mask >> 1);
+            }
+            info.deficit = _mm_cvtsd_f64(_mm_add_sd(deficit, _mm_unpackhi_pd(deficit, deficit)));
+            info.excess = _mm_cvtsd_f64(_mm_add_sd(excess, _mm_unpackhi_pd(excess, excess)));
+            for (; i < count; ++i)
+            {
+                double d = avgWeight - weights[i];
+                if (d > 0.0)
+                {
+                    info.lightCount++;
+                    info.deficit += d;
+                }
+                else info.excess -= d;
+            }
+            return info;
+        }
+    }
+
+    // This builds an alias table by a parallel variant of the sweeping algorithm from Hübschle-Schneider and Sanders 2019,
+    // "Parallel Weighted Random Sampling," which builds the same kind of table as the O(N) algorithm from Vose 1991.
     //
-    // Basic idea:  creating each alias table entry combines one overweighted sample and one underweighted sample
-    // into one alias table entry plus a residual sample (the overweighted sample minus some of its weight).
+    // Basic idea:  the items are split into light items (weight below average) and heavy items. Sweeping through
+    // both lists in order, each light item fills its table entry with weight taken from the current heavy item.
+    // Once a heavy item has less than the average weight left, it is itself completed by taking weight from the
+    // next heavy item. Because every item is completed exactly once, the entry of item i can be stored at index i.
     //
-    // By first separating all inputs into 2 temporary buffer (one overweighted set, with weights above the
-    // average; one underweighted set, with weights below average), we can simply walk through the lists once,
-    // merging the first elements in each temporary buffer.  The residual sample is interted into either the
-    // overweighted or underweighted set, depending on its residual weight.
+    // The sweep does not need to run sequentially. With D[i], the sum of the deficits (average - weight) of the
+    // light items before light item i, and E[j], the sum of the excesses (weight - average) of the heavy items before
+    // heavy item j, light item i takes its weight from the first heavy item j with E[j + 1] >= D[i]. Heavy item j
+    // runs out once the lights with D[i] <= E[j + 1] are completed and keeps the weight average + E[j + 1] - D[i*],
+    // with i* the number of those lights. Both are found by merging the prefix sums, which is done in parallel blocks.
     //
-    // The main complexity is dealing with corner cases, thanks to numerical precision issues, where you don't
-    // have 2 valid entries to combine.  By definition, in these corner cases, all remaining unhandled samples
-    // actually have the average weight (within numerical precision limits)
-    AliasTable::AliasTable(std::vector<float> weights, std::mt19937& rng)
-        : mCount((uint32_t)weights.size())
+    // Due to numerical precision, the total deficit and excess may not match exactly. Items that are left over at
+    // the end of the sweep have average weight within numerical precision and are completed with themselves.
+    std::vector<AliasTable::Item> AliasTable::buildItems(const std::vector<float>& weights, double& weightSum)
     {
-        // Use >= since we reserve 0xFFFFFFFFu as an invalid flag marker during construction.
+        // Item indices are stored as 32-bit values.
         if (weights.size() >= std::numeric_limits<uint32_t>::max()) throw RuntimeError("Too many entries for alias table.");
 
-        std::uniform_int_distribution<uint32_t> rngDist;
-
-        mpWeights = Buffer::createStructured(sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data());
+        const size_t blockCount = (weights.size() + kBlockSize - 1) / kBlockSize;
 
-        // Our working set / intermediate buffers (underweight & overweight); initialize to "invalid"
-        std::vector<uint32_t> lowIdx(mCount, 0xFFFFFFFFu);
-        std::vector<uint32_t> highIdx(mCount, 0xFFFFFFFFu);
+        // Sum element weights, use double to minimize precision issues. Blocks are summed in order to get a deterministic result.
+        std::vector<double> blockSums(blockCount);
+        forEachBlock(weights.size(), [&](size_t block, size_t begin, size_t end) { blockSums[block] = sumWeights(weights.data() + begin, end - begin); });
+        weightSum = 0.0;
+        for (double sum : blockSums) weightSum += sum;
 
-        // Sum element weights, use double to minimize precision issues
-        mWeightSum = 0.0;
-        for (float f : weights) mWeightSum += f;
+        // Find the average weight.
+        const double avgWeight = weightSum / double(weights.size());
 
-        // Find the average weight
-        float avgWeight = float(mWeightSum / double(mCount));
+        // Classify items and compute per block offsets into the light and heavy lists.
+        std::vector<BlockInfo> blocks(blockCount);
+        forEachBlock(weights.size(), [&](size_t block, size_t begin, size_t end) { blocks[block] = classifyWeights(weights.data() + begin, end - begin, avgWeight); });
 
-        // Initialize working set. Inset inputs into our lists of above-average or below-average weight elements.
-        int lowCount = 0;
-        int highCount = 0;
-        for (uint32_t i = 0; i < mCount; ++i)
+        std::vector<BlockInfo> blockOffsets(blockCount);
+        BlockInfo total;
+        for (size_t block = 0; block < blockCount; ++block)
         {
-            if (weights[i] < avgWeight)
-                lowIdx[lowCount++] = i;
-            else
-                highIdx[highCount++] = i;
+            blockOffsets[block] = total;
+            total.lightCount += blocks[block].lightCount;
+            total.deficit += blocks[block].deficit;
+            total.excess += blocks[block].excess;
         }
 
-        // Create alias table entries by merging above- and below-average samples
-        std::vector<AliasTable::Item> items(mCount);
-        for (uint32_t i = 0; i < mCount; ++i)
+        const size_t lightCount = total.lightCount;
+        const size_t heavyCount = weights.size() - lightCount;
+
+        // Build the light and heavy lists in item order along with the prefix sums of their deficits and excesses.
+        std::vector<uint32_t> lightIdx(lightCount);
+        std::vector<uint32_t> heavyIdx(heavyCount);
+        std::vector<double> deficitSum(lightCount + 1);
+        std::vector<double> excessSum(heavyCount + 1);
+        deficitSum[lightCount] = total.deficit;
+        excessSum[heavyCount] = total.excess;
+
+        forEachBlock(weights.size(), [&](size_t block, size_t begin, size_t end)
         {
-            // Usual case:  We have an above-average and below-average sample we can combine into one alias table entry
-            if ((lowIdx[i] != 0xFFFFFFFFu) && (highIdx[i] != 0xFFFFFFFFu))
+            const BlockInfo& offset = blockOffsets[block];
+            size_t light = offset.lightCount;
+            size_t heavy = begin - offset.lightCount;
+            double deficit = offset.deficit;
+            double excess = offset.excess;
+            for (size_t i = begin; i < end; ++i)
             {
-                // Create an alias table tuple:
-                items[i] = { weights[lowIdx[i]] / avgWeight, highIdx[i], lowIdx[i], 0 };
-
-                // We've removed some weight from element highIdx[i]; update it's weight, then re-enter it
-                // on the end of either the above-average or below-average lists.
-                float updatedWeight = (weights[lowIdx[i]] + weights[highIdx[i]]) - avgWeight;
-                weights[highIdx[i]] = updatedWeight;
-                if (updatedWeight < avgWeight)
-                    lowIdx[lowCount++] = highIdx[i];
+                double d = avgWeight - weights[i];
+                if (d > 0.0)
+                {
+                    lightIdx[light] = (uint32_t)i;
+                    deficitSum[light++] = deficit;
+                    deficit += d;
+                }
                 else
-                    highIdx[highCount++] = highIdx[i];
+                {
+                    heavyIdx[heavy] = (uint32_t)i;
+                    excessSum[heavy++] = excess;
+                    excess -= d;
+                }
             }
+        });
 
-            // The next two cases can only occur towards the end of table creation, because either:
-            //    (a) all the remaining possible alias table entries have weight *exactly* equal to avgWeight,
-            //        which means these alias table entries only have one input item that is selected
-            //        with 100% probability
-            //    (b) all the remaining alias table entires have *almost* avgWeight, but due to (compounding)
-            //        precision issues throughout the process, they don't have *quite* that value.  In this case
-            //        treating these entries as having exactly avgWeight (as in case (a)) is the only right
-            //        thing to do mathematically (other than re-generating the alias table using higher precision
-            //        or trying to reduce catasrophic numerical cancellation in the "updatedWeight" computation above).
-            else if (highIdx[i] != 0xFFFFFFFFu)
-            {
-                items[i] = { 1.0f, highIdx[i], highIdx[i], 0 };
-            }
-            else if (lowIdx[i] != 0xFFFFFFFFu)
+        std::vector<AliasTable::Item> items(weights.size());
+
+        // Complete light items. Each block searches its first heavy item and then merges the prefix sums.
+        forEachBlock(lightCount, [&](size_t block, size_t begin, size_t end)
+        {
+            size_t j = std::lower_bound(excessSum.begin() + 1, excessSum.end(), deficitSum[begin]) - (excessSum.begin() + 1);
+            for (size_t i = begin; i < end; ++i)
             {
-                items[i] = { 1.0f, lowIdx[i], lowIdx[i], 0 };
+                while (j < heavyCount && excessSum[j + 1] < deficitSum[i]) ++j;
+                uint32_t index = lightIdx[i];
+                if (j < heavyCount) items[index] = { (float)(weights[index] / avgWeight), heavyIdx[j], index, 0 };
+                else items[index] = { 1.0f, index, index, 0 };
             }
+        });
 
-            // If there is neither a highIdx[i] or lowIdx[i] for some array element(s).  By construction,
-            // this cannot occur (without some logic bug above).
-            else
+        // Complete heavy items. The last heavy item and heavy items that are not used up keep all of their own weight.
+        forEachBlock(heavyCount, [&](size_t block, size_t begin, size_t end)
+        {
+            size_t i = std::upper_bound(deficitSum.begin(), deficitSum.end() - 1, excessSum[begin + 1]) - deficitSum.begin();
+            for (size_t j = begin; j < end; ++j)
             {
-                FALCOR_ASSERT(false); // Should not occur
+                while (i < lightCount && deficitSum[i] <= excessSum[j + 1]) ++i;
+                uint32_t index = heavyIdx[j];
+                double residual = avgWeight + excessSum[j + 1] - deficitSum[i];
+                if (j + 1 < heavyCount && residual < avgWeight) items[index] = { (float)(std::max(residual, 0.0) / avgWeight), heavyIdx[j + 1], index, 0 };
+                else items[index] = { 1.0f, index, index, 0 };
             }
-        }
+        });
 
-        // TODO: We can simplify the alias table to implicitly store indexB (aka lowIdx[i]), so the AliasTable::Item
-        // structure would be 1 float + 1 uint32_t, rather than 128 bits.  This, of course, would change usage in shaders
-        // and elsewhere.  To do this, here you'd need to sort elements by indexB so that when looking up mpItems[j],
-        // indexB==j.  This works since, by construction, only one element in the table has indexB==j (for any j
-        // in [0...mCount-1]).  Alternatively, during the loop above, you could directly enter elements into the
-        // correct location in the alias table.
+        return items;
+    }
 
-        // Stash the alias table in our GPU buffer
+    AliasTable::AliasTable(std::vector<float> weights, std::mt19937& rng)
+        : mCount((uint32_t)weights.size())
+    {
+        std::vector<Item> items = buildItems(weights, mWeightSum);
+
+        // Stash the alias table in our GPU buffers
+        mpWeights = Buffer::createStructured(sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data());
         mpItems = Buffer::createStructured(sizeof(AliasTable::Item), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, items.data());
     }
 }
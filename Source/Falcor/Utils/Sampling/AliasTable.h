@@ -45,6 +45,23 @@ namespace Falcor
         */
         static SharedPtr create(std::vector<float> weights, std::mt19937& rng);
 
+        // Item structure for the mpItems buffer.
+        struct Item
+        {
+            float threshold;                ///< If rand() < threshold, pick indexB (else pick indexA)
+            uint32_t indexA;                ///< The "redirect" index, if uniform sampling would overweight indexB.
+            uint32_t indexB;                ///< The original index, sampled uniformly in [0...mCount-1]. Equal to the index of the item in the table.
+            uint32_t _pad;
+        };
+
+        /** Build the alias table items on the CPU.
+            This is the part of create() that runs before the GPU buffers are created.
+            \param[in] weights The weights we'd like to sample each entry proportional to.
+            \param[out] weightSum The total sum of all weights.
+            \returns The table items, the item of entry i is stored at index i.
+        */
+        static std::vector<Item> buildItems(const std::vector<float>& weights, double& weightSum);
+
         /** Bind the alias table data to a given shader var.
             \param[in] var The shader variable to set the data into.
         */
@@ -61,15 +78,6 @@ namespace Falcor
     private:
         AliasTable(std::vector<float> weights, std::mt19937& rng);
 
-        // Item structure for the mpItems buffer.
-        struct Item
-        {
-            float threshold;                ///< If rand() < threshold, pick indexB (else pick indexA)
-            uint32_t indexA;                ///< The "redirect" index, if uniform sampling would overweight indexB.
-            uint32_t indexB;                ///< The original / permutation index, sampled uniformly in [0...mCount-1]
-            uint32_t _pad;
-        };
-
         uint32_t mCount;                    ///< Number of items in the alias table.
         double mWeightSum;                  ///< Total weight of all elements used to create the alias table.
         Buffer::SharedPtr mpItems;          ///< Buffer containing table items.
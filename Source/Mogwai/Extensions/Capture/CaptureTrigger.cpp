@@ -133,6 +133,22 @@ namespace Mogwai
         }
     }
 
+    void CaptureTrigger::batchGraphExecuted(RenderContext* pRenderContext, RenderGraph* pGraph, RenderGraph* pInstance, const std::string& variant)
+    {
+        auto it = mGraphRanges.find(pGraph);
+        if (it == mGraphRanges.end()) return;
+        uint64_t frameId = gpFramework->getGlobalClock().getFrame();
+
+        for (const auto& r : it->second)
+        {
+            if (frameId >= r.first && frameId < r.first + r.second)
+            {
+                triggerBatchFrame(pRenderContext, pInstance, variant, frameId);
+                return;
+            }
+        }
+    }
+
     void CaptureTrigger::activeGraphChanged(RenderGraph* pNewGraph, RenderGraph* pPrevGraph)
     {
         if (mCurrent.pGraph)
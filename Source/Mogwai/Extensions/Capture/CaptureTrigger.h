@@ -42,6 +42,7 @@ namespace Mogwai
         virtual void toggleWindow() override { mShowUI = !mShowUI; }
         virtual void registerScriptBindings(pybind11::module& m) override;
         virtual void activeGraphChanged(RenderGraph* pNewGraph, RenderGraph* pPrevGraph) override;
+        virtual void batchGraphExecuted(RenderContext* pRenderContext, RenderGraph* pGraph, RenderGraph* pInstance, const std::string& variant) override final;
     protected:
         CaptureTrigger(Renderer* pRenderer, const std::string& name) : Extension(pRenderer, name) {}
 
@@ -51,6 +52,12 @@ namespace Mogwai
         virtual void triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID) {};
         virtual void endRange(RenderGraph* pGraph, const Range& r) {};
 
+        /** Called in batch mode after a graph was executed, if the current frame is in one of the graph's ranges.
+            \param[in] pGraph The graph instance that was executed. With multiple cameras, this is a copy of the graph the ranges were added for.
+            \param[in] variant Name of the graph variant that was rendered. This is the graph name, followed by the camera name if the batch renders multiple cameras.
+        */
+        virtual void triggerBatchFrame(RenderContext* pCtx, RenderGraph* pGraph, const std::string& variant, uint64_t frameID) {};
+
         void addRange(const RenderGraph* pGraph, uint64_t startFrame, uint64_t count);
         void reset(const RenderGraph* pGraph = nullptr);
         void renderUI(Gui::Window& w);
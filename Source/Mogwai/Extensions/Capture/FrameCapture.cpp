@@ -40,6 +40,21 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kExrCompression = "exrCompression";
+        const std::string kFastCompression = "fastCompression";
+        const std::string kThreadCount = "threadCount";
+
+        const uint32_t kMaxThreadCount = 32;
+        const size_t kMaxPendingBytes = size_t(1) << 30;    // Texel data of pending images before the render thread blocks.
+        const size_t kMaxRetiredReadbacks = 16;
+
+        const Gui::DropdownList kExrCompressionList =
+        {
+            { (uint32_t)FrameCapture::ExrCompression::Uncompressed, "Uncompressed" },
+            { (uint32_t)FrameCapture::ExrCompression::Zip, "ZIP" },
+            { (uint32_t)FrameCapture::ExrCompression::Piz, "PIZ" },
+        };
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -62,6 +77,20 @@ namespace Mogwai
         : CaptureTrigger(pRenderer, "Frame Capture")
     {
         mpImageProcessing = ImageProcessing::create();
+        mThreadCount = std::clamp(Threading::getLogicalThreadCount() / 2, 1u, 8u);
+        runWorkers(mThreadCount);
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        terminateWorkers();
+    }
+
+    void FrameCapture::shutdown()
+    {
+        // Write all pending images while the device is still alive.
+        terminateWorkers();
+        mRetiredReadbacks.clear();
     }
 
     void FrameCapture::renderUI(Gui* pGui)
@@ -75,6 +104,22 @@ namespace Mogwai
             w.checkbox("Capture All Outputs", mCaptureAllOutputs);
             w.tooltip("Capture all available outputs instead of the marked ones only.");
 
+            w.dropdown("EXR Compression", kExrCompressionList, reinterpret_cast<uint32_t&>(mExrCompression));
+            w.tooltip("Lossless compression used for EXR images. Uncompressed images are stored with 32-bit float channels.");
+            w.checkbox("Fast Compression", mFastCompression);
+            w.tooltip("Use faster compression at the cost of larger files for PNG images.");
+
+            uint32_t threadCount = mThreadCount;
+            if (w.var("Writer Threads", threadCount, 1u, kMaxThreadCount)) setThreadCount(threadCount);
+            w.tooltip("Number of threads writing images. Captured frames are read back asynchronously and written by these threads while rendering continues.");
+
+            size_t pendingCount;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                pendingCount = mPendingCount;
+            }
+            w.text("Pending images: " + std::to_string(pendingCount));
+
             if (w.button("Capture Current Frame")) capture();
         }
     }
@@ -92,6 +137,7 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -104,6 +150,21 @@ namespace Mogwai
         auto getUI = [](FrameCapture* pFC) { return pFC->mShowUI; };
         auto setUI = [](FrameCapture* pFC, bool show) { pFC->mShowUI = show; };
         frameCapture.def_property(kUI.c_str(), getUI, setUI);
+
+        pybind11::enum_<ExrCompression> exrCompression(m, "ExrCompression");
+        exrCompression.value("Uncompressed", ExrCompression::Uncompressed);
+        exrCompression.value("Zip", ExrCompression::Zip);
+        exrCompression.value("Piz", ExrCompression::Piz);
+
+        auto getExrCompression = [](FrameCapture* pFC) { return pFC->mExrCompression; };
+        auto setExrCompression = [](FrameCapture* pFC, ExrCompression c) { pFC->mExrCompression = c; };
+        frameCapture.def_property(kExrCompression.c_str(), getExrCompression, setExrCompression);
+
+        auto getFastCompression = [](FrameCapture* pFC) { return pFC->mFastCompression; };
+        auto setFastCompression = [](FrameCapture* pFC, bool fast) { pFC->mFastCompression = fast; };
+        frameCapture.def_property(kFastCompression.c_str(), getFastCompression, setFastCompression);
+
+        frameCapture.def_property(kThreadCount.c_str(), &FrameCapture::getThreadCount, &FrameCapture::setThreadCount);
     }
 
     std::string FrameCapture::getScriptVar() const
@@ -117,6 +178,8 @@ namespace Mogwai
 
         s += "# Frame Capture\n";
         s += CaptureTrigger::getScript(var);
+        if (mExrCompression != ExrCompression::Piz) s += ScriptWriter::makeSetProperty(var, kExrCompression, mExrCompression);
+        if (mFastCompression) s += ScriptWriter::makeSetProperty(var, kFastCompression, mFastCompression);
 
         for (const auto& g : mGraphRanges)
         {
@@ -126,6 +189,18 @@ namespace Mogwai
     }
 
     void FrameCapture::triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID)
+    {
+        // In batch mode the graphs are captured after they executed, see triggerBatchFrame().
+        if (mpRenderer->isBatchActive()) return;
+        captureGraph(pRenderContext, pGraph, "");
+    }
+
+    void FrameCapture::triggerBatchFrame(RenderContext* pRenderContext, RenderGraph* pGraph, const std::string& variant, uint64_t frameID)
+    {
+        captureGraph(pRenderContext, pGraph, variant);
+    }
+
+    void FrameCapture::captureGraph(RenderContext* pRenderContext, RenderGraph* pGraph, const std::string& variant)
     {
         std::vector<std::string> unmarkedOutputs;
 
@@ -139,7 +214,7 @@ namespace Mogwai
 
         for (uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
-            captureOutput(pRenderContext, pGraph, i);
+            captureOutput(pRenderContext, pGraph, i, variant);
         }
 
         if (mCaptureAllOutputs && !unmarkedOutputs.empty())
@@ -149,10 +224,12 @@ namespace Mogwai
         }
     }
 
-    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex)
+    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, const std::string& variant)
     {
+        // Batch captures are prefixed with the variant name, e.g., 'Mogwai.<graph>.<camera>.<output>.<frame>'.
         const std::string outputName = pGraph->getOutputName(outputIndex);
-        const std::string basename = getOutputNamePrefix(outputName) + std::to_string(gpFramework->getGlobalClock().getFrame());
+        const std::string prefixedName = variant.empty() ? outputName : variant + "." + outputName;
+        const std::string basename = getOutputNamePrefix(prefixedName) + std::to_string(gpFramework->getGlobalClock().getFrame());
 
         const Texture::SharedPtr pOutput = pGraph->getOutput(outputIndex)->asTexture();
         if (!pOutput) throw RuntimeError("Graph output {} is not a texture", outputName);
@@ -240,9 +317,138 @@ namespace Mogwai
             std::string filename = basename + suffix + "." + ext;
             Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
             if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
+            if (fileformat == Bitmap::FileFormat::ExrFile)
+            {
+                if (mExrCompression == ExrCompression::Uncompressed) flags |= Bitmap::ExportFlags::Uncompressed;
+                else if (mExrCompression == ExrCompression::Zip) flags |= Bitmap::ExportFlags::ExrZip;
+            }
+            if (mFastCompression) flags |= Bitmap::ExportFlags::FastCompression;
+
+            queueImage(pRenderContext, pTex, filename, fileformat, flags);
+        }
+    }
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+    void FrameCapture::queueImage(RenderContext* pRenderContext, const Texture::SharedPtr& pTexture, const std::string& filename, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags)
+    {
+        if (pTexture->getType() != Texture::Type::Texture2D) throw RuntimeError("Can't capture '{}'. Only 2D textures are supported.", filename);
+
+        // Floating-point textures with less than 3 channels are expanded to RGBA32Float, matching Texture::captureToFile().
+        Texture::SharedPtr pTex = pTexture;
+        if (getFormatType(pTex->getFormat()) == FormatType::Float && getFormatChannelCount(pTex->getFormat()) < 3)
+        {
+            pTex = Texture::create2D(pTexture->getWidth(), pTexture->getHeight(), ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource);
+            pRenderContext->blit(pTexture->getSRV(0, 1, 0, 1), pTex->getRTV(0, 0, 1));
         }
+
+        const size_t size = (size_t)pTex->getWidth() * pTex->getHeight() * getFormatBytesPerBlock(pTex->getFormat());
+
+        // Wait until the pending images fit the memory budget and take a retired readback to recycle its buffer.
+        // Readbacks beyond the retired limit are released here so GPU resources are only released on the render thread.
+        CopyContext::ReadTextureTask::SharedPtr pRecycle;
+        std::vector<CopyContext::ReadTextureTask::SharedPtr> released;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWrittenCondition.wait(lock, [&]() { return mPendingCount == 0 || mPendingBytes + size <= kMaxPendingBytes; });
+
+            auto it = std::find_if(mRetiredReadbacks.begin(), mRetiredReadbacks.end(), [size](const auto& pReadback) { return pReadback->getDataSize() >= size; });
+            if (it == mRetiredReadbacks.end() && !mRetiredReadbacks.empty()) it = std::prev(mRetiredReadbacks.end());
+            if (it != mRetiredReadbacks.end())
+            {
+                pRecycle = std::move(*it);
+                mRetiredReadbacks.erase(it);
+            }
+            if (mRetiredReadbacks.size() > kMaxRetiredReadbacks)
+            {
+                released.assign(std::make_move_iterator(mRetiredReadbacks.begin() + kMaxRetiredReadbacks), std::make_move_iterator(mRetiredReadbacks.end()));
+                mRetiredReadbacks.resize(kMaxRetiredReadbacks);
+            }
+
+            mPendingCount++;
+            mPendingBytes += size;
+        }
+
+        // Record the copy without waiting for the GPU. A worker thread waits for the copy and writes the image.
+        auto pReadback = pRenderContext->asyncReadTextureSubresource(pTex.get(), 0, pRecycle);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mWriteQueue.push_back({ filename, fileFormat, exportFlags, pTex->getFormat(), pTex->getWidth(), pTex->getHeight(), size, std::move(pReadback) });
+        }
+        mCondition.notify_one();
+    }
+
+    void FrameCapture::flush()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWrittenCondition.wait(lock, [this]() { return mPendingCount == 0; });
+    }
+
+    void FrameCapture::setThreadCount(uint32_t threadCount)
+    {
+        threadCount = std::clamp(threadCount, 1u, kMaxThreadCount);
+        if (threadCount == mThreadCount) return;
+        terminateWorkers();
+        mThreadCount = threadCount;
+        runWorkers(mThreadCount);
+    }
+
+    void FrameCapture::runWorkers(uint32_t threadCount)
+    {
+        FALCOR_ASSERT(mThreads.empty());
+        mTerminate = false;
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            mThreads.emplace_back(&FrameCapture::runWorker, this);
+        }
+    }
+
+    void FrameCapture::runWorker()
+    {
+        std::vector<uint8_t> data;
+
+        while (true)
+        {
+            WriteRequest request;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this]() { return mTerminate || !mWriteQueue.empty(); });
+                // Queued images are written before terminating.
+                if (mWriteQueue.empty()) break;
+                request = std::move(mWriteQueue.front());
+                mWriteQueue.pop_front();
+            }
+
+            try
+            {
+                data.resize(request.pReadback->getDataSize());
+                request.pReadback->getData(data.data());
+                Bitmap::saveImage(request.filename, request.width, request.height, request.fileFormat, request.exportFlags, request.resourceFormat, true, data.data());
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to write captured image '{}': {}", request.filename, e.what());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mRetiredReadbacks.push_back(std::move(request.pReadback));
+                mPendingCount--;
+                mPendingBytes -= request.size;
+            }
+            mWrittenCondition.notify_all();
+        }
+    }
+
+    void FrameCapture::terminateWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mCondition.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+        mThreads.clear();
+        FALCOR_ASSERT(mPendingCount == 0);
     }
 
     void FrameCapture::addFrames(const RenderGraph* pGraph, const uint64_vec& frames)
@@ -269,7 +475,6 @@ namespace Mogwai
     {
         auto pGraph = mpRenderer->getActiveGraph();
         if (!pGraph) return;
-        uint64_t frameID = gpFramework->getGlobalClock().getFrame();
-        triggerFrame(gpDevice->getRenderContext(), pGraph, frameID);
+        captureGraph(gpDevice->getRenderContext(), pGraph, "");
     }
 }
@@ -28,20 +28,45 @@
 #pragma once
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace Mogwai
 {
     class FrameCapture : public CaptureTrigger
     {
     public:
+        /** Lossless compression used for EXR images.
+        */
+        enum class ExrCompression
+        {
+            Uncompressed,   ///< No compression, stores 32-bit float channels.
+            Zip,            ///< ZIP compression.
+            Piz,            ///< PIZ wavelet compression (default).
+        };
+
         static UniquePtr create(Renderer* pRenderer);
+        virtual ~FrameCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void registerScriptBindings(pybind11::module& m) override;
         virtual std::string getScriptVar() const override;
         virtual std::string getScript(const std::string& var) const override;
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
+        virtual void triggerBatchFrame(RenderContext* pRenderContext, RenderGraph* pGraph, const std::string& variant, uint64_t frameID) override;
+        virtual void shutdown() override;
         void capture();
 
+        /** Block until all captured images are written to disk.
+        */
+        void flush();
+
+        /** Set the number of threads writing images. Pending images are written before the threads are restarted.
+        */
+        void setThreadCount(uint32_t threadCount);
+        uint32_t getThreadCount() const { return mThreadCount; }
+
     private:
         FrameCapture(Renderer* pRenderer);
 
@@ -49,9 +74,46 @@ namespace Mogwai
         void addFrames(const RenderGraph* pGraph, const uint64_vec& frames);
         void addFrames(const std::string& graphName, const uint64_vec& frames);
         std::string graphFramesStr(const RenderGraph* pGraph);
-        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
+        void captureGraph(RenderContext* pRenderContext, RenderGraph* pGraph, const std::string& variant);
+        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, const std::string& variant);
+
+        /** Record a readback of a texture and queue it to be written to an image file by the worker threads.
+            Blocks if the pending images exceed the memory budget.
+        */
+        void queueImage(RenderContext* pRenderContext, const Texture::SharedPtr& pTexture, const std::string& filename, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags);
+
+        void runWorkers(uint32_t threadCount);
+        void runWorker();
+        void terminateWorkers();
+
+        struct WriteRequest
+        {
+            std::string filename;
+            Bitmap::FileFormat fileFormat;
+            Bitmap::ExportFlags exportFlags;
+            ResourceFormat resourceFormat;
+            uint32_t width;
+            uint32_t height;
+            size_t size;
+            CopyContext::ReadTextureTask::SharedPtr pReadback;
+        };
 
         bool mCaptureAllOutputs = false;
+        ExrCompression mExrCompression = ExrCompression::Piz;
+        bool mFastCompression = false;
+        uint32_t mThreadCount;
         ImageProcessing::SharedPtr mpImageProcessing;
+
+        std::mutex mMutex;                          ///< Mutex for synchronizing access to shared resources.
+        std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
+        std::condition_variable mWrittenCondition;  ///< Condition variable signaled when an image was written.
+        std::vector<std::thread> mThreads;          ///< Worker threads.
+
+        // Internal state. Do not access outside of critical section.
+        std::deque<WriteRequest> mWriteQueue;       ///< Images waiting to be written.
+        size_t mPendingCount = 0;                   ///< Number of queued or in-progress images.
+        size_t mPendingBytes = 0;                   ///< Size of the texel data of queued or in-progress images.
+        std::vector<CopyContext::ReadTextureTask::SharedPtr> mRetiredReadbacks; ///< Written readbacks whose buffers are reused. Only released on the render thread.
+        bool mTerminate = false;                    ///< Flag to terminate worker threads.
     };
 }
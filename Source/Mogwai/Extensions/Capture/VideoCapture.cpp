@@ -43,6 +43,10 @@ namespace Mogwai
         const std::string kPrint = "print";
         const std::string kOutputs = "outputs";
 
+        // Maximum number of frames per output that are read back or queued for encoding.
+        // The render thread only blocks if the encoder falls further behind than this.
+        const size_t kMaxPendingFramesPerOutput = 3;
+
         Texture::SharedPtr createTextureForBlit(const Texture* pSource)
         {
             FALCOR_ASSERT(pSource->getType() == Texture::Type::Texture2D);
@@ -62,6 +66,11 @@ namespace Mogwai
         return UniquePtr(new VideoCapture(pRenderer));
     }
 
+    VideoCapture::~VideoCapture()
+    {
+        terminateEncoderThread();
+    }
+
     void VideoCapture::renderUI(Gui* pGui)
     {
         if (mShowUI)
@@ -109,17 +118,23 @@ namespace Mogwai
             encoder.pEncoder = VideoEncoder::create(d);
             mEncoders.push_back(std::move(encoder));
         }
+
+        if (!mEncoders.empty()) runEncoderThread();
     }
 
     void VideoCapture::endRange(RenderGraph* pGraph, const Range& r)
     {
+        // Encode all pending frames before finalizing the videos.
+        terminateEncoderThread();
         for (const auto& e : mEncoders) e.pEncoder->endCapture();
+        mEncoders.clear();
     }
 
     void VideoCapture::triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID)
     {
-        for (const auto& e : mEncoders)
+        for (size_t i = 0; i < mEncoders.size(); i++)
         {
+            auto& e = mEncoders[i];
             Texture::SharedPtr pTex = std::dynamic_pointer_cast<Texture>(pGraph->getOutput(e.output));
             if (e.pBlitTex)
             {
@@ -127,8 +142,83 @@ namespace Mogwai
                 pTex = e.pBlitTex;
             }
 
-            e.pEncoder->appendFrame(pCtx->readTextureSubresource(pTex.get(), 0).data());
+            // Take a retired readback to recycle its buffer. Wait for the encoder thread if it fell too far behind.
+            CopyContext::ReadTextureTask::SharedPtr pRecycle;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mRetireCondition.wait(lock, [&]() { return mPendingFrames.size() < kMaxPendingFramesPerOutput * mEncoders.size(); });
+                if (!e.retiredReadbacks.empty())
+                {
+                    pRecycle = std::move(e.retiredReadbacks.back());
+                    e.retiredReadbacks.pop_back();
+                }
+            }
+
+            // Record the copy without waiting for the GPU. The encoder thread picks up the data once the copy finished.
+            auto pReadback = pCtx->asyncReadTextureSubresource(pTex.get(), 0, pRecycle);
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mPendingFrames.push_back({ i, std::move(pReadback) });
+            }
+            mCondition.notify_one();
+        }
+    }
+
+    void VideoCapture::shutdown()
+    {
+        // Finalize an active capture while the device is still alive.
+        if (mCurrent.pGraph)
+        {
+            endRange(mCurrent.pGraph, mCurrent.range);
+            mCurrent = {};
+        }
+    }
+
+    void VideoCapture::runEncoderThread()
+    {
+        FALCOR_ASSERT(!mEncoderThread.joinable());
+        mTerminate = false;
+        mEncoderThread = std::thread(&VideoCapture::runEncoder, this);
+    }
+
+    void VideoCapture::runEncoder()
+    {
+        while (true)
+        {
+            PendingFrame frame;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this]() { return mTerminate || !mPendingFrames.empty(); });
+                // Pending frames are drained before terminating.
+                if (mPendingFrames.empty()) break;
+                frame = std::move(mPendingFrames.front());
+                mPendingFrames.pop_front();
+            }
+
+            auto& e = mEncoders[frame.encoderIndex];
+            e.frameData.resize(frame.pReadback->getDataSize());
+            frame.pReadback->getData(e.frameData.data());
+            e.pEncoder->appendFrame(e.frameData.data());
+
+            // Hand the readback back to the render thread. GPU resources are only released on the render thread.
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                e.retiredReadbacks.push_back(std::move(frame.pReadback));
+            }
+            mRetireCondition.notify_one();
+        }
+    }
+
+    void VideoCapture::terminateEncoderThread()
+    {
+        if (!mEncoderThread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
         }
+        mCondition.notify_one();
+        mEncoderThread.join();
+        FALCOR_ASSERT(mPendingFrames.empty());
     }
 
     void VideoCapture::registerScriptBindings(pybind11::module& m)
@@ -30,6 +30,10 @@
 #include "CaptureTrigger.h"
 #include "Utils/Video/VideoEncoderUI.h"
 #include "Utils/Video/VideoEncoder.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace Mogwai
 {
@@ -37,6 +41,7 @@ namespace Mogwai
     {
     public:
         static UniquePtr create(Renderer* pRenderer);
+        virtual ~VideoCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void beginRange(RenderGraph* pGraph, const Range& r) override;
         virtual void endRange(RenderGraph* pGraph, const Range& r) override;
@@ -44,6 +49,7 @@ namespace Mogwai
         virtual std::string getScriptVar() const override;
         virtual std::string getScript(const std::string& var) const override;
         virtual void triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID) override;
+        virtual void shutdown() override;
 
     private:
         VideoCapture(Renderer* pRenderer);
@@ -52,6 +58,13 @@ namespace Mogwai
         void addRanges(const std::string& graphName, const range_vec& ranges);
         std::string graphRangesStr(const RenderGraph* pGraph);
 
+        /** Frames are read back asynchronously. The render thread only records a copy into a recycled readback buffer,
+            the encoder thread waits for the copy to finish and runs the encoder. This keeps GPU sync and encoding off the render thread.
+        */
+        void runEncoderThread();
+        void runEncoder();
+        void terminateEncoderThread();
+
         VideoEncoderUI::UniquePtr mpEncoderUI;
 
         struct EncodeData
@@ -59,7 +72,24 @@ namespace Mogwai
             std::string output;
             VideoEncoder::UniquePtr pEncoder;
             Texture::SharedPtr pBlitTex;
+            std::vector<uint8_t> frameData;                                         ///< Packed frame data. Only accessed by the encoder thread.
+            std::vector<CopyContext::ReadTextureTask::SharedPtr> retiredReadbacks;  ///< Encoded readbacks whose buffers are reused. Do not access outside of critical section.
         };
         std::vector<EncodeData> mEncoders;
+
+        struct PendingFrame
+        {
+            size_t encoderIndex;
+            CopyContext::ReadTextureTask::SharedPtr pReadback;
+        };
+
+        std::mutex mMutex;                          ///< Mutex for synchronizing access to shared resources.
+        std::condition_variable mCondition;         ///< Condition variable for the encoder thread to wait on.
+        std::condition_variable mRetireCondition;   ///< Condition variable for the render thread to wait on when too many frames are pending.
+        std::thread mEncoderThread;                 ///< Encoder thread.
+
+        // Internal state. Do not access outside of critical section.
+        std::deque<PendingFrame> mPendingFrames;    ///< Frames waiting for readback and encoding, in submission order.
+        bool mTerminate = false;                    ///< Flag to terminate the encoder thread.
     };
 }
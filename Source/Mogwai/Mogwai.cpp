@@ -48,6 +48,22 @@ namespace Mogwai
         const std::string kGraphNameSwitch = "--graph-name";
 
         const std::filesystem::path kAppDataPath = getAppDataDirectory() / "NVIDIA/Falcor/Mogwai.json";
+
+        const std::string kBatchGraphVar = "_batchGraph";
+
+        /** Create a copy of a graph with its own passes and resources, by running the script representation of the graph.
+        */
+        RenderGraph::SharedPtr copyGraph(const RenderGraph::SharedPtr& pGraph, const std::string& name)
+        {
+            std::string script = RenderGraphExporter::getIR(pGraph);
+            script += kBatchGraphVar + " = " + RenderGraphExporter::getFuncName(pGraph->getName()) + "()\n";
+            Scripting::runScript(script);
+
+            auto pCopy = Scripting::getDefaultContext().getObject<RenderGraph::SharedPtr>(kBatchGraphVar);
+            if (!pCopy) throw RuntimeError("Failed to create a copy of graph '{}'.", pGraph->getName());
+            pCopy->setName(name);
+            return pCopy;
+        }
     }
 
     size_t Renderer::DebugWindow::index = 0;
@@ -71,6 +87,7 @@ namespace Mogwai
 
     void Renderer::onShutdown()
     {
+        for (auto& e : mpExtensions) e->shutdown();
         resetEditor();
         gpDevice->flushAndSync(); // Need to do that because clearing the graphs will try to release some state objects which might be in use
         mGraphs.clear();
@@ -333,6 +350,16 @@ namespace Mogwai
     void Renderer::removeGraph(const RenderGraph::SharedPtr& pGraph)
     {
         for (auto& e : mpExtensions) e->removeGraph(pGraph.get());
+        if (isBatchGraph(pGraph.get()))
+        {
+            // Remove the graph and its copies for the other cameras from the batch.
+            auto& graphs = mBatch.graphs;
+            const size_t graphIndex = std::distance(graphs.begin(), std::find(graphs.begin(), graphs.end(), pGraph->getName()));
+            graphs.erase(graphs.begin() + graphIndex);
+            for (auto& cameraGraphs : mBatch.cameraGraphs) cameraGraphs.erase(cameraGraphs.begin() + graphIndex);
+            pGraph->setResourcePool(nullptr);
+            if (graphs.empty()) clearBatch();
+        }
         size_t i = 0;
         for (; i < mGraphs.size(); i++) if (mGraphs[i].pGraph == pGraph) break;
         FALCOR_ASSERT(i < mGraphs.size());
@@ -524,6 +551,20 @@ namespace Mogwai
 
         for (auto& g : mGraphs) g.pGraph->setScene(mpScene);
         gpFramework->getGlobalClock().setTime(0);
+
+        // The batch cameras are looked up in the new scene.
+        if (!mBatch.cameras.empty())
+        {
+            try
+            {
+                setBatch(std::vector<std::string>(mBatch.graphs), std::vector<std::string>(mBatch.cameras));
+            }
+            catch (const ArgumentError& e)
+            {
+                logWarning("Disabling batch rendering. {}", e.what());
+                clearBatch();
+            }
+        }
     }
 
     Scene::SharedPtr Renderer::getScene() const
@@ -576,6 +617,93 @@ namespace Mogwai
         pGraph->execute(pRenderContext);
     }
 
+    void Renderer::setBatch(const std::vector<std::string>& graphs, const std::vector<std::string>& cameras)
+    {
+        for (const auto& name : graphs)
+        {
+            if (!getGraph(name)) throw ArgumentError("Can't find a graph named '{}'.", name);
+        }
+
+        // Validate the cameras once here, they are used every frame.
+        std::vector<Camera::SharedPtr> pCameras;
+        if (!cameras.empty() && !mpScene) throw ArgumentError("Batch cameras require a scene to be loaded.");
+        for (const auto& cameraName : cameras)
+        {
+            if (std::count(cameras.begin(), cameras.end(), cameraName) > 1) throw ArgumentError("Batch camera '{}' is listed more than once.", cameraName);
+            const auto& sceneCameras = mpScene->getCameras();
+            auto it = std::find_if(sceneCameras.begin(), sceneCameras.end(), [&](const auto& pCamera) { return pCamera->getName() == cameraName; });
+            if (it == sceneCameras.end()) throw ArgumentError("Batch camera '{}' does not exist in the scene.", cameraName);
+            pCameras.push_back(*it);
+        }
+
+        clearBatch();
+        mBatch.graphs = graphs;
+        mBatch.cameras = cameras;
+        mBatch.pCameras = pCameras;
+        mBatch.pResourcePool = ResourcePool::create();
+
+        // The first camera renders with the graphs themselves. Every other camera renders with its own copies of the graphs,
+        // so that temporal passes, e.g., accumulation, keep a separate history per camera.
+        mBatch.cameraGraphs.resize(std::max<size_t>(cameras.size(), 1));
+        for (const auto& name : mBatch.graphs) mBatch.cameraGraphs[0].push_back(getGraph(name));
+        for (size_t c = 1; c < mBatch.cameraGraphs.size(); c++)
+        {
+            for (const auto& pGraph : mBatch.cameraGraphs[0])
+            {
+                auto pCopy = copyGraph(pGraph, pGraph->getName() + "." + cameras[c]);
+                pCopy->setScene(mpScene);
+                mBatch.cameraGraphs[c].push_back(pCopy);
+            }
+        }
+
+        for (const auto& cameraGraphs : mBatch.cameraGraphs)
+        {
+            for (const auto& pGraph : cameraGraphs) pGraph->setResourcePool(mBatch.pResourcePool);
+        }
+    }
+
+    void Renderer::clearBatch()
+    {
+        for (const auto& name : mBatch.graphs)
+        {
+            if (auto pGraph = getGraph(name)) pGraph->setResourcePool(nullptr);
+        }
+        mBatch = {};
+    }
+
+    bool Renderer::isBatchGraph(const RenderGraph* pGraph) const
+    {
+        return pGraph && std::find(mBatch.graphs.begin(), mBatch.graphs.end(), pGraph->getName()) != mBatch.graphs.end();
+    }
+
+    void Renderer::executeBatch(RenderContext* pRenderContext)
+    {
+        // Every graph is rendered with every camera. All of them share the scene, which is loaded and animated once per frame.
+        // Switching to a batch camera is not a camera switch for the graphs, as each camera has its own graph instances.
+        Camera::SharedPtr pUpdateCamera = mpScene ? mpScene->getCamera() : nullptr;
+
+        for (size_t c = 0; c < mBatch.cameraGraphs.size(); c++)
+        {
+            std::string cameraSuffix;
+            if (!mBatch.pCameras.empty())
+            {
+                mpScene->setFrameCamera(mBatch.pCameras[c]);
+                cameraSuffix = "." + mBatch.cameras[c];
+            }
+
+            for (size_t g = 0; g < mBatch.graphs.size(); g++)
+            {
+                const auto& pGraph = mBatch.cameraGraphs[c][g];
+                (*pGraph->getPassesDictionary())[kRenderPassRefreshFlags] = RenderPassRefreshFlags::None;
+                pGraph->execute(pRenderContext);
+                for (auto& pe : mpExtensions) pe->batchGraphExecuted(pRenderContext, mBatch.cameraGraphs[0][g].get(), pGraph.get(), mBatch.graphs[g] + cameraSuffix);
+            }
+        }
+
+        // Select the camera used for the scene update again.
+        if (!mBatch.pCameras.empty()) mpScene->setFrameCamera(pUpdateCamera);
+    }
+
     void Renderer::beginFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
     {
         for (auto& pe : mpExtensions)  pe->beginFrame(pRenderContext, pTargetFbo);
@@ -597,7 +725,20 @@ namespace Mogwai
 
         applyEditorChanges();
 
-        if (mActiveGraph < mGraphs.size())
+        if (isBatchActive())
+        {
+            for (const auto& cameraGraphs : mBatch.cameraGraphs)
+            {
+                for (const auto& pGraph : cameraGraphs)
+                {
+                    pGraph->setResourcePool(mBatch.pResourcePool);
+                    pGraph->compile(pRenderContext);
+                }
+            }
+            // Release resources that are no longer shared after recompilation.
+            mBatch.pResourcePool->releaseUnused();
+        }
+        else if (mActiveGraph < mGraphs.size())
         {
             auto& pGraph = mGraphs[mActiveGraph].pGraph;
             pGraph->compile(pRenderContext);
@@ -619,10 +760,20 @@ namespace Mogwai
                 mpScene->update(pRenderContext, gpFramework->getGlobalClock().getTime());
             }
 
-            executeActiveGraph(pRenderContext);
+            // In batch mode the active graph is only displayed if it is one of the batch graphs.
+            bool executed = true;
+            if (isBatchActive())
+            {
+                executeBatch(pRenderContext);
+                executed = isBatchGraph(pGraph.get());
+            }
+            else
+            {
+                executeActiveGraph(pRenderContext);
+            }
 
             // Blit main graph output to frame buffer.
-            if (mGraphs[mActiveGraph].mainOutput.size())
+            if (executed && mGraphs[mActiveGraph].mainOutput.size())
             {
                 Texture::SharedPtr pOutTex = std::dynamic_pointer_cast<Texture>(pGraph->getOutput(mGraphs[mActiveGraph].mainOutput));
                 FALCOR_ASSERT(pOutTex);
@@ -672,6 +823,10 @@ namespace Mogwai
             Scene::SharedPtr graphScene = g.pGraph->getScene();
             if (graphScene) graphScene->setCameraAspectRatio((float)width / (float)height);
         }
+        for (size_t c = 1; c < mBatch.cameraGraphs.size(); c++)
+        {
+            for (const auto& pGraph : mBatch.cameraGraphs[c]) pGraph->onResize(gpFramework->getTargetFbo().get());
+        }
         if (mpScene) mpScene->setCameraAspectRatio((float)width / (float)height);
     }
 
@@ -57,6 +57,8 @@ namespace Mogwai
         virtual void addGraph(RenderGraph* pGraph) {};
         virtual void removeGraph(RenderGraph* pGraph) {};
         virtual void activeGraphChanged(RenderGraph* pNewGraph, RenderGraph* pPrevGraph) {};
+        virtual void batchGraphExecuted(RenderContext* pRenderContext, RenderGraph* pGraph, RenderGraph* pInstance, const std::string& variant) {};
+        virtual void shutdown() {};
 
     protected:
         Extension(Renderer* pRenderer, const std::string& name) : mpRenderer(pRenderer), mName(name) {}
@@ -108,6 +110,14 @@ namespace Mogwai
 
         RenderGraph* getActiveGraph() const;
 
+        /** Check if batch rendering is enabled, i.e., if the batch graphs are rendered every frame instead of the active graph.
+        */
+        bool isBatchActive() const { return !mBatch.graphs.empty(); }
+
+        /** Check if a graph is rendered in batch mode.
+        */
+        bool isBatchGraph(const RenderGraph* pGraph) const;
+
 //    private: // MOGWAI
         friend class Extension;
 
@@ -147,6 +157,7 @@ namespace Mogwai
         void setScene(const Scene::SharedPtr& pScene);
         Scene::SharedPtr getScene() const;
         void executeActiveGraph(RenderContext* pRenderContext);
+        void executeBatch(RenderContext* pRenderContext);
         void beginFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo);
         void endFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo);
 
@@ -164,6 +175,19 @@ namespace Mogwai
 
         std::vector<GraphData> mGraphs;
         uint32_t mActiveGraph = 0;
+
+        // Batch rendering
+        void setBatch(const std::vector<std::string>& graphs, const std::vector<std::string>& cameras);
+        void clearBatch();
+
+        struct
+        {
+            std::vector<std::string> graphs;            ///< Names of the graphs rendered every frame. Batch rendering is disabled if empty.
+            std::vector<std::string> cameras;           ///< Names of the cameras every graph is rendered with. The selected camera is used if empty.
+            std::vector<Camera::SharedPtr> pCameras;    ///< The batch cameras, validated when the batch is set.
+            std::vector<std::vector<RenderGraph::SharedPtr>> cameraGraphs; ///< Graph instances per camera, ordered like 'graphs'. The first camera uses the graphs themselves, the others use copies of them.
+            ResourcePool::SharedPtr pResourcePool;      ///< Pool of transient resources shared by the batch graphs.
+        } mBatch;
         Sampler::SharedPtr mpSampler = nullptr;
         std::filesystem::path mScriptPath;
 
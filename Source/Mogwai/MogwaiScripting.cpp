@@ -38,6 +38,8 @@ namespace Mogwai
         const std::string kAddGraph = "addGraph";
         const std::string kRemoveGraph = "removeGraph";
         const std::string kGetGraph = "getGraph";
+        const std::string kSetBatch = "setBatch";
+        const std::string kClearBatch = "clearBatch";
         const std::string kUI = "ui";
         const std::string kResizeSwapChain = "resizeSwapChain";
         const std::string kRenderFrame = "renderFrame";
@@ -91,6 +93,13 @@ namespace Mogwai
             s += "\n";
         }
 
+        if (!mBatch.graphs.empty())
+        {
+            s += "# Batch\n";
+            s += ScriptWriter::makeMemberFunc(kRendererVar, kSetBatch, mBatch.graphs, mBatch.cameras);
+            s += "\n";
+        }
+
         s += windowConfig() + "\n";
 
         {
@@ -123,6 +132,8 @@ namespace Mogwai
         renderer.def(kRemoveGraph.c_str(), pybind11::overload_cast<const std::string&>(&Renderer::removeGraph), "name"_a);
         renderer.def(kRemoveGraph.c_str(), pybind11::overload_cast<const RenderGraph::SharedPtr&>(&Renderer::removeGraph), "graph"_a);
         renderer.def(kGetGraph.c_str(), &Renderer::getGraph, "name"_a);
+        renderer.def(kSetBatch.c_str(), &Renderer::setBatch, "graphs"_a, "cameras"_a = std::vector<std::string>());
+        renderer.def(kClearBatch.c_str(), &Renderer::clearBatch);
 
         auto resizeSwapChain = [](Renderer* pRenderer, uint32_t width, uint32_t height) { gpFramework->resizeSwapChain(width, height); };
         renderer.def(kResizeSwapChain.c_str(), resizeSwapChain);
@@ -32,6 +32,7 @@
 
 #include <cstdio>
 #include <string>
+#include <thread>
 #include <vector>
 
 #if FALCOR_D3D12_AVAILABLE
@@ -58,7 +59,8 @@ void FalcorTest::onLoad(RenderContext* pRenderContext)
 
 void FalcorTest::onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
 {
-    sReturnCode = runTests(std::cout, pRenderContext, mOptions.filter, mOptions.repeat);
+    if (mOptions.benchmark) sReturnCode = runBenchmarks(std::cout, mOptions.filter, mOptions.benchmarkOptions);
+    else sReturnCode = runTests(std::cout, pRenderContext, mOptions.filter, mOptions.repeat, mOptions.runOptions);
     gpFramework->shutdown();
 }
 
@@ -70,6 +72,16 @@ int main(int argc, char** argv)
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
     args::ValueFlag<std::string> filterFlag(parser, "filter", "Regular expression for filtering tests to run.", {'f', "filter"});
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
+    args::ValueFlag<uint32_t> jobsFlag(parser, "N", "Number of threads running CPU tests concurrently (0 = number of logical cores).", {'j', "jobs"});
+    args::ValueFlag<uint32_t> shardIndexFlag(parser, "index", "Index of the shard of tests to run.", {"shard-index"});
+    args::ValueFlag<uint32_t> shardCountFlag(parser, "count", "Number of shards to split the tests into.", {"shard-count"});
+    args::ValueFlag<uint32_t> timeoutFlag(parser, "seconds", "Fail tests running longer than the given time.", {"timeout"});
+    args::Flag benchmarkFlag(parser, "", "Run benchmarks instead of tests.", {"benchmark"});
+    args::ValueFlag<uint32_t> warmupFlag(parser, "N", "Number of untimed benchmark iterations.", {"warmup"});
+    args::ValueFlag<uint32_t> repetitionsFlag(parser, "N", "Number of timed benchmark iterations.", {"repetitions"});
+    args::ValueFlag<std::string> benchmarkOutputFlag(parser, "path", "Write benchmark results to a JSON file.", {"benchmark-output"});
+    args::ValueFlag<std::string> benchmarkBaselineFlag(parser, "path", "Compare benchmark results against a JSON file written with --benchmark-output.", {"benchmark-baseline"});
+    args::ValueFlag<float> benchmarkToleranceFlag(parser, "tolerance", "Relative slowdown over the baseline that fails a benchmark (default 0.1).", {"benchmark-tolerance"});
     args::Flag enableDebugLayer(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::CompletionFlag completionFlag(parser, {"complete"});
 
@@ -107,6 +119,21 @@ int main(int argc, char** argv)
 
     if (filterFlag) options.filter = args::get(filterFlag);
     if (repeatFlag) options.repeat = args::get(repeatFlag);
+    if (jobsFlag) options.runOptions.threadCount = args::get(jobsFlag) > 0 ? args::get(jobsFlag) : std::max(1u, std::thread::hardware_concurrency());
+    if (shardCountFlag) options.runOptions.shardCount = std::max(1u, args::get(shardCountFlag));
+    if (shardIndexFlag) options.runOptions.shardIndex = args::get(shardIndexFlag);
+    if (timeoutFlag) options.runOptions.timeoutSeconds = args::get(timeoutFlag);
+    if (options.runOptions.shardIndex >= options.runOptions.shardCount)
+    {
+        std::cerr << "Shard index must be less than the shard count." << std::endl;
+        return 1;
+    }
+    if (benchmarkFlag) options.benchmark = true;
+    if (warmupFlag) options.benchmarkOptions.warmupCount = args::get(warmupFlag);
+    if (repetitionsFlag) options.benchmarkOptions.repetitionCount = args::get(repetitionsFlag);
+    if (benchmarkOutputFlag) options.benchmarkOptions.outputPath = args::get(benchmarkOutputFlag);
+    if (benchmarkBaselineFlag) options.benchmarkOptions.baselinePath = args::get(benchmarkBaselineFlag);
+    if (benchmarkToleranceFlag) options.benchmarkOptions.tolerance = args::get(benchmarkToleranceFlag);
 
     FalcorTest::UniquePtr pRenderer = std::make_unique<FalcorTest>(options);
     SampleConfig config;
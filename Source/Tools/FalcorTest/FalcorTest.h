@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Falcor.h"
+#include "Testing/UnitTest.h"
 
 using namespace Falcor;
 
@@ -37,6 +38,9 @@ public:
     {
         std::string filter;
         uint32_t repeat = 1;
+        TestRunOptions runOptions;
+        bool benchmark = false;             ///< Run benchmarks instead of tests.
+        BenchmarkOptions benchmarkOptions;
     };
 
     FalcorTest(const Options& options) : mOptions(options) {}
@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kSrc = "src";
+        const std::string kDst = "dst";
+        const uint2 kSourceDims = { 64, 32 };
+
+        /** Pass with an output of fixed size and configurable format.
+        */
+        class SourcePass : public RenderPass
+        {
+        public:
+            using SharedPtr = std::shared_ptr<SourcePass>;
+
+            static SharedPtr create() { return SharedPtr(new SourcePass()); }
+
+            RenderPassReflection reflect(const CompileData& compileData) override
+            {
+                RenderPassReflection r;
+                r.addOutput(kDst, "Output").format(mFormat).texture2D(kSourceDims.x, kSourceDims.y);
+                return r;
+            }
+
+            void execute(RenderContext* pRenderContext, const RenderData& renderData) override {}
+
+            void setFormat(ResourceFormat format)
+            {
+                mFormat = format;
+                requestRecompile();
+            }
+
+        private:
+            SourcePass() : RenderPass({ "SourcePass", "" }) {}
+            ResourceFormat mFormat = ResourceFormat::RGBA32Float;
+        };
+
+        /** Pass whose output takes the format and size of the connected input, like TemporalDelayPass.
+            The connections are only known on the retry after the first compilation failed.
+        */
+        class CopyPass : public RenderPass
+        {
+        public:
+            using SharedPtr = std::shared_ptr<CopyPass>;
+
+            static SharedPtr create() { return SharedPtr(new CopyPass()); }
+
+            RenderPassReflection reflect(const CompileData& compileData) override
+            {
+                RenderPassReflection r;
+                const auto pSrc = compileData.connectedResources.getField(kSrc);
+                mReady = pSrc != nullptr;
+                if (mReady)
+                {
+                    r.addInput(kSrc, "Input").format(pSrc->getFormat()).texture2D(pSrc->getWidth(), pSrc->getHeight());
+                    r.addOutput(kDst, "Output").format(pSrc->getFormat()).texture2D(pSrc->getWidth(), pSrc->getHeight());
+                }
+                else
+                {
+                    r.addInput(kSrc, "Input");
+                    r.addOutput(kDst, "Output");
+                }
+                return r;
+            }
+
+            void compile(RenderContext* pRenderContext, const CompileData& compileData) override
+            {
+                if (!mReady) throw RuntimeError("CopyPass: Missing incoming reflection information");
+                mCompileCount++;
+            }
+
+            void execute(RenderContext* pRenderContext, const RenderData& renderData) override {}
+
+            uint32_t getCompileCount() const { return mCompileCount; }
+
+        private:
+            CopyPass() : RenderPass({ "CopyPass", "" }) {}
+            bool mReady = false;
+            uint32_t mCompileCount = 0;
+        };
+
+        void checkTexture(GPUUnitTestContext& ctx, const Resource::SharedPtr& pResource, ResourceFormat format, uint2 dims)
+        {
+            auto pTexture = pResource ? pResource->asTexture() : nullptr;
+            EXPECT(pTexture != nullptr);
+            if (!pTexture) return;
+            EXPECT_EQ(pTexture->getFormat(), format);
+            EXPECT_EQ(pTexture->getWidth(), dims.x);
+            EXPECT_EQ(pTexture->getHeight(), dims.y);
+        }
+    }
+
+    GPU_TEST(RenderGraphRecompileConnectedReflection)
+    {
+        RenderContext* pRenderContext = ctx.getRenderContext();
+
+        auto pSource = SourcePass::create();
+        auto pCopy = CopyPass::create();
+        auto pGraph = RenderGraph::create("RecompileTest");
+        pGraph->addPass(pSource, "A");
+        pGraph->addPass(pCopy, "B");
+        pGraph->addEdge("A.dst", "B.src");
+        pGraph->markOutput("B.dst");
+        pGraph->onResize(Fbo::create2D(16, 16, ResourceFormat::RGBA8Unorm).get());
+
+        // The output of B is only sized and formatted from A after the retry.
+        EXPECT(pGraph->compile(pRenderContext));
+        checkTexture(ctx, pGraph->getOutput("B.dst"), ResourceFormat::RGBA32Float, kSourceDims);
+        EXPECT_EQ(pCopy->getCompileCount(), 1u);
+
+        // Recompiling for an unrelated change reuses the connected reflection of B and doesn't compile it again.
+        pGraph->addPass(SourcePass::create(), "C");
+        pGraph->markOutput("C.dst");
+        EXPECT(pGraph->compile(pRenderContext));
+        checkTexture(ctx, pGraph->getOutput("B.dst"), ResourceFormat::RGBA32Float, kSourceDims);
+        EXPECT_EQ(pCopy->getCompileCount(), 1u);
+
+        // Changing the connected input reflects and compiles B again.
+        pSource->setFormat(ResourceFormat::RG16Float);
+        EXPECT(pGraph->compile(pRenderContext));
+        checkTexture(ctx, pGraph->getOutput("B.dst"), ResourceFormat::RG16Float, kSourceDims);
+        EXPECT_EQ(pCopy->getCompileCount(), 2u);
+    }
+
+    GPU_TEST(ResourceCacheReuseByName)
+    {
+        ResourceCache::DefaultProperties params;
+        params.dims = { 16, 16 };
+        params.format = ResourceFormat::RGBA8Unorm;
+
+        RenderPassReflection r;
+        const auto field = r.addOutput("dst", "").format(ResourceFormat::RGBA32Float).texture2D(8, 8);
+        const auto defaultField = r.addOutput("defaultDst", "");
+        const auto otherField = r.addOutput("otherDst", "").format(ResourceFormat::R32Float).texture2D(8, 8);
+
+        auto pPrevCache = ResourceCache::create();
+        pPrevCache->registerField("A.dst", field, 0);
+        pPrevCache->registerField("A.defaultDst", defaultField, 0);
+        pPrevCache->registerField("A.changedDst", field, 0);
+        pPrevCache->allocateResources(params);
+        const auto pDst = pPrevCache->getResource("A.dst");
+        const auto pDefaultDst = pPrevCache->getResource("A.defaultDst");
+        const auto pChangedDst = pPrevCache->getResource("A.changedDst");
+        EXPECT(pDst && pDefaultDst && pChangedDst);
+
+        // Resources with the same name and properties are reused, others are created.
+        auto pCache = ResourceCache::create();
+        pCache->registerField("A.dst", field, 0);
+        pCache->registerField("A.defaultDst", defaultField, 0);
+        pCache->registerField("A.changedDst", otherField, 0);
+        pCache->registerField("B.dst", field, 1);
+        pCache->allocateResources(params, pPrevCache.get());
+        EXPECT(pCache->getResource("A.dst") == pDst);
+        EXPECT(pCache->getResource("A.defaultDst") == pDefaultDst);
+        EXPECT(pCache->getResource("A.changedDst") != pChangedDst);
+        EXPECT(pCache->getResource("B.dst") != pDst);
+        checkTexture(ctx, pCache->getResource("A.changedDst"), ResourceFormat::R32Float, { 8, 8 });
+
+        // The previous cache is reset.
+        EXPECT(pPrevCache->getResource("A.dst") == nullptr);
+
+        // Resources that take their properties from the defaults are not reused if the defaults changed.
+        auto pNextCache = ResourceCache::create();
+        pNextCache->registerField("A.dst", field, 0);
+        pNextCache->registerField("A.defaultDst", defaultField, 0);
+        params.dims = { 32, 32 };
+        pNextCache->allocateResources(params, pCache.get());
+        EXPECT(pNextCache->getResource("A.dst") == pDst);
+        EXPECT(pNextCache->getResource("A.defaultDst") != pDefaultDst);
+        checkTexture(ctx, pNextCache->getResource("A.defaultDst"), ResourceFormat::RGBA8Unorm, { 32, 32 });
+    }
+}
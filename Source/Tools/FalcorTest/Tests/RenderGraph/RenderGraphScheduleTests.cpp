@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/RenderGraphSchedule.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // Diamond A -> {B, C} -> D, plus an independent pass E.
+        const std::vector<std::string> kPassNames = { "A", "B", "C", "D", "E" };
+        const std::vector<RenderGraphSchedule::Dependency> kDependencies =
+        {
+            { 0, 1, "A.color" },
+            { 0, 2, "A.color" },
+            { 1, 3, "B.dst" },
+            { 2, 3, "C.dst" },
+            { 2, 3, "" },
+        };
+
+        bool throws(const std::function<void()>& func)
+        {
+            try
+            {
+                func();
+            }
+            catch (const ArgumentError&)
+            {
+                return true;
+            }
+            return false;
+        }
+    }
+
+    CPU_TEST(RenderGraphScheduleLevels)
+    {
+        auto schedule = RenderGraphSchedule::build(kPassNames, kDependencies);
+        EXPECT_EQ(schedule.getPassCount(), 5);
+
+        const auto& levels = schedule.getLevels();
+        EXPECT_EQ(levels.size(), 3);
+        if (levels.size() != 3) return;
+        EXPECT(levels[0].passes == std::vector<uint32_t>({ 0, 4 }));
+        EXPECT(levels[1].passes == std::vector<uint32_t>({ 1, 2 }));
+        EXPECT(levels[2].passes == std::vector<uint32_t>({ 3 }));
+        EXPECT_EQ(schedule.getPassLevel(3), 2);
+        EXPECT_EQ(schedule.getMaxLevelSize(), 2);
+        EXPECT(schedule.getExecutionOrder() == std::vector<uint32_t>({ 0, 4, 1, 2, 3 }));
+
+        // A resource read by multiple passes of a level needs a single barrier.
+        EXPECT_EQ(levels[0].barriers.size(), 0);
+        EXPECT_EQ(levels[1].barriers.size(), 1);
+        if (levels[1].barriers.size() == 1)
+        {
+            EXPECT_EQ(levels[1].barriers[0].resource, "A.color");
+            EXPECT_EQ(levels[1].barriers[0].srcPass, 0);
+            EXPECT(levels[1].barriers[0].dstPasses == std::vector<uint32_t>({ 1, 2 }));
+        }
+
+        // Execution dependencies don't need barriers.
+        EXPECT_EQ(levels[2].barriers.size(), 2);
+    }
+
+    CPU_TEST(RenderGraphScheduleCriticalPath)
+    {
+        // With unit costs the longest chain is A -> B -> D (B is found before C).
+        auto schedule = RenderGraphSchedule::build(kPassNames, kDependencies);
+        EXPECT(schedule.getCriticalPath() == std::vector<uint32_t>({ 0, 1, 3 }));
+        EXPECT_EQ(schedule.getCriticalPathCost(), 3.0);
+
+        schedule = RenderGraphSchedule::build(kPassNames, kDependencies, { 1.0, 2.0, 4.0, 1.0, 5.0 });
+        EXPECT(schedule.getCriticalPath() == std::vector<uint32_t>({ 0, 2, 3 }));
+        EXPECT_EQ(schedule.getCriticalPathCost(), 6.0);
+
+        // An expensive independent pass is the critical path by itself.
+        schedule = RenderGraphSchedule::build(kPassNames, kDependencies, { 1.0, 2.0, 4.0, 1.0, 10.0 });
+        EXPECT(schedule.getCriticalPath() == std::vector<uint32_t>({ 4 }));
+        EXPECT_EQ(schedule.getCriticalPathCost(), 10.0);
+    }
+
+    CPU_TEST(RenderGraphScheduleInvalid)
+    {
+        EXPECT(throws([]() { RenderGraphSchedule::build({ "A", "B" }, { { 0, 1, "" }, { 1, 0, "" } }); }));
+        EXPECT(throws([]() { RenderGraphSchedule::build({ "A", "B" }, { { 0, 2, "" } }); }));
+        EXPECT(throws([]() { RenderGraphSchedule::build({ "A", "B" }, { { 1, 1, "" } }); }));
+        EXPECT(throws([]() { RenderGraphSchedule::build({ "A", "B" }, {}, { 1.0 }); }));
+
+        auto schedule = RenderGraphSchedule::build({}, {});
+        EXPECT_EQ(schedule.getLevels().size(), 0);
+        EXPECT_EQ(schedule.getCriticalPath().size(), 0);
+    }
+}
@@ -139,5 +139,23 @@ namespace Falcor
         testAliasTable(ctx, 2, { 1.f, 2.f });
         testAliasTable(ctx, 100);
         testAliasTable(ctx, 1000);
+
+        // Sorted weights place all light items before the heavy items.
+        std::vector<float> sortedWeights(1000);
+        for (size_t i = 0; i < sortedWeights.size(); ++i) sortedWeights[i] = (float)(i + 1);
+        testAliasTable(ctx, 1000, sortedWeights);
+    }
+
+    CPU_BENCHMARK(AliasTableCreate)
+    {
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> uniform;
+        std::vector<float> weights(1 << 20);
+        for (auto& weight : weights) weight = uniform(rng);
+
+        // Measure the CPU table construction separately from the full creation including the GPU buffer uploads.
+        double weightSum = 0.0;
+        ctx.measure("build", [&]() { AliasTable::buildItems(weights, weightSum); });
+        ctx.measure("create", [&]() { AliasTable::create(weights, rng); });
     }
 }
@@ -0,0 +1,135 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kNodeCount = 5;
+        const std::vector<double> kTimes = { 0.0, 0.5, 1.0, 2.0, 3.0 };
+        const std::vector<double> kSampleTimes = { -1.0, 0.0, 0.25, 0.9, 1.5, 2.75, 3.0, 4.5, 7.0 };
+
+        Animation::Keyframe createKeyframe(uint32_t node, uint32_t frame)
+        {
+            Animation::Keyframe keyframe;
+            keyframe.time = kTimes[frame];
+            keyframe.translation = float3(node, frame, node * frame);
+            keyframe.scaling = float3(1.f + 0.1f * frame);
+            keyframe.rotation = glm::angleAxis(0.2f * (node + frame), glm::normalize(float3(1.f, node, 2.f)));
+            return keyframe;
+        }
+
+        void testInstancedAnimation(CPUUnitTestContext& ctx, Animation::InterpolationMode mode, Animation::Behavior behavior)
+        {
+            // Create one animation per node and a single animation driving all nodes.
+            std::vector<Animation::SharedPtr> animations;
+            std::vector<Animation::Keyframe> keyframes;
+            for (uint32_t node = 0; node < kNodeCount; node++)
+            {
+                auto pAnimation = Animation::create("node", node, kTimes.back());
+                for (uint32_t frame = 0; frame < kTimes.size(); frame++)
+                {
+                    pAnimation->addKeyframe(createKeyframe(node, frame));
+                    keyframes.push_back(createKeyframe(node, frame));
+                }
+                animations.push_back(pAnimation);
+            }
+            auto pInstanced = Animation::createInstanced("instanced", 0, kNodeCount, kTimes.back(), keyframes);
+            EXPECT_EQ(pInstanced->getNodeCount(), kNodeCount);
+
+            for (auto pAnimation : animations) pAnimation->setInterpolationMode(mode);
+            for (auto pAnimation : animations) pAnimation->setPreInfinityBehavior(behavior);
+            for (auto pAnimation : animations) pAnimation->setPostInfinityBehavior(behavior);
+            pInstanced->setInterpolationMode(mode);
+            pInstanced->setPreInfinityBehavior(behavior);
+            pInstanced->setPostInfinityBehavior(behavior);
+
+            // The instanced animation should match the per-node animations.
+            std::vector<glm::mat4> transforms(kNodeCount);
+            for (double time : kSampleTimes)
+            {
+                pInstanced->animate(time, transforms.data());
+                for (uint32_t node = 0; node < kNodeCount; node++)
+                {
+                    glm::mat4 expected = animations[node]->animate(time);
+                    for (int c = 0; c < 4; c++)
+                    {
+                        for (int r = 0; r < 4; r++)
+                        {
+                            EXPECT_EQ(transforms[node][c][r], expected[c][r]) << "node=" << node << " time=" << time;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    CPU_TEST(InstancedAnimation)
+    {
+        for (auto mode : { Animation::InterpolationMode::Linear, Animation::InterpolationMode::Hermite })
+        {
+            for (auto behavior : { Animation::Behavior::Constant, Animation::Behavior::Linear, Animation::Behavior::Cycle, Animation::Behavior::Oscillate })
+            {
+                testInstancedAnimation(ctx, mode, behavior);
+            }
+        }
+    }
+
+    CPU_TEST(InstancedAnimationInvalidKeyframes)
+    {
+        auto throws = [](auto&& func)
+        {
+            try
+            {
+                func();
+            }
+            catch (...)
+            {
+                return true;
+            }
+            return false;
+        };
+
+        std::vector<Animation::Keyframe> keyframes(6);
+        for (size_t i = 0; i < keyframes.size(); i++) keyframes[i].time = (double)(i % 3);
+
+        // Keyframe count must be a multiple of the node count.
+        EXPECT(throws([&]() { Animation::createInstanced("invalid", 0, 4, 2.0, keyframes); }));
+
+        // All nodes must share the keyframe times.
+        keyframes[4].time = 1.5;
+        EXPECT(throws([&]() { Animation::createInstanced("invalid", 0, 2, 2.0, keyframes); }));
+
+        // Keyframes cannot be added to an animation driving multiple nodes.
+        keyframes[4].time = 1.0;
+        auto pAnimation = Animation::createInstanced("valid", 0, 2, 2.0, keyframes);
+        EXPECT(throws([&]() { pAnimation->addKeyframe(Animation::Keyframe()); }));
+    }
+}
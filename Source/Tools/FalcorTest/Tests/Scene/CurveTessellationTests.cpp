@@ -0,0 +1,161 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Curves/CurveTessellation.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // Three strands: a straight strand, a strand with a duplicated control point, and a degenerate strand.
+        const std::vector<int> kVertexCounts = { 4, 3, 2 };
+        const std::vector<float3> kControlPoints =
+        {
+            float3(0, 0, 0), float3(1, 0, 0), float3(2, 0, 0), float3(3, 0, 0),
+            float3(0, 1, 0), float3(0, 1, 0), float3(1, 1, 0),
+            float3(5, 5, 5), float3(5, 5, 5),
+        };
+        const std::vector<float> kWidths(kControlPoints.size(), 1.f);
+        const std::vector<float2> kUVs(kControlPoints.size(), float2(0.25f, 0.75f));
+        const uint32_t kSubdivPerSegment = 2;
+    }
+
+    CPU_TEST(CurveTessellationLayout)
+    {
+        auto layout = CurveTessellation::computeStrandLayout(kVertexCounts.size(), kVertexCounts.data(), kControlPoints.data(), kSubdivPerSegment, 1, 1);
+
+        // The degenerate strand is skipped, the duplicated control point is removed.
+        EXPECT_EQ(layout.getStrandCount(), 2u);
+        EXPECT_EQ(layout.controlPointOffsets[0], 0u);
+        EXPECT_EQ(layout.controlPointOffsets[1], 4u);
+        EXPECT_EQ(layout.getPointCount(), 10u);
+        EXPECT_EQ(layout.getSegmentCount(), 8u);
+
+        // Keep every other strand.
+        layout = CurveTessellation::computeStrandLayout(kVertexCounts.size(), kVertexCounts.data(), kControlPoints.data(), kSubdivPerSegment, 2, 1);
+        EXPECT_EQ(layout.getStrandCount(), 1u);
+        EXPECT_EQ(layout.getPointCount(), 7u);
+
+        // Keep every other vertex.
+        layout = CurveTessellation::computeStrandLayout(kVertexCounts.size(), kVertexCounts.data(), kControlPoints.data(), kSubdivPerSegment, 1, 2);
+        EXPECT_EQ(layout.getPointCount(), 6u);
+    }
+
+    CPU_TEST(CurveTessellationLinearSweptSphere)
+    {
+        auto result = CurveTessellation::convertToLinearSweptSphere(kVertexCounts.size(), kVertexCounts.data(), kControlPoints.data(), kWidths.data(), kUVs.data(), 1, kSubdivPerSegment, 1, 1, 1.f, glm::identity<glm::float4x4>());
+
+        EXPECT_EQ(result.points.size(), (size_t)10);
+        EXPECT_EQ(result.radius.size(), (size_t)10);
+        EXPECT_EQ(result.texCrds.size(), (size_t)10);
+
+        const std::vector<uint32_t> expectedIndices = { 0, 1, 2, 3, 4, 5, 7, 8 };
+        EXPECT(result.indices == expectedIndices);
+
+        // Evenly spaced collinear control points result in a linear spline.
+        for (uint32_t i = 0; i < 7; i++)
+        {
+            EXPECT_LE(glm::length(result.points[i] - float3(0.5f * i, 0.f, 0.f)), 1e-5f) << "i = " << i;
+        }
+        EXPECT_LE(glm::length(result.points[9] - float3(1, 1, 0)), 1e-5f);
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            EXPECT_LE(std::abs(result.radius[i] - 0.5f), 1e-5f) << "i = " << i;
+            EXPECT_LE(glm::length(result.texCrds[i] - float2(0.25f, 0.75f)), 1e-5f) << "i = " << i;
+        }
+
+        // Writing directly into preallocated vertex data produces the same result.
+        auto layout = CurveTessellation::computeStrandLayout(kVertexCounts.size(), kVertexCounts.data(), kControlPoints.data(), kSubdivPerSegment, 1, 1);
+        std::vector<uint32_t> indices(layout.getSegmentCount());
+        std::vector<StaticCurveVertexData> vertices(layout.getPointCount());
+        CurveTessellation::convertToLinearSweptSphere(layout, kControlPoints.data(), kWidths.data(), nullptr, 1.f, glm::identity<glm::float4x4>(), indices.data(), vertices.data());
+
+        EXPECT(indices == result.indices);
+        for (uint32_t i = 0; i < vertices.size(); i++)
+        {
+            EXPECT(vertices[i].position == result.points[i]) << "i = " << i;
+            EXPECT_EQ(vertices[i].radius, result.radius[i]) << "i = " << i;
+            EXPECT(vertices[i].texCrd == float2(0.f)) << "i = " << i;
+        }
+    }
+
+    CPU_TEST(CurveTessellationMesh)
+    {
+        const uint32_t pointCountPerCrossSection = 4;
+        auto result = CurveTessellation::convertToMesh(kVertexCounts.size(), kVertexCounts.data(), kControlPoints.data(), kWidths.data(), kUVs.data(), kSubdivPerSegment, 1, 1, 1.f, pointCountPerCrossSection);
+
+        EXPECT_EQ(result.vertices.size(), (size_t)(10 * pointCountPerCrossSection));
+        EXPECT_EQ(result.normals.size(), result.vertices.size());
+        EXPECT_EQ(result.tangents.size(), result.vertices.size());
+        EXPECT_EQ(result.radii.size(), result.vertices.size());
+        EXPECT_EQ(result.texCrds.size(), result.vertices.size());
+        EXPECT_EQ(result.faceVertexCounts.size(), (size_t)(2 * 8 * pointCountPerCrossSection));
+        EXPECT_EQ(result.faceVertexIndices.size(), 3 * result.faceVertexCounts.size());
+
+        for (uint32_t index : result.faceVertexIndices) EXPECT_LT((size_t)index, result.vertices.size());
+
+        // The first face of the second strand references its first cross-sections.
+        const uint32_t secondStrandFace = 2 * 6 * pointCountPerCrossSection;
+        EXPECT_EQ(result.faceVertexIndices[3 * secondStrandFace], 7 * pointCountPerCrossSection);
+    }
+
+    CPU_TEST(CurveTessellationClusterStrands)
+    {
+        // Grid of 16 x 16 straight strands with 3 vertices each.
+        const uint32_t gridSize = 16;
+        std::vector<uint32_t> indices;
+        std::vector<StaticCurveVertexData> vertices;
+        for (uint32_t y = 0; y < gridSize; y++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                uint32_t offset = (uint32_t)vertices.size();
+                indices.insert(indices.end(), { offset, offset + 1 });
+                for (uint32_t i = 0; i < 3; i++) vertices.push_back({ float3(x, y, i), 0.1f, float2(0.f) });
+            }
+        }
+
+        // Reducing to a quarter merges 2 x 2 blocks of strands.
+        auto result = CurveTessellation::clusterStrands(indices.data(), (uint32_t)indices.size(), vertices.data(), gridSize * gridSize / 4);
+        EXPECT_EQ(result.strandCount, gridSize * gridSize / 4);
+        EXPECT_EQ(result.indices.size(), (size_t)(2 * result.strandCount));
+        EXPECT_EQ(result.vertices.size(), (size_t)(3 * result.strandCount));
+        EXPECT_LE(result.error, 1.5f);
+        for (uint32_t s = 0; s < result.strandCount; s++)
+        {
+            EXPECT_EQ(result.indices[2 * s + 1], result.indices[2 * s] + 1) << "s = " << s;
+            EXPECT_LE(std::abs(result.vertices[3 * s].radius - 0.2f), 1e-5f) << "s = " << s;
+        }
+
+        // All strands are kept if the target is not below the strand count.
+        result = CurveTessellation::clusterStrands(indices.data(), (uint32_t)indices.size(), vertices.data(), gridSize * gridSize);
+        EXPECT_EQ(result.strandCount, gridSize * gridSize);
+        EXPECT(result.indices == indices);
+        EXPECT_EQ(result.error, 0.f);
+    }
+}
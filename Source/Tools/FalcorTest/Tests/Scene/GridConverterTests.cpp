@@ -0,0 +1,233 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridConverter.h"
+#include "Scene/Volume/BrickedGridCache.h"
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996)
+#include <nanovdb/util/GridBuilder.h>
+#pragma warning(pop)
+#include <random>
+#include <set>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::vector<float> createRandomValues(std::mt19937& rng, size_t count, float minValue, float maxValue)
+        {
+            std::uniform_real_distribution<float> dist(minValue, maxValue);
+            std::vector<float> values(count);
+            for (auto& v : values) v = dist(rng);
+            return values;
+        }
+
+        /** Reference brick range computed by visiting all 10^3 voxels of the brick and its apron through the accessor.
+        */
+        float2 computeBrickRangeReference(nanovdb::FloatGrid::AccessorType& a, const nanovdb::Coord& ijk)
+        {
+            float minorant = a.getValue(ijk), majorant = minorant;
+            for (int z = -1; z <= 8; ++z)
+            {
+                for (int y = -1; y <= 8; ++y)
+                {
+                    for (int x = -1; x <= 8; ++x)
+                    {
+                        float value = a.getValue(ijk + nanovdb::Coord(x, y, z));
+                        minorant = std::min(minorant, value);
+                        majorant = std::max(majorant, value);
+                    }
+                }
+            }
+            return float2(majorant, minorant);
+        }
+    }
+
+    CPU_TEST(GridConverterExpandRange)
+    {
+        std::mt19937 rng;
+        for (size_t count = 0; count < 40; ++count)
+        {
+            auto values = createRandomValues(rng, count, -100.f, 100.f);
+            if (count > 5) values[5] = std::numeric_limits<float>::quiet_NaN();
+
+            float minorant = 0.f, majorant = 0.f;
+            expandRange(values.data(), values.size(), minorant, majorant);
+
+            float refMinorant = 0.f, refMajorant = 0.f;
+            for (float v : values)
+            {
+                if (v < refMinorant) refMinorant = v;
+                if (v > refMajorant) refMajorant = v;
+            }
+
+            EXPECT_EQ(minorant, refMinorant) << "count = " << count;
+            EXPECT_EQ(majorant, refMajorant) << "count = " << count;
+        }
+    }
+
+    CPU_TEST(GridConverterQuantize)
+    {
+        std::mt19937 rng;
+        for (size_t count : { 1, 15, 16, 17, 100, 512 })
+        {
+            auto values = createRandomValues(rng, count, -2.f, 3.f);
+
+            std::vector<uint8_t> quantized8(count);
+            quantizeValues(values.data(), count, -2.f, 255.f / 5.f, quantized8.data());
+            for (size_t i = 0; i < count; ++i) EXPECT_EQ((uint32_t)quantized8[i], (uint32_t)uint8_t((values[i] + 2.f) * (255.f / 5.f))) << "i = " << i;
+
+            std::vector<uint16_t> quantized16(count);
+            quantizeValues(values.data(), count, -2.f, 65535.f / 5.f, quantized16.data());
+            for (size_t i = 0; i < count; ++i) EXPECT_EQ((uint32_t)quantized16[i], (uint32_t)uint16_t((values[i] + 2.f) * (65535.f / 5.f))) << "i = " << i;
+        }
+    }
+
+    CPU_TEST(GridConverterBC4ConstantTile)
+    {
+        uint8_t tile[16];
+        std::fill_n(tile, 16, (uint8_t)123);
+        uint8_t block[8];
+        std::fill_n(block, 8, (uint8_t)0xff);
+        CompressAlphaDxt5(tile, block);
+
+        EXPECT_EQ((uint32_t)block[0], 123u);
+        EXPECT_EQ((uint32_t)block[1], 123u);
+        for (int i = 2; i < 8; ++i) EXPECT_EQ((uint32_t)block[i], 0u) << "i = " << i;
+    }
+
+    CPU_TEST(GridConverterBrickRange)
+    {
+        auto handle = nanovdb::createFogVolumeSphere(20.f, nanovdb::Vec3R(0.0), 1.0, 3.f);
+        auto grid = handle.grid<float>();
+        auto a = grid->getAccessor();
+
+        const auto& bbox = grid->indexBBox();
+        uint32_t leafCount = 0;
+        for (int z = bbox.min()[2] & ~7; z <= bbox.max()[2]; z += 8)
+        {
+            for (int y = bbox.min()[1] & ~7; y <= bbox.max()[1]; y += 8)
+            {
+                for (int x = bbox.min()[0] & ~7; x <= bbox.max()[0]; x += 8)
+                {
+                    nanovdb::Coord ijk(x, y, z);
+                    if (!a.probeLeaf(ijk)) continue;
+
+                    float2 range = NanoVDBConverterBC4::computeBrickRange(a, ijk);
+                    float2 refRange = computeBrickRangeReference(a, ijk);
+                    EXPECT_EQ(range.x, refRange.x) << "leaf = (" << x << ", " << y << ", " << z << ")";
+                    EXPECT_EQ(range.y, refRange.y) << "leaf = (" << x << ", " << y << ", " << z << ")";
+                    leafCount++;
+                }
+            }
+        }
+        EXPECT_EQ(leafCount, (uint32_t)grid->tree().nodeCount(0));
+    }
+
+    CPU_TEST(BrickedGridCacheRoundtrip)
+    {
+        auto handle = nanovdb::createFogVolumeSphere(20.f, nanovdb::Vec3R(0.0), 1.0, 3.f);
+        BrickedGridData data = NanoVDBConverterUNORM8(handle.grid<float>()).convertBricks();
+
+        auto key = BrickedGridCache::computeKey(handle, NanoVDBConverterUNORM8::getAtlasFormat());
+        EXPECT(key != BrickedGridCache::computeKey(handle, NanoVDBConverterBC4::getAtlasFormat()));
+
+        // Use a temporary cache directory to keep the test entries out of the user's cache.
+        std::filesystem::path cacheDirectory = std::filesystem::temp_directory_path() / fmt::format("FalcorBrickedGridCacheTest.{}", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        BrickedGridCache::write(key, data, cacheDirectory);
+        auto cached = BrickedGridCache::read(key, cacheDirectory);
+        std::error_code ec;
+        std::filesystem::remove_all(cacheDirectory, ec);
+
+        EXPECT(cached.has_value());
+        if (!cached) return;
+
+        EXPECT(cached->leafDim == data.leafDim);
+        EXPECT(cached->atlasSize == data.atlasSize);
+        EXPECT(cached->atlasFormat == data.atlasFormat);
+        EXPECT(cached->range == data.range);
+        EXPECT(cached->indirection == data.indirection);
+        EXPECT(cached->atlas == data.atlas);
+    }
+
+    // Runs serially because it changes the process-wide maximum size of the cache.
+    CPU_TEST_SERIAL(BrickedGridCacheSizeCap)
+    {
+        auto handle = nanovdb::createFogVolumeSphere(20.f, nanovdb::Vec3R(0.0), 1.0, 3.f);
+        BrickedGridData data = NanoVDBConverterUNORM8(handle.grid<float>()).convertBricks();
+
+        std::filesystem::path cacheDirectory = std::filesystem::temp_directory_path() / fmt::format("FalcorBrickedGridCacheSizeCapTest.{}", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        std::error_code ec;
+        std::filesystem::remove_all(cacheDirectory, ec);
+
+        // All entries hold the same data and have the same size, only the keys differ.
+        std::vector<BrickedGridCache::Key> keys(4);
+        for (uint8_t i = 0; i < keys.size(); ++i) keys[i].fill(i);
+        auto isCached = [&](const BrickedGridCache::Key& key) { return BrickedGridCache::read(key, cacheDirectory).has_value(); };
+
+        // Write the first three entries with increasing write times, then read the oldest one to mark it as recently used.
+        auto now = std::filesystem::file_time_type::clock::now();
+        std::set<std::filesystem::path> entryPaths;
+        uint64_t entrySize = 0;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            BrickedGridCache::write(keys[i], data, cacheDirectory);
+            for (const auto& entry : std::filesystem::directory_iterator(cacheDirectory))
+            {
+                if (!entryPaths.insert(entry.path()).second) continue;
+                std::filesystem::last_write_time(entry.path(), now - std::chrono::hours(3 - i));
+                entrySize = entry.file_size();
+            }
+        }
+        EXPECT_EQ(entryPaths.size(), 3u);
+        EXPECT(isCached(keys[0]));
+
+        // Writing a fourth entry with room for two and a half entries removes the two least recently used entries.
+        uint64_t maxSize = BrickedGridCache::getMaxSize();
+        BrickedGridCache::setMaxSize(2 * entrySize + entrySize / 2);
+        BrickedGridCache::write(keys[3], data, cacheDirectory);
+        BrickedGridCache::setMaxSize(maxSize);
+
+        EXPECT(!isCached(keys[1]));
+        EXPECT(!isCached(keys[2]));
+        EXPECT(isCached(keys[0]));
+        EXPECT(isCached(keys[3]));
+
+        std::filesystem::remove_all(cacheDirectory, ec);
+    }
+
+    CPU_BENCHMARK(GridConverterBC4)
+    {
+        auto handle = nanovdb::createFogVolumeSphere(128.f, nanovdb::Vec3R(0.0), 1.0, 3.f);
+        auto grid = handle.grid<float>();
+
+        // The converter moves its brick data out when converting, so each iteration uses a new converter.
+        ctx.measure([grid]() { NanoVDBConverterBC4(grid).convertBricks(); });
+    }
+}
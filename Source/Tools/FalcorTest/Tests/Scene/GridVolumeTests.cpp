@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridVolume.h"
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996)
+#include <nanovdb/util/IO.h>
+#include <nanovdb/util/GridBuilder.h>
+#pragma warning(pop)
+#include <chrono>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kFrameCount = 12;
+        const uint32_t kStreamingWindow = 4;
+
+        bool isResident(const GridVolume::GridSequence& grids, uint32_t frame)
+        {
+            return grids[frame] && grids[frame]->isResident();
+        }
+
+        bool containsGrid(const std::vector<Grid::SharedPtr>& grids, const Grid::SharedPtr& pGrid)
+        {
+            return std::find(grids.begin(), grids.end(), pGrid) != grids.end();
+        }
+    }
+
+    GPU_TEST(GridVolumeStreaming)
+    {
+        // Write a short sequence of small grids to a temporary directory.
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / fmt::format("FalcorGridVolumeStreamingTest.{}", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        std::filesystem::create_directories(directory);
+        std::vector<std::filesystem::path> paths;
+        for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+        {
+            auto handle = nanovdb::createFogVolumeSphere(4.f + frame, nanovdb::Vec3R(0.0), 1.0, 2.0, nanovdb::Vec3R(0.0), "density");
+            paths.push_back(directory / fmt::format("grid{:02d}.nvdb", frame));
+            nanovdb::io::writeGrid(paths.back().string(), handle);
+        }
+
+        auto pVolume = GridVolume::create("volume");
+        pVolume->setFrameRate(30.0);
+        pVolume->setStreamingWindow(kStreamingWindow);
+        EXPECT_EQ(pVolume->streamGridSequence(GridVolume::GridSlot::Density, paths, "density"), kFrameCount);
+        EXPECT(pVolume->isStreamed());
+        const auto& grids = pVolume->getGridSequence(GridVolume::GridSlot::Density);
+        EXPECT_EQ(grids.size(), (size_t)kFrameCount);
+        if (grids.size() != kFrameCount) return;
+
+        // The current frame is loaded synchronously. The window ahead of it is prefetched.
+        EXPECT(pVolume->getDensityGrid() == grids[0]);
+        EXPECT(isResident(grids, 0));
+        for (int i = 0; i < 1000 && pVolume->getResidentFrameCount() < kStreamingWindow; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            pVolume->updatePlayback(0.0);
+        }
+        EXPECT_EQ(pVolume->getResidentFrameCount(), kStreamingWindow);
+        for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+        {
+            EXPECT_EQ(isResident(grids, frame), frame < kStreamingWindow) << "frame = " << frame;
+        }
+
+        // Moving the window evicts the frames that left it and reports the residency changes.
+        pVolume->clearUpdates();
+        pVolume->setGridFrame(6);
+        EXPECT(is_set(pVolume->getUpdates(), GridVolume::UpdateFlags::ResidencyChanged));
+        EXPECT(pVolume->getDensityGrid() == grids[6]);
+        EXPECT(isResident(grids, 6));
+        for (uint32_t frame = 0; frame < kStreamingWindow; ++frame)
+        {
+            EXPECT(!isResident(grids, frame)) << "frame = " << frame;
+            EXPECT(containsGrid(pVolume->getResidencyChanges(), grids[frame])) << "frame = " << frame;
+        }
+        EXPECT(containsGrid(pVolume->getResidencyChanges(), grids[6]));
+        EXPECT_LE(pVolume->getResidentFrameCount(), kStreamingWindow);
+
+        // If the current frame fails to load, the last resident grid stays in use, even outside the window.
+        std::filesystem::remove(paths[0]);
+        pVolume->clearUpdates();
+        pVolume->setGridFrame(0);
+        EXPECT(!isResident(grids, 0));
+        EXPECT(pVolume->getDensityGrid() == grids[6]);
+        EXPECT(isResident(grids, 6));
+        EXPECT(!containsGrid(pVolume->getResidencyChanges(), grids[6]));
+
+        // Once a later frame is resident, it replaces the previous grid, which is then evicted.
+        pVolume->setGridFrame(1);
+        EXPECT(pVolume->getDensityGrid() == grids[1]);
+        EXPECT(isResident(grids, 1));
+        EXPECT(!isResident(grids, 6));
+
+        // Wait for outstanding loads before removing the files.
+        pVolume = nullptr;
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+    }
+}
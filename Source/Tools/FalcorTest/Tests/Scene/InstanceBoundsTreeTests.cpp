@@ -0,0 +1,100 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/InstanceBoundsTree.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        AABB getUnion(const std::vector<AABB>& instances)
+        {
+            AABB bounds;
+            for (const auto& aabb : instances) bounds |= aabb;
+            return bounds;
+        }
+
+        AABB createBounds(uint32_t i)
+        {
+            float3 pmin = float3((float)i, (float)(i % 3), -(float)i);
+            return AABB(pmin, pmin + float3(1.f));
+        }
+
+        void testTree(CPUUnitTestContext& ctx, uint32_t instanceCount)
+        {
+            std::vector<AABB> instances(instanceCount);
+            for (uint32_t i = 0; i < instanceCount; i++) instances[i] = createBounds(i);
+            const std::vector<AABB> initial = instances;
+            auto getBounds = [&](uint32_t instanceID) { return instances[instanceID]; };
+
+            InstanceBoundsTree tree;
+            tree.build(instanceCount, getBounds);
+            EXPECT_EQ(tree.getInstanceCount(), (size_t)instanceCount);
+            EXPECT(tree.getBounds() == getUnion(instances)) << "instanceCount = " << instanceCount;
+
+            // Move the first and last instance far out, which grows the bounds.
+            std::vector<uint32_t> moved = { 0, instanceCount - 1 };
+            if (instanceCount == 1) moved.pop_back();
+            instances[0] = AABB(float3(-100.f), float3(-99.f));
+            instances[instanceCount - 1] = AABB(float3(99.f), float3(100.f));
+            tree.update(moved, getBounds);
+            EXPECT(tree.getBounds() == getUnion(instances)) << "instanceCount = " << instanceCount;
+            EXPECT(tree.getInstanceBounds(0) == instances[0]);
+
+            // Move them back, which must shrink the bounds again.
+            instances = initial;
+            tree.update(moved, getBounds);
+            EXPECT(tree.getBounds() == getUnion(initial)) << "instanceCount = " << instanceCount;
+
+            // Move an instance in the middle inside the current bounds, which leaves the bounds unchanged.
+            uint32_t middle = instanceCount / 2;
+            instances[middle] = AABB(initial[middle].center());
+            tree.update({ middle }, getBounds);
+            EXPECT(tree.getBounds() == getUnion(instances)) << "instanceCount = " << instanceCount;
+
+            // Rebuilding gives the same bounds as refitting.
+            InstanceBoundsTree rebuilt;
+            rebuilt.build(instanceCount, getBounds);
+            EXPECT(tree.getBounds() == rebuilt.getBounds()) << "instanceCount = " << instanceCount;
+        }
+    }
+
+    CPU_TEST(InstanceBoundsTree)
+    {
+        InstanceBoundsTree tree;
+        tree.build(0, [](uint32_t) { return AABB(); });
+        EXPECT_EQ(tree.getInstanceCount(), (size_t)0);
+        EXPECT(!tree.getBounds().valid());
+
+        // Single instances, powers of two and non-powers of two.
+        for (uint32_t instanceCount : { 1u, 2u, 3u, 4u, 5u, 7u, 8u, 13u, 100u })
+        {
+            testTree(ctx, instanceCount);
+        }
+    }
+}
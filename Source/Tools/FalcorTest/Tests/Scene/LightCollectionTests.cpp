@@ -0,0 +1,140 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const float2 kQuadSize = float2(2.f, 4.f);
+        const float3 kQuadOffset = float3(1.f, 2.f, 3.f);
+        const float3 kEmissiveColor = float3(1.f);
+        const float kEmissiveFactor = 2.f;
+
+        /** Creates a scene with a single emissive quad in the y = 2 plane, covering x in [0,2] and z in [1,5].
+        */
+        Scene::SharedPtr createEmissiveQuadScene()
+        {
+            auto pBuilder = SceneBuilder::create();
+
+            auto pMaterial = StandardMaterial::create("Emissive");
+            pMaterial->setEmissiveColor(kEmissiveColor);
+            pMaterial->setEmissiveFactor(kEmissiveFactor);
+
+            uint32_t meshID = pBuilder->addTriangleMesh(TriangleMesh::createQuad(kQuadSize), pMaterial);
+            SceneBuilder::Node node = { "Quad", glm::translate(glm::identity<glm::mat4>(), kQuadOffset), glm::identity<glm::mat4>() };
+            uint32_t nodeID = pBuilder->addNode(node);
+            pBuilder->addMeshInstance(nodeID, meshID);
+
+            return pBuilder->getScene();
+        }
+    }
+
+    GPU_TEST(LightCollectionCPUBuild)
+    {
+        auto pScene = createEmissiveQuadScene();
+        EXPECT(pScene->getEmissiveMeshData(0) != nullptr);
+
+        auto pLights = pScene->getLightCollection(ctx.getRenderContext());
+        EXPECT(pLights->isCPUBuild());
+
+        // The scene has no animations, so the CPU copies are released once the triangles are built.
+        EXPECT(pScene->getEmissiveMeshData(0) == nullptr);
+
+        const auto& stats = pLights->getStats();
+        EXPECT_EQ(stats.meshLightCount, 1u);
+        EXPECT_EQ(stats.triangleCount, 2u);
+        EXPECT_EQ(stats.meshesTextured, 0u);
+        EXPECT_EQ(stats.trianglesTextured, 0u);
+        EXPECT_EQ(stats.trianglesActive, 2u);
+        EXPECT_EQ(stats.trianglesActiveUniform, 2u);
+        EXPECT_EQ(stats.trianglesActiveTextured, 0u);
+
+        // Each triangle covers half the quad. The luminance of the white emitter equals the emissive factor.
+        const float triangleArea = 0.5f * kQuadSize.x * kQuadSize.y;
+        const float triangleFlux = kEmissiveFactor * triangleArea * (float)M_PI;
+
+        const auto& triangles = pLights->getMeshLightTriangles();
+        EXPECT_EQ(triangles.size(), (size_t)2);
+        for (const auto& tri : triangles)
+        {
+            EXPECT_EQ(tri.lightIdx, 0u);
+            for (const auto& vtx : tri.vtx)
+            {
+                EXPECT_EQ(vtx.pos.y, kQuadOffset.y);
+                EXPECT(vtx.pos.x == 0.f || vtx.pos.x == 2.f) << "x = " << vtx.pos.x;
+                EXPECT(vtx.pos.z == 1.f || vtx.pos.z == 5.f) << "z = " << vtx.pos.z;
+            }
+            EXPECT(tri.normal == float3(0.f, 1.f, 0.f));
+            EXPECT_EQ(tri.area, triangleArea);
+            EXPECT(tri.averageRadiance == kEmissiveColor * kEmissiveFactor);
+            EXPECT_LE(std::abs(tri.flux - triangleFlux), 1e-4f * triangleFlux) << "flux = " << tri.flux;
+        }
+    }
+
+    GPU_TEST(LightCollectionCPUMatchesGPU)
+    {
+        auto pScene = createEmissiveQuadScene();
+        auto pCPULights = pScene->getLightCollection(ctx.getRenderContext());
+        EXPECT(pCPULights->isCPUBuild());
+
+        // With the CPU copies released, a second collection over the same scene is built on the GPU.
+        auto pGPULights = LightCollection::create(ctx.getRenderContext(), pScene);
+        EXPECT(!pGPULights->isCPUBuild());
+
+        const auto& cpuTriangles = pCPULights->getMeshLightTriangles();
+        const auto& gpuTriangles = pGPULights->getMeshLightTriangles();
+        EXPECT_EQ(cpuTriangles.size(), gpuTriangles.size());
+        if (cpuTriangles.size() != gpuTriangles.size()) return;
+
+        const float kEpsilon = 1e-5f;
+        for (size_t i = 0; i < cpuTriangles.size(); i++)
+        {
+            const auto& cpu = cpuTriangles[i];
+            const auto& gpu = gpuTriangles[i];
+            EXPECT_EQ(cpu.lightIdx, gpu.lightIdx) << "triangle " << i;
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                EXPECT_LE(glm::length(cpu.vtx[j].pos - gpu.vtx[j].pos), kEpsilon) << "triangle " << i << " vertex " << j;
+                EXPECT_LE(glm::length(cpu.vtx[j].uv - gpu.vtx[j].uv), kEpsilon) << "triangle " << i << " vertex " << j;
+            }
+            EXPECT_LE(glm::length(cpu.normal - gpu.normal), kEpsilon) << "triangle " << i;
+            EXPECT_LE(std::abs(cpu.area - gpu.area), kEpsilon * cpu.area) << "triangle " << i;
+            EXPECT_LE(glm::length(cpu.averageRadiance - gpu.averageRadiance), 1e-3f) << "triangle " << i;
+            EXPECT_LE(std::abs(cpu.flux - gpu.flux), 1e-3f * cpu.flux) << "triangle " << i;
+        }
+
+        const auto& cpuStats = pCPULights->getStats();
+        const auto& gpuStats = pGPULights->getStats();
+        EXPECT_EQ(cpuStats.trianglesActive, gpuStats.trianglesActive);
+        EXPECT_EQ(cpuStats.trianglesActiveUniform, gpuStats.trianglesActiveUniform);
+        EXPECT_EQ(cpuStats.trianglesActiveTextured, gpuStats.trianglesActiveTextured);
+    }
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/PBRTImporter/LoopSubdivide.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::vector<float3> kTetrahedronPositions = { float3(1, 1, 1), float3(1, -1, -1), float3(-1, 1, -1), float3(-1, -1, 1) };
+        const std::vector<uint32_t> kTetrahedronIndices = { 0, 1, 2, 0, 3, 1, 0, 2, 3, 1, 3, 2 };
+
+        const std::vector<float3> kQuadPositions = { float3(0, 0, 0), float3(1, 0, 0), float3(1, 1, 0), float3(0, 1, 0) };
+        const std::vector<uint32_t> kQuadIndices = { 0, 1, 2, 0, 2, 3 };
+
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> countEdges(const std::vector<uint32_t>& indices)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> edges;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t v0 = indices[i + k];
+                    uint32_t v1 = indices[i + (k + 1) % 3];
+                    edges[{ std::min(v0, v1), std::max(v0, v1) }]++;
+                }
+            }
+            return edges;
+        }
+    }
+
+    CPU_TEST(LoopSubdivideClosedMesh)
+    {
+        uint32_t vertexCount = 4;
+        uint32_t faceCount = 4;
+        for (uint32_t levels = 0; levels <= 3; levels++)
+        {
+            auto result = pbrt::loopSubdivide(levels, kTetrahedronPositions, kTetrahedronIndices);
+            EXPECT_EQ(result.positions.size(), (size_t)vertexCount);
+            EXPECT_EQ(result.normals.size(), (size_t)vertexCount);
+            EXPECT_EQ(result.indices.size(), (size_t)(3 * faceCount));
+
+            // Every edge of a closed mesh is shared by exactly two faces.
+            auto edges = countEdges(result.indices);
+            for (const auto& [edge, count] : edges) EXPECT_EQ(count, 2u);
+            EXPECT_EQ(vertexCount + faceCount - (uint32_t)edges.size(), 2u);
+
+            // Loop subdivision stays within the convex hull and normals are consistently oriented.
+            float orientation = dot(result.normals[0], result.positions[0]);
+            EXPECT_NE(orientation, 0.f);
+            for (size_t i = 0; i < result.positions.size(); i++)
+            {
+                EXPECT(glm::all(glm::lessThanEqual(glm::abs(result.positions[i]), float3(1.f + 1e-6f))));
+                EXPECT_GT(dot(result.normals[i], result.positions[i]) * orientation, 0.f);
+            }
+
+            // A subdivision level adds one vertex per edge and splits each face into four.
+            vertexCount += (uint32_t)edges.size();
+            faceCount *= 4;
+        }
+    }
+
+    CPU_TEST(LoopSubdivideBoundary)
+    {
+        auto result = pbrt::loopSubdivide(2, kQuadPositions, kQuadIndices);
+        EXPECT_EQ(result.positions.size(), (size_t)25);
+        EXPECT_EQ(result.indices.size(), (size_t)(3 * 32));
+
+        // The boundary of the quad is split into 16 edges used by a single face.
+        auto edges = countEdges(result.indices);
+        uint32_t boundaryEdgeCount = 0;
+        for (const auto& [edge, count] : edges)
+        {
+            EXPECT(count == 1 || count == 2);
+            if (count == 1) boundaryEdgeCount++;
+        }
+        EXPECT_EQ(boundaryEdgeCount, 16u);
+
+        // A planar mesh stays planar with normals perpendicular to the plane.
+        for (size_t i = 0; i < result.positions.size(); i++)
+        {
+            EXPECT_EQ(result.positions[i].z, 0.f);
+            EXPECT_EQ(result.normals[i].x, 0.f);
+            EXPECT_EQ(result.normals[i].y, 0.f);
+        }
+    }
+
+    CPU_BENCHMARK(LoopSubdivide)
+    {
+        const uint32_t kLevels = 8;
+        ctx.measure([&]() { pbrt::loopSubdivide(kLevels, kTetrahedronPositions, kTetrahedronIndices); });
+    }
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    GPU_TEST(MaterialSystemAddMaterial)
+    {
+        auto pMaterialSystem = MaterialSystem::create();
+        auto pA = StandardMaterial::create("A");
+        auto pB = StandardMaterial::create("B");
+
+        EXPECT_EQ(pMaterialSystem->addMaterial(pA), 0u);
+        EXPECT_EQ(pMaterialSystem->addMaterial(pB), 1u);
+
+        // Adding the same material again returns the existing ID.
+        EXPECT_EQ(pMaterialSystem->addMaterial(pA), 0u);
+        EXPECT_EQ(pMaterialSystem->addMaterial(pB), 1u);
+        EXPECT_EQ(pMaterialSystem->getMaterialCount(), 2u);
+    }
+
+    GPU_TEST(MaterialSystemRemoveDuplicates)
+    {
+        auto pMaterialSystem = MaterialSystem::create();
+
+        auto createMaterial = [](const std::string& name, const float4& baseColor, float roughness)
+        {
+            auto pMaterial = StandardMaterial::create(name);
+            pMaterial->setBaseColor(baseColor);
+            pMaterial->setRoughness(roughness);
+            return pMaterial;
+        };
+
+        std::vector<StandardMaterial::SharedPtr> materials =
+        {
+            createMaterial("red", float4(1.f, 0.f, 0.f, 1.f), 0.5f),
+            createMaterial("green", float4(0.f, 1.f, 0.f, 1.f), 0.5f),
+            createMaterial("red duplicate", float4(1.f, 0.f, 0.f, 1.f), 0.5f),
+            createMaterial("rough red", float4(1.f, 0.f, 0.f, 1.f), 1.f),
+            createMaterial("green duplicate", float4(0.f, 1.f, 0.f, 1.f), 0.5f),
+            createMaterial("red duplicate 2", float4(1.f, 0.f, 0.f, 1.f), 0.5f),
+        };
+        for (const auto& pMaterial : materials) pMaterialSystem->addMaterial(pMaterial);
+
+        // Equal materials must have equal hashes.
+        EXPECT_EQ(materials[0]->getHash(), materials[2]->getHash());
+        EXPECT_EQ(materials[0]->getHash(), materials[5]->getHash());
+        EXPECT_EQ(materials[1]->getHash(), materials[4]->getHash());
+
+        std::vector<uint32_t> idMap;
+        size_t removed = pMaterialSystem->removeDuplicateMaterials(idMap);
+        EXPECT_EQ(removed, 3u);
+        EXPECT_EQ(pMaterialSystem->getMaterialCount(), 3u);
+
+        // The first occurrence of each material is kept, in the original order.
+        const std::vector<uint32_t> expectedIDs = { 0, 1, 0, 2, 1, 0 };
+        EXPECT_EQ(idMap.size(), expectedIDs.size());
+        for (size_t i = 0; i < expectedIDs.size(); i++) EXPECT_EQ(idMap[i], expectedIDs[i]) << "i = " << i;
+
+        EXPECT(pMaterialSystem->getMaterial(0) == materials[0]);
+        EXPECT(pMaterialSystem->getMaterial(1) == materials[1]);
+        EXPECT(pMaterialSystem->getMaterial(2) == materials[3]);
+
+        // The material lookup is updated after removing the duplicates.
+        EXPECT_EQ(pMaterialSystem->addMaterial(materials[3]), 2u);
+        EXPECT_EQ(pMaterialSystem->addMaterial(materials[2]), 3u);
+    }
+
+    GPU_TEST(MaterialSystemDirtyUpdates)
+    {
+        auto pMaterialSystem = MaterialSystem::create();
+
+        std::vector<StandardMaterial::SharedPtr> materials;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            materials.push_back(StandardMaterial::create("material" + std::to_string(i)));
+            pMaterialSystem->addMaterial(materials.back());
+        }
+
+        // The first update uploads all materials at once.
+        pMaterialSystem->update(false);
+        auto stats = pMaterialSystem->getUpdateStats();
+        EXPECT_EQ(stats.materialsScanned, 4u);
+        EXPECT_EQ(stats.uploadCount, 1u);
+        EXPECT_EQ(stats.bytesUploaded, 4 * sizeof(MaterialDataBlob));
+
+        // Without changes no materials are visited.
+        pMaterialSystem->update(false);
+        stats = pMaterialSystem->getUpdateStats();
+        EXPECT_EQ(stats.materialsScanned, 0u);
+        EXPECT_EQ(stats.bytesUploaded, 0u);
+
+        // Only the changed material is updated and uploaded.
+        materials[2]->setRoughness(0.25f);
+        auto flags = pMaterialSystem->update(false);
+        EXPECT(is_set(flags, Material::UpdateFlags::DataChanged));
+        stats = pMaterialSystem->getUpdateStats();
+        EXPECT_EQ(stats.materialsScanned, 1u);
+        EXPECT_EQ(stats.materialsChanged, 1u);
+        EXPECT_EQ(stats.materialsCoalesced, 0u);
+        EXPECT_EQ(stats.bytesUploaded, sizeof(MaterialDataBlob));
+
+        // Nearby changed materials are coalesced into a single upload.
+        materials[0]->setRoughness(0.25f);
+        materials[3]->setRoughness(0.25f);
+        materials[0]->setMetallic(1.f);
+        pMaterialSystem->update(false);
+        stats = pMaterialSystem->getUpdateStats();
+        EXPECT_EQ(stats.materialsScanned, 2u);
+        EXPECT_EQ(stats.materialsChanged, 2u);
+        EXPECT_EQ(stats.materialsCoalesced, 2u);
+        EXPECT_EQ(stats.uploadCount, 1u);
+    }
+}
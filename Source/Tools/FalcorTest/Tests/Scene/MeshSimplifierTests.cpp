@@ -0,0 +1,110 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshSimplifier.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kGridSize = 32;
+
+        // Triangulated grid of kGridSize x kGridSize quads. The vertices are placed by the given function of the grid coordinates in [0,1]^2.
+        template<typename F>
+        void createGrid(F&& getPosition, std::vector<float3>& positions, std::vector<uint32_t>& indices)
+        {
+            positions.clear();
+            indices.clear();
+            for (uint32_t y = 0; y <= kGridSize; y++)
+            {
+                for (uint32_t x = 0; x <= kGridSize; x++) positions.push_back(getPosition(x / (float)kGridSize, y / (float)kGridSize));
+            }
+            for (uint32_t y = 0; y < kGridSize; y++)
+            {
+                for (uint32_t x = 0; x < kGridSize; x++)
+                {
+                    uint32_t i = y * (kGridSize + 1) + x;
+                    uint32_t j = i + kGridSize + 1;
+                    indices.insert(indices.end(), { i, i + 1, j + 1, i, j + 1, j });
+                }
+            }
+        }
+
+        float computeArea(const std::vector<float3>& positions, const std::vector<uint32_t>& indices)
+        {
+            float area = 0.f;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const float3& p0 = positions[indices[i]];
+                area += 0.5f * glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0).z;
+            }
+            return area;
+        }
+    }
+
+    CPU_TEST(MeshSimplifierPlane)
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createGrid([](float u, float v) { return float3(u, v, 0.f); }, positions, indices);
+
+        // A plane simplifies without error down to a few triangles. The boundary and the orientation are preserved.
+        auto result = MeshSimplifier::simplify(positions, indices, 8);
+        EXPECT_LE(result.indices.size(), (size_t)(3 * 8));
+        EXPECT_EQ(result.indices.size() % 3, (size_t)0);
+        EXPECT_LE(result.error, 1e-5f);
+        EXPECT_LE(std::abs(computeArea(positions, result.indices) - 1.f), 1e-4f);
+        for (uint32_t index : result.indices) EXPECT_LT(index, (uint32_t)positions.size());
+
+        // Nothing is removed if the target is not below the triangle count.
+        result = MeshSimplifier::simplify(positions, indices, 2 * kGridSize * kGridSize);
+        EXPECT(result.indices == indices);
+        EXPECT_EQ(result.error, 0.f);
+    }
+
+    CPU_TEST(MeshSimplifierCurved)
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createGrid([](float u, float v) { return float3(u, v, 0.25f * std::sin(6.f * u)); }, positions, indices);
+
+        // The error grows as the triangle count is reduced.
+        auto fine = MeshSimplifier::simplify(positions, indices, 512);
+        auto coarse = MeshSimplifier::simplify(positions, indices, 64);
+        EXPECT_LE(fine.indices.size(), (size_t)(3 * 512));
+        EXPECT_LE(coarse.indices.size(), (size_t)(3 * 64));
+        EXPECT_GT(coarse.error, 0.f);
+        EXPECT_LE(fine.error, coarse.error);
+        EXPECT_LT(coarse.error, 0.25f);
+
+        // Collapses above the error bound are rejected.
+        auto bounded = MeshSimplifier::simplify(positions, indices, 64, 0.5f * coarse.error);
+        EXPECT_GT(bounded.indices.size(), coarse.indices.size());
+        EXPECT_LE(bounded.error, 0.5f * coarse.error);
+    }
+}
@@ -0,0 +1,197 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/USDImporter/PreviewSurfaceTexels.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kMaxError = 1e-5f;
+
+        uint8_t encode(float v)
+        {
+            return (uint8_t)(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f);
+        }
+
+        bool isClose(float4 a, float4 b)
+        {
+            return glm::all(glm::lessThanEqual(glm::abs(a - b), float4(kMaxError)));
+        }
+
+        SHA1::MD createKey(const std::string& str)
+        {
+            SHA1 sha1;
+            sha1.update(str.data(), str.size());
+            return sha1.final();
+        }
+    }
+
+    CPU_TEST(BitmapReaderLoad)
+    {
+        // BGRA8 is swizzled to RGBA.
+        const uint8_t bgra[] = { 10, 20, 30, 40 };
+        auto pBGRA = Bitmap::create(1, 1, ResourceFormat::BGRA8Unorm, bgra);
+        EXPECT(isClose(BitmapReader(*pBGRA, false).load(0, 0), float4(30.f, 20.f, 10.f, 40.f) / 255.f));
+
+        // Missing channels read as zero and alpha as one.
+        const uint8_t rg[] = { 51, 102, 153, 204 };
+        auto pRG = Bitmap::create(2, 1, ResourceFormat::RG8Unorm, rg);
+        EXPECT(isClose(BitmapReader(*pRG, false).load(1, 0), float4(0.6f, 0.8f, 0.f, 1.f)));
+
+        const float rgb[] = { 0.5f, 2.f, -1.f };
+        auto pRGB = Bitmap::create(1, 1, ResourceFormat::RGB32Float, reinterpret_cast<const uint8_t*>(rgb));
+        EXPECT(isClose(BitmapReader(*pRGB, false).load(0, 0), float4(0.5f, 2.f, -1.f, 1.f)));
+
+        const uint16_t r16[] = { 0, 65535 };
+        auto pR16 = Bitmap::create(1, 2, ResourceFormat::R16Unorm, reinterpret_cast<const uint8_t*>(r16));
+        BitmapReader r16Reader(*pR16, false);
+        EXPECT(r16Reader.getResolution() == uint2(1, 2));
+        EXPECT(isClose(r16Reader.load(0, 1), float4(1.f, 0.f, 0.f, 1.f)));
+    }
+
+    CPU_TEST(BitmapReaderSample)
+    {
+        // Sampling at the image resolution returns the texels. Upsampling is bilinear with clamp addressing.
+        const uint8_t r8[] = { 0, 255 };
+        auto pR8 = Bitmap::create(2, 1, ResourceFormat::R8Unorm, r8);
+        BitmapReader reader(*pR8, false);
+
+        EXPECT_EQ(reader.sample(uint2(0, 0), uint2(2, 1)).r, 0.f);
+        EXPECT_EQ(reader.sample(uint2(1, 0), uint2(2, 1)).r, 1.f);
+
+        const float expected[] = { 0.f, 0.25f, 0.75f, 1.f };
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            float4 v = reader.sample(uint2(x, 0), uint2(4, 2));
+            EXPECT_LE(std::abs(v.r - expected[x]), kMaxError) << "x = " << x;
+            EXPECT_EQ(v.a, 1.f);
+        }
+    }
+
+    CPU_TEST(BitmapReaderSrgb)
+    {
+        const uint8_t bgra[] = { 64, 128, 192, 128 };
+        auto pBGRA = Bitmap::create(1, 1, ResourceFormat::BGRA8Unorm, bgra);
+        float4 encoded = float4(192.f, 128.f, 64.f, 128.f) / 255.f;
+
+        // sRGB decoding applies to the color channels only.
+        EXPECT(isClose(BitmapReader(*pBGRA, false).load(0, 0), encoded));
+        EXPECT(isClose(BitmapReader(*pBGRA, true).load(0, 0), float4(sRGBToLinear(float3(encoded)), encoded.a)));
+
+        // Formats without an sRGB variant are always read as linear.
+        const uint8_t r8[] = { 128 };
+        auto pR8 = Bitmap::create(1, 1, ResourceFormat::R8Unorm, r8);
+        EXPECT_EQ(BitmapReader(*pR8, true).load(0, 0).r, 128.f / 255.f);
+    }
+
+    CPU_TEST(PreviewSurfaceTexels)
+    {
+        const uint8_t r8[] = { 0, 255 };
+        auto pR8 = Bitmap::create(2, 1, ResourceFormat::R8Unorm, r8);
+        BitmapReader r8Reader(*pR8, false);
+
+        const uint8_t one[] = { 255 };
+        auto pOne = Bitmap::create(1, 1, ResourceFormat::R8Unorm, one);
+        BitmapReader oneReader(*pOne, false);
+
+        // Specular transmission is one minus opacity.
+        uint2 resolution;
+        auto transmission = PreviewSurfaceTexels::createSpecularTransmission({ &r8Reader, 0 }, resolution);
+        EXPECT(resolution == uint2(2, 1));
+        EXPECT(transmission == std::vector<uint8_t>({ 255, 255, 255, 255, 0, 0, 0, 255 }));
+
+        // Roughness goes to green and metallic to blue. The output has the resolution of the largest image.
+        auto specular = PreviewSurfaceTexels::createSpecular({ &r8Reader, 0 }, { &oneReader, 0 }, resolution);
+        EXPECT(resolution == uint2(2, 1));
+        EXPECT(specular == std::vector<uint8_t>({ 0, 0, 255, 255, 0, 255, 255, 255 }));
+
+        specular = PreviewSurfaceTexels::createSpecular({ nullptr, -1, float4(0.25f, 0.f, 0.f, 1.f) }, { &r8Reader, 0 }, resolution);
+        EXPECT(resolution == uint2(2, 1));
+        EXPECT(specular == std::vector<uint8_t>({ 0, encode(0.25f), 0, 255, 0, encode(0.25f), 255, 255 }));
+
+        // Base color is encoded to sRGB and opacity is stored in alpha, read from the selected channel.
+        const uint8_t rg[] = { 0, 51, 0, 204 };
+        auto pRG = Bitmap::create(2, 1, ResourceFormat::RG8Unorm, rg);
+        BitmapReader rgReader(*pRG, false);
+        float3 baseColor(0.5f, 0.25f, 0.01f);
+        float3 srgb = linearToSRGB(baseColor);
+
+        auto packed = PreviewSurfaceTexels::packBaseColorAlpha({ nullptr, 0, float4(baseColor, 1.f) }, { &rgReader, 1 }, resolution);
+        EXPECT(resolution == uint2(2, 1));
+        EXPECT(packed == std::vector<uint8_t>({ encode(srgb.r), encode(srgb.g), encode(srgb.b), 51, encode(srgb.r), encode(srgb.g), encode(srgb.b), 204 }));
+
+        // Without images there is nothing to convert.
+        packed = PreviewSurfaceTexels::packBaseColorAlpha({ nullptr, 0, float4(baseColor, 1.f) }, { nullptr, -1, float4(1.f) }, resolution);
+        EXPECT(resolution == uint2(0));
+        EXPECT(packed.empty());
+    }
+
+    // Runs serially because it toggles the process-wide enabled flag of the cache.
+    CPU_TEST_SERIAL(PreviewSurfaceTexelCacheRoundtrip)
+    {
+        // Use a temporary cache directory to keep the test entries out of the user's cache.
+        std::filesystem::path cacheDirectory = std::filesystem::temp_directory_path() / fmt::format("FalcorPreviewSurfaceTexelCacheTest.{}", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        std::error_code ec;
+        std::filesystem::remove_all(cacheDirectory, ec);
+
+        auto key = createKey("texels");
+        uint2 resolution(3, 2);
+        std::vector<uint8_t> data((size_t)resolution.x * resolution.y * 4);
+        for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)(i * 11);
+
+        uint2 cachedResolution;
+        std::vector<uint8_t> cachedData;
+        EXPECT(!PreviewSurfaceTexelCache::read(key, cachedResolution, cachedData, cacheDirectory));
+
+        PreviewSurfaceTexelCache::write(key, resolution, data, cacheDirectory);
+        EXPECT(PreviewSurfaceTexelCache::read(key, cachedResolution, cachedData, cacheDirectory));
+        EXPECT(cachedResolution == resolution);
+        EXPECT(cachedData == data);
+        EXPECT(!PreviewSurfaceTexelCache::read(createKey("other"), cachedResolution, cachedData, cacheDirectory));
+
+        // Truncated files are rejected.
+        for (const auto& entry : std::filesystem::directory_iterator(cacheDirectory))
+        {
+            std::filesystem::resize_file(entry.path(), 20, ec);
+        }
+        EXPECT(!PreviewSurfaceTexelCache::read(key, cachedResolution, cachedData, cacheDirectory));
+
+        std::filesystem::remove_all(cacheDirectory, ec);
+
+        // The cache can be disabled.
+        bool enabled = PreviewSurfaceTexelCache::isEnabled();
+        PreviewSurfaceTexelCache::setEnabled(false);
+        EXPECT(!PreviewSurfaceTexelCache::isEnabled());
+        PreviewSurfaceTexelCache::setEnabled(true);
+        EXPECT(PreviewSurfaceTexelCache::isEnabled());
+        PreviewSurfaceTexelCache::setEnabled(enabled);
+    }
+}
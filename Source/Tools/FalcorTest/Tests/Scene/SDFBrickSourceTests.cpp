@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFBrickSource.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kGridWidth = 16;
+        const uint32_t kBrickWidth = 4;
+
+        float evalSphere(const uint3& gridCoords)
+        {
+            float3 pLocal = float3(gridCoords) / float(kGridWidth) - 0.5f;
+            return glm::length(pLocal - float3(0.1f, 0.0f, -0.05f)) - 0.3f;
+        }
+
+        int8_t quantize(float value, float normalizationMultiplier)
+        {
+            float integerScale = glm::clamp(value * normalizationMultiplier, -1.0f, 1.0f) * float(INT8_MAX);
+            return integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+        }
+    }
+
+    CPU_TEST(SDFBrickFileRoundTrip)
+    {
+        const uint32_t gridWidthInValues = kGridWidth + 1;
+        std::vector<float> values(gridWidthInValues * gridWidthInValues * gridWidthInValues);
+        for (uint32_t z = 0; z < gridWidthInValues; z++)
+            for (uint32_t y = 0; y < gridWidthInValues; y++)
+                for (uint32_t x = 0; x < gridWidthInValues; x++)
+                    values[x + gridWidthInValues * (y + gridWidthInValues * z)] = evalSphere(uint3(x, y, z));
+
+        std::filesystem::path densePath = std::filesystem::temp_directory_path() / "SDFBrickFileRoundTrip.sdfg";
+        std::filesystem::path sparsePath = std::filesystem::temp_directory_path() / "SDFBrickFileRoundTrip.sdfb";
+        {
+            std::ofstream file(densePath, std::ios::out | std::ios::binary);
+            file.write(reinterpret_cast<const char*>(&kGridWidth), sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+        }
+
+        EXPECT(SDFBrickFile::convertDenseFile(densePath, sparsePath, kBrickWidth));
+
+        SDFBrickFile::SharedPtr pFile = SDFBrickFile::open(sparsePath);
+        EXPECT(pFile != nullptr);
+        if (!pFile) return;
+
+        const uint32_t bricksPerAxis = kGridWidth / kBrickWidth;
+        EXPECT_EQ(pFile->getGridWidth(), kGridWidth);
+        EXPECT_EQ(pFile->getBrickWidth(), kBrickWidth);
+        EXPECT_EQ(pFile->getBricksPerAxis(), bricksPerAxis);
+        EXPECT_GT(pFile->getBrickCount(), 0u);
+        EXPECT_LT(pFile->getBrickCount(), bricksPerAxis * bricksPerAxis * bricksPerAxis);
+
+        // Brick values must match the dense grid exactly.
+        std::vector<uint3> brickCoords;
+        std::vector<float> brickValues;
+        std::set<uint32_t> storedBricks;
+        while (uint32_t brickCount = pFile->readBricks(3, brickCoords, brickValues))
+        {
+            for (uint32_t b = 0; b < brickCount; b++)
+            {
+                storedBricks.insert(brickCoords[b].x + bricksPerAxis * (brickCoords[b].y + bricksPerAxis * brickCoords[b].z));
+                const uint32_t w = kBrickWidth + 1;
+                for (uint32_t i = 0; i < w * w * w; i++)
+                {
+                    uint3 gridCoords = brickCoords[b] * kBrickWidth + uint3(i % w, (i / w) % w, i / (w * w));
+                    EXPECT_EQ(brickValues[b * w * w * w + i], evalSphere(gridCoords));
+                }
+            }
+        }
+        EXPECT_EQ(storedBricks.size(), (size_t)pFile->getBrickCount());
+
+        // Quantized reconstruction must match the dense grid inside stored bricks and have the correct sign elsewhere.
+        const float normalizationMultiplier = 2.0f * kGridWidth / glm::root_three<float>();
+        SDFQuantizedBricks bricks(*pFile, normalizationMultiplier);
+        EXPECT_EQ(bricks.getBrickCount(), pFile->getBrickCount());
+
+        for (uint32_t z = 0; z < gridWidthInValues; z++)
+        {
+            for (uint32_t y = 0; y < gridWidthInValues; y++)
+            {
+                for (uint32_t x = 0; x < gridWidthInValues; x++)
+                {
+                    uint3 gridCoords(x, y, z);
+                    uint3 brick = glm::min(gridCoords / kBrickWidth, uint3(bricksPerAxis - 1));
+                    int8_t expected = quantize(evalSphere(gridCoords), normalizationMultiplier);
+                    int8_t value = bricks.getValue(gridCoords);
+
+                    if (storedBricks.count(brick.x + bricksPerAxis * (brick.y + bricksPerAxis * brick.z)))
+                    {
+                        EXPECT_EQ((int)value, (int)expected) << "gridCoords = " << to_string(gridCoords);
+                    }
+                    else
+                    {
+                        EXPECT_EQ(value < 0, expected < 0) << "gridCoords = " << to_string(gridCoords);
+                    }
+                }
+            }
+        }
+
+        pFile.reset();
+        std::filesystem::remove(densePath);
+        std::filesystem::remove(sparsePath);
+    }
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneUploadQueue.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // Tiny chunks so that the uploads are split over chunks and the ring is reused within a flush.
+        const size_t kChunkSize = 256;
+        const uint32_t kChunkCount = 2;
+
+        std::vector<uint8_t> createData(size_t size, uint8_t seed)
+        {
+            std::vector<uint8_t> data(size);
+            for (size_t i = 0; i < size; i++) data[i] = (uint8_t)(seed + i * 7);
+            return data;
+        }
+
+        Buffer::SharedPtr createBuffer(size_t size)
+        {
+            std::vector<uint8_t> zeros(size, 0);
+            return Buffer::create(size, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, zeros.data());
+        }
+
+        void expectContents(GPUUnitTestContext& ctx, const Buffer::SharedPtr& pBuffer, const std::vector<uint8_t>& expected)
+        {
+            const uint8_t* pData = static_cast<const uint8_t*>(pBuffer->map(Buffer::MapType::Read));
+            auto mismatch = std::mismatch(expected.begin(), expected.end(), pData);
+            EXPECT(mismatch.first == expected.end()) << "first mismatch at byte " << std::distance(expected.begin(), mismatch.first);
+            pBuffer->unmap();
+        }
+    }
+
+    GPU_TEST(SceneUploadQueue)
+    {
+        RenderContext* pRenderContext = ctx.getRenderContext();
+        SceneUploadQueue queue(kChunkSize, kChunkCount);
+        EXPECT(queue.isEmpty());
+
+        auto pBufferA = createBuffer(1024);
+        auto pBufferB = createBuffer(64);
+        auto pBufferC = createBuffer(300);
+        std::vector<uint8_t> expectedA(1024, 0), expectedB(64, 0), expectedC(300, 0);
+
+        // Two adjacent uploads that exactly fill a chunk are coalesced into one copy.
+        // The third upload doesn't fit and is copied from the next chunk.
+        auto dataA = createData(1024, 1);
+        queue.upload(pBufferA, dataA.data(), 0, 100);
+        queue.upload(pBufferA, dataA.data() + 100, 100, 156);
+        queue.upload(pBufferA, dataA.data() + 512, 512, 64);
+        EXPECT(!queue.isEmpty());
+        queue.flush(pRenderContext, true);
+        EXPECT(queue.isEmpty());
+        std::copy(dataA.begin(), dataA.begin() + 256, expectedA.begin());
+        std::copy(dataA.begin() + 512, dataA.begin() + 576, expectedA.begin() + 512);
+
+        EXPECT_EQ(queue.getStats().uploadCount, 3ull);
+        EXPECT_EQ(queue.getStats().copyCount, 2ull);
+        EXPECT_EQ(queue.getStats().bytesUploaded, 320ull);
+        expectContents(ctx, pBufferA, expectedA);
+
+        // An upload larger than a chunk is split into one copy per chunk. The source of uploadCopy() can go away right after the call.
+        // Whichever buffer is staged first, the 364 bytes span two chunks with one split, which gives three copies.
+        auto dataC = createData(300, 2);
+        queue.upload(pBufferC, dataC.data(), 0, 300);
+        {
+            auto dataB = createData(64, 3);
+            queue.uploadCopy(pBufferB, dataB.data(), 0, 64);
+            expectedB = dataB;
+        }
+        queue.flush(pRenderContext, true);
+        expectedC = dataC;
+
+        EXPECT_EQ(queue.getStats().uploadCount, 5ull);
+        EXPECT_EQ(queue.getStats().copyCount, 5ull);
+        EXPECT_EQ(queue.getStats().bytesUploaded, 684ull);
+        expectContents(ctx, pBufferB, expectedB);
+        expectContents(ctx, pBufferC, expectedC);
+
+        // Overlapping uploads to the same buffer are applied in the order they were recorded.
+        auto dataFirst = createData(16, 4);
+        auto dataSecond = createData(16, 5);
+        queue.upload(pBufferB, dataFirst.data(), 8, 16);
+        queue.upload(pBufferB, dataSecond.data(), 8, 16);
+        queue.flush(pRenderContext, true);
+        std::copy(dataSecond.begin(), dataSecond.end(), expectedB.begin() + 8);
+
+        EXPECT_EQ(queue.getStats().uploadCount, 7ull);
+        EXPECT_EQ(queue.getStats().copyCount, 7ull);
+        EXPECT_EQ(queue.getStats().bytesUploaded, 716ull);
+        expectContents(ctx, pBufferB, expectedB);
+    }
+}
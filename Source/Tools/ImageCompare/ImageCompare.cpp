@@ -27,8 +27,11 @@
  **************************************************************************/
 #include <FreeImage.h>
 #include <args.hxx>
+#include <emmintrin.h>
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,6 +39,12 @@
 #include <map>
 #include <functional>
 #include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <atomic>
+#include <thread>
+#include <cmath>
 
 template<typename T>
 T sqr(T x) { return x * x; }
@@ -46,6 +55,16 @@ T lerp(T a, T b, T t) { return a + t * (b - a); }
 template<typename T>
 T clamp(T x, T lo, T hi) { return std::max(lo, std::min(hi, x)); }
 
+/** Run a function for every row of an image in parallel.
+*/
+template<typename Func>
+void parallelForRows(uint32_t height, Func func)
+{
+    std::vector<uint32_t> rows(height);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::for_each(std::execution::par, rows.begin(), rows.end(), func);
+}
+
 class Image
 {
 public:
@@ -56,6 +75,10 @@ public:
     const float* getData() const { return mData.get(); }
     float* getData() { return mData.get(); }
 
+    /** Returns true if the image was loaded from an 8-bit per channel file, i.e. the data is sRGB encoded.
+    */
+    bool isSrgb() const { return mSrgb; }
+
     static SharedPtr create(uint32_t width, uint32_t height) { return SharedPtr(new Image(width, height)); }
 
     static SharedPtr loadFromFile(const std::filesystem::path& path)
@@ -73,6 +96,7 @@ public:
         // Read image.
         FIBITMAP* srcBitmap = FreeImage_Load(fifFormat, pathStr.c_str());
         if (!srcBitmap) throw std::runtime_error("Cannot read image");
+        bool srgb = FreeImage_GetImageType(srcBitmap) == FIT_BITMAP;
 
         // Convert to RGBA32F.
         FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
@@ -81,6 +105,7 @@ public:
 
         // Create image.
         auto image = create(FreeImage_GetWidth(floatBitmap), FreeImage_GetHeight(floatBitmap));
+        image->mSrgb = srgb;
         int bytesPerPixel = 4 * sizeof(float);
         FreeImage_ConvertToRawBits(reinterpret_cast<BYTE*>(image->getData()), floatBitmap, bytesPerPixel * image->getWidth(), bytesPerPixel * 8, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true);
         FreeImage_Unload(floatBitmap);
@@ -155,79 +180,405 @@ public:
 private:
     uint32_t mWidth;
     uint32_t mHeight;
+    bool mSrgb = false;
     std::unique_ptr<float[]> mData;
 
     Image(uint32_t width, uint32_t height)
         : mWidth(width)
         , mHeight(height)
-        , mData(std::make_unique<float[]>(width * height * 4))
+        , mData(std::make_unique<float[]>(size_t(width) * height * 4))
     {}
 };
 
+struct CompareOptions
+{
+    bool alpha = false;                 ///< Include alpha channel (not used by FLIP).
+    float pixelsPerDegree = 67.0206f;   ///< FLIP viewing conditions. Default matches FLIPPass (3840 pixels on a 0.7 m wide monitor at 0.7 m distance).
+};
+
+// Per-channel error kernels. Each kernel evaluates all four channels of an RGBA pixel at once.
+
 struct MSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 1.0;
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += sqr(a[i] - b[i]); }
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_mul_ps(d, d);
     }
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 1.0;
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3); }
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_div_ps(_mm_mul_ps(d, d), _mm_add_ps(_mm_mul_ps(a, a), _mm_set1_ps(1e-3f)));
     }
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 1.0;
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += std::fabs(sqr(a[i] - b[i])); }
-        return error / count;
+        return _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(a, b));
     }
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 100.0;
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3)); }
-        return 100.0 * error / count;
+        __m128 d = _mm_div_ps(_mm_sub_ps(a, b), _mm_add_ps(a, _mm_set1_ps(1e-3f)));
+        return _mm_andnot_ps(_mm_set1_ps(-0.f), d);
     }
 };
 
+inline float horizontalSum(__m128 v)
+{
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
 template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+double compare(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)
 {
-    Metric metric;
-    double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
-    {
-        double error = metric(a, b, alpha ? 4 : 3);
-        if (errorMap) *errorMap++ = float(error);
-        sum += error;
-        a += 4;
-        b += 4;
-    }
-    return sum / count;
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+    const uint32_t channels = options.alpha ? 4 : 3;
+    const float invChannels = 1.f / channels;
+    const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(options.alpha ? -1 : 0, -1, -1, -1));
+
+    // Rows are summed in double precision and reduced in order, so the result does not depend on the thread count.
+    std::vector<double> rowSums(height);
+    parallelForRows(height, [&](uint32_t y)
+    {
+        const float* a = imageA.getData() + size_t(y) * width * 4;
+        const float* b = imageB.getData() + size_t(y) * width * 4;
+        float* rowErrors = errorMap ? errorMap + size_t(y) * width : nullptr;
+
+        __m128d sumLo = _mm_setzero_pd();
+        __m128d sumHi = _mm_setzero_pd();
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            __m128 error = _mm_and_ps(Metric::eval(_mm_loadu_ps(a), _mm_loadu_ps(b)), mask);
+            sumLo = _mm_add_pd(sumLo, _mm_cvtps_pd(error));
+            sumHi = _mm_add_pd(sumHi, _mm_cvtps_pd(_mm_movehl_ps(error, error)));
+            if (rowErrors) rowErrors[x] = float(Metric::kScale * horizontalSum(error) * invChannels);
+            a += 4;
+            b += 4;
+        }
+
+        __m128d sum = _mm_add_pd(sumLo, sumHi);
+        rowSums[y] = _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    });
+
+    double sum = std::accumulate(rowSums.begin(), rowSums.end(), 0.0);
+    return Metric::kScale * sum / (double(width) * height * channels);
+}
+
+/** CPU implementation of LDR-FLIP matching the FLIPPass render pass (with input clamping enabled).
+    The CSF and feature detection kernels of FLIP are separable (sums of) Gaussians, so instead of evaluating the full 2D kernel
+    per pixel as the shader does, images are filtered with a horizontal and a vertical pass over bands of rows.
+*/
+namespace flip
+{
+    struct float3 { float x, y, z; };
+
+    const float kPi = 3.141592653f;
+    const float kInvSqrt2 = 0.70710678f;
+    const float kQc = 0.7f;
+    const float kPc = 0.4f;
+    const float kPt = 0.95f;
+    const float kW = 0.082f;
+    const float kQf = 0.5f;
+    const float3 kInvD65 = { 1.052156925f, 1.000000000f, 0.918357670f };
+    const float3 kD65 = { 0.950428545f, 1.000000000f, 1.088900371f };
+    const uint32_t kBandHeight = 32;
+
+    inline float sRGB2Linear(float c) { return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f); }
+
+    inline float3 linearRGB2XYZ(float3 c)
+    {
+        return {
+            (10135552.f / 24577794.f) * c.x + (8788810.f / 24577794.f) * c.y + (4435075.f / 24577794.f) * c.z,
+            (2613072.f / 12288897.f) * c.x + (8788810.f / 12288897.f) * c.y + (887015.f / 12288897.f) * c.z,
+            (1425312.f / 73733382.f) * c.x + (8788810.f / 73733382.f) * c.y + (70074185.f / 73733382.f) * c.z,
+        };
+    }
+
+    inline float3 XYZ2LinearRGB(float3 c)
+    {
+        return {
+            3.241003275f * c.x - 1.537398934f * c.y - 0.498615861f * c.z,
+            -0.969224334f * c.x + 1.875930071f * c.y + 0.041554224f * c.z,
+            0.055639423f * c.x - 0.204011202f * c.y + 1.057148933f * c.z,
+        };
+    }
+
+    inline float3 XYZ2YCxCz(float3 c)
+    {
+        c = { c.x * kInvD65.x, c.y * kInvD65.y, c.z * kInvD65.z };
+        return { 116.f * c.y - 16.f, 500.f * (c.x - c.y), 200.f * (c.y - c.z) };
+    }
+
+    inline float3 YCxCz2XYZ(float3 c)
+    {
+        float y = (c.x + 16.f) / 116.f;
+        float x = c.y / 500.f + y;
+        float z = y - c.z / 200.f;
+        return { x * kD65.x, y * kD65.y, z * kD65.z };
+    }
+
+    inline float3 XYZ2CIELab(float3 c)
+    {
+        const float delta = 6.f / 29.f;
+        const float deltaCube = delta * delta * delta;
+        const float factor = 1.f / (3.f * delta * delta);
+        const float term = 4.f / 29.f;
+        auto f = [&](float v) { return v > deltaCube ? std::pow(v, 1.f / 3.f) : factor * v + term; };
+        c = { f(c.x * kInvD65.x), f(c.y * kInvD65.y), f(c.z * kInvD65.z) };
+        return { 116.f * c.y - 16.f, 500.f * (c.x - c.y), 200.f * (c.y - c.z) };
+    }
+
+    inline float3 hunt(float3 c)
+    {
+        float h = 0.01f * c.x;
+        return { c.x, h * c.y, h * c.z };
+    }
+
+    inline float hyAB(float3 a, float3 b)
+    {
+        return std::abs(a.x - b.x) + std::sqrt(sqr(a.y - b.y) + sqr(a.z - b.z));
+    }
+
+    inline float3 linearRGB2HuntLab(float3 c)
+    {
+        c = { clamp(c.x, 0.f, 1.f), clamp(c.y, 0.f, 1.f), clamp(c.z, 0.f, 1.f) };
+        return hunt(XYZ2CIELab(linearRGB2XYZ(c)));
+    }
+
+    inline float redistributeErrors(float colorDifference, float featureDifference, float maxDistance)
+    {
+        float error = std::pow(colorDifference, kQc);
+        float perceptualCutoff = kPc * maxDistance;
+        if (error < perceptualCutoff) error *= kPt / perceptualCutoff;
+        else error = kPt + ((error - perceptualCutoff) / (maxDistance - perceptualCutoff)) * (1.f - kPt);
+        return std::pow(error, 1.f - featureDifference);
+    }
+
+    /** Filter kernels for a given viewing condition.
+        The 2D CSF weight a * sqrt(pi / b) * exp(-pi^2 * |p|^2 / b) and the Gaussian derivative feature weights factor into 1D weights.
+    */
+    struct Kernels
+    {
+        int radius;
+        std::vector<float> csfA, csfRG, csfBY1, csfBY2;     ///< 1D CSF Gaussians.
+        float normA, normRG, scaleBY1, scaleBY2, normBY;    ///< 2D CSF normalization.
+        std::vector<float> gauss, point, edge;              ///< 1D feature detection weights, point and edge are normalized.
+
+        explicit Kernels(float pixelsPerDegree)
+        {
+            const float dx = 1.f / pixelsPerDegree;
+            radius = int(std::ceil(3.f * std::sqrt(0.04f / (2.f * kPi * kPi)) * pixelsPerDegree));
+            const size_t size = 2 * radius + 1;
+
+            auto csf = [&](float b)
+            {
+                std::vector<float> w(size);
+                for (int i = -radius; i <= radius; i++) w[i + radius] = std::exp(-sqr(i * dx) * kPi * kPi / b);
+                return w;
+            };
+            auto sum = [](const std::vector<float>& w) { return std::accumulate(w.begin(), w.end(), 0.f); };
+
+            // a1, a2, b1, b2 for A and RG are { 1, 0, 0.0047, 1e-5 } and { 1, 0, 0.0053, 1e-5 }, for BY { 34.1, 13.5, 0.04, 0.025 }.
+            csfA = csf(0.0047f);
+            csfRG = csf(0.0053f);
+            csfBY1 = csf(0.04f);
+            csfBY2 = csf(0.025f);
+            normA = sqr(sum(csfA));
+            normRG = sqr(sum(csfRG));
+            scaleBY1 = 34.1f * std::sqrt(kPi / 0.04f);
+            scaleBY2 = 13.5f * std::sqrt(kPi / 0.025f);
+            normBY = scaleBY1 * sqr(sum(csfBY1)) + scaleBY2 * sqr(sum(csfBY2));
+
+            const float sigma = 0.5f * kW * pixelsPerDegree;
+            const float sigmaSquared = sigma * sigma;
+            gauss.resize(size);
+            point.resize(size);
+            edge.resize(size);
+            for (int i = -radius; i <= radius; i++)
+            {
+                gauss[i + radius] = std::exp(-float(i * i) / (2.f * sigmaSquared));
+                point[i + radius] = (float(i * i) / sigmaSquared - 1.f) * gauss[i + radius];
+                edge[i + radius] = -float(i) * gauss[i + radius];
+            }
+
+            // Kernel sums over the 2D window.
+            float positiveSum = 0.f, negativeSum = 0.f, edgeSum = 0.f;
+            const float gaussSum = sum(gauss);
+            for (size_t i = 0; i < size; i++)
+            {
+                if (point[i] >= 0.f) positiveSum += point[i] * gaussSum;
+                else negativeSum -= point[i] * gaussSum;
+                if (edge[i] >= 0.f) edgeSum += edge[i] * gaussSum;
+            }
+            for (size_t i = 0; i < size; i++)
+            {
+                point[i] /= point[i] >= 0.f ? positiveSum : negativeSum;
+                edge[i] /= edgeSum;
+            }
+        }
+    };
+
+    // Channels produced by the horizontal pass.
+    enum Channel { kA, kRG, kBY1, kBY2, kPointX, kEdgeX, kGauss, kChannelCount };
+
+    /** Convert a row of an image to YCxCz and filter it horizontally.
+        \param[out] dst kChannelCount planes of width floats each.
+    */
+    inline void filterRow(const Image& image, uint32_t y, const Kernels& k, std::vector<float3>& ycxcz, float* dst)
+    {
+        const uint32_t width = image.getWidth();
+        const float* src = image.getData() + size_t(y) * width * 4;
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float3 c = { clamp(src[4 * x], 0.f, 1.f), clamp(src[4 * x + 1], 0.f, 1.f), clamp(src[4 * x + 2], 0.f, 1.f) };
+            if (image.isSrgb()) c = { sRGB2Linear(c.x), sRGB2Linear(c.y), sRGB2Linear(c.z) };
+            ycxcz[x] = XYZ2YCxCz(linearRGB2XYZ(c));
+        }
+
+        const int r = k.radius;
+        for (int x = 0; x < int(width); x++)
+        {
+            float sum[kChannelCount] = {};
+            for (int i = -r; i <= r; i++)
+            {
+                const float3& c = ycxcz[clamp(x + i, 0, int(width) - 1)];
+                const float luminance = (c.x + 16.f) / 116.f;
+                const size_t j = i + r;
+                sum[kA] += k.csfA[j] * c.x;
+                sum[kRG] += k.csfRG[j] * c.y;
+                sum[kBY1] += k.csfBY1[j] * c.z;
+                sum[kBY2] += k.csfBY2[j] * c.z;
+                sum[kPointX] += k.point[j] * luminance;
+                sum[kEdgeX] += k.edge[j] * luminance;
+                sum[kGauss] += k.gauss[j] * luminance;
+            }
+            for (int ch = 0; ch < kChannelCount; ch++) dst[ch * width + x] = sum[ch];
+        }
+    }
+
+    struct Filtered
+    {
+        float3 color;
+        float pointGradient;
+        float edgeGradient;
+    };
+
+    /** Filter the horizontally filtered rows vertically for one pixel.
+        \param[in] rows Pointers to the horizontally filtered rows y - radius ... y + radius.
+    */
+    inline Filtered filterColumn(const float* const* rows, uint32_t width, uint32_t x, const Kernels& k)
+    {
+        float sum[kChannelCount] = {};
+        float pointY = 0.f, edgeY = 0.f;
+        for (int j = 0; j <= 2 * k.radius; j++)
+        {
+            const float* row = rows[j];
+            sum[kA] += k.csfA[j] * row[kA * width + x];
+            sum[kRG] += k.csfRG[j] * row[kRG * width + x];
+            sum[kBY1] += k.csfBY1[j] * row[kBY1 * width + x];
+            sum[kBY2] += k.csfBY2[j] * row[kBY2 * width + x];
+            sum[kPointX] += k.gauss[j] * row[kPointX * width + x];
+            sum[kEdgeX] += k.gauss[j] * row[kEdgeX * width + x];
+            pointY += k.point[j] * row[kGauss * width + x];
+            edgeY += k.edge[j] * row[kGauss * width + x];
+        }
+
+        Filtered f;
+        f.color = { sum[kA] / k.normA, sum[kRG] / k.normRG, (k.scaleBY1 * sum[kBY1] + k.scaleBY2 * sum[kBY2]) / k.normBY };
+        f.pointGradient = std::sqrt(sqr(sum[kPointX]) + sqr(pointY));
+        f.edgeGradient = std::sqrt(sqr(sum[kEdgeX]) + sqr(edgeY));
+        return f;
+    }
 }
 
+struct FLIP
+{
+    static double compare(const Image& reference, const Image& test, const CompareOptions& options, float* errorMap)
+    {
+        using namespace flip;
+
+        const uint32_t width = reference.getWidth();
+        const uint32_t height = reference.getHeight();
+        const Kernels k(options.pixelsPerDegree);
+        const int r = k.radius;
+        const size_t rowSize = size_t(kChannelCount) * width;
+        const float maxDistance = std::pow(hyAB(linearRGB2HuntLab({ 0.f, 1.f, 0.f }), linearRGB2HuntLab({ 0.f, 0.f, 1.f })), kQc);
+
+        // Process bands of rows in parallel. Each band filters the rows it needs horizontally, including an apron of radius rows.
+        const uint32_t bandCount = (height + kBandHeight - 1) / kBandHeight;
+        std::vector<double> bandSums(bandCount);
+        parallelForRows(bandCount, [&](uint32_t band)
+        {
+            const int y0 = int(band * kBandHeight);
+            const int y1 = std::min(y0 + int(kBandHeight), int(height));
+            const int rowCount = y1 - y0 + 2 * r;
+
+            std::vector<float3> ycxcz(width);
+            std::vector<float> refRows(rowCount * rowSize);
+            std::vector<float> testRows(rowCount * rowSize);
+            for (int i = 0; i < rowCount; i++)
+            {
+                uint32_t y = uint32_t(clamp(y0 - r + i, 0, int(height) - 1));
+                filterRow(reference, y, k, ycxcz, refRows.data() + i * rowSize);
+                filterRow(test, y, k, ycxcz, testRows.data() + i * rowSize);
+            }
+
+            std::vector<const float*> refWindow(2 * r + 1), testWindow(2 * r + 1);
+            double sum = 0.0;
+            for (int y = y0; y < y1; y++)
+            {
+                for (int j = 0; j <= 2 * r; j++)
+                {
+                    refWindow[j] = refRows.data() + (y - y0 + j) * rowSize;
+                    testWindow[j] = testRows.data() + (y - y0 + j) * rowSize;
+                }
+
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    Filtered ref = filterColumn(refWindow.data(), width, x, k);
+                    Filtered tst = filterColumn(testWindow.data(), width, x, k);
+
+                    float colorDifference = hyAB(linearRGB2HuntLab(XYZ2LinearRGB(YCxCz2XYZ(ref.color))), linearRGB2HuntLab(XYZ2LinearRGB(YCxCz2XYZ(tst.color))));
+                    float edgeDifference = std::abs(ref.edgeGradient - tst.edgeGradient);
+                    float pointDifference = std::abs(ref.pointGradient - tst.pointGradient);
+                    float featureDifference = std::pow(std::max(pointDifference, edgeDifference) * kInvSqrt2, kQf);
+                    float value = redistributeErrors(colorDifference, featureDifference, maxDistance);
+
+                    if (errorMap) errorMap[size_t(y) * width + x] = value;
+                    sum += value;
+                }
+            }
+            bandSums[band] = sum;
+        });
+
+        return std::accumulate(bandSums.begin(), bandSums.end(), 0.0) / (double(width) * height);
+    }
+};
+
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    std::function<double(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)> compare;
 };
 
 static const std::vector<ErrorMetric> errorMetrics =
@@ -236,6 +587,7 @@ static const std::vector<ErrorMetric> errorMetrics =
     { "rmse", "Relative Mean Squared Error", compare<RMSE> },
     { "mae", "Mean Absolute Error", compare<MAE> },
     { "mape", "Mean Absolute Percentage Error", compare<MAPE> },
+    { "flip", "Mean LDR-FLIP error (first image is the reference)", FLIP::compare },
 };
 
 static Image::SharedPtr generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
@@ -255,11 +607,12 @@ static Image::SharedPtr generateHeatMap(uint32_t width, uint32_t height, const f
         *dst++ = 1.f;
     };
 
-    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + width * height);
+    const size_t pixelCount = size_t(width) * height;
+    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + pixelCount);
     const float range = std::max(1e-5f, *maxValue - *minValue);
     auto image = Image::create(width, height);
     float* dst = image->getData();
-    for (size_t i = 0; i < width * height; ++i)
+    for (size_t i = 0; i < pixelCount; ++i)
     {
         float t = clamp((errorMap[i] - *minValue) / range, 0.f, 1.f);
         writeColor(t, dst);
@@ -269,9 +622,26 @@ static Image::SharedPtr generateHeatMap(uint32_t width, uint32_t height, const f
     return image;
 }
 
-static bool compareImages(const std::filesystem::path& pathA, const std::filesystem::path& pathB, ErrorMetric metric, float threshold, bool alpha, const std::filesystem::path& heatMapPath)
+struct ComparePair
+{
+    std::filesystem::path pathA;
+    std::filesystem::path pathB;
+    std::filesystem::path heatMapPath;
+};
+
+struct CompareResult
 {
-    auto loadImage = [] (const std::filesystem::path& path)
+    bool success = false;
+    bool compared = false;  ///< True if the images were compared and error is valid.
+    double error = 0.0;
+    std::string message;    ///< Reason the images could not be compared.
+};
+
+static CompareResult compareImages(const ComparePair& pair, const ErrorMetric& metric, float threshold, const CompareOptions& options)
+{
+    CompareResult result;
+
+    auto loadImage = [&result] (const std::filesystem::path& path)
     {
         try
         {
@@ -279,7 +649,7 @@ static bool compareImages(const std::filesystem::path& pathA, const std::filesys
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.message = "Cannot load image from '" + path.string() + "' (Error: " + e.what() + ").";
             return Image::SharedPtr();
         }
     };
@@ -297,38 +667,200 @@ static bool compareImages(const std::filesystem::path& pathA, const std::filesys
     };
 
     // Load images.
-    auto imageA = loadImage(pathA);
-    if (!imageA) return false;
-    auto imageB = loadImage(pathB);
-    if (!imageB) return false;
+    auto imageA = loadImage(pair.pathA);
+    if (!imageA) return result;
+    auto imageB = loadImage(pair.pathB);
+    if (!imageB) return result;
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.message = "Cannot compare images with different resolutions.";
+        return result;
     }
 
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap = pair.heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    result.error = metric.compare(*imageA, *imageB, options, errorMap.get());
+    result.compared = true;
 
     // Generate heat map.
     if (errorMap)
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
-        saveImage(*heatMap, heatMapPath);
+        saveImage(*heatMap, pair.heatMapPath);
     }
 
-    std::cout << error << std::endl;
-
     // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error)) return false;
+    result.success = !std::isnan(result.error) && !std::isinf(result.error) && result.error <= threshold;
+    return result;
+}
+
+static bool isImageFile(const std::filesystem::path& path)
+{
+    static const std::vector<std::string> kExtensions = { ".png", ".exr", ".jpg", ".jpeg", ".bmp", ".tga", ".pfm", ".hdr" };
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [] (char c) { return char(std::tolower(c)); });
+    return std::find(kExtensions.begin(), kExtensions.end(), ext) != kExtensions.end();
+}
+
+/** Collect image pairs with the same relative path in two directories (recursively).
+    Images that only exist in one of the directories are reported in missing.
+*/
+static std::vector<ComparePair> collectDirectoryPairs(const std::filesystem::path& dirA, const std::filesystem::path& dirB, const std::string& heatMapSuffix, std::vector<std::string>& missing)
+{
+    auto collect = [&heatMapSuffix] (const std::filesystem::path& dir)
+    {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+        {
+            if (!entry.is_regular_file() || !isImageFile(entry.path())) continue;
+            auto relative = entry.path().lexically_relative(dir);
+            auto name = relative.string();
+            if (!heatMapSuffix.empty() && name.size() >= heatMapSuffix.size() && name.compare(name.size() - heatMapSuffix.size(), heatMapSuffix.size(), heatMapSuffix) == 0) continue;
+            files.push_back(relative);
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    };
+
+    auto filesA = collect(dirA);
+    auto filesB = collect(dirB);
+
+    std::vector<ComparePair> pairs;
+    for (const auto& file : filesB)
+    {
+        if (!std::binary_search(filesA.begin(), filesA.end(), file))
+        {
+            missing.push_back("Image '" + (dirB / file).string() + "' has no corresponding image in '" + dirA.string() + "'.");
+            continue;
+        }
+        std::filesystem::path heatMapPath = heatMapSuffix.empty() ? std::filesystem::path() : dirB / (file.string() + heatMapSuffix);
+        pairs.push_back({ dirA / file, dirB / file, heatMapPath });
+    }
+    for (const auto& file : filesA)
+    {
+        if (!std::binary_search(filesB.begin(), filesB.end(), file))
+        {
+            missing.push_back("Image '" + (dirA / file).string() + "' has no corresponding image in '" + dirB.string() + "'.");
+        }
+    }
+    return pairs;
+}
+
+/** Read image pairs from a manifest file.
+    Each line contains two image paths and an optional heat map path separated by tabs. Empty lines and lines starting with '#' are ignored.
+    Relative paths are relative to the directory of the manifest.
+*/
+static std::vector<ComparePair> readManifest(const std::filesystem::path& path)
+{
+    std::ifstream stream(path);
+    if (!stream) throw std::runtime_error("Cannot open manifest '" + path.string() + "'.");
+
+    const auto baseDir = path.parent_path();
+    std::vector<ComparePair> pairs;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(stream, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, '\t')) fields.push_back(field);
+        if (fields.size() < 2 || fields.size() > 3) throw std::runtime_error("Invalid manifest line " + std::to_string(lineNumber) + " in '" + path.string() + "'.");
+
+        auto resolve = [&baseDir] (const std::string& p) { return p.empty() ? std::filesystem::path() : baseDir / p; };
+        pairs.push_back({ resolve(fields[0]), resolve(fields[1]), fields.size() > 2 ? resolve(fields[2]) : std::filesystem::path() });
+    }
+    return pairs;
+}
+
+/** Compare image pairs in parallel.
+    \param[in] threadCount Number of image pairs compared concurrently.
+*/
+static std::vector<CompareResult> compareImagePairs(const std::vector<ComparePair>& pairs, const ErrorMetric& metric, float threshold, const CompareOptions& options, uint32_t threadCount)
+{
+    std::vector<CompareResult> results(pairs.size());
+    std::atomic<size_t> next = 0;
+    auto worker = [&] ()
+    {
+        for (size_t i = next++; i < pairs.size(); i = next++)
+        {
+            results[i] = compareImages(pairs[i], metric, threshold, options);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < std::min<size_t>(threadCount, pairs.size()); i++) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+    return results;
+}
+
+static std::string jsonString(const std::string& str)
+{
+    std::string s = "\"";
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"': s += "\\\""; break;
+        case '\\': s += "\\\\"; break;
+        case '\n': s += "\\n"; break;
+        case '\t': s += "\\t"; break;
+        default:
+            if (uint8_t(c) < 0x20) { char buf[8]; std::snprintf(buf, sizeof(buf), "\\u%04x", c); s += buf; }
+            else s += c;
+        }
+    }
+    return s + "\"";
+}
 
-    return error <= threshold;
+static std::string jsonNumber(double value)
+{
+    if (std::isnan(value) || std::isinf(value)) return "null";
+    std::ostringstream ss;
+    ss.precision(17);
+    ss << value;
+    return ss.str();
+}
+
+static void writeReport(const std::filesystem::path& path, const ErrorMetric& metric, float threshold, const std::vector<ComparePair>& pairs, const std::vector<CompareResult>& results, const std::vector<std::string>& messages)
+{
+    std::ofstream stream(path);
+    if (!stream) throw std::runtime_error("Cannot write report '" + path.string() + "'.");
+
+    size_t failed = std::count_if(results.begin(), results.end(), [] (const CompareResult& r) { return !r.success; });
+
+    stream << "{\n";
+    stream << "    \"metric\": " << jsonString(metric.name) << ",\n";
+    stream << "    \"threshold\": " << jsonNumber(threshold) << ",\n";
+    stream << "    \"compared\": " << results.size() << ",\n";
+    stream << "    \"failed\": " << failed << ",\n";
+    stream << "    \"messages\": [";
+    for (size_t i = 0; i < messages.size(); i++) stream << (i > 0 ? ", " : "") << jsonString(messages[i]);
+    stream << "],\n";
+    stream << "    \"images\": [\n";
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        const auto& r = results[i];
+        stream << "        { ";
+        stream << "\"image1\": " << jsonString(pairs[i].pathA.string()) << ", ";
+        stream << "\"image2\": " << jsonString(pairs[i].pathB.string()) << ", ";
+        stream << "\"error\": " << (r.compared ? jsonNumber(r.error) : "null") << ", ";
+        stream << "\"success\": " << (r.success ? "true" : "false") << ", ";
+        stream << "\"message\": " << jsonString(r.message);
+        stream << " }" << (i + 1 < pairs.size() ? "," : "") << "\n";
+    }
+    stream << "    ]\n";
+    stream << "}\n";
 }
 
 static void printMetrics(std::ostream &stream = std::cout)
@@ -342,16 +874,22 @@ static void printMetrics(std::ostream &stream = std::cout)
 
 int main(int argc, char** argv)
 {
-    args::ArgumentParser parser("Utility to compare images.");
+    args::ArgumentParser parser("Utility to compare images.", "In batch mode, image1 and image2 are directories and all images with the same relative path are compared. "
+        "With a manifest, the image pairs are read from a file with one tab-separated pair (and optional heat map path) per line.");
     parser.helpParams.programName = "ImageCompare";
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
     args::Flag listMetricsFlag(parser, "", "List available error metrics.", {'l'});
     args::ValueFlag<std::string> metricFlag(parser, "metric", "The error metric.", {'m'});
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
-    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map. In batch mode, this is a suffix appended to the filename of the second image.", {'e'});
+    args::ValueFlag<float> ppdFlag(parser, "ppd", "Pixels per degree used by the flip metric (default matches FLIPPass).", {"ppd"});
+    args::Flag batchFlag(parser, "", "Batch mode. Compare all images in two directories.", {'b', "batch"});
+    args::ValueFlag<std::string> manifestFlag(parser, "manifest", "Compare the image pairs listed in a manifest file.", {"manifest"});
+    args::ValueFlag<std::string> reportFlag(parser, "report", "Write a JSON report of a batch comparison.", {'r', "report"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "threads", "Number of image pairs compared concurrently in batch mode.", {'j'});
+    args::Positional<std::string> image1(parser, "image1", "The first image (or directory in batch mode).");
+    args::Positional<std::string> image2(parser, "image2", "The second image (or directory in batch mode).");
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -401,12 +939,85 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
-    return compareImages(
-        args::get(image1),
-        args::get(image2),
-        metric,
-        thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false,
-        heatMapFlag ? args::get(heatMapFlag) : ""
-    ) ? 0 : 1;
+    const float threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    CompareOptions options;
+    options.alpha = alphaFlag ? args::get(alphaFlag) : false;
+    if (ppdFlag) options.pixelsPerDegree = args::get(ppdFlag);
+    const std::string heatMap = heatMapFlag ? args::get(heatMapFlag) : "";
+
+    // Single image pair.
+    if (!batchFlag && !manifestFlag)
+    {
+        if (!image1 || !image2)
+        {
+            std::cerr << "Two images are required." << std::endl;
+            std::cerr << parser;
+            return 1;
+        }
+
+        auto result = compareImages({ args::get(image1), args::get(image2), heatMap }, metric, threshold, options);
+        if (!result.compared)
+        {
+            std::cerr << result.message << std::endl;
+            return 1;
+        }
+        std::cout << result.error << std::endl;
+        return result.success ? 0 : 1;
+    }
+
+    // Batch of image pairs.
+    std::vector<ComparePair> pairs;
+    std::vector<std::string> messages;
+    try
+    {
+        if (manifestFlag)
+        {
+            pairs = readManifest(args::get(manifestFlag));
+        }
+        else
+        {
+            if (!image1 || !image2)
+            {
+                std::cerr << "Two directories are required in batch mode." << std::endl;
+                std::cerr << parser;
+                return 1;
+            }
+            pairs = collectDirectoryPairs(args::get(image1), args::get(image2), heatMap, messages);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    uint32_t threadCount = threadsFlag ? std::max(1u, args::get(threadsFlag)) : std::max(1u, std::thread::hardware_concurrency());
+    auto results = compareImagePairs(pairs, metric, threshold, options, threadCount);
+
+    size_t failed = 0;
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        const auto& r = results[i];
+        if (r.success) continue;
+        failed++;
+        if (r.compared) std::cerr << "Image '" << pairs[i].pathB.string() << "' failed with error " << r.error << "." << std::endl;
+        else std::cerr << r.message << std::endl;
+    }
+    for (const auto& message : messages) std::cerr << message << std::endl;
+
+    if (reportFlag)
+    {
+        try
+        {
+            writeReport(args::get(reportFlag), metric, threshold, pairs, results, messages);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Compared " << pairs.size() << " image pairs, " << failed << " failed." << std::endl;
+    return failed == 0 && messages.empty() ? 0 : 1;
 }
@@ -11,6 +11,7 @@ import datetime
 import argparse
 import subprocess
 import shutil
+import tempfile
 from pathlib import Path
 from enum import Enum
 
@@ -178,18 +179,26 @@ class Test:
 
         return Test.Result.PASSED, []
 
-    def compare_image(self, ref_file, result_file, error_file, tolerance, image_compare_exe):
+    def compare_image_batch(self, image_files, tolerance, image_compare_exe):
         '''
-        Compare two images using ImageCompare.
-        Returns a tuple containing the a boolean to indicate success and the measured error.
+        Compare a list of (ref_file, result_file, error_file) tuples using a single ImageCompare process.
+        Returns a list of tuples containing a boolean to indicate success and the measured error (None if images could not be compared).
         '''
-        args = [str(image_compare_exe), '-m', 'mse', '-t', str(tolerance), str(ref_file), str(result_file)]
-        if error_file:
-            args += ['-e', str(error_file)]
-        process = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
-        output = process.communicate()[0]
-        error = float(output.strip())
-        return process.returncode == 0, error
+        with tempfile.TemporaryDirectory() as temp_dir:
+            manifest_file = Path(temp_dir) / 'manifest.txt'
+            report_file = Path(temp_dir) / 'report.json'
+            with open(manifest_file, 'w') as f:
+                for ref_file, result_file, error_file in image_files:
+                    f.write('\t'.join(str(Path(p).resolve()) for p in [ref_file, result_file, error_file] if p) + '\n')
+
+            args = [str(image_compare_exe), '-m', 'mse', '-t', str(tolerance), '--manifest', str(manifest_file), '-r', str(report_file)]
+            process = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+            output = process.communicate()[0]
+            if not report_file.exists():
+                raise RuntimeError(f'ImageCompare failed: {output.decode(errors="replace").strip()}')
+            report = json.loads(report_file.read_text())
+
+        return [(image['success'], image['error']) for image in report['images']]
 
     def compare_images(self, ref_dir, result_dir, image_compare_exe):
         '''
@@ -223,17 +232,19 @@ class Test:
         messages = []
         image_reports = []
 
-        # Compare every result image with the corresponding reference image and report missing references.
+        # Report missing references.
+        compared_images = []
         for image in result_images:
             if not image in ref_images:
                 result = Test.Result.FAILED
                 messages.append(f'Test has generated image "{image}" with no corresponding reference image.')
                 continue
+            compared_images.append(image)
 
-            ref_file = ref_dir / image
-            result_file = result_dir / image
-            error_file = result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)
-            compare_success, compare_error = self.compare_image(ref_file, result_file, error_file, self.tolerance, image_compare_exe)
+        # Compare every result image with the corresponding reference image.
+        image_files = [(ref_dir / image, result_dir / image, result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)) for image in compared_images]
+        compare_results = self.compare_image_batch(image_files, self.tolerance, image_compare_exe) if len(image_files) > 0 else []
+        for image, (compare_success, compare_error) in zip(compared_images, compare_results):
             if not compare_success:
                 result = Test.Result.FAILED
                 messages.append(f'Test image "{image}" failed with error {compare_error}.')
@@ -12,16 +12,21 @@ from build_falcor import build_falcor
 from core import Environment, config
 from core.termcolor import colored
 
-def run_unit_tests(env, filter_regex, repeat_count):
+def run_unit_tests(env, filter_regex, repeat_count, jobs=None, test_timeout=None):
     '''
     Run unit tests by running FalcorTest.
     The optional filter_regex is used to select specific tests to run.
+    The optional jobs sets the number of threads running CPU tests concurrently (0 = number of logical cores).
     '''
     args = [str(env.falcor_test_exe)]
     if filter_regex:
         args += ['--filter', str(filter_regex)]
     if repeat_count:
         args += ['--repeat', str(repeat_count)]
+    if jobs is not None:
+        args += ['--jobs', str(jobs)]
+    if test_timeout:
+        args += ['--timeout', str(test_timeout)]
 
     p = subprocess.Popen(args)
     try:
@@ -43,6 +48,8 @@ def main():
     parser.add_argument('-e', '--environment', type=str, action='store', help='Environment', default=config.DEFAULT_ENVIRONMENT)
     parser.add_argument('-f', '--filter', type=str, action='store', help='Regular expression for filtering tests to run')
     parser.add_argument('-r', '--repeat', type=int, action='store', help='Number of times to repeat the test.')
+    parser.add_argument('-j', '--jobs', type=int, action='store', help='Number of threads running CPU tests concurrently (0 = number of logical cores).')
+    parser.add_argument('--timeout', type=int, action='store', help='Fail tests running longer than the given number of seconds.')
     parser.add_argument('--skip-build', action='store_true', help='Skip building project before running tests')
     args = parser.parse_args()
 
@@ -60,7 +67,7 @@ def main():
             sys.exit(1)
 
     # Run tests.
-    success = run_unit_tests(env, args.filter, args.repeat)
+    success = run_unit_tests(env, args.filter, args.repeat, args.jobs, args.timeout)
 
     sys.exit(0 if success else 1)
 